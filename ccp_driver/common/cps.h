@@ -202,11 +202,32 @@ extern void CPS_CacheInvalidate(void* address, size_t size, uintptr_t devInfo);
 extern void CPS_CacheFlush(void* address, size_t size, uintptr_t devInfo);
 
 /**
- * Delay software execution by a number of nanoseconds
+ * Delay software execution by a number of nanoseconds.
+ * Drivers use it also as a back-off step of polling loops, so on
+ * a system with a scheduler longer delays may sleep or yield the CPU
  * @param[in] ns number of nanoseconds to delay software execution
  */
 extern void CPS_DelayNs(uint32_t ns);
 
+/**
+ * Get time from a monotonic clock
+ * Drivers use it to measure timeouts, so it must not go backwards and
+ * it must keep counting while software execution is delayed
+ * @return nanoseconds elapsed since an arbitrary, fixed point in time
+ */
+extern uint64_t CPS_GetTimeNs(void);
+
+/**
+ * Get the number of register accesses done with CPS_ReadReg32/64 and
+ * CPS_WriteReg32/64. Drivers use it only for statistics, a platform which
+ * does not count the accesses may return zeros. The counters are shared by
+ * all driver instances, so they must be updated atomically when registers
+ * are accessed from more than one context
+ * @param[out] reads number of register reads since start-up
+ * @param[out] writes number of register writes since start-up
+ */
+extern void CPS_GetRegAccessCount(uint64_t* reads, uint64_t* writes);
+
 /**
  * Memory barrier
  * Waits until previous data accesses are finished
@@ -225,6 +246,26 @@ extern void CPS_MemoryBarrierWrite(void);
  */
 extern void CPS_MemoryBarrierRead(void);
 
+/**
+ * Atomic compare and swap of a 32-bit variable. The operation is
+ * a full memory barrier
+ * @param[in] address address of the variable
+ * @param[in] expected value the variable is expected to hold
+ * @param[in] value value written if the variable holds expected value
+ * @return true if value was written, false if the variable was changed
+ */
+extern bool CPS_AtomicCompareSwap32(volatile uint32_t* address, uint32_t expected, uint32_t value);
+
+/**
+ * Atomic compare and swap of a pointer variable. The operation is
+ * a full memory barrier
+ * @param[in] address address of the variable
+ * @param[in] expected pointer the variable is expected to hold
+ * @param[in] value pointer written if the variable holds expected pointer
+ * @return true if value was written, false if the variable was changed
+ */
+extern bool CPS_AtomicCompareSwapPtr(void* volatile* address, void* expected, void* value);
+
 // parasoft-end-suppress METRICS-36-3
 // parasoft-end-suppress MISRA2012-RULE-8_6-2
 
@@ -107,6 +107,19 @@ typedef struct CSDD_CQRequestData_s CSDD_CQRequestData;
 typedef struct CSDD_CQRequest_s CSDD_CQRequest;
 typedef struct CSDD_CQDcmdRequest_s CSDD_CQDcmdRequest;
 typedef struct CSDD_CQIntCoalescingCfg_s CSDD_CQIntCoalescingCfg;
+typedef struct CSDD_CQCompletion_s CSDD_CQCompletion;
+typedef struct CSDD_CQSchedConfig_s CSDD_CQSchedConfig;
+typedef struct CSDD_CQIntCoalescingAuto_s CSDD_CQIntCoalescingAuto;
+typedef struct CSDD_CQIntCoalescingStats_s CSDD_CQIntCoalescingStats;
+typedef struct CSDD_HybridPollStats_s CSDD_HybridPollStats;
+typedef struct CSDD_BounceStats_s CSDD_BounceStats;
+typedef struct CSDD_DeviceListNode_s CSDD_DeviceListNode;
+typedef struct CSDD_MemRequest_s CSDD_MemRequest;
+typedef struct CSDD_AddrXlateEntry_s CSDD_AddrXlateEntry;
+typedef struct CSDD_Adma2Chain_s CSDD_Adma2Chain;
+typedef struct CSDD_MemBatchEntry_s CSDD_MemBatchEntry;
+typedef struct CSDD_DmaCalTiming_s CSDD_DmaCalTiming;
+typedef struct CSDD_DmaCalibration_s CSDD_DmaCalibration;
 typedef struct CSDD_SDIO_SlotSettings_s CSDD_SDIO_SlotSettings;
 typedef struct CSDD_SDIO_CidRegister_s CSDD_SDIO_CidRegister;
 typedef struct CSDD_SDIO_Device_s CSDD_SDIO_Device;
@@ -286,7 +299,17 @@ typedef enum
     /** restore signal interrupts */
     CSDD_CONFIG_RESTORE_SIGNAL_INTERRUPT = 5U,
     /** set DMA mode */
-    CSDD_CONFIG_SET_DMA_MODE = 6U
+    CSDD_CONFIG_SET_DMA_MODE = 6U,
+    /** enable (1) or disable (0) non-blocking command issue. In non-blocking mode a request which finds the slot busy or CMD/DAT line inhibited is appended to the slot submission queue. Queued requests are issued in order from the command/transfer complete interrupt, without polling SRS09 */
+    CSDD_CONFIG_SET_NONBLOCK_ISSUE = 7U,
+    /** set hybrid interrupt/polling completion mode of the host. Argument is uint32_t number of requests submitted within SDIO_CFG_HYBRID_POLL_WINDOW_NS above which interrupt signals, except card detection and DMA interrupt which refills ADMA2 descriptor ring, are masked and completions are polled from the submitting context, 0 disables the mode. Interrupts are enabled again when a window ends with fewer requests or when all submitted requests have finished. While polling, completions are collected only when the driver is called (request submission, waiting for a request, CSDD_Isr), so a user which waits only for completion callbacks has to call CSDD_Isr periodically. The mode is not used while command queuing is enabled */
+    CSDD_CONFIG_SET_HYBRID_POLL = 8U,
+    /** drop address ranges translated by CSDD_Callbacks.virtToPhysCallback and cached by the host. It has to be called when a mapping of data buffer used before changes, e.g. buffer is unpinned. No argument */
+    CSDD_CONFIG_FLUSH_ADDR_CACHE = 9U,
+    /** set SDMA buffer boundary of the slot. Argument is uint32_t boundary in bytes, power of 2 from 4 KB to 512 KB. SDMA stops at each boundary and is resumed by the driver from the DMA interrupt, so a bigger boundary means fewer interrupts. 0 (default) selects for each transfer the biggest boundary at which all physical discontinuities of data buffer lie, so data buffer translated by CSDD_Callbacks.virtToPhysCallback does not have to be physically contiguous. Number of boundary interrupts is reported in CSDD_Request.sdmaBoundaryInts */
+    CSDD_CONFIG_SET_SDMA_BOUNDARY = 10U,
+    /** enable (1) or disable (0) the command queuing completion ring of the slot. When enabled, each finished CQ request is stored in the ring with its task ID, final status and userContext, so all completions can be read in one pass by CSDD_CQGetCompletions. Enabling empties the ring. The ring holds SDIO_CFG_CQ_COMPL_RING_SIZE entries, completions which find it full are dropped and counted */
+    CSDD_CONFIG_SET_CQ_COMPLETION_RING = 11U
 } CSDD_ConfigCmd;
 
 typedef enum
@@ -432,6 +455,20 @@ typedef enum
     CSDD_CQ_REQ_STAT_FAILED = 3U
 } CSDD_CQReqStat;
 
+/** Command queuing I/O class of request, used by the scheduler, see CSDD_CQSetSchedConfig */
+typedef enum
+{
+    /** Request without special needs */
+    CSDD_CQ_IO_CLASS_DEFAULT = 0U,
+    /** Latency sensitive request (small reads), started first and with high priority */
+    CSDD_CQ_IO_CLASS_LATENCY = 1U,
+    /** Large background transfer (sequential writes), started last */
+    CSDD_CQ_IO_CLASS_BULK = 2U
+} CSDD_CQIoClass;
+
+/** Number of command queuing I/O classes */
+#define CSDD_CQ_IO_CLASS_COUNT 3U
+
 /** PHY configuration delay type */
 typedef enum
 {
@@ -478,6 +515,14 @@ typedef void (*CSDD_AxiErrorCallback)(void* pd, uint8_t axiError);
 
 typedef uint8_t (*CSDD_SetTuneValCallback)(const CSDD_SDIO_Host* pd, uint8_t tune_val);
 
+typedef void (*CSDD_RequestCompleteCallback)(CSDD_Request* request, void* userContext);
+
+typedef void (*CSDD_CQRequestCompleteCallback)(CSDD_CQRequest* request, void* userContext);
+
+typedef void (*CSDD_CQDcmdCompleteCallback)(CSDD_CQDcmdRequest* request, void* userContext);
+
+typedef uintptr_t (*CSDD_VirtToPhysCallback)(CSDD_SDIO_Host* pd, void* address, uint32_t size, uint32_t* contiguousSize);
+
 /**
  *  @}
  */
@@ -485,6 +530,17 @@ typedef uint8_t (*CSDD_SetTuneValCallback)(const CSDD_SDIO_Host* pd, uint8_t tun
 /** @defgroup DriverFunctionAPI Driver Function API
  *  Prototypes for the driver API functions. The user application can link statically to the
  *  necessary API functions and call them directly.
+ *
+ *  Reentrancy: the driver keeps all of its own state in the
+ *  CSDD_SDIO_Host object (per host) and its CSDD_SDIO_Slot objects (per slot),
+ *  so the functions can be called concurrently for different host objects,
+ *  e.g. one SD4HC instance per core. Calls for one host object must be
+ *  serialized by the caller, only CSDD_IsrTopHalf may preempt them.
+ *  CSDD_Probe does not use any object and is always reentrant.
+ *  The only state shared by host objects are the platform register access
+ *  counters (CPS_GetRegAccessCount), which only feed CSDD_Request regReads
+ *  and regWrites, so these count also accesses of other hosts done while
+ *  the request was in progress.
  *  @{
  */
 
@@ -529,7 +585,7 @@ uint32_t CSDD_Stop(CSDD_SDIO_Host* pD);
  * @param[in] pD private data
  * @param[in] slotIndex slot index
  * @param[in] request request to execute
- * @return 0 on success or error code otherwise
+ * @return 0 on success, EINPROGRESS if request is executing or queued, or error code otherwise
  */
 uint32_t CSDD_ExecCardCommand(CSDD_SDIO_Host* pD, uint8_t slotIndex, CSDD_Request* request);
 
@@ -589,6 +645,47 @@ uint32_t CSDD_Configure(CSDD_SDIO_Host* pD, uint8_t slotIndex, CSDD_ConfigCmd cm
  */
 void CSDD_Isr(CSDD_SDIO_Host* pD, bool* handled);
 
+/**
+ * interrupt top half, alternative to CSDD_Isr for integrators which
+ * handle interrupts in a deferred context. It only acknowledges and
+ * saves the status of signalling slots and masks their interrupt
+ * signals, it never waits for the hardware. Errors are left latched for
+ * CSDD_IsrBottomHalf, which has to be scheduled whenever handled is set.
+ * Blocking driver calls wait for the bottom half, so it has to run in a
+ * context which can preempt them (e.g. a worker thread)
+ * @param[in] pD private data
+ * @param[out] handled informs if interrupt occurred and CSDD_IsrBottomHalf has to be called
+ */
+void CSDD_IsrTopHalf(CSDD_SDIO_Host* pD, bool* handled);
+
+/**
+ * interrupt bottom half, handles the status saved by CSDD_IsrTopHalf
+ * including error recovery and completion callbacks, then unmasks the
+ * slot interrupt signals. It must not run concurrently with other driver
+ * calls except CSDD_IsrTopHalf
+ * @param[in] pD private data
+ * @return 0 on success or error code otherwise
+ */
+uint32_t CSDD_IsrBottomHalf(CSDD_SDIO_Host* pD);
+
+/**
+ * Function returns statistics of hybrid interrupt/polling completion
+ * mode, see CSDD_CONFIG_SET_HYBRID_POLL
+ * @param[in] pD private data
+ * @param[out] stats statistics of the host
+ * @return 0 on success or error code otherwise
+ */
+uint32_t CSDD_GetHybridPollStats(CSDD_SDIO_Host* pD, CSDD_HybridPollStats* stats);
+
+/**
+ * Function returns statistics of DMA bounce buffers used for data
+ * buffers which are not aligned for DMA, see CSDD_Config
+ * @param[in] pD private data
+ * @param[out] stats statistics of the host
+ * @return 0 on success or error code otherwise
+ */
+uint32_t CSDD_GetBounceStats(CSDD_SDIO_Host* pD, CSDD_BounceStats* stats);
+
 /**
  * switches a card and host to work either in high speed mode or in
  * normal mode
@@ -689,11 +786,61 @@ uint32_t CSDD_MemoryCardDataTransfer(CSDD_SDIO_Host* pD, uint8_t slotIndex, uint
  * @param[in,out] buffer buffer (or buffers when SubBufferCount > 0) with data to be written or to save data that was read
  * @param[in] size BufferSize size of buffer in bytes
  * @param[in] direction parameter defines data transfer direction
- * @param[in] subBufferCount If it is bigger than 0 it means that Buffer is pointer to CSDD_SubBuffer array where are defined buffers with data to transfer and data sizes of each buffer
+ * @param[in] subBufferCount If it is bigger than 0 it means that Buffer is pointer to CSDD_SubBuffer array where are defined DMA addresses of buffers with data to transfer and data sizes of each buffer. Cache of these buffers is maintained by the caller
  * @return 0 on success or error code otherwise
  */
 uint32_t CSDD_MemoryCardDataTransfer2(CSDD_SDIO_Host* pD, uint8_t slotIndex, uint32_t address, void* buffer, uint32_t size, CSDD_TransferDirection direction, uint32_t subBufferCount);
 
+/**
+ * Function transfers data to/from memory card directly from/to
+ * scattered buffers. Each segment is described by one ADMA2 descriptor,
+ * data is not copied. Function operates on blocks (512 bytes)
+ * @param[in] pD private data
+ * @param[in] slotIndex slot index
+ * @param[in] address memory card address to/from which data will be transferred; address in blocks (512 bytes);
+ * @param[in] segments array of segments; address of each segment is DMA (physical) address aligned to 4 bytes (8 bytes for 64-bit DMA), size is not bigger than 64 KB (64 MB for host version 4 and above). Sum of sizes must be divisible by 512. Driver does no cache maintenance of the segments, the caller cleans written segments before and invalidates read segments after the transfer, unless they are cache coherent
+ * @param[in] segmentCount number of segments
+ * @param[in] direction parameter defines data transfer direction
+ * @return 0 on success or error code otherwise
+ */
+uint32_t CSDD_MemoryCardSgTransfer(CSDD_SDIO_Host* pD, uint8_t slotIndex, uint32_t address, CSDD_SubBuffer* segments, uint32_t segmentCount, CSDD_TransferDirection direction);
+
+/**
+ * Function executes independent block reads and writes as one ADMA3
+ * transfer. Each entry is one command of an integrated descriptor chain,
+ * the controller executes up to CSDD_MAX_NUMBER_COMMAND entries
+ * and interrupts once when all of them are finished. Longer batches are
+ * split into chains of CSDD_MAX_NUMBER_COMMAND entries. Function
+ * requires ADMA3 (host version 6 and above) and DMA mode set to auto
+ * or ADMA3
+ * @param[in] pD private data
+ * @param[in] slotIndex slot index
+ * @param[in] entries array of transfers, each buffer is aligned for DMA (4 bytes, 8 bytes for 64-bit DMA) and its size is divisible by 512
+ * @param[in] entryCount number of transfers
+ * @return 0 on success, EINVAL if a buffer is not aligned or error code otherwise
+ */
+uint32_t CSDD_MemCardBatchXfer(CSDD_SDIO_Host* pD, uint8_t slotIndex, CSDD_MemBatchEntry* entries, uint32_t entryCount);
+
+/**
+ * Function measures transfers of each size class in all DMA modes
+ * supported by the slot except ADMA1, which depends on buffer alignment,
+ * (and without DMA) and stores mode selection
+ * table used by auto DMA mode for transfers with 512 bytes blocks.
+ * For each class the mode with the lowest CPU time is selected among
+ * the modes which wall time is close to the best one. Classes which
+ * transfer size exceeds the buffer size are not measured, fixed rules
+ * are used for them. Card data is only read. Table is dropped when the card
+ * is removed
+ * @param[in] pD private data
+ * @param[in] slotIndex slot index
+ * @param[in] address memory card address of the read data; address in blocks (512 bytes)
+ * @param[in] buffer buffer aligned for DMA to read data to
+ * @param[in] size size of buffer in bytes
+ * @param[out] result measured timings and selected modes
+ * @return 0 on success or error code otherwise
+ */
+uint32_t CSDD_MemCardCalibrateDmaMode(CSDD_SDIO_Host* pD, uint8_t slotIndex, uint32_t address, void* buffer, uint32_t size, CSDD_DmaCalibration* result);
+
 /**
  * function executes configuration commands on memory card
  * @param[in] pD private data
@@ -768,7 +915,11 @@ uint32_t CSDD_MemCardInfXferFinish(CSDD_SDIO_Host* pD, uint8_t slotIndex, CSDD_T
  * Therefore it returns pointer to current request. User using
  * MemoryCard_FinishXferNonBlock function and request pointer can wait
  * until operation finish and get the status of operation. Function
- * needs AUTO_CMD option enabled
+ * needs AUTO_CMD option enabled. Request is taken from a pool of
+ * SDIO_CFG_MEM_REQUESTS_PER_SLOT requests of the slot, it goes
+ * back to the pool in CSDD_MemCardFinishXferNonBlock. If the transfer
+ * is rejected or fails before the function returns, the error is
+ * returned and the request is already back in the pool
  * @param[in] pD private data
  * @param[in] slotIndex slot index
  * @param[in] address address in card memory to/from which data will be transferred; address in blocks (512 bytes)
@@ -776,13 +927,38 @@ uint32_t CSDD_MemCardInfXferFinish(CSDD_SDIO_Host* pD, uint8_t slotIndex, CSDD_T
  * @param[in] size size of buffer in bytes
  * @param[in] direction parameter defines transfer direction
  * @param[out] request current executing request
- * @return 0 on success or error code otherwise
+ * @return 0 on success, ENOMEM if all requests from the pool are in use
+ *     or error code otherwise
  */
 uint32_t CSDD_MemCardDataXferNonBlock(CSDD_SDIO_Host* pD, uint8_t slotIndex, uint32_t address, void* buffer, uint32_t size, CSDD_TransferDirection direction, void** request);
 
+/**
+ * Function works like CSDD_MemCardDataXferNonBlock, but additionally
+ * it registers a callback called from interrupt context when the
+ * transfer finishes. Status of the transfer is available in the
+ * request passed to the callback. If callback is not NULL the request
+ * goes back to the pool when the callback returns, so it must not be
+ * passed to CSDD_MemCardFinishXferNonBlock. Callback is called also for
+ * a transfer rejected before it is issued, it may be called before
+ * this function returns
+ * @param[in] pD private data
+ * @param[in] slotIndex slot index
+ * @param[in] address address in card memory to/from which data will be transferred; address in blocks (512 bytes)
+ * @param[in,out] buffer buffer with data to be written or to save data that was read
+ * @param[in] size size of buffer in bytes
+ * @param[in] direction parameter defines transfer direction
+ * @param[in] callback function called when transfer finishes, may be NULL
+ * @param[in] userContext pointer passed to the callback
+ * @param[out] request current executing request
+ * @return 0 on success, ENOMEM if all requests from the pool are in use
+ *     or error code otherwise
+ */
+uint32_t CSDD_MemCardDataXferNonBlockCb(CSDD_SDIO_Host* pD, uint8_t slotIndex, uint32_t address, void* buffer, uint32_t size, CSDD_TransferDirection direction, CSDD_RequestCompleteCallback callback, void* userContext, void** request);
+
 /**
  * Function waits until request finish and returns status of request
- * execution
+ * execution. Request started by CSDD_MemCardDataXferNonBlock goes back
+ * to the request pool and must not be used after this call
  * @param[in] pD private data
  * @param[in] pRequest request to wait for
  * @return 0 on success or error code otherwise
@@ -1240,6 +1416,105 @@ uint32_t CSDD_CQSetResponseErrorMask(CSDD_SDIO_Host* pD, uint32_t errorMask);
  */
 uint32_t CSDD_CQGetResponseErrorMask(CSDD_SDIO_Host* pD, uint32_t* errorMask);
 
+/**
+ * Function reads completions of command queuing requests stored in the
+ * completion ring, see CSDD_CONFIG_SET_CQ_COMPLETION_RING. If interrupts
+ * are disabled, the interrupt handler is called first to collect finished tasks.
+ * @param[in] pD private data
+ * @param[out] entries completions in the order the tasks finished
+ * @param[in] maxEntries size of entries array
+ * @param[out] count number of completions written to entries
+ * @param[out] overflows number of completions dropped because the ring was full since the ring was enabled, can be NULL
+ * @return 0 on success, EIO if completion ring is not enabled or error code otherwise
+ */
+uint32_t CSDD_CQGetCompletions(CSDD_SDIO_Host* pD, CSDD_CQCompletion* entries, uint8_t maxEntries, uint8_t* count, uint32_t* overflows);
+
+/**
+ * Function submits data transfer request to command queue. Driver allocates
+ * a free task for the request (request taskId is set by the driver), builds
+ * its descriptors and starts it. The doorbell is written only when ringDoorbell
+ * is set, then it starts all tasks submitted since the last doorbell, so
+ * a batch of requests is started by one register write. When all tasks are
+ * used, the request waits in a software backlog and is started when a task
+ * finishes. Without the scheduler requests get tasks in submission order,
+ * a request does not take a free task while an earlier one waits in the
+ * backlog. Request status is CSDD_CQ_REQ_STAT_PENDING until it finishes.
+ * Several threads may submit at the same time without a lock, tasks and
+ * the doorbell are taken with atomic operations. Other command queuing
+ * functions must not be called concurrently with it.
+ * When the scheduler is enabled (see CSDD_CQSetSchedConfig) every request
+ * goes through the backlog and it is started at the next doorbell or task completion.
+ * @param[in] pD private data
+ * @param[in] request data transfer request, it must be kept until it finishes
+ * @param[in] ringDoorbell 1 - start submitted tasks, 0 - more requests are going to be submitted
+ * @return 0 on success or error code otherwise
+ */
+uint32_t CSDD_CQSubmit(CSDD_SDIO_Host* pD, CSDD_CQRequest* request, uint8_t ringDoorbell);
+
+/**
+ * Function sets configuration of the command queuing I/O scheduler.
+ * When it is enabled, requests submitted by CSDD_CQSubmit wait in one
+ * backlog queue per I/O class and free tasks are given first to requests
+ * which missed their class deadline, then to latency, default and bulk
+ * classes in this order. Latency class tasks get high priority. Requests
+ * of the same queue which continue each other (same direction and flags,
+ * block address right after the previous request) are merged into one
+ * task with one transfer descriptor list. It can be changed only when
+ * no submitted request waits in the backlog.
+ * @param[in] pD private data
+ * @param[in] config new scheduler configuration
+ * @return 0 on success, EBUSY if backlog is not empty, EINVAL if merge
+ *     limit is too big or default or bulk class has no deadline while
+ *     scheduler is enabled, or error code otherwise
+ */
+uint32_t CSDD_CQSetSchedConfig(CSDD_SDIO_Host* pD, CSDD_CQSchedConfig* config);
+
+/**
+ * Function gets configuration of the command queuing I/O scheduler
+ * @param[in] pD private data
+ * @param[out] config current scheduler configuration
+ * @return 0 on success or error code otherwise
+ */
+uint32_t CSDD_CQGetSchedConfig(CSDD_SDIO_Host* pD, CSDD_CQSchedConfig* config);
+
+/**
+ * Function sets adaptive mode of command queuing interrupt coalescing.
+ * In this mode the driver measures task completion rate and number of
+ * outstanding tasks in the interrupt handler and once per
+ * SDIO_CFG_CQ_COAL_WINDOW_NS it retunes coalescing counter threshold and
+ * timeout. While completion rate is below maxIntRate, completions are
+ * coalesced only as much as they can be in latencyTargetUs, at queue
+ * depth 1 coalescing is disabled. Above it, threshold and timeout are
+ * raised to keep the interrupt rate under maxIntRate. Threshold is at most
+ * half of average number of outstanding tasks. Setting static
+ * configuration by CSDD_CQSetIntCoalescingConfig disables adaptive mode.
+ * As with static configuration, only tasks of requests with intCoalEn set
+ * are coalesced.
+ * @param[in] pD private data
+ * @param[in] config adaptive interrupt coalescing configuration
+ * @return 0 on success or error code otherwise
+ */
+uint32_t CSDD_CQSetIntCoalescingAuto(CSDD_SDIO_Host* pD, CSDD_CQIntCoalescingAuto* config);
+
+/**
+ * Function gets configuration of adaptive command queuing interrupt coalescing
+ * @param[in] pD private data
+ * @param[out] config adaptive interrupt coalescing configuration
+ * @return 0 on success or error code otherwise
+ */
+uint32_t CSDD_CQGetIntCoalescingAuto(CSDD_SDIO_Host* pD, CSDD_CQIntCoalescingAuto* config);
+
+/**
+ * Function gets counters of adaptive command queuing interrupt coalescing,
+ * see CSDD_CQSetIntCoalescingAuto. Counters are cleared when the mode is enabled.
+ * Interrupt handler publishes a consistent copy of the counters, it is read
+ * without masking the slot interrupt
+ * @param[in] pD private data
+ * @param[out] stats adaptive interrupt coalescing counters
+ * @return 0 on success or error code otherwise
+ */
+uint32_t CSDD_CQGetIntCoalescingStats(CSDD_SDIO_Host* pD, CSDD_CQIntCoalescingStats* stats);
+
 /**
  * Function reads base clock
  * @param[in] pD private data
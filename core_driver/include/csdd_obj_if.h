@@ -159,6 +159,47 @@ typedef struct CSDD_OBJ_s
      */
     void (*isr)(CSDD_SDIO_Host* pD, bool* handled);
 
+    /**
+     * interrupt top half, alternative to CSDD_Isr for integrators which
+     * handle interrupts in a deferred context. It only acknowledges and
+     * saves the status of signalling slots and masks their interrupt
+     * signals, it never waits for the hardware. Errors are left latched for
+     * CSDD_IsrBottomHalf, which has to be scheduled whenever handled is set.
+     * Blocking driver calls wait for the bottom half, so it has to run in a
+     * context which can preempt them (e.g. a worker thread)
+     * @param[in] pD private data
+     * @param[out] handled informs if interrupt occurred and CSDD_IsrBottomHalf has to be called
+     */
+    void (*isrTopHalf)(CSDD_SDIO_Host* pD, bool* handled);
+
+    /**
+     * interrupt bottom half, handles the status saved by CSDD_IsrTopHalf
+     * including error recovery and completion callbacks, then unmasks the
+     * slot interrupt signals. It must not run concurrently with other driver
+     * calls except CSDD_IsrTopHalf
+     * @param[in] pD private data
+     * @return 0 on success or error code otherwise
+     */
+    uint32_t (*isrBottomHalf)(CSDD_SDIO_Host* pD);
+
+    /**
+     * Function returns statistics of hybrid interrupt/polling completion
+     * mode, see CSDD_CONFIG_SET_HYBRID_POLL
+     * @param[in] pD private data
+     * @param[out] stats statistics of the host
+     * @return 0 on success or error code otherwise
+     */
+    uint32_t (*getHybridPollStats)(CSDD_SDIO_Host* pD, CSDD_HybridPollStats* stats);
+
+    /**
+     * Function returns statistics of DMA bounce buffers used for data
+     * buffers which are not aligned for DMA, see CSDD_Config
+     * @param[in] pD private data
+     * @param[out] stats statistics of the host
+     * @return 0 on success or error code otherwise
+     */
+    uint32_t (*getBounceStats)(CSDD_SDIO_Host* pD, CSDD_BounceStats* stats);
+
     /**
      * switches a card and host to work either in high speed mode or in
      * normal mode
@@ -259,11 +300,61 @@ typedef struct CSDD_OBJ_s
      * @param[in,out] buffer buffer (or buffers when SubBufferCount > 0) with data to be written or to save data that was read
      * @param[in] size BufferSize size of buffer in bytes
      * @param[in] direction parameter defines data transfer direction
-     * @param[in] subBufferCount If it is bigger than 0 it means that Buffer is pointer to CSDD_SubBuffer array where are defined buffers with data to transfer and data sizes of each buffer
+     * @param[in] subBufferCount If it is bigger than 0 it means that Buffer is pointer to CSDD_SubBuffer array where are defined DMA addresses of buffers with data to transfer and data sizes of each buffer. Cache of these buffers is maintained by the caller
      * @return 0 on success or error code otherwise
      */
     uint32_t (*memoryCardDataTransfer2)(CSDD_SDIO_Host* pD, uint8_t slotIndex, uint32_t address, void* buffer, uint32_t size, CSDD_TransferDirection direction, uint32_t subBufferCount);
 
+    /**
+     * Function transfers data to/from memory card directly from/to
+     * scattered buffers. Each segment is described by one ADMA2 descriptor,
+     * data is not copied. Function operates on blocks (512 bytes)
+     * @param[in] pD private data
+     * @param[in] slotIndex slot index
+     * @param[in] address memory card address to/from which data will be transferred; address in blocks (512 bytes);
+     * @param[in] segments array of segments; address of each segment is DMA (physical) address aligned to 4 bytes (8 bytes for 64-bit DMA), size is not bigger than 64 KB (64 MB for host version 4 and above). Sum of sizes must be divisible by 512. Driver does no cache maintenance of the segments, the caller cleans written segments before and invalidates read segments after the transfer, unless they are cache coherent
+     * @param[in] segmentCount number of segments
+     * @param[in] direction parameter defines data transfer direction
+     * @return 0 on success or error code otherwise
+     */
+    uint32_t (*memoryCardSgTransfer)(CSDD_SDIO_Host* pD, uint8_t slotIndex, uint32_t address, CSDD_SubBuffer* segments, uint32_t segmentCount, CSDD_TransferDirection direction);
+
+    /**
+     * Function executes independent block reads and writes as one ADMA3
+     * transfer. Each entry is one command of an integrated descriptor chain,
+     * the controller executes up to CSDD_MAX_NUMBER_COMMAND entries
+     * and interrupts once when all of them are finished. Longer batches are
+     * split into chains of CSDD_MAX_NUMBER_COMMAND entries. Function
+     * requires ADMA3 (host version 6 and above) and DMA mode set to auto
+     * or ADMA3
+     * @param[in] pD private data
+     * @param[in] slotIndex slot index
+     * @param[in] entries array of transfers, each buffer is aligned for DMA (4 bytes, 8 bytes for 64-bit DMA) and its size is divisible by 512
+     * @param[in] entryCount number of transfers
+     * @return 0 on success, EINVAL if a buffer is not aligned or error code otherwise
+     */
+    uint32_t (*memCardBatchXfer)(CSDD_SDIO_Host* pD, uint8_t slotIndex, CSDD_MemBatchEntry* entries, uint32_t entryCount);
+
+    /**
+     * Function measures transfers of each size class in all DMA modes
+     * supported by the slot except ADMA1, which depends on buffer alignment,
+     * (and without DMA) and stores mode selection
+     * table used by auto DMA mode for transfers with 512 bytes blocks.
+     * For each class the mode with the lowest CPU time is selected among
+     * the modes which wall time is close to the best one. Classes which
+     * transfer size exceeds the buffer size are not measured, fixed rules
+     * are used for them. Card data is only read. Table is dropped when the card
+     * is removed
+     * @param[in] pD private data
+     * @param[in] slotIndex slot index
+     * @param[in] address memory card address of the read data; address in blocks (512 bytes)
+     * @param[in] buffer buffer aligned for DMA to read data to
+     * @param[in] size size of buffer in bytes
+     * @param[out] result measured timings and selected modes
+     * @return 0 on success or error code otherwise
+     */
+    uint32_t (*memCardCalibrateDmaMode)(CSDD_SDIO_Host* pD, uint8_t slotIndex, uint32_t address, void* buffer, uint32_t size, CSDD_DmaCalibration* result);
+
     /**
      * function executes configuration commands on memory card
      * @param[in] pD private data
@@ -338,7 +429,11 @@ typedef struct CSDD_OBJ_s
      * Therefore it returns pointer to current request. User using
      * MemoryCard_FinishXferNonBlock function and request pointer can
      * wait until operation finish and get the status of operation.
-     * Function needs AUTO_CMD option enabled
+     * Function needs AUTO_CMD option enabled. Request is taken from a
+     * pool of SDIO_CFG_MEM_REQUESTS_PER_SLOT requests of the slot,
+     * it goes back to the pool in CSDD_MemCardFinishXferNonBlock. If
+     * the transfer is rejected or fails before the function returns,
+     * the error is returned and the request is already back in the pool
      * @param[in] pD private data
      * @param[in] slotIndex slot index
      * @param[in] address address in card memory to/from which data will be transferred; address in blocks (512 bytes)
@@ -346,13 +441,38 @@ typedef struct CSDD_OBJ_s
      * @param[in] size size of buffer in bytes
      * @param[in] direction parameter defines transfer direction
      * @param[out] request current executing request
-     * @return 0 on success or error code otherwise
+     * @return 0 on success, ENOMEM if all requests from the pool are in use
+     *     or error code otherwise
      */
     uint32_t (*memCardDataXferNonBlock)(CSDD_SDIO_Host* pD, uint8_t slotIndex, uint32_t address, void* buffer, uint32_t size, CSDD_TransferDirection direction, void** request);
 
+    /**
+     * Function works like CSDD_MemCardDataXferNonBlock, but additionally
+     * it registers a callback called from interrupt context when the
+     * transfer finishes. Status of the transfer is available in the
+     * request passed to the callback. If callback is not NULL the request
+     * goes back to the pool when the callback returns, so it must not be
+     * passed to CSDD_MemCardFinishXferNonBlock. Callback is called also
+     * for a transfer rejected before it is issued, it may be called
+     * before this function returns
+     * @param[in] pD private data
+     * @param[in] slotIndex slot index
+     * @param[in] address address in card memory to/from which data will be transferred; address in blocks (512 bytes)
+     * @param[in,out] buffer buffer with data to be written or to save data that was read
+     * @param[in] size size of buffer in bytes
+     * @param[in] direction parameter defines transfer direction
+     * @param[in] callback function called when transfer finishes, may be NULL
+     * @param[in] userContext pointer passed to the callback
+     * @param[out] request current executing request
+     * @return 0 on success, ENOMEM if all requests from the pool are in use
+     *     or error code otherwise
+     */
+    uint32_t (*memCardDataXferNonBlockCb)(CSDD_SDIO_Host* pD, uint8_t slotIndex, uint32_t address, void* buffer, uint32_t size, CSDD_TransferDirection direction, CSDD_RequestCompleteCallback callback, void* userContext, void** request);
+
     /**
      * Function waits until request finish and returns status of request
-     * execution
+     * execution. Request started by CSDD_MemCardDataXferNonBlock goes back
+     * to the request pool and must not be used after this call
      * @param[in] pD private data
      * @param[in] pRequest request to wait for
      * @return 0 on success or error code otherwise
@@ -810,6 +930,105 @@ typedef struct CSDD_OBJ_s
      */
     uint32_t (*cQGetResponseErrorMask)(CSDD_SDIO_Host* pD, uint32_t* errorMask);
 
+    /**
+     * Function reads completions of command queuing requests stored in the
+     * completion ring, see CSDD_CONFIG_SET_CQ_COMPLETION_RING. If interrupts
+     * are disabled, the interrupt handler is called first to collect finished tasks.
+     * @param[in] pD private data
+     * @param[out] entries completions in the order the tasks finished
+     * @param[in] maxEntries size of entries array
+     * @param[out] count number of completions written to entries
+     * @param[out] overflows number of completions dropped because the ring was full since the ring was enabled, can be NULL
+     * @return 0 on success, EIO if completion ring is not enabled or error code otherwise
+     */
+    uint32_t (*cQGetCompletions)(CSDD_SDIO_Host* pD, CSDD_CQCompletion* entries, uint8_t maxEntries, uint8_t* count, uint32_t* overflows);
+
+    /**
+     * Function submits data transfer request to command queue. Driver allocates
+     * a free task for the request (request taskId is set by the driver), builds
+     * its descriptors and starts it. The doorbell is written only when ringDoorbell
+     * is set, then it starts all tasks submitted since the last doorbell, so
+     * a batch of requests is started by one register write. When all tasks are
+     * used, the request waits in a software backlog and is started when a task
+     * finishes. Without the scheduler requests get tasks in submission order,
+     * a request does not take a free task while an earlier one waits in the
+     * backlog. Request status is CSDD_CQ_REQ_STAT_PENDING until it finishes.
+     * Several threads may submit at the same time without a lock, tasks and
+     * the doorbell are taken with atomic operations. Other command queuing
+     * functions must not be called concurrently with it.
+     * When the scheduler is enabled (see CSDD_CQSetSchedConfig) every request
+     * goes through the backlog and it is started at the next doorbell or task completion.
+     * @param[in] pD private data
+     * @param[in] request data transfer request, it must be kept until it finishes
+     * @param[in] ringDoorbell 1 - start submitted tasks, 0 - more requests are going to be submitted
+     * @return 0 on success or error code otherwise
+     */
+    uint32_t (*cQSubmit)(CSDD_SDIO_Host* pD, CSDD_CQRequest* request, uint8_t ringDoorbell);
+
+    /**
+     * Function sets configuration of the command queuing I/O scheduler.
+     * When it is enabled, requests submitted by CSDD_CQSubmit wait in one
+     * backlog queue per I/O class and free tasks are given first to requests
+     * which missed their class deadline, then to latency, default and bulk
+     * classes in this order. Latency class tasks get high priority. Requests
+     * of the same queue which continue each other (same direction and flags,
+     * block address right after the previous request) are merged into one
+     * task with one transfer descriptor list. It can be changed only when
+     * no submitted request waits in the backlog.
+     * @param[in] pD private data
+     * @param[in] config new scheduler configuration
+     * @return 0 on success, EBUSY if backlog is not empty, EINVAL if merge
+     *     limit is too big or default or bulk class has no deadline while
+     *     scheduler is enabled, or error code otherwise
+     */
+    uint32_t (*cQSetSchedConfig)(CSDD_SDIO_Host* pD, CSDD_CQSchedConfig* config);
+
+    /**
+     * Function gets configuration of the command queuing I/O scheduler
+     * @param[in] pD private data
+     * @param[out] config current scheduler configuration
+     * @return 0 on success or error code otherwise
+     */
+    uint32_t (*cQGetSchedConfig)(CSDD_SDIO_Host* pD, CSDD_CQSchedConfig* config);
+
+    /**
+     * Function sets adaptive mode of command queuing interrupt coalescing.
+     * In this mode the driver measures task completion rate and number of
+     * outstanding tasks in the interrupt handler and once per
+     * SDIO_CFG_CQ_COAL_WINDOW_NS it retunes coalescing counter threshold and
+     * timeout. While completion rate is below maxIntRate, completions are
+     * coalesced only as much as they can be in latencyTargetUs, at queue
+     * depth 1 coalescing is disabled. Above it, threshold and timeout are
+     * raised to keep the interrupt rate under maxIntRate. Threshold is at most
+     * half of average number of outstanding tasks. Setting static
+     * configuration by CSDD_CQSetIntCoalescingConfig disables adaptive mode.
+     * As with static configuration, only tasks of requests with intCoalEn set
+     * are coalesced.
+     * @param[in] pD private data
+     * @param[in] config adaptive interrupt coalescing configuration
+     * @return 0 on success or error code otherwise
+     */
+    uint32_t (*cQSetIntCoalescingAuto)(CSDD_SDIO_Host* pD, CSDD_CQIntCoalescingAuto* config);
+
+    /**
+     * Function gets configuration of adaptive command queuing interrupt coalescing
+     * @param[in] pD private data
+     * @param[out] config adaptive interrupt coalescing configuration
+     * @return 0 on success or error code otherwise
+     */
+    uint32_t (*cQGetIntCoalescingAuto)(CSDD_SDIO_Host* pD, CSDD_CQIntCoalescingAuto* config);
+
+    /**
+     * Function gets counters of adaptive command queuing interrupt coalescing,
+     * see CSDD_CQSetIntCoalescingAuto. Counters are cleared when the mode is enabled.
+     * Interrupt handler publishes a consistent copy of the counters, it is read
+     * without masking the slot interrupt
+     * @param[in] pD private data
+     * @param[out] stats adaptive interrupt coalescing counters
+     * @return 0 on success or error code otherwise
+     */
+    uint32_t (*cQGetIntCoalescingStats)(CSDD_SDIO_Host* pD, CSDD_CQIntCoalescingStats* stats);
+
     /**
      * Function reads base clock
      * @param[in] pD private data
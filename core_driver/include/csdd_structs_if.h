@@ -65,6 +65,8 @@ struct CSDD_SysReq_s
     uint32_t descSize;
     /** ADMA3 Integrated descriptors buffer size */
     uint32_t idDescSize;
+    /** size of the default pool of DMA bounce buffers (CSDD_Config bounceCount is 0), the buffers are optional */
+    uint32_t bounceSize;
 };
 
 /** Structure defining all configuration parameters applied on driver start-up */
@@ -82,6 +84,18 @@ struct CSDD_Config_s
     void* idDescPhyAddress;
     /** Enable DMA width 64bit */
     uint8_t dma64BitEn;
+    /** logical address of DMA bounce buffers, NULL if data buffers which are not aligned shall be transferred without DMA */
+    void* bounceLogAddress;
+    /** physical address of DMA bounce buffers */
+    void* bouncePhyAddress;
+    /** number of DMA bounce buffers in the pool, up to SDIO_CFG_BOUNCE_BUFFERS_MAX. 0 - default pool of CSDD_SysReq bounceSize, other values need bounceCount * bounceBufferSize bytes at bounceLogAddress */
+    uint8_t bounceCount;
+    /** size in bytes of each DMA bounce buffer, a multiple of 512, used only when bounceCount is not 0 */
+    uint32_t bounceBufferSize;
+    /** 1 if descriptor buffers are in DMA coherent memory, the driver skips cache maintenance of descriptors then */
+    uint8_t descCoherent;
+    /** 1 if DMA of the controller is coherent with CPU caches (IO-coherent interconnect), the driver skips all cache maintenance then */
+    uint8_t ioCoherent;
 };
 
 /** Structure describes a parameters of SD request */
@@ -121,7 +135,7 @@ struct CSDD_CommandField_s
     /** size of block data in bytes to send or receive; field to be taken into consideration only in data transfer commands */
     uint16_t blockLen;
     /** Number of sub-buffers */
-    uint8_t subBuffersCount;
+    uint32_t subBuffersCount;
     /** data buffer or buffers for read/write data; field to be taken into consideration only in data transfer commands. If the SubBuffersCount parameter is 0 then it is just pointer to data. But if the SubBuffersCount is more than 0 then it is pointer to array of sub buffers. */
     void* pDataBuffer;
 };
@@ -160,6 +174,30 @@ struct CSDD_Request_s
     CSDD_Request* subCommandRequest;
     /** Indicate request is executed as a subcommand or Main command */
     CSDD_CmdCat commandCategory;
+    /** Next request in the slot submission queue. Only driver can modify it. */
+    CSDD_Request* pNextRequest;
+    /** Optional function called when request finishes with any status, NULL if not used */
+    CSDD_RequestCompleteCallback completeCallback;
+    /** User pointer passed to completeCallback */
+    void* userContext;
+    /** Number of register reads done from the request submission until its completion, valid when the request is completed. Request queued behind other requests counts from its issue, so accesses of the transfers ahead of it are not included. Accesses are counted by the platform for all hosts and slots, so requests which overlap, on other slots or hosts, count accesses of each other */
+    uint32_t regReads;
+    /** Number of register writes done from the request submission until its completion, see regReads */
+    uint32_t regWrites;
+    /** Internal field */
+    uint8_t regCountActive;
+    /** Internal field: user data buffer replaced by a bounce buffer of the host pool, NULL if the request is not bounced */
+    void* bounceUserBuffer;
+    /** Internal field: 1 if data buffers were prepared for DMA and need cache maintenance when the request finishes */
+    uint8_t dmaMapped;
+    /** Internal field: 1 if DMA transfer was prepared while the request was queued */
+    uint8_t dmaPrepared;
+    /** Number of data bytes written back from CPU cache for the request, valid when the request is completed */
+    uint32_t cacheCleanBytes;
+    /** Number of data bytes invalidated in CPU cache for the request, before and after the transfer, valid when the request is completed */
+    uint32_t cacheInvalidateBytes;
+    /** Number of SDMA buffer boundary interrupts of the request, valid when the request is completed */
+    uint32_t sdmaBoundaryInts;
     /** Number of command in a request. For noDMA, SDMA, ADMA1, ADMA2 must be 1 and for ADMA3 - 1 to CSDD_MAX_NUMBER_COMMAND */
     uint8_t cmdCount;
     /** Array to hold set of commands */
@@ -175,6 +213,19 @@ struct CSDD_SubBuffer_s
     uint32_t size;
 };
 
+/** structure describes one independent transfer of a memory card batch */
+struct CSDD_MemBatchEntry_s
+{
+    /** Memory card address in blocks (512 bytes) */
+    uint32_t address;
+    /** Data buffer, aligned for DMA */
+    void* buffer;
+    /** Size in bytes of data buffer, must be divisible by 512 */
+    uint32_t size;
+    /** Data transfer direction */
+    CSDD_TransferDirection direction;
+};
+
 /** Structure contains information that will be used to recognize type of supported devices */
 struct CSDD_DeviceInfo_s
 {
@@ -309,6 +360,16 @@ struct CSDD_CQRequest_s
     uintptr_t descDataSize;
     /** Request status. Only driver can modify it. */
     CSDD_CQReqStat cQReqStat;
+    /** Optional function called from the interrupt handler when request finishes with any status, NULL if not used. Task ID of the request may be used again in the callback */
+    CSDD_CQRequestCompleteCallback completeCallback;
+    /** User pointer passed to completeCallback and stored in the completion ring */
+    void* userContext;
+    /** Next request in the slot CQ backlog or in the same task, see CSDD_CQSubmit. Only driver can modify it. */
+    CSDD_CQRequest* pNextRequest;
+    /** I/O class of the request, used when the scheduler is enabled, see CSDD_CQSetSchedConfig */
+    CSDD_CQIoClass ioClass;
+    /** Time (CPS_GetTimeNs) by which the scheduler starts the request, 0 - no deadline. Only driver can modify it. */
+    uint64_t deadlineNs;
 };
 
 /** Direct command request used to execute eMMC command by their index and argument. It is not used to data transfer */
@@ -328,6 +389,34 @@ struct CSDD_CQDcmdRequest_s
     uint32_t response;
     /** Request status. Only driver can modify it. */
     CSDD_CQReqStat cQReqStat;
+    /** Optional function called from the interrupt handler when request finishes with any status, NULL if not used */
+    CSDD_CQDcmdCompleteCallback completeCallback;
+    /** User pointer passed to completeCallback and stored in the completion ring */
+    void* userContext;
+};
+
+/** Entry of the command queuing completion ring, see CSDD_CQGetCompletions */
+struct CSDD_CQCompletion_s
+{
+    /** ID of the finished task, CQ_DCMD_TASK_ID (31) for direct command, 0xFF for request discarded from the backlog before it got a task */
+    uint8_t taskId;
+    /** final status of the request, CSDD_CQ_REQ_STAT_FINISHED or CSDD_CQ_REQ_STAT_FAILED */
+    CSDD_CQReqStat status;
+    /** userContext of the finished request */
+    void* userContext;
+};
+
+/** Command queuing I/O scheduler configuration, see CSDD_CQSetSchedConfig */
+struct CSDD_CQSchedConfig_s
+{
+    /** 1 - scheduler is enabled, 0 - requests are started in submission order, other fields must be 0 */
+    uint8_t enable;
+    /** maximum number of blocks of task made of merged requests, 0 - requests are not merged.
+     * It must not exceed 128 blocks per each of SDIO_CFG_CQ_MERGE_MAX_BUFFERS data buffers */
+    uint16_t maxMergeBlocks;
+    /** time in microseconds request of each I/O class may wait in the backlog, 0 - no deadline.
+     * Default and bulk classes must have a deadline, so they are not starved by latency class */
+    uint32_t deadlineUs[CSDD_CQ_IO_CLASS_COUNT];
 };
 
 /** Command queuing interrupt coalescing configuration */
@@ -341,6 +430,176 @@ struct CSDD_CQIntCoalescingCfg_s
     uint8_t timeout;
 };
 
+/** Adaptive command queuing interrupt coalescing configuration, see CSDD_CQSetIntCoalescingAuto */
+struct CSDD_CQIntCoalescingAuto_s
+{
+    /** 1 - enable adaptive mode, 0 - disable adaptive mode and interrupt coalescing */
+    uint8_t enable;
+    /** time in microseconds a task completion may wait for its interrupt while the load is below maxIntRate */
+    uint32_t latencyTargetUs;
+    /** maximum number of task completion interrupts per second at high load, it must not be 0 */
+    uint32_t maxIntRate;
+};
+
+/** Counters of adaptive command queuing interrupt coalescing, see CSDD_CQGetIntCoalescingStats */
+struct CSDD_CQIntCoalescingStats_s
+{
+    /** number of task completion interrupts */
+    uint32_t interrupts;
+    /** number of completed tasks */
+    uint32_t completions;
+    /** number of changes of coalescing threshold or timeout */
+    uint32_t retunes;
+    /** task completions per second measured in the last window */
+    uint32_t completionRate;
+    /** task completion interrupts per second measured in the last window */
+    uint32_t interruptRate;
+    /** average number of outstanding tasks at interrupt in the last window */
+    uint8_t avgDepth;
+    /** current coalescing counter threshold, 0 - only the timeout is used */
+    uint8_t threshold;
+    /** current coalescing timeout value, in units of 1024 timeout base clocks */
+    uint8_t timeout;
+    /** 1 - interrupt coalescing is enabled at the moment, 0 - interrupt is generated for each task */
+    uint8_t enable;
+};
+
+/** Statistics of hybrid interrupt/polling completion mode, see CSDD_CONFIG_SET_HYBRID_POLL */
+struct CSDD_HybridPollStats_s
+{
+    /** number of switches from interrupts to polling */
+    uint32_t pollingPhases;
+    /** number of switches from polling back to interrupts */
+    uint32_t interruptPhases;
+    /** number of interrupt status events handled by polling */
+    uint32_t polledEvents;
+    /** number of interrupt status events handled by interrupt handler with interrupts enabled */
+    uint32_t interruptEvents;
+    /** true if completions are polled at the moment */
+    bool polling;
+};
+
+/** Statistics of DMA bounce buffers, see CSDD_Config */
+struct CSDD_BounceStats_s
+{
+    /** number of transfers copied through a bounce buffer because the data buffer is not aligned */
+    uint32_t bouncedRequests;
+    /** number of bytes copied through bounce buffers */
+    uint64_t bouncedBytes;
+    /** number of not aligned transfers done without DMA, because bounce buffers are not configured, too small or all in use */
+    uint32_t pioFallbacks;
+};
+
+/** Average timing of one transfer measured by DMA mode calibration */
+struct CSDD_DmaCalTiming_s
+{
+    /** time from the transfer start to its completion in ns, 0 if the mode was not measured */
+    uint64_t wallNs;
+    /** time the CPU spent in the driver issuing the transfer and handling its interrupts in ns, waiting for completion is not included */
+    uint64_t cpuNs;
+};
+
+/** Result of DMA mode calibration, see CSDD_MemCardCalibrateDmaMode */
+struct CSDD_DmaCalibration_s
+{
+    /** transfer size of each size class in bytes, 0 if the class was not measured */
+    uint32_t size[SDIO_CFG_DMA_CAL_CLASSES];
+    /** timing of DMA modes of each size class, indexed by CSDD_DmaMode (CSDD_SDMA_MODE to CSDD_ADMA3_MODE), ADMA1 is not measured */
+    CSDD_DmaCalTiming dma[SDIO_CFG_DMA_CAL_CLASSES][4];
+    /** timing of transfers without DMA of each size class */
+    CSDD_DmaCalTiming pio[SDIO_CFG_DMA_CAL_CLASSES];
+    /** mode used by auto DMA mode for each size class, CSDD_AUTO_MODE if the class was not measured */
+    uint8_t selected[SDIO_CFG_DMA_CAL_CLASSES];
+};
+
+/** Node of the host list of supported device drivers */
+struct CSDD_DeviceListNode_s
+{
+    /** device driver description, NULL if node is free */
+    CSDD_DeviceInfo* Item;
+    /** next node of the list */
+    struct CSDD_DeviceListNode_s* Next;
+};
+
+/** Address range translated by CSDD_Callbacks.virtToPhysCallback */
+struct CSDD_AddrXlateEntry_s
+{
+    /** CPU address of the range */
+    uintptr_t virtAddress;
+    /** DMA address of the range */
+    uintptr_t phyAddress;
+    /** size of the range in bytes, 0 if entry is not used */
+    uint32_t size;
+};
+
+/** Position of the current transfer in the ADMA2 descriptor ring */
+struct CSDD_Adma2Chain_s
+{
+    /** CPU address of data which is not described yet, if data buffer is contiguous */
+    uintptr_t nextAddress;
+    /** number of data bytes which are not described yet, if data buffer is contiguous */
+    uint32_t bytesLeft;
+    /** next sub-buffer to describe, NULL if data buffer is contiguous */
+    const CSDD_SubBuffer* pSubBuffers;
+    /** number of sub-buffers which are not described yet */
+    uint32_t subBuffersLeft;
+    /** 1 - data is in a bounce buffer, its DMA address is not translated */
+    uint8_t bounced;
+    /** ring page which DMA processed at the last refill */
+    uint8_t dmaPage;
+    /** ring page which will be filled next, not valid until the transfer is described */
+    uint8_t fillPage;
+    /** 1 - the last descriptor of the transfer is written */
+    uint8_t complete;
+    /** 1 - the ring is used by the current transfer */
+    uint8_t active;
+};
+
+/** Request of the memory card driver pool used by non-blocking transfers */
+struct CSDD_MemRequest_s
+{
+    /** request passed to the host driver */
+    CSDD_Request Request;
+    /** user callback, called before request goes back to the pool */
+    CSDD_RequestCompleteCallback Callback;
+    /** 1 - request is in use, 0 - request is free */
+    uint8_t Used;
+};
+
+/** Private data of the memory card driver kept for each device */
+struct MEMORY_CARD_INFO_s
+{
+    /** Block size */
+    uint16_t BlockSize;
+    /** Card command classes */
+    uint16_t commandClasses;
+    /** Device size */
+    uint32_t DeviceSizeMB;
+    /** Defines whether partial block sizes can be used in block read commands. */
+    uint8_t PartialReadAllowed;
+    /** Defines whether partial block sizes can be used in block write commands. */
+    uint8_t PartialWriteAllowed;
+    /** Defines if the data block to be written by one command can be
+     * spread over more than one physical block of the memory device. */
+    uint8_t WriteBlkMisalign;
+    /** Defines if the data block to be read by one command can be
+     * spread over more than one physical block of the memory device. */
+    uint8_t ReadBlkMisalign;
+    /** The size of an erasable sector.
+     * The content of this register is a 7-bit binary coded value, defining the
+     * number of write blocks (see WRITE_BL_LEN */
+    uint16_t SectorSize;
+    /** The EraseBlkEn defines the granularity of the unit size of the data to be erased. */
+    uint8_t EraseBlkEn;
+    /** The maximum read data block length. */
+    uint8_t ReadBlLen;
+    /** The maximum write data block length. */
+    uint8_t WriteBlLen;
+    /** Request used by infinite transfer. It is kept between
+     * MemoryCard_InfXferStart and MemoryCard_InfXferContinue calls. */
+    CSDD_Request InfRequest;
+};
+
 struct CSDD_SDIO_SlotSettings_s
 {
     /** DMA 64 bit enabled */
@@ -387,8 +646,10 @@ struct CSDD_SDIO_Device_s
     CSDD_CardInterruptHandlerCallback pCardInterruptHandler;
     /** Function pointer which should point to  function which deinitialize the card device */
     CSDD_CardDeinitializeCallback pCardDeinitialize;
-    /** Private driver data */
+    /** Private driver data, points to MemoryCardInfo when memory card driver handles the device */
     CSDD_PMEMORY_CARD_INFO CardDriverData;
+    /** Memory card driver data of the device */
+    CSDD_MEMORY_CARD_INFO MemoryCardInfo;
     /** Slot in which card is inserted */
     CSDD_SDIO_Slot* pSlot;
     /** Flag is set if UHS-I mode is supported by the device */
@@ -416,6 +677,10 @@ struct CSDD_SDIO_Slot_s
     uint8_t BusWidth;
     /** Pointer to current executing SD request */
     CSDD_Request* pCurrentRequest;
+    /** First request of the submission queue, issued from the completion interrupt */
+    CSDD_Request* pRequestQueueHead;
+    /** Last request of the submission queue */
+    CSDD_Request* pRequestQueueTail;
     uint8_t subCommandStatus;
     /** 1 - card is inserted, 0 - there is no card in slot */
     uint32_t CardInserted:1;
@@ -423,14 +688,32 @@ struct CSDD_SDIO_Slot_s
     uint32_t UhsiSelected:1;
     /** Abort current transaction */
     uint8_t AbortRequest;
+    /** Capabilities register (SRS16) read at slot initialization */
+    uint32_t CapabilitiesSrs16;
+    /** Capabilities register 2 (SRS17) read at slot initialization */
+    uint32_t CapabilitiesSrs17;
+    /** Host control 2 bits of SRS15 last written by the driver */
+    uint32_t HostCtrl2;
+    /** DMA select field last written to SRS10, SRS10_DMA_SELECT_UNKNOWN if it is not known */
+    uint32_t DmaSelect;
     /** Settings of signaling the interrupts */
     uint32_t IntSettings;
+    /** SRS12 status acknowledged by CSDD_IsrTopHalf and not yet handled by CSDD_IsrBottomHalf */
+    uint32_t IsrSrs12;
+    /** CQRS04 status acknowledged by CSDD_IsrTopHalf and not yet handled by CSDD_IsrBottomHalf */
+    uint32_t IsrCqrs04;
+    /** signal enables (SRS14) saved by CSDD_IsrTopHalf before it masked the slot interrupt */
+    uint32_t IsrSignalEnable;
+    /** slot interrupt is masked by CSDD_IsrTopHalf until CSDD_IsrBottomHalf handles latched errors */
+    uint8_t IsrMasked;
     /** Flag is set if error recovering is already executing */
     uint8_t ErrorRecorvering;
     /** pointer to the sdio host object */
     CSDD_SDIO_Host* pSdioHost;
     /** slot number */
     uint8_t SlotNr;
+    /** relative card address which will be assigned to next MMC card */
+    uint16_t MmcRca;
     /** pointer to logical address of descriptor buffer */
     uint32_t* DescriptorBuffer;
     /** pointer to physical address of descriptor buffer */
@@ -439,6 +722,41 @@ struct CSDD_SDIO_Slot_s
     uint32_t* IntegratedDescriptorBuffer;
     /** pointer to physical address of ADMA3 integrated descriptor buffer */
     uint32_t* IntegratedDescriptorDMAAddr;
+    /** temporary sub-buffers used to split big data buffer between ADMA descriptors */
+    CSDD_SubBuffer SubBuffers[SDIO_CFG_SDIO_SUB_BUFFERS_COUNT];
+    /** ADMA2 descriptor rings, while one of them is used by the current
+     *  transfer the other one is filled for the next queued request */
+    CSDD_Adma2Chain Adma2Chain[2];
+    /** index of ADMA2 descriptor ring used by the current transfer */
+    uint8_t DescRing;
+    /** queued request which DMA transfer is already prepared, NULL if there is no such request */
+    CSDD_Request* pPreparedRequest;
+    /** DMA mode of the prepared request */
+    uint8_t PreparedDmaMode;
+    /** ADMA2 descriptor ring of the prepared request */
+    uint8_t PreparedDescRing;
+    /** DMA address of data of the prepared SDMA request */
+    uintptr_t PreparedDmaAddr;
+    /** SDMA buffer boundary (SRS01 value) of the prepared SDMA request */
+    uint32_t PreparedDmaBoundary;
+    /** SDMA buffer boundary in bytes set by CSDD_CONFIG_SET_SDMA_BOUNDARY,
+     *  0 - the biggest boundary allowed by the data buffer is used */
+    uint32_t SdmaBoundary;
+    /** CPU address of data at SdmaDmaAddr */
+    uintptr_t SdmaCpuAddr;
+    /** DMA address at which the current SDMA transfer was started or resumed */
+    uintptr_t SdmaDmaAddr;
+    /** DMA mode used by auto mode for each transfer size class, set by
+     *  DMA mode calibration, CSDD_AUTO_MODE - fixed selection rules are used */
+    uint8_t DmaModeTable[SDIO_CFG_DMA_CAL_CLASSES];
+    /** 1 - DMA mode calibration is running and CPU time of the driver is measured */
+    uint8_t DmaCalActive;
+    /** CPU time in ns spent in the driver issuing commands and handling interrupts during DMA mode calibration */
+    uint64_t DmaCalCpuNs;
+    /** requests of the memory card driver used by non-blocking transfers */
+    CSDD_MemRequest MemRequests[SDIO_CFG_MEM_REQUESTS_PER_SLOT];
+    /** memory card driver buffer for CMD42 data block */
+    uint8_t LockCmdBuffer[512];
     /** If this flag is set then programmable clock mode is enabled, if it is 0 then 10-bit divider clock mode is enabled */
     uint32_t ProgClockMode:1;
     /** flag informs if re-tuning is currently enabled */
@@ -447,6 +765,8 @@ struct CSDD_SDIO_Slot_s
     uint8_t AccessMode;
     /** flags informs if host requests for re-tuning */
     uint32_t RetuningRequest:1;
+    /** seconds left to next re-tuning, it is decremented on each check if re-tuning is needed */
+    uint32_t RetuningTimer;
     /** data count in bytes which are transfered since last re-tuning procedure */
     uint32_t DataCount;
     /** DMA mode */
@@ -461,6 +781,8 @@ struct CSDD_SDIO_Slot_s
     CSDD_DmaMode dmaModeSelected;
     /** flag is set when card is in slot but it is not attached by the driver */
     uint32_t NeedAttach:1;
+    /** if set, requests submitted to busy slot are queued instead of waiting, see CSDD_CONFIG_SET_NONBLOCK_ISSUE */
+    uint32_t NonBlockIssue:1;
     /** CQ: it informs if DCMD mode is enabled. In DCMD mode the pointer CQCurrentReq[31] is always NULL */
     uint32_t CQDcmdEnabled:1;
     /** is command queuing enabled */
@@ -479,6 +801,55 @@ struct CSDD_SDIO_Slot_s
     CSDD_CQDcmdRequest* CQCurrentDcmdReq;
     /** task/transfer descriptor size in bytes */
     CSDD_EmmcCmdqTaskDescSize CQDescSize;
+    /** CQ: bit mask of tasks with attached request, task is taken by atomic compare and swap */
+    volatile uint32_t CQTaskBusy;
+    /** CQ: bit mask of tasks submitted by CSDD_CQSubmit and not started by the doorbell yet, changed atomically */
+    volatile uint32_t CQDoorbellPending;
+    /** CQ: requests submitted by CSDD_CQSubmit without a free task, newest first, pushed atomically */
+    CSDD_CQRequest* volatile CQBacklogIn;
+    /** CQ: first request of each backlog queue in submission order, used only by owner of the backlog refill.
+     *  Scheduler has one queue per I/O class, otherwise only CSDD_CQ_IO_CLASS_DEFAULT queue is used */
+    CSDD_CQRequest* CQBacklogHead[CSDD_CQ_IO_CLASS_COUNT];
+    /** CQ: last request of each backlog queue */
+    CSDD_CQRequest* CQBacklogTail[CSDD_CQ_IO_CLASS_COUNT];
+    /** CQ: I/O scheduler configuration */
+    CSDD_CQSchedConfig CQSchedCfg;
+    /** CQ: transfer descriptor lists of tasks made of merged requests, logical address */
+    uint8_t* CQMergeDescBuffer;
+    /** CQ: transfer descriptor lists of tasks made of merged requests, physical address */
+    uintptr_t CQMergeDescDmaAddr;
+    /** CQ: backlog refill is running, taken by atomic compare and swap */
+    volatile uint32_t CQRefillOwner;
+    /** CQ: backlog refill was requested and is not done yet */
+    volatile uint32_t CQRefillRequested;
+    /** CQ: finished tasks are stored in the completion ring, see CSDD_CONFIG_SET_CQ_COMPLETION_RING */
+    uint32_t CQComplRingEn:1;
+    /** CQ: completion ring, written by the interrupt handler and read by CSDD_CQGetCompletions */
+    CSDD_CQCompletion CQComplRing[SDIO_CFG_CQ_COMPL_RING_SIZE];
+    /** CQ: number of entries written to the completion ring, entry index is the number modulo ring size */
+    volatile uint32_t CQComplHead;
+    /** CQ: number of entries read from the completion ring */
+    volatile uint32_t CQComplTail;
+    /** CQ: number of completions dropped because the completion ring was full */
+    uint32_t CQComplOverflows;
+    /** CQ: adaptive interrupt coalescing configuration, see CSDD_CQSetIntCoalescingAuto */
+    CSDD_CQIntCoalescingAuto CQCoalAuto;
+    /** CQ: adaptive interrupt coalescing counters and current settings */
+    CSDD_CQIntCoalescingStats CQCoalStats;
+    /** CQ: copy of CQCoalStats published by the interrupt handler for CSDD_CQGetIntCoalescingStats */
+    CSDD_CQIntCoalescingStats CQCoalStatsCopy;
+    /** CQ: sequence of CQCoalStatsCopy updates, it is odd while the copy is written */
+    volatile uint32_t CQCoalStatsSeq;
+    /** CQ: interrupt coalescing timeout base clock in KHz, read when adaptive mode is enabled */
+    uint32_t CQCoalClockKHz;
+    /** CQ: start time of the current adaptive coalescing window in ns */
+    uint64_t CQCoalWindowStart;
+    /** CQ: number of task completion interrupts in the current window */
+    uint32_t CQCoalWindowInts;
+    /** CQ: number of completed tasks in the current window */
+    uint32_t CQCoalWindowCompletions;
+    /** CQ: sum of outstanding tasks at each interrupt of the current window */
+    uint32_t CQCoalWindowDepth;
 };
 
 /** Structure contains information about inserted card and functions to handle them */
@@ -488,6 +859,8 @@ struct CSDD_SDIO_Host_s
     SD4HC_Regs* RegOffset;
     /** slots array which belong to the host */
     CSDD_SDIO_Slot Slots[SDIO_SLOT_COUNT];
+    /** list of supported device drivers, first node is the list head */
+    CSDD_DeviceListNode SuppDevList[MAX_SUPPORTED_DEVICE_COUNT + 1U];
     /** host bus mode (SPI SD, in the current version only SD is supported) */
     uint8_t HostBusMode;
     /** The host's slots count */
@@ -502,12 +875,46 @@ struct CSDD_SDIO_Host_s
     CSDD_SetTuneValCallback pSetTuneVal;
     /** callback called when AXI error occurs */
     CSDD_AxiErrorCallback axiErrorCallback;
+    /** translates data buffer addresses to DMA addresses, NULL if buffers are identity mapped */
+    CSDD_VirtToPhysCallback virtToPhys;
+    /** address ranges translated by virtToPhys */
+    CSDD_AddrXlateEntry addrCache[SDIO_CFG_ADDR_CACHE_SIZE];
+    /** index of addrCache entry replaced by next translation */
+    uint8_t addrCacheNext;
     /** pointer to user driver data */
     void* drvData;
     /** interrupts enabled */
     uint32_t intEn:1;
     /** DMA 64 bit enable */
     uint32_t dma64BitEn:1;
+    /** descriptor buffers are in DMA coherent memory */
+    uint32_t descCoherent:1;
+    /** DMA is coherent with CPU caches */
+    uint32_t ioCoherent:1;
+    /** hybrid mode: interrupt signals are masked and completions are polled */
+    uint32_t hybridPolling:1;
+    /** hybrid mode: completions are being polled from the submitting context */
+    uint32_t hybridPollBusy:1;
+    /** hybrid mode: number of requests per window above which completions are polled, 0 if mode is disabled */
+    uint32_t hybridPollThreshold;
+    /** hybrid mode: number of requests submitted in the current window */
+    uint32_t hybridWindowCount;
+    /** hybrid mode: start time of the current window in nanoseconds */
+    uint64_t hybridWindowStartNs;
+    /** hybrid mode statistics */
+    CSDD_HybridPollStats hybridPollStats;
+    /** pointer to logical address of the DMA bounce buffer pool, NULL if it is not configured */
+    uint8_t* BounceBuffer;
+    /** pointer to physical address of the DMA bounce buffer pool */
+    void* BounceDMAAddr;
+    /** number of buffers in the bounce buffer pool */
+    uint8_t BounceCount;
+    /** size of each buffer of the bounce buffer pool */
+    uint32_t BounceBufferSize;
+    /** bit n is set if bounce buffer n is used by a request */
+    volatile uint32_t BounceUsed;
+    /** DMA bounce buffers statistics */
+    CSDD_BounceStats bounceStats;
     /** emmc command queueing is supported */
     bool cqSupported;
     /** HS 400ES supported */
@@ -530,6 +937,8 @@ struct CSDD_Callbacks_s
     CSDD_CardRemovedCallback cardRemovedCallback;
     CSDD_AxiErrorCallback axiErrorCallback;
     CSDD_SetTuneValCallback setTuneValCallback;
+    /** optional, translates CPU address of a data buffer to DMA address and sets contiguousSize to the number of bytes (at most size) physically contiguous from address, 0 if the address cannot be translated. NULL if data buffers are identity mapped. Buffers have to stay pinned while they are used by the driver, see CSDD_CONFIG_FLUSH_ADDR_CACHE */
+    CSDD_VirtToPhysCallback virtToPhysCallback;
 };
 
 /** Controls the IO delay related timings - Combo PHY */
@@ -52,6 +52,10 @@ CSDD_OBJ *CSDD_GetInstance(void)
         .standBy = CSDD_StandBy,
         .configure = CSDD_Configure,
         .isr = CSDD_Isr,
+        .isrTopHalf = CSDD_IsrTopHalf,
+        .isrBottomHalf = CSDD_IsrBottomHalf,
+        .getHybridPollStats = CSDD_GetHybridPollStats,
+        .getBounceStats = CSDD_GetBounceStats,
         .configureHighSpeed = CSDD_ConfigureHighSpeed,
         .checkSlots = CSDD_CheckSlots,
         .checkInterrupt = CSDD_CheckInterrupt,
@@ -63,6 +67,9 @@ CSDD_OBJ *CSDD_GetInstance(void)
         .memoryCardLoadDriver = CSDD_MemoryCardLoadDriver,
         .memoryCardDataTransfer = CSDD_MemoryCardDataTransfer,
         .memoryCardDataTransfer2 = CSDD_MemoryCardDataTransfer2,
+        .memoryCardSgTransfer = CSDD_MemoryCardSgTransfer,
+        .memCardBatchXfer = CSDD_MemCardBatchXfer,
+        .memCardCalibrateDmaMode = CSDD_MemCardCalibrateDmaMode,
         .memoryCardConfigure = CSDD_MemoryCardConfigure,
         .memoryCardDataErase = CSDD_MemoryCardDataErase,
         .memCardPartialDataXfer = CSDD_MemCardPartialDataXfer,
@@ -70,6 +77,7 @@ CSDD_OBJ *CSDD_GetInstance(void)
         .memCardInfXferContinue = CSDD_MemCardInfXferContinue,
         .memCardInfXferFinish = CSDD_MemCardInfXferFinish,
         .memCardDataXferNonBlock = CSDD_MemCardDataXferNonBlock,
+        .memCardDataXferNonBlockCb = CSDD_MemCardDataXferNonBlockCb,
         .memCardFinishXferNonBlock = CSDD_MemCardFinishXferNonBlock,
         .phySettingsSd3 = CSDD_PhySettingsSd3,
         .phySettingsSd4 = CSDD_PhySettingsSd4,
@@ -120,6 +128,13 @@ CSDD_OBJ *CSDD_GetInstance(void)
         .cQResetIntCoalCounters = CSDD_CQResetIntCoalCounters,
         .cQSetResponseErrorMask = CSDD_CQSetResponseErrorMask,
         .cQGetResponseErrorMask = CSDD_CQGetResponseErrorMask,
+        .cQGetCompletions = CSDD_CQGetCompletions,
+        .cQSubmit = CSDD_CQSubmit,
+        .cQSetSchedConfig = CSDD_CQSetSchedConfig,
+        .cQGetSchedConfig = CSDD_CQGetSchedConfig,
+        .cQSetIntCoalescingAuto = CSDD_CQSetIntCoalescingAuto,
+        .cQGetIntCoalescingAuto = CSDD_CQGetIntCoalescingAuto,
+        .cQGetIntCoalescingStats = CSDD_CQGetIntCoalescingStats,
         .getBaseClk = CSDD_GetBaseClk,
         .waitForRequest = CSDD_WaitForRequest,
         .setCPhyConfigIoDelay = CSDD_SetCPhyConfigIoDelay,
@@ -576,7 +576,12 @@ uint32_t CSDD_SanityFunction10(const CSDD_SDIO_Host* pD, const CSDD_ConfigCmd cm
         (cmd != CSDD_CONFIG_SET_DAT_TIMEOUT) &&
         (cmd != CSDD_CONFIG_DISABLE_SIGNAL_INTERRUPT) &&
         (cmd != CSDD_CONFIG_RESTORE_SIGNAL_INTERRUPT) &&
-        (cmd != CSDD_CONFIG_SET_DMA_MODE)
+        (cmd != CSDD_CONFIG_SET_DMA_MODE) &&
+        (cmd != CSDD_CONFIG_SET_NONBLOCK_ISSUE) &&
+        (cmd != CSDD_CONFIG_SET_HYBRID_POLL) &&
+        (cmd != CSDD_CONFIG_FLUSH_ADDR_CACHE) &&
+        (cmd != CSDD_CONFIG_SET_SDMA_BOUNDARY) &&
+        (cmd != CSDD_CONFIG_SET_CQ_COMPLETION_RING)
     )
     {
         ret = CDN_EINVAL;
@@ -1972,6 +1977,274 @@ uint32_t CSDD_SanityFunction92(const CSDD_SDIO_Host* pD, const bool* extendedWrM
     return ret;
 }
 
+
+/**
+ * A common function to check the validity of API functions with
+ * following parameter types
+ * @param[in] pD private data
+ * @param[out] stats statistics of the host
+ * @return 0 success
+ * @return CDN_EINVAL invalid parameters
+ */
+uint32_t CSDD_SanityFunction93(const CSDD_SDIO_Host* pD, const CSDD_HybridPollStats* stats)
+{
+    /* Declaring return variable */
+    uint32_t ret = 0;
+
+    if (stats == NULL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else if (CSDD_SDIOHostSF(pD) == CDN_EINVAL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else
+    {
+        /*
+         * All 'if ... else if' constructs shall be terminated with an 'else' statement
+         * (MISRA2012-RULE-15_7-3)
+         */
+    }
+
+    return ret;
+}
+
+
+/**
+ * A common function to check the validity of API functions with
+ * following parameter types
+ * @param[in] pD private data
+ * @param[out] stats statistics of the host
+ * @return 0 success
+ * @return CDN_EINVAL invalid parameters
+ */
+uint32_t CSDD_SanityFunction94(const CSDD_SDIO_Host* pD, const CSDD_BounceStats* stats)
+{
+    /* Declaring return variable */
+    uint32_t ret = 0;
+
+    if (stats == NULL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else if (CSDD_SDIOHostSF(pD) == CDN_EINVAL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else
+    {
+        /*
+         * All 'if ... else if' constructs shall be terminated with an 'else' statement
+         * (MISRA2012-RULE-15_7-3)
+         */
+    }
+
+    return ret;
+}
+
+/**
+ * A common function to check the validity of API functions with
+ * following parameter types
+ * @param[in] pD private data
+ * @param[in] entries array of transfers
+ * @return 0 success
+ * @return CDN_EINVAL invalid parameters
+ */
+uint32_t CSDD_SanityFunction95(const CSDD_SDIO_Host* pD, const CSDD_MemBatchEntry* entries)
+{
+    /* Declaring return variable */
+    uint32_t ret = 0;
+
+    if (entries == NULL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else if (CSDD_SDIOHostSF(pD) == CDN_EINVAL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else
+    {
+        /*
+         * All 'if ... else if' constructs shall be terminated with an 'else' statement
+         * (MISRA2012-RULE-15_7-3)
+         */
+    }
+
+    return ret;
+}
+
+/**
+ * A common function to check the validity of API functions with
+ * following parameter types
+ * @param[in] pD private data
+ * @param[in] buffer data buffer
+ * @param[out] result calibration result
+ * @return 0 success
+ * @return CDN_EINVAL invalid parameters
+ */
+uint32_t CSDD_SanityFunction96(const CSDD_SDIO_Host* pD, const void* buffer, const CSDD_DmaCalibration* result)
+{
+    /* Declaring return variable */
+    uint32_t ret = 0;
+
+    if (buffer == NULL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else if (result == NULL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else if (CSDD_SDIOHostSF(pD) == CDN_EINVAL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else
+    {
+        /*
+         * All 'if ... else if' constructs shall be terminated with an 'else' statement
+         * (MISRA2012-RULE-15_7-3)
+         */
+    }
+
+    return ret;
+}
+
+/**
+ * A common function to check the validity of API functions with
+ * following parameter types
+ * @param[in] pD private data
+ * @param[out] entries completions read from the ring
+ * @param[out] count number of completions
+ * @return 0 success
+ * @return CDN_EINVAL invalid parameters
+ */
+uint32_t CSDD_SanityFunction97(const CSDD_SDIO_Host* pD, const CSDD_CQCompletion* entries, const uint8_t* count)
+{
+    /* Declaring return variable */
+    uint32_t ret = 0;
+
+    if (entries == NULL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else if (count == NULL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else if (CSDD_SDIOHostSF(pD) == CDN_EINVAL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else
+    {
+        /*
+         * All 'if ... else if' constructs shall be terminated with an 'else' statement
+         * (MISRA2012-RULE-15_7-3)
+         */
+    }
+
+    return ret;
+}
+
+/**
+ * A common function to check the validity of API functions with
+ * following parameter types
+ * @param[in] pD private data
+ * @param[in] config scheduler configuration
+ * @return 0 success
+ * @return CDN_EINVAL invalid parameters
+ */
+uint32_t CSDD_SanityFunction98(const CSDD_SDIO_Host* pD, const CSDD_CQSchedConfig* config)
+{
+    /* Declaring return variable */
+    uint32_t ret = 0;
+
+    if (config == NULL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else if (CSDD_SDIOHostSF(pD) == CDN_EINVAL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else
+    {
+        /*
+         * All 'if ... else if' constructs shall be terminated with an 'else' statement
+         * (MISRA2012-RULE-15_7-3)
+         */
+    }
+
+    return ret;
+}
+
+/**
+ * A common function to check the validity of API functions with
+ * following parameter types
+ * @param[in] pD private data
+ * @param[in] config adaptive interrupt coalescing configuration
+ * @return 0 success
+ * @return CDN_EINVAL invalid parameters
+ */
+uint32_t CSDD_SanityFunction99(const CSDD_SDIO_Host* pD, const CSDD_CQIntCoalescingAuto* config)
+{
+    /* Declaring return variable */
+    uint32_t ret = 0;
+
+    if (config == NULL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else if (CSDD_SDIOHostSF(pD) == CDN_EINVAL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else
+    {
+        /*
+         * All 'if ... else if' constructs shall be terminated with an 'else' statement
+         * (MISRA2012-RULE-15_7-3)
+         */
+    }
+
+    return ret;
+}
+
+/**
+ * A common function to check the validity of API functions with
+ * following parameter types
+ * @param[in] pD private data
+ * @param[out] stats adaptive interrupt coalescing counters
+ * @return 0 success
+ * @return CDN_EINVAL invalid parameters
+ */
+uint32_t CSDD_SanityFunction100(const CSDD_SDIO_Host* pD, const CSDD_CQIntCoalescingStats* stats)
+{
+    /* Declaring return variable */
+    uint32_t ret = 0;
+
+    if (stats == NULL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else if (CSDD_SDIOHostSF(pD) == CDN_EINVAL)
+    {
+        ret = CDN_EINVAL;
+    }
+    else
+    {
+        /*
+         * All 'if ... else if' constructs shall be terminated with an 'else' statement
+         * (MISRA2012-RULE-15_7-3)
+         */
+    }
+
+    return ret;
+}
+
 /* parasoft-end-suppress MISRA2012-RULE-8_7 */
 /* parasoft-end-suppress METRICS-41-3 */
 /* parasoft-end-suppress METRICS-39-3 */
@@ -118,6 +118,14 @@ uint32_t CSDD_SanityFunction87(const CSDD_SDIO_Host* pD, const CSDD_CPhyConfigDf
 uint32_t CSDD_SanityFunction88(const CSDD_SDIO_Host* pD, const CSDD_CPhyConfigOutputDelay* outputDelay);
 uint32_t CSDD_SanityFunction89(const CSDD_SDIO_Host* pD, const CSDD_CPhyConfigOutputDelay* outputDelay);
 uint32_t CSDD_SanityFunction92(const CSDD_SDIO_Host* pD, const bool* extendedWrMode, const bool* extendedRdMode);
+uint32_t CSDD_SanityFunction93(const CSDD_SDIO_Host* pD, const CSDD_HybridPollStats* stats);
+uint32_t CSDD_SanityFunction94(const CSDD_SDIO_Host* pD, const CSDD_BounceStats* stats);
+uint32_t CSDD_SanityFunction95(const CSDD_SDIO_Host* pD, const CSDD_MemBatchEntry* entries);
+uint32_t CSDD_SanityFunction96(const CSDD_SDIO_Host* pD, const void* buffer, const CSDD_DmaCalibration* result);
+uint32_t CSDD_SanityFunction97(const CSDD_SDIO_Host* pD, const CSDD_CQCompletion* entries, const uint8_t* count);
+uint32_t CSDD_SanityFunction98(const CSDD_SDIO_Host* pD, const CSDD_CQSchedConfig* config);
+uint32_t CSDD_SanityFunction99(const CSDD_SDIO_Host* pD, const CSDD_CQIntCoalescingAuto* config);
+uint32_t CSDD_SanityFunction100(const CSDD_SDIO_Host* pD, const CSDD_CQIntCoalescingStats* stats);
 
 #define	CSDD_ProbeSF CSDD_SanityFunction1
 #define	CSDD_InitSF CSDD_SanityFunction2
@@ -130,6 +138,10 @@ uint32_t CSDD_SanityFunction92(const CSDD_SDIO_Host* pD, const bool* extendedWrM
 #define	CSDD_StandBySF CSDD_SanityFunction3
 #define	CSDD_ConfigureSF CSDD_SanityFunction10
 #define	CSDD_IsrSF CSDD_SanityFunction11
+#define	CSDD_IsrTopHalfSF CSDD_SanityFunction11
+#define	CSDD_IsrBottomHalfSF CSDD_SanityFunction3
+#define	CSDD_GetHybridPollStatsSF CSDD_SanityFunction93
+#define	CSDD_GetBounceStatsSF CSDD_SanityFunction94
 #define	CSDD_ConfigureHighSpeedSF CSDD_SanityFunction3
 #define	CSDD_CheckSlotsSF CSDD_SanityFunction3
 #define	CSDD_CheckInterruptSF CSDD_SanityFunction3
@@ -141,6 +153,9 @@ uint32_t CSDD_SanityFunction92(const CSDD_SDIO_Host* pD, const bool* extendedWrM
 #define	CSDD_MemoryCardLoadDriverSF CSDD_SanityFunction3
 #define	CSDD_MemoryCardDataTransferSF CSDD_SanityFunction21
 #define	CSDD_MemoryCardDataTransfer2SF CSDD_SanityFunction21
+#define	CSDD_MemoryCardSgTransferSF CSDD_SanityFunction21
+#define	CSDD_MemCardBatchXferSF CSDD_SanityFunction95
+#define	CSDD_MemCardCalibrateDmaModeSF CSDD_SanityFunction96
 #define	CSDD_MemoryCardConfigureSF CSDD_SanityFunction23
 #define	CSDD_MemoryCardDataEraseSF CSDD_SanityFunction3
 #define	CSDD_MemCardPartialDataXferSF CSDD_SanityFunction21
@@ -148,6 +163,7 @@ uint32_t CSDD_SanityFunction92(const CSDD_SDIO_Host* pD, const bool* extendedWrM
 #define	CSDD_MemCardInfXferContinueSF CSDD_SanityFunction21
 #define	CSDD_MemCardInfXferFinishSF CSDD_SanityFunction28
 #define	CSDD_MemCardDataXferNonBlockSF CSDD_SanityFunction29
+#define	CSDD_MemCardDataXferNonBlockCbSF CSDD_SanityFunction29
 #define	CSDD_MemCardFinishXferNonBloSF CSDD_SanityFunction5
 #define	CSDD_PhySettingsSd3SF CSDD_SanityFunction31
 #define	CSDD_PhySettingsSd4SF CSDD_SanityFunction31
@@ -198,6 +214,13 @@ uint32_t CSDD_SanityFunction92(const CSDD_SDIO_Host* pD, const bool* extendedWrM
 #define	CSDD_CQResetIntCoalCountersSF CSDD_SanityFunction3
 #define	CSDD_CQSetResponseErrorMaskSF CSDD_SanityFunction3
 #define	CSDD_CQGetResponseErrorMaskSF CSDD_SanityFunction35
+#define	CSDD_CQGetCompletionsSF CSDD_SanityFunction97
+#define	CSDD_CQSubmitSF CSDD_SanityFunction66
+#define	CSDD_CQSetSchedConfigSF CSDD_SanityFunction98
+#define	CSDD_CQGetSchedConfigSF CSDD_SanityFunction98
+#define	CSDD_CQSetIntCoalescingAutoSF CSDD_SanityFunction99
+#define	CSDD_CQGetIntCoalescingAutoSF CSDD_SanityFunction99
+#define	CSDD_CQGetIntCoalescingStatsSF CSDD_SanityFunction100
 #define	CSDD_GetBaseClkSF CSDD_SanityFunction35
 #define	CSDD_WaitForRequestSF CSDD_SanityFunction5
 #define	CSDD_SetCPhyConfigIoDelaySF CSDD_SanityFunction82
@@ -48,6 +48,7 @@
 #include "sdio_card_general.h"
 #include "sdio_request.h"
 #include "sdio_cq.h"
+#include "sdio_dma.h"
 #include "sdio_debug.h"
 #include "sdio_utils.h"
 
@@ -83,6 +84,12 @@ static uint32_t ErrorTranslate(uint8_t sdioError)
     case 0:
         result = 0;
         break;
+    case SDIO_STATUS_PENDING:
+        result = EINPROGRESS;
+        break;
+    case SDIO_ERR_MEM_ALLOC:
+        result = ENOMEM;
+        break;
     case SDIO_ERR_BUS_SPEED_UNSUPP:
     case SDIO_ERR_UNSUPPORTED_COMMAND:
     case SDIO_ERR_FUNCTION_UNSUPP:
@@ -138,6 +145,7 @@ uint32_t CSDD_Probe(uintptr_t registerBase, CSDD_SysReq* req)
         req->descSize += MAX_COMMAND_DESCR_BUFF_SIZE * SDIO_SLOT_COUNT;
         req->idDescSize = MAX_INTEGREATED_DESCR_BUFF_SIZE * SDIO_SLOT_COUNT;
 #endif
+        req->bounceSize = SDIO_CFG_BOUNCE_BUFFER_SIZE * SDIO_CFG_BOUNCE_BUFFERS;
     }
 
     return (ret);
@@ -151,16 +159,24 @@ uint32_t CSDD_Init(CSDD_SDIO_Host* pD, CSDD_Config *config, CSDD_Callbacks* call
     uintptr_t phyAddrADMA;
     uintptr_t logAddrID;
     uintptr_t phyAddrID;
+    uintptr_t logAddrBounce;
+    uintptr_t phyAddrBounce;
+    uint8_t bounceCount;
+    uint32_t bounceBufferSize;
 
     uint32_t ret = CSDD_InitSF(pD, config, callbacks);
 
     if (ret == CDN_EOK) {
         pSdioHost->RegOffset = (void*)(uintptr_t)config->regBase;
         pSdioHost->dma64BitEn = config->dma64BitEn;
+        pSdioHost->descCoherent = (config->descCoherent != 0U) ? 1U : 0U;
+        pSdioHost->ioCoherent = (config->ioCoherent != 0U) ? 1U : 0U;
 
         pSdioHost->pCardRemoved = callbacks->cardRemovedCallback;
         pSdioHost->pCardInserted = callbacks->cardInsertedCallback;
         pSdioHost->axiErrorCallback = callbacks->axiErrorCallback;
+        pSdioHost->virtToPhys = callbacks->virtToPhysCallback;
+        DMA_FlushAddrCache(pSdioHost);
 #if SDIO_CFG_ENABLE_MMC
 	pSdioHost->pSetTuneVal = SDIOHost_MmcTune;
 #if SDIO_CFG_HOST_VER > 4
@@ -171,6 +187,14 @@ uint32_t CSDD_Init(CSDD_SDIO_Host* pD, CSDD_Config *config, CSDD_Callbacks* call
         phyAddrADMA = (uintptr_t)config->descPhyAddress;
 	logAddrID = (uintptr_t)config->idDescLogAddress;
         phyAddrID = (uintptr_t)config->idDescPhyAddress;
+        logAddrBounce = (uintptr_t)config->bounceLogAddress;
+        phyAddrBounce = (uintptr_t)config->bouncePhyAddress;
+        bounceCount = config->bounceCount;
+        bounceBufferSize = config->bounceBufferSize;
+        if (bounceCount == 0U) {
+            bounceCount = SDIO_CFG_BOUNCE_BUFFERS;
+            bounceBufferSize = SDIO_CFG_BOUNCE_BUFFER_SIZE;
+        }
 
         if ((logAddrADMA == 0U) || (phyAddrADMA == 0U)) {
             ret = EINVAL;
@@ -178,7 +202,21 @@ uint32_t CSDD_Init(CSDD_SDIO_Host* pD, CSDD_Config *config, CSDD_Callbacks* call
         } else if ((logAddrID == 0U) || (phyAddrID == 0U)) {
             ret = EINVAL;
 #endif
+        } else if ((bounceCount > SDIO_CFG_BOUNCE_BUFFERS_MAX)
+                   || (bounceBufferSize == 0U) || ((bounceBufferSize % 512U) != 0U)) {
+            ret = EINVAL;
 	} else {
+            pSdioHost->BounceBuffer = NULL;
+            pSdioHost->BounceDMAAddr = NULL;
+            pSdioHost->BounceCount = 0U;
+            pSdioHost->BounceBufferSize = bounceBufferSize;
+            pSdioHost->BounceUsed = 0U;
+            if ((logAddrBounce != 0U) && (phyAddrBounce != 0U)) {
+                pSdioHost->BounceBuffer = (uint8_t*)logAddrBounce;
+                pSdioHost->BounceDMAAddr = (void*)phyAddrBounce;
+                pSdioHost->BounceCount = bounceCount;
+            }
+
             for (i = 0; i < SDIO_SLOT_COUNT; i++) {
                 const uintptr_t offset = (uintptr_t)i * MAX_DESCR_BUFF_SIZE;
                 pSdioHost->Slots[i].DescriptorBuffer = (uint32_t*)(logAddrADMA + offset);
@@ -240,6 +278,8 @@ uint32_t CSDD_Start(CSDD_SDIO_Host* pD)
         for (i = 0; i < pSdioHost->NumberOfSlots; i++) {
             (void)SDIOHost_InterruptConfig(&pSdioHost->Slots[i], 1);
         }
+        pSdioHost->hybridPolling = 0;
+        pSdioHost->hybridPollStats.polling = false;
     }
 
     return (ret);
@@ -260,6 +300,8 @@ uint32_t CSDD_Stop(CSDD_SDIO_Host* pD)
         for (i = 0; i < pSdioHost->NumberOfSlots; i++) {
             (void)SDIOHost_InterruptConfig(&pSdioHost->Slots[i], 0);
         }
+        pSdioHost->hybridPolling = 0;
+        pSdioHost->hybridPollStats.polling = false;
     }
 
     return (ret);
@@ -390,6 +432,48 @@ void CSDD_Isr(CSDD_SDIO_Host* pD, bool* handled)
     }
 }
 
+void CSDD_IsrTopHalf(CSDD_SDIO_Host* pD, bool* handled)
+{
+    uint32_t ret = CSDD_IsrTopHalfSF(pD, handled);
+
+    if (ret == CDN_EOK) {
+        SDIOHost_InterruptTopHalf(pD, (uint8_t*)handled);
+    }
+}
+
+uint32_t CSDD_IsrBottomHalf(CSDD_SDIO_Host* pD)
+{
+    uint32_t ret = CSDD_IsrBottomHalfSF(pD);
+
+    if (ret == CDN_EOK) {
+        SDIOHost_InterruptBottomHalf(pD);
+    }
+
+    return (ret);
+}
+
+uint32_t CSDD_GetHybridPollStats(CSDD_SDIO_Host* pD, CSDD_HybridPollStats* stats)
+{
+    uint32_t ret = CSDD_GetHybridPollStatsSF(pD, stats);
+
+    if (ret == CDN_EOK) {
+        *stats = pD->hybridPollStats;
+    }
+
+    return (ret);
+}
+
+uint32_t CSDD_GetBounceStats(CSDD_SDIO_Host* pD, CSDD_BounceStats* stats)
+{
+    uint32_t ret = CSDD_GetBounceStatsSF(pD, stats);
+
+    if (ret == CDN_EOK) {
+        *stats = pD->bounceStats;
+    }
+
+    return (ret);
+}
+
 uint32_t CSDD_ConfigureHighSpeed(CSDD_SDIO_Host* pD, uint8_t slotIndex, bool setHighSpeed)
 {
     CSDD_SDIO_Host *pSdioHost = pD;
@@ -546,7 +630,7 @@ void CSDD_MemoryCardLoadDriver(CSDD_SDIO_Host* pD)
     uint32_t ret = CSDD_MemoryCardLoadDriverSF(pD);
 
     if (ret == CDN_EOK) {
-        MemoryCard_LoadDriver();
+        MemoryCard_LoadDriver(pD);
     }
 }
 
@@ -596,6 +680,68 @@ uint32_t CSDD_MemoryCardDataTransfer2(CSDD_SDIO_Host* pD, uint8_t slotIndex, uin
     return (ret);
 }
 
+uint32_t CSDD_MemoryCardSgTransfer(CSDD_SDIO_Host* pD, uint8_t slotIndex, uint32_t address, CSDD_SubBuffer* segments,
+                                   uint32_t segmentCount, CSDD_TransferDirection direction)
+{
+    CSDD_SDIO_Host *pSdioHost = pD;
+    uint64_t size = 0U;
+    uint32_t i;
+
+    uint32_t ret = CSDD_MemoryCardSgTransferSF(pD, segments, direction);
+
+    if (ret == CDN_EOK) {
+        for (i = 0; i < segmentCount; i++) {
+            size += segments[i].size;
+        }
+
+        if ((slotIndex >= pSdioHost->NumberOfSlots) || (segmentCount == 0U) || (size > 0xFFFFFFFFU)) {
+            ret = EINVAL;
+        } else {
+            CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[slotIndex];
+            ret = ErrorTranslate(MemoryCard_DataXfer2(pSlot->pDevice, address, segments, (uint32_t)size, direction, segmentCount));
+        }
+    }
+
+    return (ret);
+}
+
+uint32_t CSDD_MemCardBatchXfer(CSDD_SDIO_Host* pD, uint8_t slotIndex, CSDD_MemBatchEntry* entries, uint32_t entryCount)
+{
+    CSDD_SDIO_Host *pSdioHost = pD;
+
+    uint32_t ret = CSDD_MemCardBatchXferSF(pD, entries);
+
+    if (ret == CDN_EOK) {
+        if (slotIndex >= pSdioHost->NumberOfSlots) {
+            ret = EINVAL;
+        } else {
+            CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[slotIndex];
+            ret = ErrorTranslate(MemoryCard_BatchXfer(pSlot->pDevice, entries, entryCount));
+        }
+    }
+
+    return (ret);
+}
+
+uint32_t CSDD_MemCardCalibrateDmaMode(CSDD_SDIO_Host* pD, uint8_t slotIndex, uint32_t address, void* buffer,
+                                      uint32_t size, CSDD_DmaCalibration* result)
+{
+    CSDD_SDIO_Host *pSdioHost = pD;
+
+    uint32_t ret = CSDD_MemCardCalibrateDmaModeSF(pD, buffer, result);
+
+    if (ret == CDN_EOK) {
+        if (slotIndex >= pSdioHost->NumberOfSlots) {
+            ret = EINVAL;
+        } else {
+            CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[slotIndex];
+            ret = ErrorTranslate(MemoryCard_CalibrateDmaMode(pSlot->pDevice, address, buffer, size, result));
+        }
+    }
+
+    return (ret);
+}
+
 uint32_t CSDD_MemoryCardConfigure(CSDD_SDIO_Host* pD, uint8_t slotIndex, CSDD_MmcConfigCmd cmd, uint8_t* data, uint8_t size)
 {
     CSDD_SDIO_Host *pSdioHost = pD;
@@ -722,7 +868,30 @@ uint32_t CSDD_MemCardDataXferNonBlock(CSDD_SDIO_Host* pD, uint8_t slotIndex,
             ret = EINVAL;
         } else {
             CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[slotIndex];
-            ret = ErrorTranslate(MemoryCard_DataXferNonBlock(pSlot->pDevice, address, buffer, size, direction, request));
+            ret = ErrorTranslate(MemoryCard_DataXferNonBlock(pSlot->pDevice, address, buffer, size, direction,
+                                                             NULL, NULL, request));
+        }
+    }
+
+    return (ret);
+}
+
+uint32_t CSDD_MemCardDataXferNonBlockCb(CSDD_SDIO_Host* pD, uint8_t slotIndex,
+                                        uint32_t address, void* buffer, uint32_t size,
+                                        CSDD_TransferDirection direction, CSDD_RequestCompleteCallback callback,
+                                        void* userContext, void** request)
+{
+    CSDD_SDIO_Host *pSdioHost = pD;
+
+    uint32_t ret = CSDD_MemCardDataXferNonBlockCbSF(pD, (const void*)buffer, direction, (const void**)request);
+
+    if (ret == CDN_EOK) {
+        if (slotIndex >= pSdioHost->NumberOfSlots) {
+            ret = EINVAL;
+        } else {
+            CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[slotIndex];
+            ret = ErrorTranslate(MemoryCard_DataXferNonBlock(pSlot->pDevice, address, buffer, size, direction,
+                                                             callback, userContext, request));
         }
     }
 
@@ -734,9 +903,7 @@ uint32_t CSDD_MemCardFinishXferNonBlock(CSDD_SDIO_Host* pD, CSDD_Request* pReque
     uint32_t ret = CSDD_MemCardFinishXferNonBloSF(pD, pRequest);
 
     if (ret == CDN_EOK) {
-        SDIOHost_CheckBusy(pRequest->pSdioHost, pRequest);
-
-        ret = ErrorTranslate(pRequest->status);
+        ret = ErrorTranslate(MemoryCard_FinishXferNonBlock(pRequest));
     }
 
     return (ret);
@@ -1699,6 +1866,156 @@ uint32_t CSDD_CQGetResponseErrorMask(CSDD_SDIO_Host* pD, uint32_t *errorMask)
     return (ret);
 }
 
+uint32_t CSDD_CQGetCompletions(CSDD_SDIO_Host* pD, CSDD_CQCompletion* entries, uint8_t maxEntries, uint8_t* count, uint32_t* overflows)
+{
+    CSDD_SDIO_Host *pSdioHost = pD;
+
+    uint32_t ret = CSDD_CQGetCompletionsSF(pD, entries, count);
+
+    if (ret == CDN_EOK) {
+        if (!pSdioHost->cqSupported) {
+            ret = ENOTSUP;
+        }
+    }
+
+    if (ret == CDN_EOK) {
+        CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[0];
+
+        ret = SDIOHost_CQ_GetCompletions(pSlot, entries, maxEntries, count);
+        if ((ret == CDN_EOK) && (overflows != NULL)) {
+            *overflows = pSlot->CQComplOverflows;
+        }
+    }
+
+    return (ret);
+}
+
+uint32_t CSDD_CQSubmit(CSDD_SDIO_Host* pD, CSDD_CQRequest* request, uint8_t ringDoorbell)
+{
+    CSDD_SDIO_Host *pSdioHost = pD;
+
+    uint32_t ret = CSDD_CQSubmitSF(pD, request);
+
+    if (ret == CDN_EOK) {
+        if (!pSdioHost->cqSupported) {
+            ret = ENOTSUP;
+        }
+    }
+
+    if (ret == CDN_EOK) {
+        CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[0];
+
+        ret = SDIOHost_CQ_Submit(pSlot, request, ringDoorbell);
+    }
+
+    return (ret);
+}
+
+uint32_t CSDD_CQSetSchedConfig(CSDD_SDIO_Host* pD, CSDD_CQSchedConfig* config)
+{
+    CSDD_SDIO_Host *pSdioHost = pD;
+
+    uint32_t ret = CSDD_CQSetSchedConfigSF(pD, config);
+
+    if (ret == CDN_EOK) {
+        if (!pSdioHost->cqSupported) {
+            ret = ENOTSUP;
+        }
+    }
+
+    if (ret == CDN_EOK) {
+        CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[0];
+
+        ret = SDIOHost_CQ_SetSchedConfig(pSlot, config);
+    }
+
+    return (ret);
+}
+
+uint32_t CSDD_CQGetSchedConfig(CSDD_SDIO_Host* pD, CSDD_CQSchedConfig* config)
+{
+    CSDD_SDIO_Host *pSdioHost = pD;
+
+    uint32_t ret = CSDD_CQGetSchedConfigSF(pD, config);
+
+    if (ret == CDN_EOK) {
+        if (!pSdioHost->cqSupported) {
+            ret = ENOTSUP;
+        }
+    }
+
+    if (ret == CDN_EOK) {
+        CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[0];
+
+        ret = SDIOHost_CQ_GetSchedConfig(pSlot, config);
+    }
+
+    return (ret);
+}
+
+uint32_t CSDD_CQSetIntCoalescingAuto(CSDD_SDIO_Host* pD, CSDD_CQIntCoalescingAuto* config)
+{
+    CSDD_SDIO_Host *pSdioHost = pD;
+
+    uint32_t ret = CSDD_CQSetIntCoalescingAutoSF(pD, config);
+
+    if (ret == CDN_EOK) {
+        if (!pSdioHost->cqSupported) {
+            ret = ENOTSUP;
+        }
+    }
+
+    if (ret == CDN_EOK) {
+        CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[0];
+
+        ret = SDIOHost_CQ_SetIntCoalescingAuto(pSlot, config);
+    }
+
+    return (ret);
+}
+
+uint32_t CSDD_CQGetIntCoalescingAuto(CSDD_SDIO_Host* pD, CSDD_CQIntCoalescingAuto* config)
+{
+    CSDD_SDIO_Host *pSdioHost = pD;
+
+    uint32_t ret = CSDD_CQGetIntCoalescingAutoSF(pD, config);
+
+    if (ret == CDN_EOK) {
+        if (!pSdioHost->cqSupported) {
+            ret = ENOTSUP;
+        }
+    }
+
+    if (ret == CDN_EOK) {
+        CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[0];
+
+        ret = SDIOHost_CQ_GetIntCoalescingAuto(pSlot, config);
+    }
+
+    return (ret);
+}
+
+uint32_t CSDD_CQGetIntCoalescingStats(CSDD_SDIO_Host* pD, CSDD_CQIntCoalescingStats* stats)
+{
+    CSDD_SDIO_Host *pSdioHost = pD;
+
+    uint32_t ret = CSDD_CQGetIntCoalescingStatsSF(pD, stats);
+
+    if (ret == CDN_EOK) {
+        if (!pSdioHost->cqSupported) {
+            ret = ENOTSUP;
+        }
+    }
+
+    if (ret == CDN_EOK) {
+        CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[0];
+
+        ret = SDIOHost_CQ_GetIntCoalescingStats(pSlot, stats);
+    }
+
+    return (ret);
+}
+
 uint32_t CSDD_GetBaseClk(CSDD_SDIO_Host* pD, uint8_t slotIndex, uint32_t *frequencyKHz)
 {
     CSDD_SDIO_Host *pSdioHost = pD;
@@ -469,21 +469,19 @@ uint8_t SDIOHost_ReadSCR(CSDD_SDIO_Slot* pSlot)
 //-----------------------------------------------------------------------------
 uint8_t SDIOHost_ReadRCA(CSDD_SDIO_Slot* pSlot)
 {
-    // RCA address for RCA cards for MMC cards
-    static uint16_t RcaAddr = 0x1000;
-
     uint8_t status;
 
     if (pSlot == NULL) {
         status = SDIO_ERR_INVALID_PARAMETER;
     } else {
-        RcaAddr--;
+        // RCA address for MMC cards
+        pSlot->MmcRca--;
 
         CSDD_Request Request = {0};
 
 #if SDIO_CFG_ENABLE_MMC
         if (pSlot->pDevice->deviceType == (uint8_t)CSDD_CARD_TYPE_MMC) {
-            pSlot->pDevice->RCA = RcaAddr;
+            pSlot->pDevice->RCA = pSlot->MmcRca;
             SDIO_REQ_INIT_CMD(&Request, &((SD_CsddRequesParams){.cmd = SDIO_CMD3, .arg = ((uint32_t)pSlot->pDevice->RCA << 16),
                                                                 .cmdType = CSDD_CMD_TYPE_NORMAL,
                                                                 .respType = CSDD_RESPONSE_R1, .hwRespCheck = 0}));
@@ -66,12 +66,18 @@
 // Macros used as constants
 /// Set debouncing period
 #define DEBOUNCING_TIME                     0x300000UL
-/// Commands timeout is a iteration count after which timeout error will be report
+/// Commands timeout in microseconds after which timeout error will be reported
 /// if a command will not execute (mainly using in WaitForValue function)
 #define COMMANDS_TIMEOUT                    3000U
+/// timeout in microseconds of waiting for a request to finish. It only backs up
+/// the controller command and data timeouts, so it has to cover the longest
+/// card busy time (500 ms write timeout of SDXC cards)
+#define REQUEST_TIMEOUT                     1000000U
 // system clock in Hz
 #define SYTEM_CLK_KHZ                       (140000U)
-/// buffer size for ADMA2 descriptors
+/// buffer size for ADMA1/ADMA3 descriptors and the ADMA2 descriptor ring.
+/// ADMA2 transfers are not limited by it, but ADMA1, ADMA3 and command
+/// queuing keep flat descriptor tables in it, so it is sized for them
 #define MAX_DESCR_BUFF_SIZE                 (1024U * 50U)
 /// buffer size for ADMA 3 command descriptors
 #define MAX_COMMAND_DESCR_BUFF_SIZE         (1024U * 50U)
@@ -89,8 +95,70 @@
 /// delay in microseconds after power enable
 #define POWER_UP_DELAY_US                   2000U
 /// number of temporary sub-buffers, used by to split data
-/// bigger than 64KB for smaller parts. Split is made by ADMA module.
+/// bigger than 64KB for smaller parts. Split is made by ADMA module
+/// for ADMA1 and ADMA3 transfers, ADMA2 uses the descriptor ring and
+/// does not use them.
 #define SDIO_CFG_SDIO_SUB_BUFFERS_COUNT     4000U
 /// Configuration of how many times each reset operation shall be executed
 #define SDIO_CFG_RESET_COUNT                2U
+/// polling loops check the hardware every SDIO_CFG_POLL_MIN_DELAY_NS for the
+/// first SDIO_CFG_POLL_SPIN_NS, then the delay between checks doubles up to
+/// SDIO_CFG_POLL_MAX_DELAY_NS, but stays below 1/8 of the time already spent.
+/// Delays are made with CPS_DelayNs and timeouts are measured with CPS_GetTimeNs.
+#define SDIO_CFG_POLL_MIN_DELAY_NS          100U
+#define SDIO_CFG_POLL_SPIN_NS               20000U
+#define SDIO_CFG_POLL_MAX_DELAY_NS          200000U
+/// length in nanoseconds of the window in which hybrid interrupt/polling mode
+/// counts submitted requests, see CSDD_CONFIG_SET_HYBRID_POLL
+#define SDIO_CFG_HYBRID_POLL_WINDOW_NS      1000000U
+/// number of requests the memory card driver keeps for non-blocking
+/// transfers of each slot. It limits how many such transfers can be
+/// in flight at once on one slot.
+#define SDIO_CFG_MEM_REQUESTS_PER_SLOT      4U
+/// default pool of DMA bounce buffers of a host, SDIO_CFG_BOUNCE_BUFFERS
+/// buffers of SDIO_CFG_BOUNCE_BUFFER_SIZE bytes, the pool can be changed
+/// in CSDD_Config. Each transfer from/to data buffer which is not aligned
+/// for DMA takes a free buffer it fits in and its data is copied through it,
+/// the transfer is done without DMA if there is no such buffer.
+#define SDIO_CFG_BOUNCE_BUFFER_SIZE         (64U * 1024U)
+#define SDIO_CFG_BOUNCE_BUFFERS             (2U * SDIO_SLOT_COUNT)
+/// maximum number of DMA bounce buffers in the pool configured in CSDD_Config
+#define SDIO_CFG_BOUNCE_BUFFERS_MAX         32U
+/// maximum number of data buffers of command queuing task made of requests
+/// merged by the I/O scheduler, see CSDD_CQSetSchedConfig. Each task has its
+/// own transfer descriptor list of this size in the slot descriptor buffer.
+#define SDIO_CFG_CQ_MERGE_MAX_BUFFERS       16U
+/// length in nanoseconds of the window in which adaptive command queuing
+/// interrupt coalescing measures completion rate and queue depth before
+/// it retunes threshold and timeout, see CSDD_CQSetIntCoalescingAuto
+#define SDIO_CFG_CQ_COAL_WINDOW_NS          1000000U
+/// number of address ranges translated by CSDD_Callbacks.virtToPhysCallback
+/// which each host keeps, so pinned buffers used again are not translated
+/// by the callback on every transfer
+#define SDIO_CFG_ADDR_CACHE_SIZE            8U
+/// ADMA2 descriptors are written to a ring of SDIO_CFG_ADMA2_DESC_PAGES pages
+/// of SDIO_CFG_ADMA2_DESC_PAGE_SIZE bytes at the beginning of the slot
+/// descriptor buffer. Each page ends with a link descriptor to the next page.
+/// Pages which DMA has passed, found from the ADMA system address, are filled
+/// again from the DMA interrupt, so size of a transfer is not limited by the
+/// ring and page ends handled by one interrupt are not lost. One page is
+/// always left not valid, so DMA which overtakes the refill stops with ADMA
+/// error. At least 3 pages are needed and page size must be a multiple of 16. Each slot has two rings,
+/// the second one is filled for the next queued request while the current
+/// one is transferred, both must fit in MAX_DESCR_BUFF_SIZE. Pages are not
+/// taken from a shared pool, the DMA interrupt would have to allocate them.
+#define SDIO_CFG_ADMA2_DESC_PAGE_SIZE       512U
+#define SDIO_CFG_ADMA2_DESC_PAGES           4U
+/// number of transfer size classes of DMA mode calibration, see
+/// CSDD_MemCardCalibrateDmaMode. Class n holds transfers up to 512 * 4^n
+/// bytes, the last class holds also all bigger transfers.
+#define SDIO_CFG_DMA_CAL_CLASSES            6U
+/// number of timed transfers of each DMA mode and size class
+#define SDIO_CFG_DMA_CAL_REPEATS            4U
+/// calibration selects the mode with the lowest CPU time among modes
+/// which wall time exceeds the best one by at most 1/SDIO_CFG_DMA_CAL_WALL_SLACK
+#define SDIO_CFG_DMA_CAL_WALL_SLACK         8U
+/// number of entries of the command queuing completion ring of each slot,
+/// see CSDD_CONFIG_SET_CQ_COMPLETION_RING. It must be a power of 2
+#define SDIO_CFG_CQ_COMPL_RING_SIZE         64U
 #endif
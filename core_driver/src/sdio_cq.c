@@ -64,6 +64,10 @@ static inline uint32_t CQ_TASK_MGMT_ARG(uint32_t taskId, uint32_t tmOpcode)
 #define  CQ_HOST_NUMBER_OF_TASKS   32U
 /* direct command task ID */
 #define  CQ_DCMD_TASK_ID           31U
+/* task ID reported for request discarded from the backlog before it got a task */
+#define  CQ_NO_TASK_ID             0xFFU
+/* no backlog queue selected */
+#define  CQ_NO_QUEUE               0xFFU
 
 /* macro checks if given task is direc to command task */
 static inline bool CQ_IS_DIRECT_TASK(const CSDD_SDIO_Slot* pSlot, uint8_t taskId)
@@ -71,6 +75,79 @@ static inline bool CQ_IS_DIRECT_TASK(const CSDD_SDIO_Slot* pSlot, uint8_t taskId
     return ((pSlot->CQDcmdEnabled != 0U) && (taskId == CQ_DCMD_TASK_ID));
 }
 
+/* function returns index of the lowest bit set in mask, mask must not be 0 */
+static inline uint8_t CQ_FindFirstSet(uint32_t mask)
+{
+    /* keep the lowest set bit only */
+    const uint32_t bit = mask & (~mask + 1U);
+    uint8_t index = 0U;
+
+    if ((bit & 0xFFFF0000U) != 0U) {
+        index += 16U;
+    }
+    if ((bit & 0xFF00FF00U) != 0U) {
+        index += 8U;
+    }
+    if ((bit & 0xF0F0F0F0U) != 0U) {
+        index += 4U;
+    }
+    if ((bit & 0xCCCCCCCCU) != 0U) {
+        index += 2U;
+    }
+    if ((bit & 0xAAAAAAAAU) != 0U) {
+        index += 1U;
+    }
+
+    return (index);
+}
+
+/* function returns number of bits set in mask */
+static inline uint32_t CQ_CountBits(uint32_t mask)
+{
+    uint32_t bits = mask;
+    uint32_t count = 0U;
+
+    while (bits != 0U) {
+        /* clear the lowest set bit */
+        bits &= bits - 1U;
+        count++;
+    }
+
+    return (count);
+}
+
+/* function atomically sets bits of the variable */
+static void CQ_AtomicSetBits(volatile uint32_t* variable, uint32_t bits)
+{
+    uint32_t value;
+
+    do {
+        value = *variable;
+    } while (!CPS_AtomicCompareSwap32(variable, value, value | bits));
+}
+
+/* function atomically clears bits of the variable */
+static void CQ_AtomicClearBits(volatile uint32_t* variable, uint32_t bits)
+{
+    uint32_t value;
+
+    do {
+        value = *variable;
+    } while (!CPS_AtomicCompareSwap32(variable, value, value & ~bits));
+}
+
+/* function atomically clears the variable and returns its previous value */
+static uint32_t CQ_AtomicTake(volatile uint32_t* variable)
+{
+    uint32_t value;
+
+    do {
+        value = *variable;
+    } while (!CPS_AtomicCompareSwap32(variable, value, 0U));
+
+    return (value);
+}
+
 /* Task Descriptor Fields (for DCMD tasks) - 64 bit*/
 typedef struct CQ_DcmdTaskDesc64_s {
     /* standard flags config
@@ -194,60 +271,152 @@ static void CQDumpDcmdRequest(const CSDD_CQDcmdRequest *pRequest, uint8_t isErro
     }
 }
 
+/* function stores completion in the completion ring if it is enabled */
+static void CompletionRingPush(CSDD_SDIO_Slot* pSlot, uint8_t taskId,
+                               CSDD_CQReqStat status, void* userContext)
+{
+    if (pSlot->CQComplRingEn != 0U) {
+        const uint32_t head = pSlot->CQComplHead;
+
+        if ((head - pSlot->CQComplTail) >= SDIO_CFG_CQ_COMPL_RING_SIZE) {
+            pSlot->CQComplOverflows++;
+        } else {
+            CSDD_CQCompletion* entry = &pSlot->CQComplRing[head % SDIO_CFG_CQ_COMPL_RING_SIZE];
+
+            entry->taskId = taskId;
+            entry->status = status;
+            entry->userContext = userContext;
+            /* entry must be visible before the reader sees new head */
+            CPS_MemoryBarrierWrite();
+            pSlot->CQComplHead = head + 1U;
+        }
+    }
+}
+
 /* function finishes request but only if attached */
 static void FinishRequest(CSDD_SDIO_Slot* pSlot, uint8_t taskId,
                           CSDD_CQReqStat status)
 {
-    if (pSlot->CQCurrentReq[taskId] != NULL) {
+    CSDD_CQRequest* request = pSlot->CQCurrentReq[taskId];
+
+    if (request != NULL) {
         if (status == CSDD_CQ_REQ_STAT_FAILED) {
-            CQDumpRequest(pSlot->CQCurrentReq[taskId], 1);
+            CQDumpRequest(request, 1);
         }
 
-        pSlot->CQCurrentReq[taskId]->cQReqStat = status;
         pSlot->CQCurrentReq[taskId] = NULL;
+        /* task can be taken by another producer from now on */
+        CQ_AtomicClearBits(&pSlot->CQTaskBusy, 1UL << taskId);
+
+        /* requests merged by the scheduler into one task finish together,
+         * callback may submit the request again, so next one is taken first */
+        while (request != NULL) {
+            CSDD_CQRequest* next = request->pNextRequest;
+
+            request->pNextRequest = NULL;
+            request->cQReqStat = status;
+
+            CompletionRingPush(pSlot, taskId, status, request->userContext);
+            if (request->completeCallback != NULL) {
+                request->completeCallback(request, request->userContext);
+            }
+            request = next;
+        }
     }
 }
 
 /* function finishes direct request but only if attached */
 static void FinishDcmdRequest(CSDD_SDIO_Slot* pSlot, CSDD_CQReqStat status)
 {
-    if (pSlot->CQCurrentDcmdReq != NULL) {
+    CSDD_CQDcmdRequest* request = pSlot->CQCurrentDcmdReq;
+
+    if (request != NULL) {
         if (status == CSDD_CQ_REQ_STAT_FAILED) {
-            CQDumpDcmdRequest(pSlot->CQCurrentDcmdReq, 1);
+            CQDumpDcmdRequest(request, 1);
         }
-        pSlot->CQCurrentDcmdReq->cQReqStat = status;
-        pSlot->CQCurrentDcmdReq->response =
+        request->cQReqStat = status;
+        request->response =
             CPS_REG_READ(&pSlot->RegOffset->CQRS.CQRS18);
 
         pSlot->CQCurrentDcmdReq = NULL;
+
+        CompletionRingPush(pSlot, CQ_DCMD_TASK_ID, status, request->userContext);
+        if (request->completeCallback != NULL) {
+            request->completeCallback(request, request->userContext);
+        }
     }
 }
 
-static void CheckTaskCompletion(CSDD_SDIO_Slot* pSlot)
+/* function returns mask of task IDs which can be used by normal (not DCMD) requests */
+static uint32_t CQ_TaskMask(const CSDD_SDIO_Slot* pSlot)
 {
-    uint8_t i;
+    const uint8_t depth = ((pSlot->pDevice != NULL) ? pSlot->pDevice->cQDepth : 0U);
+    uint32_t mask = (depth >= CQ_HOST_NUMBER_OF_TASKS) ? 0xFFFFFFFFU : ((1UL << depth) - 1U);
+
+    if (pSlot->CQDcmdEnabled != 0U) {
+        mask &= ~(1UL << CQ_DCMD_TASK_ID);
+    }
+
+    return (mask);
+}
+
+/* function atomically takes the lowest free task,
+ * it returns CQ_NO_TASK_ID if all tasks are busy */
+static uint8_t CQ_ClaimTask(CSDD_SDIO_Slot* pSlot)
+{
+    uint8_t taskId = CQ_NO_TASK_ID;
+    bool done = false;
+
+    while (!done) {
+        const uint32_t busy = pSlot->CQTaskBusy;
+        const uint32_t freeTasks = ~busy & CQ_TaskMask(pSlot);
+
+        if (freeTasks == 0U) {
+            taskId = CQ_NO_TASK_ID;
+            done = true;
+        } else {
+            taskId = CQ_FindFirstSet(freeTasks);
+            /* another producer may take the same task, then try again */
+            done = CPS_AtomicCompareSwap32(&pSlot->CQTaskBusy, busy, busy | (1UL << taskId));
+        }
+    }
+
+    return (taskId);
+}
 
+static void CQBacklogCollect(CSDD_SDIO_Slot* pSlot);
+static CSDD_CQRequest* CQBacklogPop(CSDD_SDIO_Slot* pSlot, uint8_t queue);
+static void CQBacklogRefill(CSDD_SDIO_Slot* pSlot);
+
+/* function finishes completed tasks, it returns number of them */
+static uint32_t CheckTaskCompletion(CSDD_SDIO_Slot* pSlot)
+{
     uint32_t reg;
+    uint32_t completed;
+    uint32_t count;
+
     reg = CPS_REG_READ(&pSlot->RegOffset->CQRS.CQRS11);
     /* clear all caught notifications */
     CPS_REG_WRITE(&pSlot->RegOffset->CQRS.CQRS11, reg);
 
-    uint8_t numOfTasks = ((pSlot->pDevice != NULL) ? pSlot->pDevice->cQDepth : 0U);
-
-    if ((pSlot->CQDcmdEnabled != 0U) && (numOfTasks == CQ_HOST_NUMBER_OF_TASKS)) {
-        numOfTasks--;
-    }
-
-    for (i = 0; i < numOfTasks; i++) {
-        if (CQRS11_GET_TASK_COMPL(reg, i) != 0U) {
-            FinishRequest(pSlot, i, CSDD_CQ_REQ_STAT_FINISHED);
-        }
+    completed = reg & CQ_TaskMask(pSlot);
+    count = CQ_CountBits(completed);
+    while (completed != 0U) {
+        FinishRequest(pSlot, CQ_FindFirstSet(completed), CSDD_CQ_REQ_STAT_FINISHED);
+        /* clear the lowest set bit */
+        completed &= completed - 1U;
     }
     if (pSlot->CQDcmdEnabled != 0U) {
         if (CQRS11_GET_TASK_COMPL(reg, CQ_DCMD_TASK_ID) != 0U) {
             FinishDcmdRequest(pSlot, CSDD_CQ_REQ_STAT_FINISHED);
+            count++;
         }
     }
+
+    /* tasks freed above are given to requests waiting in the backlog */
+    CQBacklogRefill(pSlot);
+
+    return (count);
 }
 
 static void DiscardAllRequests(CSDD_SDIO_Slot* pSlot)
@@ -266,6 +435,21 @@ static void DiscardAllRequests(CSDD_SDIO_Slot* pSlot)
     if (pSlot->CQDcmdEnabled != 0U) {
         FinishDcmdRequest(pSlot, CSDD_CQ_REQ_STAT_FAILED);
     }
+
+    /* requests waiting for a task are discarded too */
+    CQBacklogCollect(pSlot);
+    for (i = 0; i < CSDD_CQ_IO_CLASS_COUNT; i++) {
+        while (pSlot->CQBacklogHead[i] != NULL) {
+            CSDD_CQRequest* request = CQBacklogPop(pSlot, i);
+
+            request->cQReqStat = CSDD_CQ_REQ_STAT_FAILED;
+
+            CompletionRingPush(pSlot, CQ_NO_TASK_ID, CSDD_CQ_REQ_STAT_FAILED, request->userContext);
+            if (request->completeCallback != NULL) {
+                request->completeCallback(request, request->userContext);
+            }
+        }
+    }
 }
 
 static uint8_t TaskClear(CSDD_SDIO_Slot* pSlot, uint8_t taskId)
@@ -630,11 +814,139 @@ static void HandleInterruptCoalescing(CSDD_SDIO_Slot* pSlot)
     }
 }
 
+/* function publishes adaptive interrupt coalescing counters for
+ * SDIOHost_CQ_GetIntCoalescingStats, readers retry while the sequence
+ * is odd or changes during their copy */
+static void CQCoalPublishStats(CSDD_SDIO_Slot* pSlot)
+{
+    pSlot->CQCoalStatsSeq++;
+    CPS_MemoryBarrierWrite();
+    pSlot->CQCoalStatsCopy = pSlot->CQCoalStats;
+    CPS_MemoryBarrierWrite();
+    pSlot->CQCoalStatsSeq++;
+}
+
+/* function converts time in microseconds to interrupt coalescing timeout value,
+ * which counts 1024 clocks of timeout base clock */
+static uint8_t CQCoalTimeoutValue(const CSDD_SDIO_Slot* pSlot, uint64_t timeUs)
+{
+    uint64_t value = (timeUs * pSlot->CQCoalClockKHz) / (1024U * 1000U);
+
+    if (value == 0U) {
+        value = 1U;
+    }
+    if (value > 127U) {
+        value = 127U;
+    }
+
+    return ((uint8_t)value);
+}
+
+/* function selects interrupt coalescing configuration for completion rate
+ * and average outstanding tasks measured in the last window */
+static void CQCoalAutoTune(CSDD_SDIO_Slot* pSlot, uint64_t rate, uint32_t avgDepth)
+{
+    const CSDD_CQIntCoalescingAuto* autoCfg = &pSlot->CQCoalAuto;
+    CSDD_CQIntCoalescingStats* stats = &pSlot->CQCoalStats;
+    /* half of the tasks keeps the device busy while the other half is coalesced */
+    const uint64_t maxThreshold = ((avgDepth / 2U) < (CQ_HOST_NUMBER_OF_TASKS - 1U)) ?
+                                  (avgDepth / 2U) : (CQ_HOST_NUMBER_OF_TASKS - 1U);
+    CSDD_CQIntCoalescingCfg config;
+    uint64_t threshold;
+    uint64_t timeUs;
+
+    if (rate <= autoCfg->maxIntRate) {
+        /* low load: only completions which fit in the latency target wait together */
+        threshold = (rate * autoCfg->latencyTargetUs) / 1000000U;
+        timeUs = autoCfg->latencyTargetUs;
+    } else {
+        /* high load: enough completions per interrupt to keep the interrupt rate cap */
+        threshold = (rate + autoCfg->maxIntRate - 1U) / autoCfg->maxIntRate;
+        timeUs = 1000000U / autoCfg->maxIntRate;
+        if (timeUs < autoCfg->latencyTargetUs) {
+            timeUs = autoCfg->latencyTargetUs;
+        }
+    }
+    if (threshold > maxThreshold) {
+        threshold = maxThreshold;
+    }
+
+    if (threshold < 2U) {
+        /* coalescing of a single completion only delays it */
+        config.enable = 0U;
+        config.threshold = 0U;
+        config.timeout = 0U;
+    } else {
+        config.enable = 1U;
+        config.threshold = (uint8_t)threshold;
+        config.timeout = CQCoalTimeoutValue(pSlot, timeUs);
+    }
+
+    if ((config.enable != stats->enable) || (config.threshold != stats->threshold)
+        || (config.timeout != stats->timeout)) {
+        uint32_t reg = CPS_REG_READ(&pSlot->RegOffset->CQRS.CQRS07);
+
+        /* counter is not reset, completions counted so far still raise interrupt */
+        reg &= ~((uint32_t)CQRS07_INT_COAL_COUNT_THRESHOLD_MASK | CQRS07_INT_COAL_TIMEOUT_VAL_MASK
+                 | (uint32_t)CQRS07_INT_COAL_COUNTER_TIMER_RESET);
+        reg |= CQRS07_SET_INT_COAL_COUNT_THRESHOLD(config.threshold) | (uint32_t)CQRS07_INT_COAL_COUNT_THRESHOLD_WE;
+        reg |= CQRS07_SET_INT_COAL_TIMEOUT_VAL(config.timeout) | (uint32_t)CQRS07_INT_COAL_TIMEOUT_WE;
+        if (config.enable != 0U) {
+            reg |= (uint32_t)CQRS07_INT_COAL_ENABLE;
+        } else {
+            reg &= ~(uint32_t)CQRS07_INT_COAL_ENABLE;
+        }
+        CPS_REG_WRITE(&pSlot->RegOffset->CQRS.CQRS07, reg);
+
+        pSlot->CQIntCoalescingEn = config.enable;
+        stats->enable = config.enable;
+        stats->threshold = config.threshold;
+        stats->timeout = config.timeout;
+        stats->retunes++;
+    }
+}
+
+/* function counts task completion interrupt of adaptive interrupt coalescing,
+ * at the end of each window it retunes threshold and timeout */
+static void CQCoalAutoUpdate(CSDD_SDIO_Slot* pSlot, uint32_t completed, uint32_t depth)
+{
+    CSDD_CQIntCoalescingStats* stats = &pSlot->CQCoalStats;
+    const uint64_t now = CPS_GetTimeNs();
+    const uint64_t elapsed = now - pSlot->CQCoalWindowStart;
+
+    stats->interrupts++;
+    stats->completions += completed;
+    pSlot->CQCoalWindowInts++;
+    pSlot->CQCoalWindowCompletions += completed;
+    pSlot->CQCoalWindowDepth += depth;
+
+    if (elapsed >= SDIO_CFG_CQ_COAL_WINDOW_NS) {
+        const uint64_t rate = ((uint64_t)pSlot->CQCoalWindowCompletions * 1000000000U) / elapsed;
+        const uint32_t avgDepth = pSlot->CQCoalWindowDepth / pSlot->CQCoalWindowInts;
+
+        stats->completionRate = (uint32_t)rate;
+        stats->interruptRate = (uint32_t)(((uint64_t)pSlot->CQCoalWindowInts * 1000000000U) / elapsed);
+        stats->avgDepth = (uint8_t)avgDepth;
+
+        CQCoalAutoTune(pSlot, rate, avgDepth);
+
+        pSlot->CQCoalWindowStart = now;
+        pSlot->CQCoalWindowInts = 0U;
+        pSlot->CQCoalWindowCompletions = 0U;
+        pSlot->CQCoalWindowDepth = 0U;
+    }
+
+    CQCoalPublishStats(pSlot);
+}
+
 static void CheckCQInterrupt(CSDD_SDIO_Slot* pSlot)
 {
     uint32_t reg;
     reg = CPS_REG_READ(&pSlot->RegOffset->CQRS.CQRS04);
     CPS_REG_WRITE(&pSlot->RegOffset->CQRS.CQRS04, reg);
+    // status acknowledged by the interrupt top half
+    reg |= pSlot->IsrCqrs04;
+    pSlot->IsrCqrs04 = 0U;
 
     if (pSlot->pDevice == NULL) {
         vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "Device is NULL fatal ERROR\n");
@@ -647,8 +959,16 @@ static void CheckCQInterrupt(CSDD_SDIO_Slot* pSlot)
     }
 
     if ((reg & CQRS04_TASK_COMPLETE_INT) != 0U) {
+        /* tasks in flight, including the ones completed now */
+        const uint32_t depth = CQ_CountBits(pSlot->CQTaskBusy & CQ_TaskMask(pSlot));
+        uint32_t completed;
+
         HandleInterruptCoalescing(pSlot);
-        CheckTaskCompletion(pSlot);
+        completed = CheckTaskCompletion(pSlot);
+
+        if (pSlot->CQCoalAuto.enable != 0U) {
+            CQCoalAutoUpdate(pSlot, completed, depth);
+        }
     }
 
 }
@@ -675,7 +995,7 @@ void SDIOHost_CQ_CheckInterrupt(CSDD_SDIO_Slot* pSlot)
                      reg & SRS12_ERROR_STATUS_MASK);
     }
 
-    if ((reg & SRS12_CMD_QUEUING_INT) != 0U) {
+    if (((reg & SRS12_CMD_QUEUING_INT) != 0U) || (pSlot->IsrCqrs04 != 0U)) {
         CheckCQInterrupt(pSlot);
     }
 
@@ -1090,24 +1410,12 @@ static uint8_t VerifyRequestDataBuffers(const CSDD_CQRequest *request)
     return (status);
 }
 
-static uint8_t VerifyRequest(const CSDD_SDIO_Slot* pSlot, const CSDD_CQRequest *request)
+static uint8_t VerifyRequestData(const CSDD_SDIO_Slot* pSlot, const CSDD_CQRequest *request)
 {
     uint8_t status;
     /* descriptor size in bytes */
     uint32_t descSize;
 
-    if (request->taskId >= pSlot->pDevice->cQDepth) {
-        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Given task ID %d is bigger than max supported by device %d\n",
-                     request->taskId, pSlot->pDevice->cQDepth);
-
-    }
-
-    if ((pSlot->CQDcmdEnabled != 0U) && (request->taskId ==  CQ_DCMD_TASK_ID)) {
-        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Given task ID %d is used for direct command %d. \
-                     So it cannot be used to execute normal request\n",
-                     request->taskId,  CQ_DCMD_TASK_ID);
-    }
-
     status = VerifyRequestDataBuffers(request);
 
     if (status == SDIO_ERR_NO_ERROR) {
@@ -1136,6 +1444,23 @@ static uint8_t VerifyRequest(const CSDD_SDIO_Slot* pSlot, const CSDD_CQRequest *
     return (status);
 }
 
+static uint8_t VerifyRequest(const CSDD_SDIO_Slot* pSlot, const CSDD_CQRequest *request)
+{
+    if (request->taskId >= pSlot->pDevice->cQDepth) {
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Given task ID %d is bigger than max supported by device %d\n",
+                     request->taskId, pSlot->pDevice->cQDepth);
+
+    }
+
+    if ((pSlot->CQDcmdEnabled != 0U) && (request->taskId ==  CQ_DCMD_TASK_ID)) {
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Given task ID %d is used for direct command %d. \
+                     So it cannot be used to execute normal request\n",
+                     request->taskId,  CQ_DCMD_TASK_ID);
+    }
+
+    return (VerifyRequestData(pSlot, request));
+}
+
 static uint8_t VerifyDcmdRequest(const CSDD_CQDcmdRequest *request)
 {
     uint8_t status;
@@ -1170,11 +1495,22 @@ static void SDIOHost_ProcessCQInit(CSDD_SDIO_Slot* pSlot, uint32_t reg)
     pSlot->CQHalted = 0;
     pSlot->CQDcmdEnabled = 0;
     pSlot->CQIntCoalescingEn = 0;
+    pSlot->CQCoalAuto.enable = 0U;
     pSlot->CQDescriptorBuffer = NULL;
     pSlot->CQCurrentDcmdReq = NULL;
     for (i = 0; i <  CQ_HOST_NUMBER_OF_TASKS; i++) {
         pSlot->CQCurrentReq[i] = NULL;
     }
+    pSlot->CQTaskBusy = 0U;
+    pSlot->CQDoorbellPending = 0U;
+    pSlot->CQBacklogIn = NULL;
+    for (i = 0; i < CSDD_CQ_IO_CLASS_COUNT; i++) {
+        pSlot->CQBacklogHead[i] = NULL;
+        pSlot->CQBacklogTail[i] = NULL;
+    }
+    pSlot->CQRefillOwner = 0U;
+    pSlot->CQRefillRequested = 0U;
+    (void)SDIOHost_CQ_SetCompletionRing(pSlot, 0U);
 
     /* init descriptor pointer and physical address */
     descAddr = (uintptr_t)pSlot->DescriptorBuffer;
@@ -1189,6 +1525,14 @@ static void SDIOHost_ProcessCQInit(CSDD_SDIO_Slot* pSlot, uint32_t reg)
     pSlot->CQDescriptorBuffer = (uint32_t*)descAddr;
     pSlot->CQDescriptorDmaAddr = descPhyAddr;
 
+    /* transfer descriptor lists of merged requests are just before task descriptor list */
+    descAddr = (uintptr_t)pSlot->DescriptorBuffer;
+    descAddr += MAX_DESCR_BUFF_SIZE - CQ_DESC_LIST_SIZE_WITH_ALIGN_MARGIN - CQ_MERGE_DESC_LIST_SIZE;
+    descPhyAddr = (uintptr_t)pSlot->DescriptorDMAAddr;
+    descPhyAddr += MAX_DESCR_BUFF_SIZE - CQ_DESC_LIST_SIZE_WITH_ALIGN_MARGIN - CQ_MERGE_DESC_LIST_SIZE;
+    pSlot->CQMergeDescBuffer = (uint8_t*)descAddr;
+    pSlot->CQMergeDescDmaAddr = descPhyAddr;
+
     /* Task Descriptor List address configuration */
     descAddr64 = pSlot->CQDescriptorDmaAddr;
     CPS_REG_WRITE(&pSlot->RegOffset->CQRS.CQRS08, (uint32_t)(descAddr64 & 0xFFFFFFFFU));
@@ -1281,6 +1625,303 @@ uint8_t SDIOHost_CQ_ExecuteDcmdRequest(CSDD_SDIO_Slot*          pSlot,
     return (status);
 }
 
+/* function writes descriptors of verified request and attaches it to its task,
+ * caller must own the task. Descriptors of different tasks do not overlap,
+ * so producers write them in parallel */
+static void AttachToTask(CSDD_SDIO_Slot* pSlot, CSDD_CQRequest *request)
+{
+    if (pSlot->CQDescSize == CSDD_CQ_TASK_DESC_SIZE_64BIT) {
+        PrepareDescs64(pSlot->CQDescriptorBuffer, request);
+    } else {
+        PrepareDescs128(pSlot->CQDescriptorBuffer, request);
+    }
+
+    request->cQReqStat = CSDD_CQ_REQ_STAT_ATTACHED;
+    pSlot->CQCurrentReq[request->taskId] = request;
+}
+
+/* function checks if no submitted request waits for a task */
+static uint8_t CQBacklogEmpty(const CSDD_SDIO_Slot* pSlot)
+{
+    uint8_t result = (pSlot->CQBacklogIn == NULL) ? 1U : 0U;
+    uint8_t i;
+
+    for (i = 0; i < CSDD_CQ_IO_CLASS_COUNT; i++) {
+        if (pSlot->CQBacklogHead[i] != NULL) {
+            result = 0U;
+        }
+    }
+
+    return (result);
+}
+
+/* function appends request to the end of backlog queue */
+static void CQBacklogAppend(CSDD_SDIO_Slot* pSlot, uint8_t queue, CSDD_CQRequest* request)
+{
+    request->pNextRequest = NULL;
+    if (pSlot->CQBacklogTail[queue] != NULL) {
+        pSlot->CQBacklogTail[queue]->pNextRequest = request;
+    } else {
+        pSlot->CQBacklogHead[queue] = request;
+    }
+    pSlot->CQBacklogTail[queue] = request;
+}
+
+/* function removes the first request of backlog queue, queue must not be empty */
+static CSDD_CQRequest* CQBacklogPop(CSDD_SDIO_Slot* pSlot, uint8_t queue)
+{
+    CSDD_CQRequest* request = pSlot->CQBacklogHead[queue];
+
+    pSlot->CQBacklogHead[queue] = request->pNextRequest;
+    if (pSlot->CQBacklogHead[queue] == NULL) {
+        pSlot->CQBacklogTail[queue] = NULL;
+    }
+    request->pNextRequest = NULL;
+
+    return (request);
+}
+
+/* function moves requests pushed by producers to the backlog in submission order */
+static void CQBacklogCollect(CSDD_SDIO_Slot* pSlot)
+{
+    CSDD_CQRequest* pushed;
+    CSDD_CQRequest* ordered = NULL;
+
+    do {
+        pushed = pSlot->CQBacklogIn;
+    } while (!CPS_AtomicCompareSwapPtr((void* volatile*)&pSlot->CQBacklogIn, pushed, NULL));
+
+    /* pushed requests are linked newest first, reverse them */
+    while (pushed != NULL) {
+        CSDD_CQRequest* next = pushed->pNextRequest;
+
+        pushed->pNextRequest = ordered;
+        ordered = pushed;
+        pushed = next;
+    }
+
+    while (ordered != NULL) {
+        CSDD_CQRequest* next = ordered->pNextRequest;
+        /* without the scheduler all requests wait in one queue */
+        const uint8_t queue = (pSlot->CQSchedCfg.enable != 0U) ?
+                              (uint8_t)ordered->ioClass : (uint8_t)CSDD_CQ_IO_CLASS_DEFAULT;
+
+        CQBacklogAppend(pSlot, queue, ordered);
+        ordered = next;
+    }
+}
+
+/* function returns backlog queue from which the next task is started,
+ * or CQ_NO_QUEUE if all queues are empty */
+static uint8_t CQSchedSelectQueue(const CSDD_SDIO_Slot* pSlot, uint64_t now)
+{
+    /* queues in order of their priority */
+    static const uint8_t order[CSDD_CQ_IO_CLASS_COUNT] = {
+        (uint8_t)CSDD_CQ_IO_CLASS_LATENCY,
+        (uint8_t)CSDD_CQ_IO_CLASS_DEFAULT,
+        (uint8_t)CSDD_CQ_IO_CLASS_BULK
+    };
+    uint8_t queue = CQ_NO_QUEUE;
+    uint8_t i;
+
+    /* request which missed its deadline goes first, the oldest deadline wins */
+    for (i = 0; i < CSDD_CQ_IO_CLASS_COUNT; i++) {
+        const CSDD_CQRequest* head = pSlot->CQBacklogHead[i];
+
+        if ((head != NULL) && (head->deadlineNs != 0U) && (head->deadlineNs <= now)) {
+            if ((queue == CQ_NO_QUEUE) || (head->deadlineNs < pSlot->CQBacklogHead[queue]->deadlineNs)) {
+                queue = i;
+            }
+        }
+    }
+
+    for (i = 0; (queue == CQ_NO_QUEUE) && (i < CSDD_CQ_IO_CLASS_COUNT); i++) {
+        if (pSlot->CQBacklogHead[order[i]] != NULL) {
+            queue = order[i];
+        }
+    }
+
+    return (queue);
+}
+
+/* function checks if next request of backlog queue continues the last request of task */
+static bool CQSchedCanMerge(const CSDD_SDIO_Slot* pSlot, const CSDD_CQRequest* last,
+                            const CSDD_CQRequest* next, uint32_t blocks, uint32_t buffers)
+{
+    return ((next->transferDirection == last->transferDirection)
+            && ((last->blockAddress + last->blockCount) == next->blockAddress)
+            && ((blocks + next->blockCount) <= pSlot->CQSchedCfg.maxMergeBlocks)
+            && ((buffers + next->numberOfBuffers) <= SDIO_CFG_CQ_MERGE_MAX_BUFFERS)
+            && (next->queueBarrierEn == 0U)
+            && (next->forceProgEn == last->forceProgEn)
+            && (next->reliableWriteEn == last->reliableWriteEn)
+            && (next->tagRequestEn == last->tagRequestEn)
+            && (next->contextId == last->contextId));
+}
+
+/* function writes descriptors of task made of merged requests, transfer
+ * descriptors of all requests are written to the merge list of the task */
+static void PrepareMergedDescs(const CSDD_SDIO_Slot* pSlot, const CSDD_CQRequest* task,
+                               const CSDD_CQRequest* first)
+{
+    const uint32_t listOffset = (uint32_t)task->taskId * SDIO_CFG_CQ_MERGE_MAX_BUFFERS
+                                * (uint32_t)sizeof(CQ_TransDesc128);
+    const uintptr_t listPhyAddr = pSlot->CQMergeDescDmaAddr + listOffset;
+    const CSDD_CQRequest* request;
+    uint32_t count = 0U;
+
+    if (pSlot->CQDescSize == CSDD_CQ_TASK_DESC_SIZE_64BIT) {
+        CQ_Desc64 *descPtr = (CQ_Desc64*)pSlot->CQDescriptorBuffer;
+        CQ_TransDesc64 *list = (CQ_TransDesc64*)&pSlot->CQMergeDescBuffer[listOffset];
+
+        PrepareTaskDesc64(task, &descPtr[task->taskId].taskDesc);
+        for (request = first; request != NULL; request = request->pNextRequest) {
+            /* only the last descriptor of the whole list ends it */
+            if (count > 0U) {
+                list[count - 1U].flags &= (uint16_t)~CQ_DESC_END;
+            }
+            PrepareTransDesc64(&list[count], request->buffers, request->numberOfBuffers);
+            count += request->numberOfBuffers;
+        }
+        PrepareTransLinkDesc64(&descPtr[task->taskId].transDesc, listPhyAddr,
+                               (uint16_t)(count * sizeof(CQ_TransDesc64)));
+    } else {
+        CQ_Desc128 *descPtr = (CQ_Desc128*)pSlot->CQDescriptorBuffer;
+        CQ_TransDesc128 *list = (CQ_TransDesc128*)&pSlot->CQMergeDescBuffer[listOffset];
+
+        PrepareTaskDesc128(task, &descPtr[task->taskId].taskDesc);
+        for (request = first; request != NULL; request = request->pNextRequest) {
+            if (count > 0U) {
+                list[count - 1U].flags &= (uint16_t)~CQ_DESC_END;
+            }
+            PrepareTransDesc128(&list[count], request->buffers, request->numberOfBuffers);
+            count += request->numberOfBuffers;
+        }
+        PrepareTransLinkDesc128(&descPtr[task->taskId].transDesc, listPhyAddr,
+                                (uint16_t)(count * sizeof(CQ_TransDesc128)));
+    }
+}
+
+/* function attaches request taken from backlog queue by the scheduler to its task.
+ * Following requests of the queue which continue it are merged into the task.
+ * Latency class and requests which missed their deadline get high priority */
+static void CQSchedAttach(CSDD_SDIO_Slot* pSlot, CSDD_CQRequest* request, uint8_t queue, uint64_t now)
+{
+    /* descriptors are written from a copy, so request given by the user is not changed */
+    CSDD_CQRequest task = *request;
+    CSDD_CQRequest* last = request;
+    uint32_t blocks = request->blockCount;
+    uint32_t buffers = request->numberOfBuffers;
+
+    while ((pSlot->CQBacklogHead[queue] != NULL)
+           && CQSchedCanMerge(pSlot, last, pSlot->CQBacklogHead[queue], blocks, buffers)) {
+        last->pNextRequest = CQBacklogPop(pSlot, queue);
+        last = last->pNextRequest;
+        last->taskId = request->taskId;
+        blocks += last->blockCount;
+        buffers += last->numberOfBuffers;
+    }
+
+    if ((queue == (uint8_t)CSDD_CQ_IO_CLASS_LATENCY)
+        || ((request->deadlineNs != 0U) && (request->deadlineNs <= now))) {
+        task.highPriorityEn = 1U;
+    }
+
+    if (request->pNextRequest != NULL) {
+        task.blockCount = (uint16_t)blocks;
+        PrepareMergedDescs(pSlot, &task, request);
+    } else if (pSlot->CQDescSize == CSDD_CQ_TASK_DESC_SIZE_64BIT) {
+        PrepareDescs64(pSlot->CQDescriptorBuffer, &task);
+    } else {
+        PrepareDescs128(pSlot->CQDescriptorBuffer, &task);
+    }
+
+    pSlot->CQCurrentReq[request->taskId] = request;
+}
+
+/* function gives free tasks to requests waiting in the backlog
+ * and starts them with one doorbell write, only owner of the refill calls it */
+static void CQBacklogRefillPass(CSDD_SDIO_Slot* pSlot)
+{
+    const uint64_t now = (pSlot->CQSchedCfg.enable != 0U) ? CPS_GetTimeNs() : 0U;
+    uint32_t doorbell = 0U;
+    uint8_t queue;
+    uint8_t taskId;
+
+    CQBacklogCollect(pSlot);
+
+    queue = CQSchedSelectQueue(pSlot, now);
+    taskId = (queue != CQ_NO_QUEUE) ? CQ_ClaimTask(pSlot) : CQ_NO_TASK_ID;
+    while (taskId != CQ_NO_TASK_ID) {
+        CSDD_CQRequest* request = CQBacklogPop(pSlot, queue);
+
+        request->taskId = taskId;
+        if (pSlot->CQSchedCfg.enable != 0U) {
+            CQSchedAttach(pSlot, request, queue, now);
+        } else {
+            AttachToTask(pSlot, request);
+            request->cQReqStat = CSDD_CQ_REQ_STAT_PENDING;
+        }
+        doorbell |= CQRS10_SET_TASK_DORBELL(taskId);
+
+        queue = CQSchedSelectQueue(pSlot, now);
+        taskId = (queue != CQ_NO_QUEUE) ? CQ_ClaimTask(pSlot) : CQ_NO_TASK_ID;
+    }
+
+    if (doorbell != 0U) {
+        CPS_REG_WRITE(&pSlot->RegOffset->CQRS.CQRS10, doorbell);
+    }
+}
+
+/* function refills free tasks from the backlog. Only one caller at a time
+ * owns the refill, caller which finds it owned leaves its request to the owner.
+ * It never waits, so producers and the interrupt handler can call it */
+static void CQBacklogRefill(CSDD_SDIO_Slot* pSlot)
+{
+    pSlot->CQRefillRequested = 1U;
+    CPS_MemoryBarrier();
+
+    while ((pSlot->CQRefillRequested != 0U)
+           && CPS_AtomicCompareSwap32(&pSlot->CQRefillOwner, 0U, 1U)) {
+        pSlot->CQRefillRequested = 0U;
+        CPS_MemoryBarrier();
+
+        CQBacklogRefillPass(pSlot);
+
+        CPS_MemoryBarrier();
+        pSlot->CQRefillOwner = 0U;
+        /* request made during the pass is seen here or its caller takes the refill */
+        CPS_MemoryBarrier();
+    }
+}
+
+/* function claims a task for request submitted without the scheduler if no
+ * earlier request waits in the backlog. Requests pushed by producers are
+ * collected first under the refill ownership, so a task freed for them is
+ * not taken out of order. It returns CQ_NO_TASK_ID if the request has to
+ * go through the backlog */
+static uint8_t CQClaimTaskInOrder(CSDD_SDIO_Slot* pSlot)
+{
+    uint8_t taskId = CQ_NO_TASK_ID;
+
+    if (CPS_AtomicCompareSwap32(&pSlot->CQRefillOwner, 0U, 1U)) {
+        CQBacklogCollect(pSlot);
+        if (CQBacklogEmpty(pSlot) != 0U) {
+            taskId = CQ_ClaimTask(pSlot);
+        }
+
+        CPS_MemoryBarrier();
+        pSlot->CQRefillOwner = 0U;
+        CPS_MemoryBarrier();
+        /* refill left to this owner by other callers */
+        if (pSlot->CQRefillRequested != 0U) {
+            CQBacklogRefill(pSlot);
+        }
+    }
+
+    return (taskId);
+}
+
 uint8_t SDIOHost_CQ_AttachRequest(CSDD_SDIO_Slot* pSlot, CSDD_CQRequest *request)
 {
     uint8_t status;
@@ -1308,14 +1949,9 @@ uint8_t SDIOHost_CQ_AttachRequest(CSDD_SDIO_Slot* pSlot, CSDD_CQRequest *request
             vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", status);
         } else {
 
-            if (pSlot->CQDescSize == CSDD_CQ_TASK_DESC_SIZE_64BIT) {
-                PrepareDescs64(pSlot->CQDescriptorBuffer, request);
-            } else {
-                PrepareDescs128(pSlot->CQDescriptorBuffer, request);
-            }
-
-            request->cQReqStat = CSDD_CQ_REQ_STAT_ATTACHED;
-            pSlot->CQCurrentReq[request->taskId] = request;
+            request->pNextRequest = NULL;
+            CQ_AtomicSetBits(&pSlot->CQTaskBusy, 1UL << request->taskId);
+            AttachToTask(pSlot, request);
 
             status = SDIO_ERR_NO_ERROR;
         }
@@ -1362,7 +1998,6 @@ uint8_t SDIOHost_CQ_StartExecuteTask(CSDD_SDIO_Slot* pSlot, uint8_t taskId)
 uint8_t SDIOHost_CQ_GetUnusedTaskId(CSDD_SDIO_Slot* pSlot, uint8_t *taskId)
 {
     uint8_t status;
-    uint8_t i;
 
     if (pSlot->CQEnabled == 0U) {
         vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "Command queuing is not enabled.\n");
@@ -1372,23 +2007,17 @@ uint8_t SDIOHost_CQ_GetUnusedTaskId(CSDD_SDIO_Slot* pSlot, uint8_t *taskId)
         vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", EINVAL);
         status = EINVAL;
     } else {
+        /* task is unused if no request is attached and HW does not keep it pending */
+        const uint32_t freeTasks = ~pSlot->CQTaskBusy
+                                   & ~CPS_REG_READ(&pSlot->RegOffset->CQRS.CQRS13)
+                                   & CQ_TaskMask(pSlot);
 
-        for (i = 0; i < pSlot->pDevice->cQDepth; i++) {
-            if ((pSlot->CQCurrentReq[i] == NULL) && (IsHwTaskPending(pSlot, i) == 0U)) {
-                *taskId = i;
-                break;
-            }
-        }
-
-        if ((pSlot->CQDcmdEnabled != 0U) && (*taskId ==  CQ_DCMD_TASK_ID)) {
-            vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "There is no unused task.\n");
-            vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", EBUSY);
-            status = EBUSY;
-        } else if (i == pSlot->pDevice->cQDepth) {
+        if (freeTasks == 0U) {
             vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "There is no unused task.\n");
             vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", EBUSY);
             status = EBUSY;
         } else {
+            *taskId = CQ_FindFirstSet(freeTasks);
             status = SDIO_ERR_NO_ERROR;
         }
     }
@@ -1428,7 +2057,13 @@ uint8_t SDIOHost_CQ_Disable(CSDD_SDIO_Slot* pSlot)
 
         reg = CPS_REG_READ(&pSlot->RegOffset->CQRS.CQRS13);
 
-        for (i = 0; i <  CQ_HOST_NUMBER_OF_TASKS; i++) {
+        if ((CQBacklogEmpty(pSlot) == 0U) || (pSlot->CQDoorbellPending != 0U)) {
+            vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "Command queuing cannot be disabled until submitted requests are started\n");
+            vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", EBUSY);
+            status = EBUSY;
+        }
+
+        for (i = 0; (status == SDIO_ERR_NO_ERROR) && (i <  CQ_HOST_NUMBER_OF_TASKS); i++) {
             if (IsHwTaskPending(pSlot, i) != 0U) {
                 vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Command queuing cannot be disabled until all tasks are finished. Task %d is pending\n", i);
                 vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", EBUSY);
@@ -1488,6 +2123,11 @@ static void SDIOHost_ProcessCQEnable(CSDD_SDIO_Slot* pSlot)
 
     pSlot->CQEnabled = 1;
 
+    // command queuing is not polled, hybrid mode must give interrupts back
+    if (pSlot->pSdioHost->hybridPolling != 0U) {
+        SDIOHost_HybridPollSetPhase(pSlot->pSdioHost, 0);
+    }
+
     (void)SDIOHost_CQ_InterruptConfig(pSlot, pSlot->pSdioHost->intEn);
 }
 
@@ -1571,6 +2211,7 @@ uint8_t SDIOHost_CQ_SetDirectCmdConfig(CSDD_SDIO_Slot* pSlot, uint8_t enable)
             reg |= (uint32_t)CQRS02_DIRECT_CMD_ENABLE;
             /* it is unused when direct command is enabled */
             pSlot->CQCurrentReq[CQ_DCMD_TASK_ID] = NULL;
+            CQ_AtomicClearBits(&pSlot->CQTaskBusy, 1UL << CQ_DCMD_TASK_ID);
         }
         else {
             reg &= ~(uint32_t)CQRS02_DIRECT_CMD_ENABLE;
@@ -1684,6 +2325,8 @@ uint8_t SDIOHost_CQ_SetIntCoalescingCfg(CSDD_SDIO_Slot* pSlot, const CSDD_CQIntC
         vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", EINVAL);
         status = EINVAL;
     } else {
+        /* static configuration replaces adaptive mode */
+        pSlot->CQCoalAuto.enable = 0U;
         status = SDIOHost_ProcessCQSetIntCoalescingConfig(pSlot, config);
     }
 
@@ -1871,6 +2514,9 @@ uint8_t SDIOHost_CQ_TaskDiscard(CSDD_SDIO_Slot* pSlot, uint8_t taskId)
             SDIOHost_ProcessCQTaskDiscard(pSlot, taskId);
 
             (void)SDIOHost_CQ_Halt(pSlot, 0);
+
+            /* discarded task may be waited for by the backlog */
+            CQBacklogRefill(pSlot);
         }
     }
 
@@ -1969,3 +2615,234 @@ uint8_t SDIOHost_CQ_GetResponseErrMask(CSDD_SDIO_Slot* pSlot, uint32_t *errorMas
 
     return (status);
 }
+
+uint8_t SDIOHost_CQ_SetCompletionRing(CSDD_SDIO_Slot* pSlot, uint8_t enable)
+{
+    /* ring is emptied before producer can see it enabled */
+    pSlot->CQComplRingEn = 0U;
+    pSlot->CQComplHead = 0U;
+    pSlot->CQComplTail = 0U;
+    pSlot->CQComplOverflows = 0U;
+    CPS_MemoryBarrierWrite();
+    pSlot->CQComplRingEn = (enable != 0U) ? 1U : 0U;
+
+    return (SDIO_ERR_NO_ERROR);
+}
+
+uint8_t SDIOHost_CQ_GetCompletions(CSDD_SDIO_Slot* pSlot, CSDD_CQCompletion* entries,
+                                   uint8_t maxEntries, uint8_t* count)
+{
+    uint8_t status;
+    uint8_t i = 0U;
+
+    if (pSlot->CQComplRingEn == 0U) {
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "Completion ring is not enabled.\n");
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", EIO);
+        status = EIO;
+    } else {
+        uint32_t tail = pSlot->CQComplTail;
+        uint32_t head;
+
+        /* in polling mode finished tasks are collected here */
+        if (pSlot->pSdioHost->intEn == 0U) {
+            uint8_t handled;
+            SDIOHost_InterruptHandler(pSlot->pSdioHost, &handled);
+        }
+
+        head = pSlot->CQComplHead;
+        /* entries are read after they are seen published by head */
+        CPS_MemoryBarrierRead();
+
+        while ((tail != head) && (i < maxEntries)) {
+            entries[i] = pSlot->CQComplRing[tail % SDIO_CFG_CQ_COMPL_RING_SIZE];
+            tail++;
+            i++;
+        }
+        pSlot->CQComplTail = tail;
+
+        status = SDIO_ERR_NO_ERROR;
+    }
+
+    *count = i;
+
+    return (status);
+}
+
+uint8_t SDIOHost_CQ_Submit(CSDD_SDIO_Slot* pSlot, CSDD_CQRequest *request, uint8_t ringDoorbell)
+{
+    uint8_t status;
+
+    if (pSlot->CQEnabled == 0U) {
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "Command queuing is not enabled.\n");
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", EIO);
+        status = EIO;
+    } else if (pSlot->pDevice == NULL) {
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", EINVAL);
+        status = EINVAL;
+    } else if ((uint32_t)request->ioClass >= CSDD_CQ_IO_CLASS_COUNT) {
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Wrong I/O class %d\n", request->ioClass);
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", EINVAL);
+        status = EINVAL;
+    } else {
+        status = VerifyRequestData(pSlot, request);
+        if (status != SDIO_ERR_NO_ERROR) {
+            request->cQReqStat = CSDD_CQ_REQ_STAT_FAILED;
+            vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", status);
+        } else {
+            uint8_t taskId = CQ_NO_TASK_ID;
+
+            /* requests in the backlog get tasks first,
+             * with the scheduler all requests go through the backlog */
+            if (pSlot->CQSchedCfg.enable == 0U) {
+                taskId = CQClaimTaskInOrder(pSlot);
+            }
+
+            if (taskId != CQ_NO_TASK_ID) {
+                /* task is owned now, descriptors are written without any lock */
+                request->pNextRequest = NULL;
+                request->taskId = taskId;
+                CQDumpRequest(request, 0);
+                AttachToTask(pSlot, request);
+                request->cQReqStat = CSDD_CQ_REQ_STAT_PENDING;
+                CQ_AtomicSetBits(&pSlot->CQDoorbellPending, CQRS10_SET_TASK_DORBELL(taskId));
+            } else {
+                const uint32_t deadlineUs = (pSlot->CQSchedCfg.enable != 0U) ?
+                                            pSlot->CQSchedCfg.deadlineUs[request->ioClass] : 0U;
+                CSDD_CQRequest* first;
+
+                request->cQReqStat = CSDD_CQ_REQ_STAT_PENDING;
+                request->deadlineNs = (deadlineUs != 0U) ?
+                                      (CPS_GetTimeNs() + ((uint64_t)deadlineUs * 1000U)) : 0U;
+                do {
+                    first = pSlot->CQBacklogIn;
+                    request->pNextRequest = first;
+                } while (!CPS_AtomicCompareSwapPtr((void* volatile*)&pSlot->CQBacklogIn, first, request));
+
+                /* tasks may have been freed before the request was pushed. The scheduler
+                 * waits for the doorbell, so requests of one batch can be merged */
+                if ((pSlot->CQSchedCfg.enable == 0U) || (ringDoorbell != 0U)) {
+                    CQBacklogRefill(pSlot);
+                }
+            }
+
+            if (ringDoorbell != 0U) {
+                /* one doorbell write starts all tasks submitted since the last one,
+                 * also those of other producers which did not ring yet */
+                const uint32_t doorbell = CQ_AtomicTake(&pSlot->CQDoorbellPending);
+
+                if (doorbell != 0U) {
+                    CPS_REG_WRITE(&pSlot->RegOffset->CQRS.CQRS10, doorbell);
+                }
+            }
+        }
+    }
+
+    return (status);
+}
+
+/* function checks scheduler configuration. Merged task must fit in its
+ * transfer descriptor list and classes below latency need a deadline,
+ * otherwise they may never get a task under latency load. Settings
+ * which would be ignored by disabled scheduler are not accepted */
+static bool CQSchedConfigValid(const CSDD_CQSchedConfig *config)
+{
+    bool valid;
+
+    if (config->enable == 0U) {
+        valid = (config->maxMergeBlocks == 0U)
+                && (config->deadlineUs[CSDD_CQ_IO_CLASS_DEFAULT] == 0U)
+                && (config->deadlineUs[CSDD_CQ_IO_CLASS_LATENCY] == 0U)
+                && (config->deadlineUs[CSDD_CQ_IO_CLASS_BULK] == 0U);
+    } else {
+        valid = (config->enable == 1U)
+                && (config->maxMergeBlocks <= CQ_SCHED_MAX_MERGE_BLOCKS)
+                && (config->deadlineUs[CSDD_CQ_IO_CLASS_DEFAULT] != 0U)
+                && (config->deadlineUs[CSDD_CQ_IO_CLASS_BULK] != 0U);
+    }
+
+    return (valid);
+}
+
+uint8_t SDIOHost_CQ_SetSchedConfig(CSDD_SDIO_Slot* pSlot, const CSDD_CQSchedConfig *config)
+{
+    uint8_t status;
+
+    if (!CQSchedConfigValid(config)) {
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", EINVAL);
+        status = EINVAL;
+    } else if (CQBacklogEmpty(pSlot) == 0U) {
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "Scheduler cannot be changed while requests wait in the backlog\n");
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", EBUSY);
+        status = EBUSY;
+    } else {
+        pSlot->CQSchedCfg = *config;
+        status = SDIO_ERR_NO_ERROR;
+    }
+
+    return (status);
+}
+
+uint8_t SDIOHost_CQ_GetSchedConfig(CSDD_SDIO_Slot* pSlot, CSDD_CQSchedConfig *config)
+{
+    *config = pSlot->CQSchedCfg;
+
+    return (SDIO_ERR_NO_ERROR);
+}
+
+uint8_t SDIOHost_CQ_SetIntCoalescingAuto(CSDD_SDIO_Slot* pSlot, const CSDD_CQIntCoalescingAuto *config)
+{
+    uint8_t status;
+    uint32_t clockKHz = 0U;
+
+    if ((config->enable > 1U) || ((config->enable != 0U) && (config->maxIntRate == 0U))) {
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", EINVAL);
+        status = EINVAL;
+    } else {
+        /* it fails also if command queuing is not enabled */
+        status = SDIOHost_CQ_GetIntCoalescingTimeoutBase(pSlot, &clockKHz);
+    }
+
+    if (status == SDIO_ERR_NO_ERROR) {
+        const CSDD_CQIntCoalescingCfg disabled = {0U, 0U, 0U};
+        const CSDD_CQIntCoalescingStats noStats = {0U};
+
+        /* interrupt handler does not tune while the configuration is changed,
+         * adaptive mode starts with interrupt for each task */
+        pSlot->CQCoalAuto.enable = 0U;
+        (void)SDIOHost_ProcessCQSetIntCoalescingConfig(pSlot, &disabled);
+
+        pSlot->CQCoalStats = noStats;
+        CQCoalPublishStats(pSlot);
+        pSlot->CQCoalClockKHz = clockKHz;
+        pSlot->CQCoalWindowStart = CPS_GetTimeNs();
+        pSlot->CQCoalWindowInts = 0U;
+        pSlot->CQCoalWindowCompletions = 0U;
+        pSlot->CQCoalWindowDepth = 0U;
+        pSlot->CQCoalAuto = *config;
+    }
+
+    return (status);
+}
+
+uint8_t SDIOHost_CQ_GetIntCoalescingAuto(CSDD_SDIO_Slot* pSlot, CSDD_CQIntCoalescingAuto *config)
+{
+    *config = pSlot->CQCoalAuto;
+
+    return (SDIO_ERR_NO_ERROR);
+}
+
+uint8_t SDIOHost_CQ_GetIntCoalescingStats(CSDD_SDIO_Slot* pSlot, CSDD_CQIntCoalescingStats *stats)
+{
+    uint32_t seq;
+
+    /* counters are updated by the interrupt handler, the copy it published
+     * is read again if the handler wrote it in the meantime */
+    do {
+        seq = pSlot->CQCoalStatsSeq;
+        CPS_MemoryBarrierRead();
+        *stats = pSlot->CQCoalStatsCopy;
+        CPS_MemoryBarrierRead();
+    } while (((seq & 1U) != 0U) || (seq != pSlot->CQCoalStatsSeq));
+
+    return (SDIO_ERR_NO_ERROR);
+}
@@ -45,6 +45,16 @@
  * Maximum size of descriptor list is 1024. */
 #define CQ_DESC_LIST_SIZE_WITH_ALIGN_MARGIN 2048U
 
+/* size of transfer descriptor lists of tasks made of merged requests,
+ * 32 tasks of SDIO_CFG_CQ_MERGE_MAX_BUFFERS 128 bit descriptors.
+ * They are placed before the task descriptor list. */
+#define CQ_MERGE_DESC_LIST_SIZE (32U * SDIO_CFG_CQ_MERGE_MAX_BUFFERS * 16U)
+
+/* maximum number of 512 byte blocks of task made of merged requests,
+ * transfer descriptor list of SDIO_CFG_CQ_MERGE_MAX_BUFFERS descriptors
+ * of at most 64 KB each */
+#define CQ_SCHED_MAX_MERGE_BLOCKS (SDIO_CFG_CQ_MERGE_MAX_BUFFERS * 128U)
+
 /* Command Queuing Task Descriptor List Base Address aligment mask*/
 #define  CQ_TDLBA_ALIGN_MASK    ((1UL << 10) - 1U)
 
@@ -137,5 +147,14 @@ uint8_t SDIOHost_CQ_ResetIntCoalCounters(CSDD_SDIO_Slot* pSlot);
 
 uint8_t SDIOHost_CQ_SetResponseErrMask(CSDD_SDIO_Slot* pSlot, uint32_t errorMask);
 uint8_t SDIOHost_CQ_GetResponseErrMask(CSDD_SDIO_Slot* pSlot, uint32_t *errorMask);
+uint8_t SDIOHost_CQ_Submit(CSDD_SDIO_Slot* pSlot, CSDD_CQRequest *request, uint8_t ringDoorbell);
+uint8_t SDIOHost_CQ_SetSchedConfig(CSDD_SDIO_Slot* pSlot, const CSDD_CQSchedConfig *config);
+uint8_t SDIOHost_CQ_GetSchedConfig(CSDD_SDIO_Slot* pSlot, CSDD_CQSchedConfig *config);
+uint8_t SDIOHost_CQ_SetIntCoalescingAuto(CSDD_SDIO_Slot* pSlot, const CSDD_CQIntCoalescingAuto *config);
+uint8_t SDIOHost_CQ_GetIntCoalescingAuto(CSDD_SDIO_Slot* pSlot, CSDD_CQIntCoalescingAuto *config);
+uint8_t SDIOHost_CQ_GetIntCoalescingStats(CSDD_SDIO_Slot* pSlot, CSDD_CQIntCoalescingStats *stats);
+uint8_t SDIOHost_CQ_SetCompletionRing(CSDD_SDIO_Slot* pSlot, uint8_t enable);
+uint8_t SDIOHost_CQ_GetCompletions(CSDD_SDIO_Slot* pSlot, CSDD_CQCompletion* entries,
+                                   uint8_t maxEntries, uint8_t* count);
 
 #endif
@@ -106,12 +106,10 @@ static inline uint32_t ADMA2_DESCRIPTOR_LENGTH(const CSDD_SDIO_Slot* pSlot,const
 {
     // data length for 16-bit Data Length Mode
     uint32_t data_length = ((uint32_t)(val & ADMA2_DESCRIPTOR_16_MASK) << ADMA2_DESCRIPTOR_16_SHIFT);
-    uint32_t reg = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS15);
     if (pSlot->pSdioHost->hostCtrlVer >= SDIO_HOST_VER_WTH_CCP) {
-        // data length for 26-bit Data Length Mode
+        // data length for 26-bit Data Length Mode,
+        // selected in SRS15 by SDIOHost_SlotInitialize
         data_length = ((val << ADMA2_DESCRIPTOR_16_SHIFT) | ((val >> ADMA2_DESCRIPTOR_10_SHIFT) & ADMA2_DESCRIPTOR_10_MASK));
-        // selects ADMA2 Length Mode as 26-bit.
-        CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS15,(reg | SRS15_ADMA2LM_MASK));
     }
 
     return data_length;
@@ -122,23 +120,69 @@ static inline uint32_t ADMA2_DESCRIPTOR_LENGTH(const CSDD_SDIO_Slot* pSlot,const
 #define ADMA2_DESCRIPTOR_TYPE_TRAN  (0x2U << 4)
 #define ADMA3_DESCRIPTOR_TYPE_TRAN  (0x7U << 3)
 /// Go to the next descriptor list
-// ADMA2_DESCRIPTOR_TYPE_LINK  (0x3U << 4)
+#define ADMA2_DESCRIPTOR_TYPE_LINK  (0x3U << 4)
 /// the ADMA interrupt is generated
-/// when the ADMA1 engine finishes processing the descriptor.
-// ADMA2_DESCRIPTOR_INT        (0x1U << 2)
+/// when the ADMA2 engine finishes processing the descriptor.
+#define ADMA2_DESCRIPTOR_INT        (0x1U << 2)
 /// it signals termination of the transfer
 /// and generates Transfer Complete Interrupt
 /// when this transfer is completed
-// ADMA2_DESCRIPTOR_END        (0x1U << 1)
+#define ADMA2_DESCRIPTOR_END        (0x1U << 1)
 /// it indicates the valid descriptor on a list
 #define ADMA2_DESCRIPTOR_VAL        (0x1U << 0)
 // Attribute indicate command descriptor for SD mode
 #define ADMA3_SDCMDDESCRIPTOR_ACT   (0x1U << 3)
 
+/// number of 32-bit words in one page of the ADMA2 descriptor ring
+#define ADMA2_DESC_PAGE_WORDS       (SDIO_CFG_ADMA2_DESC_PAGE_SIZE / 4U)
+
+/// Offset in 32-bit words of the ADMA2 descriptor ring page from the beginning of descriptor buffer
+static inline uint32_t ADMA2_DESC_PAGE_OFFSET(const uint8_t Ring, const uint8_t Page)
+{
+    return ((((uint32_t)Ring * SDIO_CFG_ADMA2_DESC_PAGES) + Page) * ADMA2_DESC_PAGE_WORDS);
+}
+
 typedef struct {
     uint32_t numberOfDescriptors;
     uint32_t descSize;
 } SD_DescriptorsParams;
+//-----------------------------------------------------------------------------
+/// Maximum data length of one ADMA2 descriptor
+static inline uint32_t ADMA2MaxBufSize(const CSDD_SDIO_Slot* pSlot)
+{
+    // max data length 2^16 or 2^26
+    return ((pSlot->pSdioHost->hostCtrlVer >= SDIO_HOST_VER_WTH_CCP)
+            ? (uint32_t)ADMA2_26LM_MAX_BUFSIZE : (uint32_t)ADMA2_16LM_MAX_BUFSIZE);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Size of one ADMA2 descriptor in bytes
+static inline uint32_t ADMA2DescriptorSize(const CSDD_SDIO_Slot* pSlot)
+{
+    uint32_t descSize = ADMA2_SIZE_OF_DESCRIPTOR_32;
+
+    if (pSlot->SlotSettings.DMA64_En != 0U) {
+        if (pSlot->SlotSettings.HostVer4_En != 0U) {
+            descSize = ADMA2_SIZE_OF_DESCRIPTOR_64_HV4;
+        }
+        else {
+            descSize = ADMA2_SIZE_OF_DESCRIPTOR_64;
+        }
+    }
+
+    return (descSize);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Mask of address bits which must be 0 in buffers used by DMA
+static inline uint32_t DMA_AlignMask(const CSDD_SDIO_Slot* pSlot)
+{
+    return ((pSlot->SlotSettings.DMA64_En != 0U) ? 0x7U : 0x3U);
+}
+//-----------------------------------------------------------------------------
+
 //-----------------------------------------------------------------------------
 static uint8_t DMA_FreeDecsriptors(CSDD_Request* pRequest)
 {
@@ -194,17 +238,17 @@ static uint8_t ADMACalcDescParams(const CSDD_SDIO_Slot* pSlot, const uint8_t ADM
         }
     }
     else if (ADMAType == (uint8_t)CSDD_ADMA2_MODE || (ADMAType == (uint8_t)CSDD_ADMA3_MODE)) {
-        if (pSlot->SlotSettings.DMA64_En != 0U) {
-            if (pSlot->SlotSettings.HostVer4_En != 0U) {
-                descSize = ADMA2_SIZE_OF_DESCRIPTOR_64_HV4;
-            }
-            else {
-                descSize = ADMA2_SIZE_OF_DESCRIPTOR_64;
+        const uint32_t maxSize = ADMA2MaxBufSize(pSlot);
+        /// each sub buffer is described by one descriptor
+        for (i = 0; i < SubBuffersCount; i++) {
+            if ((pSubBuffers[i].size == 0U) || (pSubBuffers[i].size > maxSize)
+                || ((pSubBuffers[i].address & DMA_AlignMask(pSlot)) != 0U)) {
+                status = SDIO_ERR_INVALID_PARAMETER;
+                break;
             }
         }
-        else {
-            descSize =  ADMA2_SIZE_OF_DESCRIPTOR_32;
-        }
+
+        descSize = ADMA2DescriptorSize(pSlot);
     }
     else {
         status = SDIO_ERR_INVALID_PARAMETER;
@@ -242,36 +286,50 @@ static void ADMA1FillDescriptors(const CSDD_SubBuffer* pSubBuffers, const uint32
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
-static void ADMA2FillDescriptors(const CSDD_SDIO_Slot* pSlot, const CSDD_SubBuffer* pSubBuffers,
-                                 const uint32_t NumberOfDescriptors, const uint32_t DescSize, uint32_t* Descriptors){
-    uint32_t i;
+/// Writes one ADMA2 descriptor, returns number of written 32-bit words
+static uint32_t ADMA2WriteDescriptor(const CSDD_SDIO_Slot* pSlot, uint32_t* Descriptor,
+                                     uint32_t Attributes, uintptr_t Address)
+{
     uint32_t j = 0;
     const CSDD_SDIO_SlotSettings* pSlotSettings = &pSlot->SlotSettings;
-    // fill descriptors
-    for (i = 0; i < NumberOfDescriptors; i++) {
-        Descriptors[j] = CpuToLe32(
-            ADMA2_DESCRIPTOR_TYPE_TRAN
-            | ADMA2_DESCRIPTOR_LENGTH(pSlot, pSubBuffers[i].size)
-            | ADMA2_DESCRIPTOR_VAL);
-        j++;
 
-        Descriptors[j] = CpuToLe32(((uint32_t)pSubBuffers[i].address & 0xFFFFFFFFU));
-        j++;
+    Descriptor[j] = CpuToLe32(Attributes);
+    j++;
 
-        if (pSlotSettings->DMA64_En != 0U) {
-            if (sizeof(uintptr_t) > 4U) {
-                Descriptors[j] = CpuToLe32((uint32_t)((uint64_t)pSubBuffers[i].address >> 32));
-            }
-            else {
-                Descriptors[j] = 0;
-            }
+    Descriptor[j] = CpuToLe32(((uint32_t)Address & 0xFFFFFFFFU));
+    j++;
+
+    if (pSlotSettings->DMA64_En != 0U) {
+        if (sizeof(uintptr_t) > 4U) {
+            Descriptor[j] = CpuToLe32((uint32_t)((uint64_t)Address >> 32));
+        }
+        else {
+            Descriptor[j] = 0;
+        }
+        j++;
+        if (pSlotSettings->HostVer4_En != 0U) {
+            Descriptor[j] = 0;
             j++;
-            if (pSlotSettings->HostVer4_En != 0U) {
-                Descriptors[j] = 0;
-                j++;
-            }
         }
     }
+
+    return (j);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+static void ADMA2FillDescriptors(const CSDD_SDIO_Slot* pSlot, const CSDD_SubBuffer* pSubBuffers,
+                                 const uint32_t NumberOfDescriptors, const uint32_t DescSize, uint32_t* Descriptors){
+    uint32_t i;
+    uint32_t j = 0;
+    // fill descriptors
+    for (i = 0; i < NumberOfDescriptors; i++) {
+        j += ADMA2WriteDescriptor(pSlot, &Descriptors[j],
+                                  ADMA2_DESCRIPTOR_TYPE_TRAN
+                                  | ADMA2_DESCRIPTOR_LENGTH(pSlot, pSubBuffers[i].size)
+                                  | ADMA2_DESCRIPTOR_VAL,
+                                  pSubBuffers[i].address);
+    }
     // last descriptor finishes transmission
     const uint32_t offset = (NumberOfDescriptors * (DescSize / 4U)) - (DescSize / 4U);
     Descriptors[offset]
@@ -416,8 +474,7 @@ static uint8_t ADMACreateDescriptors(CSDD_SDIO_Slot* pSlot, CSDD_Request* pReque
 
             if (ADMAType == (uint8_t)CSDD_ADMA3_MODE) {
                 ADMA2FillDescriptors(pSlot, pSubBuffers, NumberOfDescriptors, DescSize, Descriptors);
-                uint32_t offset = (NumberOfDescriptors * (DescSize / 4U)) - (DescSize / 4U);
-                *next = offset + 2U;
+                *next = NumberOfDescriptors * (DescSize / 4U);
                 pRequest->IdDescriptorTable = pSlot->IntegratedDescriptorDMAAddr;
             }
 
@@ -539,235 +596,239 @@ static uint8_t SetDMAAddr(CSDD_SDIO_Slot* pSlot, const void *BufAddr, uint8_t Dm
 }
 //-----------------------------------------------------------------------------
 
-#if SDIO_ADMA1_SUPPORTED || SDIO_ADMA2_SUPPORTED || SDIO_ADMA3_SUPPORTED
-static CSDD_SubBuffer SubBuffers[SDIO_CFG_SDIO_SUB_BUFFERS_COUNT];
-#endif
+//-----------------------------------------------------------------------------
+void DMA_FlushAddrCache(CSDD_SDIO_Host* pSdioHost)
+{
+    uint32_t i;
 
-#if SDIO_ADMA2_SUPPORTED || SDIO_ADMA1_SUPPORTED || SDIO_SDMA_SUPPORTED
+    for (i = 0; i < SDIO_CFG_ADDR_CACHE_SIZE; i++) {
+        pSdioHost->addrCache[i].size = 0U;
+    }
+    pSdioHost->addrCacheNext = 0U;
+}
 //-----------------------------------------------------------------------------
 
-static uint8_t DMA_PrepareSubBuffers(CSDD_SDIO_Slot* pSlot, const CSDD_CommandField* pCmd, uint32_t* pNumBuffers)
+//-----------------------------------------------------------------------------
+/// Translates CPU address of data buffer to DMA address, using ranges
+/// cached by the host or virtToPhys callback. Contiguous is set to number
+/// of bytes (at most Size) physically contiguous from Address,
+/// 0 if Address cannot be translated.
+static uintptr_t DMA_TranslateAddr(CSDD_SDIO_Host* pSdioHost, uintptr_t Address,
+                                   uint32_t Size, uint32_t* Contiguous)
 {
-    // 32-bit block count * block len( Max 2048)
-    uint64_t DataSize = pCmd->blockCount * pCmd->blockLen;
-    // max data length 2^16 or 2^26
-    uint32_t SubBufSize = (uint32_t)ADMA2_16LM_MAX_BUFSIZE;
-    uint32_t i = 0;
-    uint8_t status = SDIO_ERR_NO_ERROR;
-    if (pSlot->pSdioHost->hostCtrlVer >= SDIO_HOST_VER_WTH_CCP) {
-        SubBufSize = (uint32_t)ADMA2_26LM_MAX_BUFSIZE;
-    }
-    if (DataSize >= SubBufSize) {
-        uint32_t CurrentSubsize = SubBufSize;
-        uint32_t Size = DataSize;
-        uintptr_t BufAddress = (uintptr_t)pCmd->pDataBuffer;
-        while (Size > 0U) {
-            if (i >= SDIO_CFG_SDIO_SUB_BUFFERS_COUNT) {
-                // There is not enough buffer count to create descriptors.
-                // You need to increase SDIO_CFG_SDIO_SUB_BUFFERS_COUNT parameter
-                status = SDIO_ERR_INVALID_PARAMETER;
+    uintptr_t PhyAddress = Address;
+    const CSDD_AddrXlateEntry* pEntry = NULL;
+    uint32_t i;
+
+    *Contiguous = Size;
+
+    if (pSdioHost->virtToPhys != NULL) {
+        for (i = 0; i < SDIO_CFG_ADDR_CACHE_SIZE; i++) {
+            const CSDD_AddrXlateEntry* pCached = &pSdioHost->addrCache[i];
+            if ((pCached->size != 0U) && (Address >= pCached->virtAddress)
+                && ((Address - pCached->virtAddress) < pCached->size)) {
+                pEntry = pCached;
                 break;
             }
+        }
 
-            if (Size < CurrentSubsize) {
-                CurrentSubsize = Size;
+        if (pEntry == NULL) {
+            uint32_t Length = 0U;
+            const uintptr_t Translated = pSdioHost->virtToPhys(pSdioHost, (void*)Address, Size, &Length);
+
+            if ((Length != 0U) && (Length <= Size)) {
+                CSDD_AddrXlateEntry* pNew = &pSdioHost->addrCache[pSdioHost->addrCacheNext];
+                pNew->virtAddress = Address;
+                pNew->phyAddress = Translated;
+                pNew->size = Length;
+                pSdioHost->addrCacheNext = (uint8_t)((pSdioHost->addrCacheNext + 1U) % SDIO_CFG_ADDR_CACHE_SIZE);
+                pEntry = pNew;
             }
-            SubBuffers[i].address = BufAddress;
-            SubBuffers[i].size = CurrentSubsize;
-
-            Size -= CurrentSubsize;
-            BufAddress += CurrentSubsize;
-            i++;
         }
-    }
-    else {
-        SubBuffers[0].size = DataSize;
-        SubBuffers[0].address = (uintptr_t)pCmd->pDataBuffer;
-        i = 1;
-    }
 
-    if (status == SDIO_ERR_NO_ERROR) {
-        *pNumBuffers = i;
+        if (pEntry == NULL) {
+            vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", SDIO_ERR_INVALID_PARAMETER);
+            PhyAddress = 0U;
+            *Contiguous = 0U;
+        } else {
+            const uintptr_t Offset = Address - pEntry->virtAddress;
+            const uint32_t Left = pEntry->size - (uint32_t)Offset;
+
+            PhyAddress = pEntry->phyAddress + Offset;
+            if (Left < Size) {
+                *Contiguous = Left;
+            }
+        }
     }
 
-    return (status);
+    return (PhyAddress);
 }
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
-static uint8_t DMA_PrepareTransferSDMA(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest, uint8_t DMAMode)
+/// Gets DMA address of data buffer at CPU Address. Data in a bounce
+/// buffer of the host pool is contiguous at its known DMA address, other
+/// buffers are translated as in DMA_TranslateAddr.
+static uintptr_t DMA_DataAddr(const CSDD_SDIO_Slot* pSlot, uint8_t Bounced, uintptr_t Address,
+                              uint32_t Size, uint32_t* Contiguous)
 {
-    uint8_t status;
+    uintptr_t PhyAddress;
 
-    if (pRequest->pCmd->subBuffersCount != 0U) {
-        status = SDIO_ERR_INVALID_PARAMETER;
+    if (Bounced != 0U) {
+        const CSDD_SDIO_Host* pSdioHost = pSlot->pSdioHost;
+        PhyAddress = (uintptr_t)pSdioHost->BounceDMAAddr + (Address - (uintptr_t)pSdioHost->BounceBuffer);
+        *Contiguous = Size;
     } else {
-        // SDMA mode selected
-        status = SetDMAAddr(pSlot, pRequest->pCmd->pDataBuffer, DMAMode);
-
-        uint32_t Tmp = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS10);
-        Tmp = (Tmp & (~SRS10_DMA_SELECT_MASK));
-        CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS10, Tmp | SRS10_DMA_SELECT_SDMA);
+        PhyAddress = DMA_TranslateAddr(pSlot->pSdioHost, Address, Size, Contiguous);
     }
 
-    return (status);
+    return (PhyAddress);
 }
 //-----------------------------------------------------------------------------
 
+#if SDIO_ADMA2_SUPPORTED || SDIO_ADMA1_SUPPORTED || SDIO_SDMA_SUPPORTED
 //-----------------------------------------------------------------------------
-#if SDIO_ADMA1_SUPPORTED || SDIO_ADMA2_SUPPORTED || SDIO_ADMA3_SUPPORTED
-static uint8_t DMA_PrepareTransferADMA(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest,
-                                       CSDD_CommandField* pCmd,
-                                       uint8_t DMAMode,uint32_t *Descriptors,
-                                       uint32_t *offset, uint32_t * ADMADescSize)
-{
-    uint8_t status;
-    uint32_t Buffers = 0U;
 
-    // if user prepared sub-buffers then create descriptors
-    if (pCmd->subBuffersCount != 0U) {
-        status = ADMACreateDescriptors(pSlot, pRequest, DMAMode, pCmd->pDataBuffer,
-                                       pCmd->subBuffersCount, Descriptors, offset, ADMADescSize);
-    }
-    else {
-        status = DMA_PrepareSubBuffers(pSlot, pCmd, &Buffers);
-    }
+static uint8_t DMA_PrepareSubBuffers(CSDD_SDIO_Slot* pSlot, const CSDD_Request* pRequest,
+                                     const CSDD_CommandField* pCmd, uint32_t* pNumBuffers)
+{
+    // 32-bit block count * block len( Max 2048)
+    uint64_t DataSize = pCmd->blockCount * pCmd->blockLen;
+    const uint32_t SubBufSize = ADMA2MaxBufSize(pSlot);
+    uint32_t i = 0;
+    uint8_t status = SDIO_ERR_NO_ERROR;
+    uint32_t Size = DataSize;
+    uintptr_t BufAddress = (uintptr_t)pCmd->pDataBuffer;
 
-    if (Buffers > 0) {
-        status = ADMACreateDescriptors(pSlot, pRequest, DMAMode,
-                                       &SubBuffers[0], Buffers, Descriptors, offset, ADMADescSize);
+    if (DataSize == 0U) {
+        status = SDIO_ERR_INVALID_PARAMETER;
     }
+    // buffer is split on max descriptor length and on physical discontinuity
+    while ((status == SDIO_ERR_NO_ERROR) && (Size > 0U)) {
+        uint32_t CurrentSubsize = SubBufSize;
+        uintptr_t PhyAddress;
 
-    if (status == SDIO_ERR_NO_ERROR) {
-        CPS_CacheFlush((void*)pRequest->admaDescriptorTable, MAX_DESCR_BUFF_SIZE, 0);
-
-        // set address to DMA engine
-        if (DMAMode != CSDD_ADMA3_MODE) {
-            status = SetDMAAddr(pSlot, pRequest->admaDescriptorTable, DMAMode);
+        if (i >= SDIO_CFG_SDIO_SUB_BUFFERS_COUNT) {
+            // There is not enough buffer count to create descriptors.
+            // You need to increase SDIO_CFG_SDIO_SUB_BUFFERS_COUNT parameter
+            status = SDIO_ERR_INVALID_PARAMETER;
+            break;
         }
-        if (status == SDIO_ERR_NO_ERROR) {
-            uint32_t Tmp = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS10);
-            Tmp = (Tmp & (~SRS10_DMA_SELECT_MASK));
-            if (DMAMode == (uint8_t)CSDD_ADMA1_MODE) {
-                // ADMA1 mode selected
-                CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS10,
-                              Tmp | SRS10_DMA_SELECT_ADMA1);
-            } else {
-                // ADMA2 mode (ADMA3 is not supported or disabled) selected
-                uint32_t dmaselect = SRS10_DMA_SELECT_ADMA2;
-#if SDIO_ADMA3_SUPPORTED
-                dmaselect = SRS10_DMA_SELECT_MASK;
-#endif
-                CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS10,
-                              Tmp | dmaselect);
 
-            }
+        if (Size < CurrentSubsize) {
+            CurrentSubsize = Size;
+        }
+        PhyAddress = DMA_DataAddr(pSlot, (pRequest->bounceUserBuffer != NULL) ? 1U : 0U,
+                                  BufAddress, CurrentSubsize, &CurrentSubsize);
+        if (CurrentSubsize == 0U) {
+            status = SDIO_ERR_INVALID_PARAMETER;
+            break;
         }
+        pSlot->SubBuffers[i].address = PhyAddress;
+        pSlot->SubBuffers[i].size = CurrentSubsize;
+
+        Size -= CurrentSubsize;
+        BufAddress += CurrentSubsize;
+        i++;
+    }
+
+    if (status == SDIO_ERR_NO_ERROR) {
+        *pNumBuffers = i;
     }
 
     return (status);
 }
-static uint8_t ADMA3CalcIDDescsize(const CSDD_SDIO_Slot* pSlot)
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Selects DMA type in SRS10, skipped when the same type is already selected
+static void DMA_Select(CSDD_SDIO_Slot* pSlot, uint32_t DmaSelect)
 {
-    uint32_t idDescSize;
-    if (pSlot->SlotSettings.DMA64_En != 0U) {
-        idDescSize = ADMA2_SIZE_OF_DESCRIPTOR_64_HV4;
-    } else {
-        idDescSize =  ADMA2_SIZE_OF_DESCRIPTOR_32;
+    if (pSlot->DmaSelect != DmaSelect) {
+        uint32_t Tmp = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS10);
+        Tmp = (Tmp & (~SRS10_DMA_SELECT_MASK));
+        CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS10, Tmp | DmaSelect);
+        pSlot->DmaSelect = DmaSelect;
     }
-    return idDescSize;
 }
-uint8_t DMA_PrepareTransferADMA3(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest, uint8_t DMAMode, uint8_t count) {
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Translates SDMA data buffer. SDMA can jump to other DMA address only
+/// where it stops, at the buffer boundary, so Boundary is lowered (unless
+/// it is Fixed) until each physical discontinuity of the buffer is at
+/// a boundary. Fails if no boundary fits or the buffer cannot be translated.
+static uint8_t DMA_SDMAFitBoundary(CSDD_SDIO_Host* pSdioHost, uintptr_t Address, uint32_t Size,
+                                   bool Fixed, uint32_t* pBoundary, uintptr_t* pDmaAddress)
+{
     uint8_t status = SDIO_ERR_NO_ERROR;
-    uint32_t *IntegratedDescriptors = pSlot->IntegratedDescriptorBuffer;
-    uint32_t *CDDescriptors = pSlot->DescriptorBuffer;
-    uint32_t ADMADescSize = (ADMA2_SIZE_OF_DESCRIPTOR_32 * 4U * count);
-    uint32_t *CDDescriptorsAddr;
-    uint32_t endvalue = 0;
-    uint32_t i = 0, j = 0;
-    const uint32_t RealIdDescSize = count * ADMA3CalcIDDescsize(pSlot);
-    if (RealIdDescSize > MAX_INTEGREATED_DESCR_BUFF_SIZE) {
-        status = SDIO_ERR_TO_FEW_MEM;
-    } else if (count > CSDD_MAX_NUMBER_COMMAND) {
-        status = SDIO_ERR_OUT_OF_RANGE;
-    } else {
-        for (i = 0; i < count; i++) {
-            CDDescriptorsAddr = CDDescriptors;
-            // create integrated descriptor
-            status =  ADMACreateIntegratedDescriptors(pSlot, pRequest, &pRequest->pCmd[i], DMAMode, &CDDescriptors, &ADMADescSize );
-            if (status != SDIO_ERR_NO_ERROR) {
-                break;
+    uint32_t Boundary = *pBoundary;
+    uint32_t SizeLeft = Size;
+    uintptr_t CpuAddress = Address;
+    uint32_t Contiguous;
+    uintptr_t RunEnd;
+    uintptr_t PhyAddress = DMA_TranslateAddr(pSdioHost, CpuAddress, SizeLeft, &Contiguous);
+
+    *pDmaAddress = PhyAddress;
+
+    while ((status == SDIO_ERR_NO_ERROR) && (Contiguous != 0U) && (Contiguous < SizeLeft)) {
+        RunEnd = PhyAddress + Contiguous;
+        CpuAddress += Contiguous;
+        SizeLeft -= Contiguous;
+        PhyAddress = DMA_TranslateAddr(pSdioHost, CpuAddress, SizeLeft, &Contiguous);
+
+        if (PhyAddress != RunEnd) {
+            while (!Fixed && (Boundary > SRS1_DMA_BUFF_MIN_BYTES) && ((RunEnd % Boundary) != 0U)) {
+                Boundary >>= 1;
             }
-            if (i == (count - 1U)) {
-                endvalue = ADMA1_DESCRIPTOR_END;
-            }
-
-            IntegratedDescriptors[j] = CpuToLe32(
-                ADMA3_DESCRIPTOR_TYPE_TRAN
-                | ADMA2_DESCRIPTOR_VAL
-                | endvalue);
-            j++;
-            IntegratedDescriptors[j] = CpuToLe32(((uint32_t)(uintptr_t)CDDescriptorsAddr & 0xFFFFFFFFU));
-            j++;
-
-            if (pSlot->SlotSettings.DMA64_En != 0U) {
-                if (sizeof(uintptr_t) > 4U) {
-                    IntegratedDescriptors[j] = CpuToLe32((uint32_t)((uint64_t)(uintptr_t)CDDescriptorsAddr >> 32));
-                }
-                else {
-                    IntegratedDescriptors[j] = 0;
-                }
-                j++;
-                IntegratedDescriptors[j] = 0;
-                j++;
+            if ((RunEnd % Boundary) != 0U) {
+                // SDMA cannot transfer buffer which is discontinuous between boundaries
+                status = SDIO_ERR_INVALID_PARAMETER;
             }
-            CPS_CacheFlush((void*)pRequest->IdDescriptorTable, MAX_DESCR_BUFF_SIZE, 0);
-        }
-        // set DMA descriptor address
-        if (status == SDIO_ERR_NO_ERROR ) {
-            status = SetDMAAddr(pSlot, pRequest->IdDescriptorTable, DMAMode);
         }
+    }
 
+    if (Contiguous == 0U) {
+        status = SDIO_ERR_INVALID_PARAMETER;
     }
 
+    *pBoundary = Boundary;
+
     return (status);
 }
-#endif
-//-----------------------------------------------------------------------------
-
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
-uint8_t DMA_PrepareTransfer(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest)
+/// Gets DMA address of SDMA transfer data and SRS01 value of its buffer boundary
+static uint8_t DMA_GetSDMAAddr(CSDD_SDIO_Slot* pSlot, const CSDD_Request* pRequest, uintptr_t* pAddress,
+                               uint32_t* pBoundary)
 {
     uint8_t status = SDIO_ERR_NO_ERROR;
-    uint8_t DMAMode = DMA_SpecifyTransmissionMode(pSlot, pRequest);
-    uint32_t offset = 0U;
-    uint32_t descSize = 0U;
 
-    switch (DMAMode) {
-    case (uint8_t)CSDD_SDMA_MODE:
-        status = DMA_PrepareTransferSDMA(pSlot, pRequest, DMAMode);
-        break;
-    case (uint8_t)CSDD_ADMA1_MODE:
-    case (uint8_t)CSDD_ADMA2_MODE:
-#if SDIO_ADMA1_SUPPORTED || SDIO_ADMA2_SUPPORTED
-        status = DMA_PrepareTransferADMA(pSlot, pRequest, pRequest->pCmd, DMAMode, pSlot->DescriptorBuffer, &offset, &descSize);
-        break;
-#endif
-#if SDIO_ADMA3_SUPPORTED
-    case (uint8_t)CSDD_ADMA3_MODE:
-        status = DMA_PrepareTransferADMA3(pSlot, pRequest,DMAMode, pRequest->cmdCount);
-#endif
-        break;
-    default:
+    if (pRequest->pCmd->subBuffersCount != 0U) {
         status = SDIO_ERR_INVALID_PARAMETER;
-        break;
-    }
+    } else {
+        const uint32_t DataSize = pRequest->pCmd->blockCount * pRequest->pCmd->blockLen;
+        uintptr_t Address;
+        uint32_t Boundary = (pSlot->SdmaBoundary != 0U) ? pSlot->SdmaBoundary : SRS1_DMA_BUFF_MAX_BYTES;
+        uint32_t BoundaryReg = 0U;
+
+        if (pRequest->bounceUserBuffer != NULL) {
+            // bounce buffer is contiguous, any boundary fits
+            Address = (uintptr_t)pSlot->pSdioHost->BounceDMAAddr
+                      + ((uintptr_t)pRequest->pCmd->pDataBuffer - (uintptr_t)pSlot->pSdioHost->BounceBuffer);
+        } else {
+            status = DMA_SDMAFitBoundary(pSlot->pSdioHost, (uintptr_t)pRequest->pCmd->pDataBuffer, DataSize,
+                                         (pSlot->SdmaBoundary != 0U), &Boundary, &Address);
+        }
 
-    if (status == SDIO_ERR_NO_ERROR) {
-        uint32_t DataSize = pRequest->pCmd->blockCount * pRequest->pCmd->blockLen;
-        CPS_CacheFlush((void*)pRequest->pCmd->pDataBuffer, DataSize, 0);
+        if (status == SDIO_ERR_NO_ERROR) {
+            while ((SRS1_DMA_BUFF_MIN_BYTES << BoundaryReg) < Boundary) {
+                BoundaryReg++;
+            }
+            *pAddress = Address;
+            *pBoundary = BoundaryReg << SRS1_DMA_BUFF_SIZE_SHIFT;
+        }
     }
 
     return (status);
@@ -775,24 +836,578 @@ uint8_t DMA_PrepareTransfer(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest)
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
-inline static bool DMA_NeedDescriptorsFreed(const uint32_t Status, const uint8_t DMAMode)
+/// Sets buffer boundary and DMA address of SDMA transfer
+static uint8_t DMA_StartSDMA(CSDD_SDIO_Slot* pSlot, const CSDD_Request* pRequest, uintptr_t Address,
+                             uint32_t Boundary, uint8_t DMAMode)
 {
-    return ((((Status & SRS12_TRANSFER_COMPLETE) != 0U)
-             || ((Status & SRS12_ERROR_INTERRUPT) != 0U)
-             || ((Status & SRS12_CARD_REMOVAL) != 0U)
-             || ((Status & SRS12_CARD_INSERTION) != 0U))
-            && ((DMAMode == (uint8_t)CSDD_ADMA1_MODE) || (DMAMode == (uint8_t)CSDD_ADMA2_MODE)));
+    // SRS01 with the boundary is written after DMA is prepared
+    pSlot->DMABufferBoundary = Boundary;
+    pSlot->SdmaCpuAddr = (uintptr_t)pRequest->pCmd->pDataBuffer;
+    pSlot->SdmaDmaAddr = Address;
+
+    return (SetDMAAddr(pSlot, (void*)Address, DMAMode));
 }
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
-uint8_t DMA_HandleInterrupt(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest, uint32_t Status)
+/// Gets DMA address from which SDMA stopped at the buffer boundary continues,
+/// it differs from StopAddress if data buffer is physically discontinuous there
+static uintptr_t DMA_SDMANextAddr(CSDD_SDIO_Slot* pSlot, const CSDD_Request* pRequest, uintptr_t StopAddress)
 {
-    uint8_t retStatus = SDIO_ERR_NO_ERROR;
-    uint8_t DMAMode = DMA_SpecifyTransmissionMode(pSlot, pRequest);
+    const uint32_t DataSize = pRequest->pCmd->blockCount * pRequest->pCmd->blockLen;
+    const uintptr_t CpuAddress = pSlot->SdmaCpuAddr + (StopAddress - pSlot->SdmaDmaAddr);
+    const uint32_t Done = (uint32_t)(CpuAddress - (uintptr_t)pRequest->pCmd->pDataBuffer);
+    uintptr_t Address = StopAddress;
+    uint32_t Contiguous;
+
+    // bounce buffer is contiguous, DMA continues from where it stopped
+    if ((pRequest->bounceUserBuffer == NULL) && (Done < DataSize)) {
+        Address = DMA_TranslateAddr(pSlot->pSdioHost, CpuAddress, DataSize - Done, &Contiguous);
+        pSlot->SdmaCpuAddr = CpuAddress;
+        pSlot->SdmaDmaAddr = Address;
+    }
 
-    if (pRequest->pCmd->requestFlags.dataPresent != 0U) {
-        if (((Status & SRS12_DMA_INTERRUPT) != 0U)
+    return (Address);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+static uint8_t DMA_PrepareTransferSDMA(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest, uint8_t DMAMode)
+{
+    uintptr_t Address = 0U;
+    uint32_t Boundary = 0U;
+    uint8_t status = DMA_GetSDMAAddr(pSlot, pRequest, &Address, &Boundary);
+
+    if (status == SDIO_ERR_NO_ERROR) {
+        // SDMA mode selected
+        status = DMA_StartSDMA(pSlot, pRequest, Address, Boundary, DMAMode);
+
+        DMA_Select(pSlot, SRS10_DMA_SELECT_SDMA);
+    }
+
+    return (status);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+#if SDIO_ADMA1_SUPPORTED || SDIO_ADMA2_SUPPORTED || SDIO_ADMA3_SUPPORTED
+/// Writes back Size bytes of descriptors written by the driver,
+/// skipped if descriptor buffers are in coherent memory
+static void DMA_FlushDescriptors(const CSDD_SDIO_Slot* pSlot, uint32_t* Descriptors, uint32_t Size)
+{
+    const CSDD_SDIO_Host* pSdioHost = pSlot->pSdioHost;
+
+    if ((pSdioHost->descCoherent == 0U) && (pSdioHost->ioCoherent == 0U) && (Size > 0U)) {
+        CPS_CacheFlush((void*)Descriptors, Size, 0);
+    }
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Gets DMA address and size of the next data segment of the ADMA2 chain.
+/// Contiguous data buffer is split on max descriptor length
+/// and on physical discontinuity.
+static uint8_t ADMA2ChainNextSegment(CSDD_SDIO_Slot* pSlot, CSDD_Adma2Chain* pChain,
+                                     uintptr_t* Address, uint32_t* Size)
+{
+    uint8_t status = SDIO_ERR_NO_ERROR;
+
+    if (pChain->pSubBuffers != NULL) {
+        *Address = pChain->pSubBuffers->address;
+        *Size = pChain->pSubBuffers->size;
+        pChain->pSubBuffers++;
+        pChain->subBuffersLeft--;
+    } else {
+        uint32_t Length = ADMA2MaxBufSize(pSlot);
+
+        if (pChain->bytesLeft < Length) {
+            Length = pChain->bytesLeft;
+        }
+        *Address = DMA_DataAddr(pSlot, pChain->bounced, pChain->nextAddress, Length, &Length);
+        if (Length == 0U) {
+            status = SDIO_ERR_INVALID_PARAMETER;
+        } else {
+            *Size = Length;
+            pChain->nextAddress += Length;
+            pChain->bytesLeft -= Length;
+        }
+    }
+
+    return (status);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Makes the first descriptor of the ring page not valid, DMA which reaches
+/// this page before it is filled stops with ADMA error
+static void ADMA2ChainInvalidatePage(const CSDD_SDIO_Slot* pSlot, uint8_t Ring, uint8_t Page)
+{
+    uint32_t* Descriptors = &pSlot->DescriptorBuffer[ADMA2_DESC_PAGE_OFFSET(Ring, Page)];
+
+    Descriptors[0] = 0U;
+    DMA_FlushDescriptors(pSlot, Descriptors, 4U);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Fills the next page of the ADMA2 descriptor ring. The page ends with
+/// a link descriptor to the following page or with the last descriptor
+/// of the transfer. The last data descriptor of a linked page generates
+/// DMA interrupt, on which the page is refilled.
+static uint8_t ADMA2ChainFillPage(CSDD_SDIO_Slot* pSlot, uint8_t Ring)
+{
+    CSDD_Adma2Chain* pChain = &pSlot->Adma2Chain[Ring];
+    const uint32_t DescWords = ADMA2DescriptorSize(pSlot) / 4U;
+    const uint32_t PageDescriptors = SDIO_CFG_ADMA2_DESC_PAGE_SIZE / (DescWords * 4U);
+    const uint8_t NextPage = (uint8_t)((pChain->fillPage + 1U) % SDIO_CFG_ADMA2_DESC_PAGES);
+    uint32_t* Descriptors = &pSlot->DescriptorBuffer[ADMA2_DESC_PAGE_OFFSET(Ring, pChain->fillPage)];
+    uint32_t Words = 0U;
+    uint32_t i;
+    uint8_t status = SDIO_ERR_NO_ERROR;
+
+    // last descriptor of the page is left for the link
+    for (i = 0; (i < (PageDescriptors - 1U)) && (pChain->complete == 0U); i++) {
+        uintptr_t Address = 0U;
+        uint32_t Size = 0U;
+
+        status = ADMA2ChainNextSegment(pSlot, pChain, &Address, &Size);
+        if (status != SDIO_ERR_NO_ERROR) {
+            break;
+        }
+        Words += ADMA2WriteDescriptor(pSlot, &Descriptors[Words],
+                                      ADMA2_DESCRIPTOR_TYPE_TRAN
+                                      | ADMA2_DESCRIPTOR_LENGTH(pSlot, Size)
+                                      | ADMA2_DESCRIPTOR_VAL,
+                                      Address);
+        if ((pChain->bytesLeft == 0U) && (pChain->subBuffersLeft == 0U)) {
+            pChain->complete = 1U;
+        }
+    }
+
+    if (status == SDIO_ERR_NO_ERROR) {
+        if (pChain->complete != 0U) {
+            // last descriptor finishes transmission
+            Descriptors[Words - DescWords] |= CpuToLe32(ADMA2_DESCRIPTOR_END);
+        } else {
+            Descriptors[Words - DescWords] |= CpuToLe32(ADMA2_DESCRIPTOR_INT);
+            Words += ADMA2WriteDescriptor(pSlot, &Descriptors[Words],
+                                          ADMA2_DESCRIPTOR_TYPE_LINK | ADMA2_DESCRIPTOR_VAL,
+                                          (uintptr_t)&pSlot->DescriptorDMAAddr[ADMA2_DESC_PAGE_OFFSET(Ring, NextPage)]);
+        }
+#ifdef DEBUG
+        ADMADumpDescriptors(Descriptors, Words * 4U);
+#endif
+        DMA_FlushDescriptors(pSlot, Descriptors, Words * 4U);
+        pChain->fillPage = NextPage;
+    } else {
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", status);
+    }
+
+    return (status);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Describes data of ADMA2 transfer in the descriptor ring. All pages but
+/// one are filled, the remaining page stays not valid until DMA finishes
+/// the first page.
+static uint8_t ADMA2ChainStart(CSDD_SDIO_Slot* pSlot, uint8_t Ring, CSDD_Request* pRequest,
+                               const CSDD_CommandField* pCmd)
+{
+    CSDD_Adma2Chain* pChain = &pSlot->Adma2Chain[Ring];
+    SD_DescriptorsParams descriptorsParams;
+    uint8_t status;
+    uint32_t i;
+
+    pChain->active = 0U;
+    pChain->complete = 0U;
+    pChain->dmaPage = 0U;
+    pChain->fillPage = 0U;
+    pChain->bounced = (pRequest->bounceUserBuffer != NULL) ? 1U : 0U;
+    if (pCmd->subBuffersCount != 0U) {
+        pChain->pSubBuffers = pCmd->pDataBuffer;
+        pChain->subBuffersLeft = pCmd->subBuffersCount;
+        pChain->nextAddress = 0U;
+        pChain->bytesLeft = 0U;
+    } else {
+        pChain->pSubBuffers = NULL;
+        pChain->subBuffersLeft = 0U;
+        pChain->nextAddress = (uintptr_t)pCmd->pDataBuffer;
+        pChain->bytesLeft = pCmd->blockCount * pCmd->blockLen;
+    }
+
+    // user sub-buffers are checked all before the transfer starts
+    status = ADMACalcDescParams(pSlot, (uint8_t)CSDD_ADMA2_MODE, pChain->pSubBuffers,
+                                pChain->subBuffersLeft, &descriptorsParams);
+    if ((pChain->bytesLeft == 0U) && (pChain->subBuffersLeft == 0U)) {
+        status = SDIO_ERR_INVALID_PARAMETER;
+    }
+
+    for (i = 0; (i < (SDIO_CFG_ADMA2_DESC_PAGES - 1U)) && (status == SDIO_ERR_NO_ERROR); i++) {
+        if (pChain->complete != 0U) {
+            break;
+        }
+        status = ADMA2ChainFillPage(pSlot, Ring);
+    }
+
+    if (status == SDIO_ERR_NO_ERROR) {
+        if (pChain->complete == 0U) {
+            ADMA2ChainInvalidatePage(pSlot, Ring, pChain->fillPage);
+        }
+        pChain->active = 1U;
+        pRequest->admaDescriptorTable = &pSlot->DescriptorDMAAddr[ADMA2_DESC_PAGE_OFFSET(Ring, 0U)];
+    }
+
+    return (status);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Gets the ring page which DMA processes from the ADMA system address.
+/// DMA which reached the link descriptor of a page is counted on the next
+/// page, the link stays valid until the page is filled again.
+/// Returns false if the address is not in the ring.
+static bool ADMA2ChainDmaPage(CSDD_SDIO_Slot* pSlot, uint8_t Ring, uint8_t* Page)
+{
+    const uintptr_t RingAddr = (uintptr_t)&pSlot->DescriptorDMAAddr[ADMA2_DESC_PAGE_OFFSET(Ring, 0U)];
+    const uintptr_t RingSize = (uintptr_t)SDIO_CFG_ADMA2_DESC_PAGES * SDIO_CFG_ADMA2_DESC_PAGE_SIZE;
+    void* DmaAddr = NULL;
+    uintptr_t Offset;
+    bool InRing = false;
+
+    (void)GetDMAAddr(pSlot, &DmaAddr, (uint8_t)CSDD_ADMA2_MODE);
+    // addresses below the ring wrap around to big offsets
+    Offset = (uintptr_t)DmaAddr - RingAddr;
+    if (Offset < RingSize) {
+        Offset += ADMA2DescriptorSize(pSlot);
+        *Page = (uint8_t)((Offset / SDIO_CFG_ADMA2_DESC_PAGE_SIZE) % SDIO_CFG_ADMA2_DESC_PAGES);
+        InRing = true;
+    }
+
+    return (InRing);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Refills all ring pages which DMA has passed. Each finished page becomes
+/// the not valid one and the page which was not valid is filled with next
+/// descriptors. Pages are found from the ADMA system address, not counted
+/// from DMA interrupts, so page ends which share one interrupt are not lost.
+static uint8_t ADMA2ChainRefill(CSDD_SDIO_Slot* pSlot, uint8_t Ring)
+{
+    CSDD_Adma2Chain* pChain = &pSlot->Adma2Chain[Ring];
+    uint8_t status = SDIO_ERR_NO_ERROR;
+    uint8_t DmaPage = pChain->dmaPage;
+
+    if (ADMA2ChainDmaPage(pSlot, Ring, &DmaPage)) {
+        while ((pChain->dmaPage != DmaPage) && (status == SDIO_ERR_NO_ERROR)) {
+            const uint8_t FinishedPage = pChain->dmaPage;
+
+            pChain->dmaPage = (uint8_t)((FinishedPage + 1U) % SDIO_CFG_ADMA2_DESC_PAGES);
+            if (pChain->complete == 0U) {
+                ADMA2ChainInvalidatePage(pSlot, Ring, FinishedPage);
+                status = ADMA2ChainFillPage(pSlot, Ring);
+            }
+        }
+    }
+
+    return (status);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Selects ADMA1 or ADMA2 DMA type
+static void DMA_SelectADMA(CSDD_SDIO_Slot* pSlot, uint8_t DMAMode)
+{
+    if (DMAMode == (uint8_t)CSDD_ADMA1_MODE) {
+        // ADMA1 mode selected
+        DMA_Select(pSlot, SRS10_DMA_SELECT_ADMA1);
+    } else {
+        // ADMA2 mode (ADMA3 is not supported or disabled) selected
+        uint32_t dmaselect = SRS10_DMA_SELECT_ADMA2;
+#if SDIO_ADMA3_SUPPORTED
+        dmaselect = SRS10_DMA_SELECT_MASK;
+#endif
+        DMA_Select(pSlot, dmaselect);
+
+    }
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// ADMA2 descriptor ring which can be used by a request issued now,
+/// it is not the ring of the prepared request
+static uint8_t DMA_FreeDescRing(const CSDD_SDIO_Slot* pSlot)
+{
+    uint8_t Ring = pSlot->DescRing;
+
+    if ((pSlot->pPreparedRequest != NULL) && (pSlot->PreparedDescRing == Ring)) {
+        Ring ^= 1U;
+    }
+
+    return (Ring);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+static uint8_t DMA_PrepareTransferADMA(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest,
+                                       CSDD_CommandField* pCmd,
+                                       uint8_t DMAMode,uint32_t *Descriptors,
+                                       uint32_t *offset, uint32_t * ADMADescSize)
+{
+    uint8_t status;
+    uint32_t Buffers = 0U;
+
+    if (DMAMode == (uint8_t)CSDD_ADMA2_MODE) {
+        // ADMA2 descriptors are written and flushed page by page
+        const uint8_t Ring = DMA_FreeDescRing(pSlot);
+
+        status = ADMA2ChainStart(pSlot, Ring, pRequest, pCmd);
+        if (status == SDIO_ERR_NO_ERROR) {
+            pSlot->DescRing = Ring;
+        }
+    }
+    // if user prepared sub-buffers then create descriptors
+    else if (pCmd->subBuffersCount != 0U) {
+        status = ADMACreateDescriptors(pSlot, pRequest, DMAMode, pCmd->pDataBuffer,
+                                       pCmd->subBuffersCount, Descriptors, offset, ADMADescSize);
+    }
+    else {
+        status = DMA_PrepareSubBuffers(pSlot, pRequest, pCmd, &Buffers);
+    }
+
+    if (Buffers > 0) {
+        status = ADMACreateDescriptors(pSlot, pRequest, DMAMode,
+                                       &pSlot->SubBuffers[0], Buffers, Descriptors, offset, ADMADescSize);
+    }
+
+    if (status == SDIO_ERR_NO_ERROR) {
+        // set address to DMA engine, ADMA3 descriptors are flushed
+        // all together by DMA_PrepareTransferADMA3
+        if (DMAMode != CSDD_ADMA3_MODE) {
+            DMA_FlushDescriptors(pSlot, Descriptors, *ADMADescSize);
+            status = SetDMAAddr(pSlot, pRequest->admaDescriptorTable, DMAMode);
+        }
+        if (status == SDIO_ERR_NO_ERROR) {
+            DMA_SelectADMA(pSlot, DMAMode);
+        }
+    }
+
+    return (status);
+}
+static uint8_t ADMA3CalcIDDescsize(const CSDD_SDIO_Slot* pSlot)
+{
+    uint32_t idDescSize;
+    if (pSlot->SlotSettings.DMA64_En != 0U) {
+        idDescSize = ADMA2_SIZE_OF_DESCRIPTOR_64_HV4;
+    } else {
+        idDescSize =  ADMA2_SIZE_OF_DESCRIPTOR_32;
+    }
+    return idDescSize;
+}
+uint8_t DMA_PrepareTransferADMA3(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest, uint8_t DMAMode, uint8_t count) {
+    uint8_t status = SDIO_ERR_NO_ERROR;
+    uint32_t *IntegratedDescriptors = pSlot->IntegratedDescriptorBuffer;
+    uint32_t *CDDescriptors = pSlot->DescriptorBuffer;
+    uint32_t ADMADescSize = (ADMA2_SIZE_OF_DESCRIPTOR_32 * 4U * count);
+    uint32_t *CDDescriptorsAddr;
+    uint32_t endvalue = 0;
+    uint32_t i = 0, j = 0;
+    const uint32_t RealIdDescSize = count * ADMA3CalcIDDescsize(pSlot);
+    if (RealIdDescSize > MAX_INTEGREATED_DESCR_BUFF_SIZE) {
+        status = SDIO_ERR_TO_FEW_MEM;
+    } else if (count > CSDD_MAX_NUMBER_COMMAND) {
+        status = SDIO_ERR_OUT_OF_RANGE;
+    } else {
+        for (i = 0; i < count; i++) {
+            CDDescriptorsAddr = CDDescriptors;
+            // create integrated descriptor
+            status =  ADMACreateIntegratedDescriptors(pSlot, pRequest, &pRequest->pCmd[i], DMAMode, &CDDescriptors, &ADMADescSize );
+            if (status != SDIO_ERR_NO_ERROR) {
+                break;
+            }
+            if (i == (count - 1U)) {
+                endvalue = ADMA1_DESCRIPTOR_END;
+            }
+
+            IntegratedDescriptors[j] = CpuToLe32(
+                ADMA3_DESCRIPTOR_TYPE_TRAN
+                | ADMA2_DESCRIPTOR_VAL
+                | endvalue);
+            j++;
+            // DMA address of the command descriptors
+            CDDescriptorsAddr = &pSlot->DescriptorDMAAddr[CDDescriptorsAddr - pSlot->DescriptorBuffer];
+            IntegratedDescriptors[j] = CpuToLe32(((uint32_t)(uintptr_t)CDDescriptorsAddr & 0xFFFFFFFFU));
+            j++;
+
+            if (pSlot->SlotSettings.DMA64_En != 0U) {
+                if (sizeof(uintptr_t) > 4U) {
+                    IntegratedDescriptors[j] = CpuToLe32((uint32_t)((uint64_t)(uintptr_t)CDDescriptorsAddr >> 32));
+                }
+                else {
+                    IntegratedDescriptors[j] = 0;
+                }
+                j++;
+                IntegratedDescriptors[j] = 0;
+                j++;
+            }
+        }
+        // set DMA descriptor address
+        if (status == SDIO_ERR_NO_ERROR ) {
+            // command and data descriptors of all commands are one range
+            DMA_FlushDescriptors(pSlot, pSlot->DescriptorBuffer, ADMADescSize);
+            DMA_FlushDescriptors(pSlot, IntegratedDescriptors, RealIdDescSize);
+            status = SetDMAAddr(pSlot, pRequest->IdDescriptorTable, DMAMode);
+        }
+
+    }
+
+    return (status);
+}
+#endif
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Cache maintenance of one data segment, written data is cleaned
+/// and read data is invalidated
+static void DMA_SyncSegment(CSDD_Request* pRequest, void* Address, uint32_t Size,
+                            CSDD_TransferDirection Direction)
+{
+    if (Direction == CSDD_TRANSFER_WRITE) {
+        CPS_CacheFlush(Address, Size, 0);
+        pRequest->cacheCleanBytes += Size;
+    } else {
+        CPS_CacheInvalidate(Address, Size, 0);
+        pRequest->cacheInvalidateBytes += Size;
+    }
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Cache maintenance of data buffers of all request commands.
+/// Before the transfer (ForDevice = 1) written data is cleaned and read
+/// buffers are invalidated, so no dirty line is evicted over data written
+/// by DMA. After the transfer (ForDevice = 0) read buffers are invalidated
+/// again to drop lines speculatively loaded while DMA was running.
+/// Sub-buffers are given by DMA addresses, which cannot be used by CPU cache
+/// operations, so the caller maintains cache of them.
+static void DMA_SyncData(CSDD_Request* pRequest, uint8_t ForDevice)
+{
+    uint32_t i;
+
+    for (i = 0; i < pRequest->cmdCount; i++) {
+        const CSDD_CommandField* pCmd = &pRequest->pCmd[i];
+        const CSDD_TransferDirection Direction = pCmd->requestFlags.dataTransferDirection;
+
+        if ((pCmd->requestFlags.dataPresent == 0U)
+            || ((ForDevice == 0U) && (Direction == CSDD_TRANSFER_WRITE))) {
+            // no data or nothing to do after write
+        } else if (pCmd->subBuffersCount != 0U) {
+            // sub-buffers are maintained by the caller
+        } else {
+            DMA_SyncSegment(pRequest, pCmd->pDataBuffer, pCmd->blockCount * pCmd->blockLen, Direction);
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Starts DMA transfer prepared by DMA_PrepareNext, only DMA registers are written
+static uint8_t DMA_StartPrepared(CSDD_SDIO_Slot* pSlot, const CSDD_Request* pRequest, uint8_t DMAMode)
+{
+    uint8_t status;
+
+    if (DMAMode == (uint8_t)CSDD_SDMA_MODE) {
+        status = DMA_StartSDMA(pSlot, pRequest, pSlot->PreparedDmaAddr, pSlot->PreparedDmaBoundary, DMAMode);
+        DMA_Select(pSlot, SRS10_DMA_SELECT_SDMA);
+    }
+#if SDIO_ADMA2_SUPPORTED
+    else if (DMAMode == (uint8_t)CSDD_ADMA2_MODE) {
+        pSlot->DescRing = pSlot->PreparedDescRing;
+        status = SetDMAAddr(pSlot, pRequest->admaDescriptorTable, DMAMode);
+        DMA_SelectADMA(pSlot, DMAMode);
+    }
+#endif
+    else {
+        status = SDIO_ERR_INVALID_PARAMETER;
+    }
+
+    return (status);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+uint8_t DMA_PrepareTransfer(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest)
+{
+    uint8_t status = SDIO_ERR_NO_ERROR;
+    uint8_t DMAMode = DMA_SpecifyTransmissionMode(pSlot, pRequest);
+    uint32_t offset = 0U;
+    uint32_t descSize = 0U;
+    uint8_t Prepared = 0U;
+
+    if (pRequest->dmaPrepared != 0U) {
+        // DMA mode may be changed after the request was prepared
+        Prepared = (pSlot->PreparedDmaMode == DMAMode) ? 1U : 0U;
+        pSlot->pPreparedRequest = NULL;
+        pRequest->dmaPrepared = 0U;
+    }
+
+    if (Prepared != 0U) {
+        status = DMA_StartPrepared(pSlot, pRequest, DMAMode);
+    } else {
+        switch (DMAMode) {
+        case (uint8_t)CSDD_SDMA_MODE:
+            status = DMA_PrepareTransferSDMA(pSlot, pRequest, DMAMode);
+            break;
+        case (uint8_t)CSDD_ADMA1_MODE:
+        case (uint8_t)CSDD_ADMA2_MODE:
+#if SDIO_ADMA1_SUPPORTED || SDIO_ADMA2_SUPPORTED
+            status = DMA_PrepareTransferADMA(pSlot, pRequest, pRequest->pCmd, DMAMode, pSlot->DescriptorBuffer, &offset, &descSize);
+            break;
+#endif
+#if SDIO_ADMA3_SUPPORTED
+        case (uint8_t)CSDD_ADMA3_MODE:
+            status = DMA_PrepareTransferADMA3(pSlot, pRequest,DMAMode, pRequest->cmdCount);
+#endif
+            break;
+        default:
+            status = SDIO_ERR_INVALID_PARAMETER;
+            break;
+        }
+    }
+
+    // cache maintenance of the prepared request is done already
+    if ((status == SDIO_ERR_NO_ERROR) && (pSlot->pSdioHost->ioCoherent == 0U)
+        && (pRequest->dmaMapped == 0U)) {
+        DMA_SyncData(pRequest, 1U);
+        pRequest->dmaMapped = 1U;
+    }
+
+    return (status);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+inline static bool DMA_NeedDescriptorsFreed(const uint32_t Status, const uint8_t DMAMode)
+{
+    return ((((Status & SRS12_TRANSFER_COMPLETE) != 0U)
+             || ((Status & SRS12_ERROR_INTERRUPT) != 0U)
+             || ((Status & SRS12_CARD_REMOVAL) != 0U)
+             || ((Status & SRS12_CARD_INSERTION) != 0U))
+            && ((DMAMode == (uint8_t)CSDD_ADMA1_MODE) || (DMAMode == (uint8_t)CSDD_ADMA2_MODE)));
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+uint8_t DMA_HandleInterrupt(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest, uint32_t Status)
+{
+    uint8_t retStatus = SDIO_ERR_NO_ERROR;
+    uint8_t DMAMode = DMA_SpecifyTransmissionMode(pSlot, pRequest);
+
+    if (pRequest->pCmd->requestFlags.dataPresent != 0U) {
+        if (((Status & SRS12_DMA_INTERRUPT) != 0U)
             && (DMAMode == (uint8_t)CSDD_SDMA_MODE)) {
             // DMA interrupt
             if (pSlot->pCurrentRequest->pBufferPos == NULL) {
@@ -801,20 +1416,30 @@ uint8_t DMA_HandleInterrupt(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest, uint3
             } else {
                 // clear DMA status
                 CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS12, SRS12_DMA_INTERRUPT);
+                pRequest->sdmaBoundaryInts++;
 
                 (void)GetDMAAddr(pSlot, &pRequest->pBufferPos, DMAMode);
+                pRequest->pBufferPos = (void*)DMA_SDMANextAddr(pSlot, pRequest, (uintptr_t)pRequest->pBufferPos);
                 // set system address register (transfer will be resumed)
                 retStatus = SetDMAAddr(pSlot, pRequest->pBufferPos, DMAMode);
             }
-        } else if (((Status & SRS12_DMA_INTERRUPT) != 0U)
-                   && ((DMAMode == (uint8_t)CSDD_ADMA1_MODE) || (DMAMode == (uint8_t)CSDD_ADMA2_MODE) || (DMAMode == (uint8_t)CSDD_ADMA3_MODE))) {
-            retStatus = SDIO_ERR_DMA_UNEXCEPTED_INTERRUPT;
         }
 #if SDIO_ADMA1_SUPPORTED || SDIO_ADMA2_SUPPORTED || SDIO_ADMA3_SUPPORTED
         else if (DMA_NeedDescriptorsFreed(Status, DMAMode)) {
+            pSlot->Adma2Chain[pSlot->DescRing].active = 0U;
             (void)DMA_FreeDecsriptors(pRequest);
         }
+        else if (((Status & SRS12_DMA_INTERRUPT) != 0U)
+                 && (DMAMode == (uint8_t)CSDD_ADMA2_MODE) && (pSlot->Adma2Chain[pSlot->DescRing].active != 0U)) {
+            // DMA finished page of the descriptor ring
+            CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS12, SRS12_DMA_INTERRUPT);
+            retStatus = ADMA2ChainRefill(pSlot, pSlot->DescRing);
+        }
 #endif
+        else if (((Status & SRS12_DMA_INTERRUPT) != 0U)
+                 && ((DMAMode == (uint8_t)CSDD_ADMA1_MODE) || (DMAMode == (uint8_t)CSDD_ADMA2_MODE) || (DMAMode == (uint8_t)CSDD_ADMA3_MODE))) {
+            retStatus = SDIO_ERR_DMA_UNEXCEPTED_INTERRUPT;
+        }
         else {
             // All 'if ... else if' constructs shall be terminated with an 'else' statement
             // (MISRA2012-RULE-15_7-3)
@@ -944,11 +1569,100 @@ uint8_t DMA_FinishTransfer(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest)
 #endif
 
 //-----------------------------------------------------------------------------
-uint8_t DMA_SpecifyTransmissionMode(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest)
+/// Selects DMA mode in auto mode, without checking data buffer alignment
+static uint8_t DMA_SelectAutoMode(const CSDD_SDIO_Slot* pSlot, const CSDD_Request* pRequest)
 {
     uint8_t Mode = (uint8_t)CSDD_NONEDMA_MODE; // MANUAL
-    uint32_t SRS16 = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS16);
-    uint32_t SRS17 = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS17);
+    uint32_t SRS16 = pSlot->CapabilitiesSrs16;
+    uint32_t SRS17 = pSlot->CapabilitiesSrs17;
+
+#if SDIO_SDMA_SUPPORTED
+    if ((SRS16 & SRS16_DMA_SUPPORT) != 0U) {
+        if ((pRequest->pCmd->blockLen > 32U) != 0U) {
+            Mode = (uint8_t)CSDD_SDMA_MODE; // SDMA
+        }
+    }
+#endif
+#if SDIO_ADMA1_SUPPORTED
+    if (SRS16 & SRS16_ADMA1_SUPPORT) {
+        if (((pRequest->pCmd->blockLen % 4096U) == 0U)
+            && (((uint32_t)pRequest->pCmd->pDataBuffer % 4096U) == 0U)) {
+            Mode = (uint8_t)CSDD_ADMA1_MODE; // ADMA1
+        }
+    }
+#endif
+#if SDIO_ADMA2_SUPPORTED
+    if ((SRS16 & SRS16_ADMA2_SUPPORT) != 0U) {
+        if (pRequest->pCmd->blockCount > 1U) {
+            Mode = (uint8_t)CSDD_ADMA2_MODE; // AMDA2
+        }
+    }
+#endif
+    if ((pSlot->pSdioHost->hostCtrlVer >= 6) && (SRS17 & SRS17_ADMA3_SUPPORT) != 0U) {
+        if (pRequest->pCmd->blockCount > 1U) {
+            Mode = (uint8_t)CSDD_ADMA3_MODE; // AMDA3
+        }
+    }
+    if (pRequest->pCmd->blockLen == 512U) {
+        const uint8_t Calibrated = pSlot->DmaModeTable[DMA_SizeClass(pRequest->pCmd->blockCount * 512U)];
+
+        if (Calibrated != (uint8_t)CSDD_AUTO_MODE) {
+            // mode measured by calibration for this transfer size
+            Mode = Calibrated;
+        }
+    }
+#if SDIO_ADMA2_SUPPORTED
+    if ((Mode == (uint8_t)CSDD_SDMA_MODE) && (pSlot->pSdioHost->virtToPhys != NULL)
+        && ((SRS16 & SRS16_ADMA2_SUPPORT) != 0U)) {
+        // with address translation the buffer may be not physically
+        // contiguous, ADMA2 descriptors can describe it
+        Mode = (uint8_t)CSDD_ADMA2_MODE;
+    }
+#endif
+
+    return (Mode);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Selects ADMA mode for a request with sub buffers in auto mode
+static uint8_t DMA_SelectSubBuffersMode(const CSDD_SDIO_Slot* pSlot)
+{
+    uint8_t Mode = (uint8_t)CSDD_NONEDMA_MODE;
+
+#if SDIO_ADMA2_SUPPORTED
+    if ((pSlot->CapabilitiesSrs16 & SRS16_ADMA2_SUPPORT) != 0U) {
+        Mode = (uint8_t)CSDD_ADMA2_MODE;
+    }
+#endif
+    if ((pSlot->pSdioHost->hostCtrlVer >= 6) && ((pSlot->CapabilitiesSrs17 & SRS17_ADMA3_SUPPORT) != 0U)) {
+        Mode = (uint8_t)CSDD_ADMA3_MODE;
+    }
+
+    return (Mode);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Selects DMA mode for a request with several commands in auto mode
+static uint8_t DMA_SelectCommandsMode(const CSDD_SDIO_Slot* pSlot)
+{
+    uint8_t Mode = (uint8_t)CSDD_NONEDMA_MODE;
+
+    // only ADMA3 integrated descriptors chain commands of one request
+    if ((pSlot->pSdioHost->hostCtrlVer >= 6) && ((pSlot->CapabilitiesSrs17 & SRS17_ADMA3_SUPPORT) != 0U)) {
+        Mode = (uint8_t)CSDD_ADMA3_MODE;
+    }
+
+    return (Mode);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Selects DMA mode of the request, without changing the slot state
+static uint8_t DMA_RequestMode(const CSDD_SDIO_Slot* pSlot, const CSDD_Request* pRequest)
+{
+    uint8_t Mode;
 
     if (pRequest == NULL) {
         Mode = SDIO_ERR_INVALID_PARAMETER;
@@ -956,42 +1670,347 @@ uint8_t DMA_SpecifyTransmissionMode(CSDD_SDIO_Slot* pSlot, CSDD_Request* pReques
         Mode = (uint8_t)CSDD_NONEDMA_MODE;
     } else if (pSlot->DmaMode != (uint8_t)CSDD_AUTO_MODE) {
         Mode = pSlot->DmaMode;
+    } else if (pRequest->cmdCount > 1U) {
+        Mode = DMA_SelectCommandsMode(pSlot);
+    } else if (pRequest->pCmd->subBuffersCount != 0U) {
+        // sub buffers can be transferred only by ADMA descriptors
+        Mode = DMA_SelectSubBuffersMode(pSlot);
     } else {
-#if SDIO_SDMA_SUPPORTED
-        if ((SRS16 & SRS16_DMA_SUPPORT) != 0U) {
-            if ((pRequest->pCmd->blockLen > 32U) != 0U) {
-                Mode = (uint8_t)CSDD_SDMA_MODE; // SDMA
-            }
+        Mode = DMA_SelectAutoMode(pSlot, pRequest);
+
+        const uint32_t alignMask = DMA_AlignMask(pSlot);
+
+        if (((uintptr_t)pRequest->pCmd->pDataBuffer & alignMask) != 0U) {
+            Mode = (uint8_t)CSDD_NONEDMA_MODE;
         }
+    }
+
+    return (Mode);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+uint8_t DMA_SpecifyTransmissionMode(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest)
+{
+    const uint8_t Mode = DMA_RequestMode(pSlot, pRequest);
+
+    pSlot->dmaModeSelected = (CSDD_DmaMode)Mode;
+    return (Mode);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+uint8_t DMA_SizeClass(uint32_t Size)
+{
+    uint8_t Class = 0U;
+    uint32_t Limit = 512U;
+
+    while ((Size > Limit) && (Class < (SDIO_CFG_DMA_CAL_CLASSES - 1U))) {
+        Limit <<= 2;
+        Class++;
+    }
+
+    return (Class);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+bool DMA_BufferAligned(const CSDD_SDIO_Slot* pSlot, const void* Buffer)
+{
+    return (((uintptr_t)Buffer & DMA_AlignMask(pSlot)) == 0U);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+bool DMA_RingRefillPending(const CSDD_SDIO_Slot* pSlot)
+{
+    bool Pending = false;
+
+#if SDIO_ADMA2_SUPPORTED
+    const CSDD_Adma2Chain* pChain = &pSlot->Adma2Chain[pSlot->DescRing];
+
+    Pending = ((pChain->active != 0U) && (pChain->complete == 0U));
+#endif
+
+    return (Pending);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+bool DMA_ModeSupported(const CSDD_SDIO_Slot* pSlot, uint8_t Mode)
+{
+    bool Supported = false;
+
+    switch (Mode) {
+    case (uint8_t)CSDD_NONEDMA_MODE:
+        Supported = true;
+        break;
+#if SDIO_SDMA_SUPPORTED
+    case (uint8_t)CSDD_SDMA_MODE:
+        Supported = ((pSlot->CapabilitiesSrs16 & SRS16_DMA_SUPPORT) != 0U);
+        break;
 #endif
 #if SDIO_ADMA1_SUPPORTED
-        if (SRS16 & SRS16_ADMA1_SUPPORT) {
-            if (((pRequest->pCmd->blockLen % 4096U) == 0U)
-                && (((uint32_t)pRequest->pCmd->pDataBuffer % 4096U) == 0U)) {
-                Mode = (uint8_t)CSDD_ADMA1_MODE; // ADMA1
-            }
-        }
+    case (uint8_t)CSDD_ADMA1_MODE:
+        Supported = ((pSlot->CapabilitiesSrs16 & SRS16_ADMA1_SUPPORT) != 0U);
+        break;
 #endif
 #if SDIO_ADMA2_SUPPORTED
-        if ((SRS16 & SRS16_ADMA2_SUPPORT) != 0U) {
-            if (pRequest->pCmd->blockCount > 1U) {
-                Mode = (uint8_t)CSDD_ADMA2_MODE; // AMDA2
+    case (uint8_t)CSDD_ADMA2_MODE:
+        Supported = ((pSlot->CapabilitiesSrs16 & SRS16_ADMA2_SUPPORT) != 0U);
+        break;
+#endif
+#if SDIO_ADMA3_SUPPORTED
+    case (uint8_t)CSDD_ADMA3_MODE:
+        Supported = (pSlot->pSdioHost->hostCtrlVer >= 6)
+                    && ((pSlot->CapabilitiesSrs17 & SRS17_ADMA3_SUPPORT) != 0U);
+        break;
+#endif
+    default:
+        // mode is not supported
+        break;
+    }
+
+    return (Supported);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+void DMA_ResetModeTable(CSDD_SDIO_Slot* pSlot)
+{
+    uint8_t i;
+
+    for (i = 0; i < SDIO_CFG_DMA_CAL_CLASSES; i++) {
+        pSlot->DmaModeTable[i] = (uint8_t)CSDD_AUTO_MODE;
+    }
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Selects mode of one size class: the lowest CPU time among modes
+/// which wall time is close to the best wall time
+static uint8_t DMA_SelectCalibratedMode(const CSDD_DmaCalibration* pResult, uint8_t Class)
+{
+    const CSDD_DmaCalTiming* pTiming;
+    uint64_t BestWallNs = pResult->pio[Class].wallNs;
+    uint64_t BestCpuNs;
+    uint8_t Mode = (uint8_t)CSDD_NONEDMA_MODE;
+    uint8_t i;
+
+    for (i = 0; i < 4U; i++) {
+        pTiming = &pResult->dma[Class][i];
+        if ((pTiming->wallNs != 0U) && (pTiming->wallNs < BestWallNs)) {
+            BestWallNs = pTiming->wallNs;
+        }
+    }
+
+    const uint64_t MaxWallNs = BestWallNs + (BestWallNs / SDIO_CFG_DMA_CAL_WALL_SLACK);
+
+    // transfer without DMA is a candidate only if it is fast enough
+    bool Found = (pResult->pio[Class].wallNs <= MaxWallNs);
+    BestCpuNs = pResult->pio[Class].cpuNs;
+
+    for (i = 0; i < 4U; i++) {
+        pTiming = &pResult->dma[Class][i];
+        if ((pTiming->wallNs != 0U) && (pTiming->wallNs <= MaxWallNs)
+            && (!Found || (pTiming->cpuNs < BestCpuNs))) {
+            BestCpuNs = pTiming->cpuNs;
+            Mode = i;
+            Found = true;
+        }
+    }
+
+    return (Mode);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+void DMA_ApplyCalibration(CSDD_SDIO_Slot* pSlot, CSDD_DmaCalibration* pResult)
+{
+    uint8_t i;
+
+    for (i = 0; i < SDIO_CFG_DMA_CAL_CLASSES; i++) {
+        if (pResult->size[i] == 0U) {
+            // class was not measured
+            pResult->selected[i] = (uint8_t)CSDD_AUTO_MODE;
+        } else {
+            pResult->selected[i] = DMA_SelectCalibratedMode(pResult, i);
+        }
+        pSlot->DmaModeTable[i] = pResult->selected[i];
+    }
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Checks if the request with not aligned data would use DMA and so needs
+/// a bounce buffer, otherwise the transfer mode does not depend on alignment.
+static bool DMA_BounceNeeded(CSDD_SDIO_Slot* pSlot, const CSDD_Request* pRequest)
+{
+    const CSDD_CommandField* pCmd = pRequest->pCmd;
+    bool Needed = false;
+
+    if ((((uintptr_t)pCmd->pDataBuffer & DMA_AlignMask(pSlot)) == 0U)
+        || (pCmd->requestFlags.isInfinite != 0U)
+        || (pCmd->subBuffersCount != 0U)
+        || (pRequest->cmdCount > 1U)
+        || (pSlot->DmaMode != (uint8_t)CSDD_AUTO_MODE)) {
+        // DMA mode does not depend on the buffer alignment
+    } else {
+        const uint8_t Mode = DMA_SelectAutoMode(pSlot, pRequest);
+
+        // the caller chose auto CMD23 expecting a transfer without DMA
+        // and SDMA cannot be used with it
+        Needed = (Mode != (uint8_t)CSDD_NONEDMA_MODE)
+                 && ((Mode != (uint8_t)CSDD_SDMA_MODE) || (pCmd->requestFlags.autoCMD23Enable == 0U));
+    }
+
+    return (Needed);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+/// Replaces not aligned data buffer of the request with a free bounce buffer
+/// of the host pool. Returns 1 if the request got one. Buffers are claimed
+/// with compare and swap, requests of other slots may take them at the same time.
+static uint8_t DMA_BounceTake(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest)
+{
+    CSDD_SDIO_Host* pSdioHost = pSlot->pSdioHost;
+    CSDD_CommandField* pCmd = pRequest->pCmd;
+    const uint32_t DataSize = pCmd->blockCount * pCmd->blockLen;
+    uint8_t Taken = 0U;
+
+    if (DMA_BounceNeeded(pSlot, pRequest) && (DataSize <= pSdioHost->BounceBufferSize)) {
+        uint32_t Used = pSdioHost->BounceUsed;
+        uint8_t Index = 0U;
+
+        while (Index < pSdioHost->BounceCount) {
+            if ((Used & (1UL << Index)) != 0U) {
+                Index++;
+            } else if (CPS_AtomicCompareSwap32(&pSdioHost->BounceUsed, Used, Used | (1UL << Index))) {
+                break;
+            } else {
+                // other request took a buffer, look again from the first one
+                Used = pSdioHost->BounceUsed;
+                Index = 0U;
             }
         }
-#endif
-        if ((pSlot->pSdioHost->hostCtrlVer >= 6) && (SRS17 & SRS17_ADMA3_SUPPORT) != 0U) {
-            if (pRequest->pCmd->blockCount > 1U) {
-                Mode = (uint8_t)CSDD_ADMA3_MODE; // AMDA3
+
+        if (Index < pSdioHost->BounceCount) {
+            uint8_t* Buffer = &pSdioHost->BounceBuffer[(uintptr_t)Index * pSdioHost->BounceBufferSize];
+
+            if (pCmd->requestFlags.dataTransferDirection == CSDD_TRANSFER_WRITE) {
+                CPS_BufferCopy(Buffer, pCmd->pDataBuffer, DataSize);
             }
+            pRequest->bounceUserBuffer = pCmd->pDataBuffer;
+            pCmd->pDataBuffer = Buffer;
+            pSdioHost->bounceStats.bouncedRequests++;
+            pSdioHost->bounceStats.bouncedBytes += DataSize;
+            Taken = 1U;
         }
+    }
 
-        const uint32_t alignMask = ((pSlot->SlotSettings.DMA64_En != 0U) ? 0x7U : 0x3U);
+    return (Taken);
+}
+//-----------------------------------------------------------------------------
 
-        if (((uintptr_t)pRequest->pCmd->pDataBuffer & alignMask) != 0U) {
-            Mode = (uint8_t)CSDD_NONEDMA_MODE;
+//-----------------------------------------------------------------------------
+void DMA_PrepareNext(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest)
+{
+    const CSDD_Request* pCurrent = pSlot->pCurrentRequest;
+    const CSDD_CommandField* pCmd = pRequest->pCmd;
+    uint8_t CurrentMode = (uint8_t)CSDD_NONEDMA_MODE;
+    uint8_t Mode = (uint8_t)CSDD_NONEDMA_MODE;
+    uint8_t status = SDIO_ERR_INVALID_PARAMETER;
+
+    if ((pCurrent != NULL) && (pCurrent->pCmd->requestFlags.dataPresent != 0U)) {
+        CurrentMode = DMA_RequestMode(pSlot, pCurrent);
+    }
+
+    if ((pSlot->pPreparedRequest != NULL) || (pRequest->cmdCount != 1U)
+        || (pCmd->requestFlags.dataPresent == 0U)
+        || (CurrentMode == (uint8_t)CSDD_ADMA1_MODE) || (CurrentMode == (uint8_t)CSDD_ADMA3_MODE)) {
+        // only one request is prepared, ADMA1 and ADMA3 tables overlap the ADMA2 rings
+    } else if ((pCmd->subBuffersCount == 0U) && (((uintptr_t)pCmd->pDataBuffer & DMA_AlignMask(pSlot)) != 0U)
+               && (DMA_BounceTake(pSlot, pRequest) == 0U)) {
+        // not aligned data without a free bounce buffer, the request
+        // tries again when it is issued
+    } else {
+        Mode = DMA_RequestMode(pSlot, pRequest);
+    }
+
+    if (Mode == (uint8_t)CSDD_SDMA_MODE) {
+        status = DMA_GetSDMAAddr(pSlot, pRequest, &pSlot->PreparedDmaAddr, &pSlot->PreparedDmaBoundary);
+    }
+#if SDIO_ADMA2_SUPPORTED
+    else if (Mode == (uint8_t)CSDD_ADMA2_MODE) {
+        // the other ring may be used by the current transfer
+        pSlot->PreparedDescRing = pSlot->DescRing ^ 1U;
+        status = ADMA2ChainStart(pSlot, pSlot->PreparedDescRing, pRequest, pCmd);
+    }
+#endif
+    else {
+        // All 'if ... else if' constructs shall be terminated with an 'else' statement
+        // (MISRA2012-RULE-15_7-3)
+    }
+
+    if (status == SDIO_ERR_NO_ERROR) {
+        if (pSlot->pSdioHost->ioCoherent == 0U) {
+            DMA_SyncData(pRequest, 1U);
+            pRequest->dmaMapped = 1U;
         }
+        pSlot->PreparedDmaMode = Mode;
+        pSlot->pPreparedRequest = pRequest;
+        pRequest->dmaPrepared = 1U;
+    }
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+void DMA_BounceAcquire(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest)
+{
+    if ((pRequest->bounceUserBuffer == NULL) && DMA_BounceNeeded(pSlot, pRequest)
+        && (DMA_BounceTake(pSlot, pRequest) == 0U)) {
+        // pool is not configured, buffers are too small or all are in use
+        pSlot->pSdioHost->bounceStats.pioFallbacks++;
+    }
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+void DMA_UnmapData(CSDD_Request* pRequest)
+{
+    if (pRequest->dmaPrepared != 0U) {
+        // request finished before it was issued
+        pRequest->pSdioHost->Slots[pRequest->slotIndex].pPreparedRequest = NULL;
+        pRequest->dmaPrepared = 0U;
+    }
+    if (pRequest->dmaMapped != 0U) {
+        DMA_SyncData(pRequest, 0U);
+        pRequest->dmaMapped = 0U;
+    }
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+void DMA_BounceRelease(CSDD_Request* pRequest, uint8_t Status)
+{
+    if (pRequest->bounceUserBuffer != NULL) {
+        CSDD_SDIO_Host* pSdioHost = pRequest->pSdioHost;
+        CSDD_CommandField* pCmd = pRequest->pCmd;
+        const uint32_t DataSize = pCmd->blockCount * pCmd->blockLen;
+        const uint32_t Index = (uint32_t)(((uintptr_t)pCmd->pDataBuffer - (uintptr_t)pSdioHost->BounceBuffer)
+                                          / pSdioHost->BounceBufferSize);
+        uint32_t Used;
+
+        if ((pCmd->requestFlags.dataTransferDirection == CSDD_TRANSFER_READ)
+            && (Status == SDIO_ERR_NO_ERROR)) {
+            CPS_BufferCopy(pRequest->bounceUserBuffer, pCmd->pDataBuffer, DataSize);
+        }
+        pCmd->pDataBuffer = pRequest->bounceUserBuffer;
+        pRequest->bounceUserBuffer = NULL;
+        do {
+            Used = pSdioHost->BounceUsed;
+        } while (!CPS_AtomicCompareSwap32(&pSdioHost->BounceUsed, Used, Used & ~(1UL << Index)));
     }
-    pSlot->dmaModeSelected = (CSDD_DmaMode)Mode;
-    return (Mode);
 }
 //-----------------------------------------------------------------------------
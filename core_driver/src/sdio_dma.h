@@ -92,4 +92,136 @@ uint8_t DMA_FinishTransfer(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest);
 /*****************************************************************************/
 uint8_t DMA_SpecifyTransmissionMode(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest);
 
+/*****************************************************************************/
+/*!
+ * @fn      void DMA_PrepareNext(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest)
+ * @brief   Function prepares DMA transfer of the queued request which is
+ *              issued next: address translation, ADMA2 descriptors in the ring
+ *              not used by the current transfer and cache maintenance.
+ *              DMA_PrepareTransfer then writes only DMA registers.
+ *              Not aligned data takes a bounce buffer of the host pool,
+ *              the request is not prepared if none is free.
+ * @param   pSlot Slot on which the request is queued
+ * @param   pRequest it describes queued request
+ */
+/*****************************************************************************/
+void DMA_PrepareNext(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest);
+
+/*****************************************************************************/
+/*!
+ * @fn      uint8_t DMA_SizeClass(uint32_t Size)
+ * @brief   Function returns size class of DMA mode calibration
+ *              of transfer with given size
+ * @param   Size transfer size in bytes
+ * @return  size class, 0 to SDIO_CFG_DMA_CAL_CLASSES - 1
+ */
+/*****************************************************************************/
+uint8_t DMA_SizeClass(uint32_t Size);
+
+/*****************************************************************************/
+/*!
+ * @fn      bool DMA_ModeSupported(const CSDD_SDIO_Slot* pSlot, uint8_t Mode)
+ * @brief   Function checks if DMA mode is supported by the slot and the driver
+ * @param   pSlot Slot to check
+ * @param   Mode DMA mode, CSDD_NONEDMA_MODE is always supported
+ * @return  true if mode can be used
+ */
+/*****************************************************************************/
+bool DMA_ModeSupported(const CSDD_SDIO_Slot* pSlot, uint8_t Mode);
+
+/*****************************************************************************/
+/*!
+ * @fn      bool DMA_BufferAligned(const CSDD_SDIO_Slot* pSlot, const void* Buffer)
+ * @brief   Function checks if data buffer is aligned for DMA of the slot
+ * @param   pSlot Slot which DMA transfers the buffer
+ * @param   Buffer data buffer
+ * @return  true if buffer can be used by DMA
+ */
+/*****************************************************************************/
+bool DMA_BufferAligned(const CSDD_SDIO_Slot* pSlot, const void* Buffer);
+
+/*****************************************************************************/
+/*!
+ * @fn      bool DMA_RingRefillPending(const CSDD_SDIO_Slot* pSlot)
+ * @brief   Function checks if ADMA2 transfer of the slot has data which
+ *              is not described in the descriptor ring yet. Such transfer
+ *              stops with ADMA error unless DMA interrupts are serviced
+ *              before DMA reaches the not valid ring page
+ * @param   pSlot Slot to check
+ * @return  true if ring pages are still to be refilled
+ */
+/*****************************************************************************/
+bool DMA_RingRefillPending(const CSDD_SDIO_Slot* pSlot);
+
+/*****************************************************************************/
+/*!
+ * @fn      void DMA_ResetModeTable(CSDD_SDIO_Slot* pSlot)
+ * @brief   Function drops DMA mode selection table of the slot,
+ *              auto mode uses fixed selection rules again
+ * @param   pSlot Slot which table is dropped
+ */
+/*****************************************************************************/
+void DMA_ResetModeTable(CSDD_SDIO_Slot* pSlot);
+
+/*****************************************************************************/
+/*!
+ * @fn      void DMA_ApplyCalibration(CSDD_SDIO_Slot* pSlot,
+ *                                    CSDD_DmaCalibration* pResult)
+ * @brief   Function selects DMA mode of each measured size class
+ *              and stores it in the slot selection table used by auto mode
+ * @param   pSlot Slot which was calibrated
+ * @param   pResult measured timings, selected modes are written to it
+ */
+/*****************************************************************************/
+void DMA_ApplyCalibration(CSDD_SDIO_Slot* pSlot, CSDD_DmaCalibration* pResult);
+
+/*****************************************************************************/
+/*!
+ * @fn      void DMA_FlushAddrCache(CSDD_SDIO_Host* pSdioHost)
+ * @brief   Function drops all address ranges translated by
+ *              virtToPhys callback and cached by the host
+ * @param   pSdioHost host object
+ */
+/*****************************************************************************/
+void DMA_FlushAddrCache(CSDD_SDIO_Host* pSdioHost);
+
+/*****************************************************************************/
+/*!
+ * @fn      void DMA_BounceAcquire(CSDD_SDIO_Slot* pSlot,
+ *                                 CSDD_Request* pRequest)
+ * @brief   Function replaces data buffer which is not aligned for DMA
+ *              with a free buffer of the host bounce buffer pool, if there is
+ *              one and the data fits in it, otherwise the transfer is counted
+ *              as PIO fallback. Write data is copied to the bounce buffer.
+ *              Request prepared by DMA_PrepareNext may have one already.
+ * @param   pSlot Slot on which the request shall be executed
+ * @param   pRequest it describes request to execute
+ */
+/*****************************************************************************/
+void DMA_BounceAcquire(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest);
+
+/*****************************************************************************/
+/*!
+ * @fn      void DMA_UnmapData(CSDD_Request* pRequest)
+ * @brief   Function does cache maintenance of data buffers of the finished
+ *              request, read buffers are invalidated. It must be called
+ *              before DMA_BounceRelease
+ * @param   pRequest it describes finished request
+ */
+/*****************************************************************************/
+void DMA_UnmapData(CSDD_Request* pRequest);
+
+/*****************************************************************************/
+/*!
+ * @fn      void DMA_BounceRelease(CSDD_Request* pRequest, uint8_t Status)
+ * @brief   Function restores user data buffer of the finished request
+ *              and returns its bounce buffer to the pool. Data of successful read
+ *              is copied to the user buffer.
+ * @param   pRequest it describes finished request
+ * @param   Status final status of the request, it is not set in
+ *              the request yet
+ */
+/*****************************************************************************/
+void DMA_BounceRelease(CSDD_Request* pRequest, uint8_t Status);
+
 #endif
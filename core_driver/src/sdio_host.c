@@ -96,9 +96,6 @@
 
 static const uint32_t Freq200MHzInKHz = 200000U;
 
-static LIST_NODE SuppDevListArray[MAX_SUPPORTED_DEVICE_COUNT + 1U];
-LIST_NODE *SuppDevList = &SuppDevListArray[0];
-
 static uint8_t SDIOHost_GetResponse(CSDD_Request* pRequest, CSDD_SDIO_Slot* pSlot);
 static void ConfigHostHighSpeedMode(CSDD_SDIO_Slot* pSlot, bool SetHighSpeed);
 static uint8_t SDIOHost_SetBusWidth(CSDD_SDIO_Slot* pSlot, uint8_t BusType);
@@ -112,6 +109,9 @@ static void SDIOHost_CheckRequestOnRecovery(CSDD_SDIO_Slot* pSlot, const CSDD_Re
 static uint8_t SDIOHost_CheckErrorOnRecovery(CSDD_SDIO_Slot* pSlot);
 static void SDIOHost_ErrorRecoveryExecuteCmd12(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest, uint8_t doResetLines);
 static void SDIOHost_ExecCardCommand_Set_Block_Count(CSDD_SDIO_Slot* pSlot,CSDD_Request* pRequest);
+static void SDIOHost_IssueQueuedRequests(CSDD_SDIO_Slot* pSlot);
+static void SDIOHost_HybridPollOnSubmit(CSDD_SDIO_Host* pSdioHost);
+static void SDIOHost_HybridPollOnIdle(CSDD_SDIO_Host* pSdioHost);
 
 static void DumpRequest(const CSDD_Request *pRequest, uint8_t isError)
 {
@@ -145,6 +145,88 @@ static void DumpRequest(const CSDD_Request *pRequest, uint8_t isError)
 
 }
 
+//-----------------------------------------------------------------------------
+static void SDIOHost_RegAccessCountStart(CSDD_Request* pRequest)
+{
+    uint64_t reads, writes;
+
+    CPS_GetRegAccessCount(&reads, &writes);
+    // fields keep the start values until the request completes
+    pRequest->regReads = (uint32_t)reads;
+    pRequest->regWrites = (uint32_t)writes;
+    pRequest->regCountActive = 1U;
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+static void SDIOHost_RegAccessCountStop(CSDD_Request* pRequest)
+{
+    uint64_t reads, writes;
+
+    if (pRequest->regCountActive != 0U) {
+        CPS_GetRegAccessCount(&reads, &writes);
+        pRequest->regReads = (uint32_t)reads - pRequest->regReads;
+        pRequest->regWrites = (uint32_t)writes - pRequest->regWrites;
+        pRequest->regCountActive = 0U;
+    }
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Release what the request holds from its submission until its completion
+static void SDIOHost_RequestFinished(CSDD_Request* pRequest, uint8_t status)
+{
+    SDIOHost_RegAccessCountStop(pRequest);
+    DMA_UnmapData(pRequest);
+    DMA_BounceRelease(pRequest, status);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Set final status of the request and notify its owner. Callback is called
+// once, when the status leaves SDIO_STATUS_PENDING, so it is safe to submit
+// the next request from inside of it. Owner polling the status may use
+// the data as soon as it is not pending, so the status is set last.
+static void SDIOHost_CompleteRequest(CSDD_Request* pRequest, uint8_t status)
+{
+    if ((pRequest->status == SDIO_STATUS_PENDING) && (status != SDIO_STATUS_PENDING)) {
+        SDIOHost_RequestFinished(pRequest, status);
+        CPS_MemoryBarrier();
+        pRequest->status = status;
+        if (pRequest->completeCallback != NULL) {
+            pRequest->completeCallback(pRequest, pRequest->userContext);
+        }
+    } else {
+        pRequest->status = status;
+    }
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Reset what the request tracks from its submission until its completion
+static void SDIOHost_RequestSubmitted(CSDD_Request* pRequest)
+{
+    SDIOHost_RegAccessCountStart(pRequest);
+    pRequest->bounceUserBuffer = NULL;
+    pRequest->dmaMapped = 0U;
+    pRequest->dmaPrepared = 0U;
+    pRequest->cacheCleanBytes = 0U;
+    pRequest->cacheInvalidateBytes = 0U;
+    pRequest->sdmaBoundaryInts = 0U;
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Finish request rejected before it was issued. It goes through
+// SDIOHost_CompleteRequest as any other request, so its callback is called
+// and what it holds since the submission is released.
+static void SDIOHost_RejectRequest(CSDD_Request* pRequest, uint8_t status)
+{
+    pRequest->status = SDIO_STATUS_PENDING;
+    SDIOHost_CompleteRequest(pRequest, status);
+}
+//-----------------------------------------------------------------------------
+
 //-----------------------------------------------------------------------------
 uint8_t ResetLines(CSDD_SDIO_Slot* pSlot, uint8_t cmd, uint8_t dat)
 {
@@ -659,7 +741,7 @@ static uint8_t ChangeDeviceMmcBusMode(CSDD_SDIO_Slot* pSlot, CSDD_SpeedMode Acce
 static uint8_t HostSupportAccessMode(CSDD_SDIO_Slot* pSlot, CSDD_SpeedMode AccessMode)
 {
     uint8_t status = SDIO_ERR_NO_ERROR;
-    uint32_t tmp = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS17);
+    uint32_t tmp = pSlot->CapabilitiesSrs17;
 
     switch(AccessMode) {
     case CSDD_ACCESS_MODE_SDR12:
@@ -867,6 +949,17 @@ static uint8_t ChangeDeviceMmcBusWidth(CSDD_SDIO_Slot* pSlot, uint8_t BusWidth)
 //-----------------------------------------------------------------------------
 #endif
 
+//-----------------------------------------------------------------------------
+/**
+ * Writes SRS15 and keeps the copy of host control 2 bits used on the
+ * transfer paths instead of reading the register back
+ */
+static void SDIOHost_WriteHostCtrl2(CSDD_SDIO_Slot* pSlot, uint32_t Value)
+{
+    CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS15, Value);
+    pSlot->HostCtrl2 = Value & SRS15_HOST_CTRL2_MASK;
+}
+
 //-----------------------------------------------------------------------------
 static uint8_t ChangeHostUhsiMode(CSDD_SDIO_Slot* pSlot, CSDD_SpeedMode AccessMode)
 {
@@ -907,7 +1000,7 @@ static uint8_t ChangeHostUhsiMode(CSDD_SDIO_Slot* pSlot, CSDD_SpeedMode AccessMo
         tmp = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS15);
         tmp &= ~SRS15_UHS_MODE_MASK;
         tmp |= UhsMode;
-        CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS15, tmp);
+        SDIOHost_WriteHostCtrl2(pSlot, tmp);
     }
 
     return (status);
@@ -955,7 +1048,7 @@ static uint8_t Tuning(CSDD_SDIO_Slot* pSlot, uint8_t Reset)
     // start of tuning
     tmp |= SRS15_EXECUTE_TUNING;
 
-    CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS15, tmp);
+    SDIOHost_WriteHostCtrl2(pSlot, tmp);
 
     RepeatCount = 40;
     while((tmp & SRS15_EXECUTE_TUNING) != 0U) {
@@ -1009,7 +1102,7 @@ static uint8_t IsTunningNeeded(CSDD_SDIO_Slot* pSlot, const CSDD_Request *pReque
                 pSlot->DataCount += (uint32_t)pRequest->pCmd->blockCount * pRequest->pCmd->blockLen;
             }
 
-            RetuningGetTimer(&Timing, pSlot->SlotNr);
+            RetuningGetTimer(&pSlot->RetuningTimer, &Timing);
             // if host controller doesn't request tuning
             // and transfered data doesn't exceed 14MB
             // and re-tuning timer doesn't signal that tuning is needed
@@ -1039,10 +1132,10 @@ static uint8_t ExecuteTuning(CSDD_SDIO_Slot* pSlot, uint8_t Reset, const CSDD_Re
         if (status != SDIO_ERR_NO_ERROR) {
             vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", status);
         } else {
-            uint32_t tmp = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS17);
+            uint32_t tmp = pSlot->CapabilitiesSrs17;
             uint32_t Timing = SRS17_GET_RETUNING_TIMER_COUNT(tmp);
 
-            RetuningSetTimer(Timing, pSlot->SlotNr);
+            RetuningSetTimer(&pSlot->RetuningTimer, Timing);
             pSlot->DataCount = 0;
             pSlot->RetuningRequest = 0;
         }
@@ -1061,12 +1154,12 @@ static uint8_t IsUhsiSupported(CSDD_SDIO_Slot* pSlot)
     if (CRS63_GET_SPEC_VERSION(tmp) < 2U) {
         result = 0U;
     } else {
-        tmp = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS16);
+        tmp = pSlot->CapabilitiesSrs16;
 
         if ((tmp & SRS16_VOLTAGE_1_8V_SUPPORT) == 0U) {
             result = 0U;
         } else {
-            tmp = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS17);
+            tmp = pSlot->CapabilitiesSrs17;
 
             uint32_t UhsiModes = (uint32_t)(SRS17_SDR50_SUPPORTED | SRS17_SDR104_SUPPORTED
                                             | SRS17_DDR50_SUPPORTED);
@@ -1092,7 +1185,7 @@ static uint8_t SwitchVoltageCardNot33(CSDD_SDIO_Slot* pSlot)
     // 1.8V signal enable
     uint32_t tmp = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS15);
     tmp |= SRS15_18V_ENABLE;
-    CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS15, tmp);
+    SDIOHost_WriteHostCtrl2(pSlot, tmp);
 
     // wait 5ms
     CPS_DelayNs(5000000U);
@@ -1134,7 +1227,7 @@ static uint8_t SwitchVoltageCard33Wait(CSDD_SDIO_Slot* pSlot, const uint32_t Dat
     // 1.8V signal enable
     uint32_t tmp = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS15);
     tmp |= SRS15_18V_ENABLE;
-    CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS15, tmp);
+    SDIOHost_WriteHostCtrl2(pSlot, tmp);
 
     // wait 5ms
     CPS_DelayNs(5000000U);
@@ -1244,7 +1337,7 @@ static uint32_t SDIOHost_SetTimeout(CSDD_SDIO_Slot* pSlot, uint32_t timeoutValUs
     uint8_t j;
     uint32_t sdmclk, timeoutVal;
 
-    temp = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS16);
+    temp = pSlot->CapabilitiesSrs16;
     sdmclk_khz = SRS16_GET_TIMEOUT_CLK_FREQ(temp);
 
     if (((temp & SRS16_TIMEOUT_CLOCK_UNIT_MHZ) == 0U) && (timeoutValUs < 1000U)) {
@@ -1445,6 +1538,53 @@ static void SDIOHost_InterruptHandlerAxiError(CSDD_SDIO_Host *pSdioHost)
 //-----------------------------------------------------------------------------
 #endif
 
+//-----------------------------------------------------------------------------
+static void SDIOHost_SlotInterruptHandler(CSDD_SDIO_Slot* pSlot, uint8_t *Handled)
+{
+    CSDD_SDIO_Host *pSdioHost = pSlot->pSdioHost;
+    const uint64_t CalStartNs = (pSlot->DmaCalActive != 0U) ? CPS_GetTimeNs() : 0U;
+    // status acknowledged by the top half is handled first
+    uint32_t regStatus = pSlot->IsrSrs12 | CPS_REG_READ(&pSlot->RegOffset->SRS.SRS12);
+
+    pSlot->IsrSrs12 = 0U;
+
+    while (regStatus != 0U) {
+        uint32_t intToClear;
+        *Handled = 1;
+        if (pSdioHost->intEn != 0U) {
+            pSdioHost->hybridPollStats.interruptEvents++;
+        } else if (pSdioHost->hybridPolling != 0U) {
+            pSdioHost->hybridPollStats.polledEvents++;
+        } else {
+            // All 'if ... else if' constructs shall be terminated with an 'else' statement
+            // (MISRA2012-RULE-15_7-3)
+        }
+        /* The CC and TC are to be used only when CQ is disabled or halted */
+        if ((pSlot->CQEnabled != 0U) && (pSlot->CQHalted == 0U)) {
+            regStatus &= ~(SRS12_COMMAND_COMPLETE | SRS12_TRANSFER_COMPLETE);
+        }
+        intToClear =  regStatus
+                     & (SRS12_NORMAL_STAUS_MASK & ~SRS12_CMD_QUEUING_INT);
+        // clear occurred normal status interrupts apart from CQ interrupt
+        if (intToClear != 0U) {
+            CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS12, intToClear);
+        }
+        SDIOHost_CheckInterrupt(pSlot, regStatus);
+
+        regStatus = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS12);
+    }
+
+    if (pSlot->IsrMasked != 0U) {
+        pSlot->IsrMasked = 0U;
+        CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS14, pSlot->IsrSignalEnable);
+    }
+
+    if (pSlot->DmaCalActive != 0U) {
+        pSlot->DmaCalCpuNs += CPS_GetTimeNs() - CalStartNs;
+    }
+}
+//-----------------------------------------------------------------------------
+
 //-----------------------------------------------------------------------------
 void SDIOHost_InterruptHandler(CSDD_SDIO_Host *pSdioHost, uint8_t *Handled)
 {
@@ -1458,6 +1598,7 @@ void SDIOHost_InterruptHandler(CSDD_SDIO_Host *pSdioHost, uint8_t *Handled)
 #endif
 
     for (i = 0; i < pSdioHost->NumberOfSlots; i++) {
+        CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[i];
         uint32_t IntSignal = 1;
 
         /* if interrupts are enabled then check which slot signals interrupt
@@ -1468,32 +1609,97 @@ void SDIOHost_InterruptHandler(CSDD_SDIO_Host *pSdioHost, uint8_t *Handled)
             IntSignal = (CPS_REG_READ(&pSdioHost->RegOffset->CRS.CRS63) >> i) & 1U;
         }
 
-        if (IntSignal != 0U) {
-            CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[i];
+        // slot masked by the top half does not signal its pending status
+        if ((IntSignal != 0U) || (pSlot->IsrMasked != 0U)) {
+            SDIOHost_SlotInterruptHandler(pSlot, Handled);
+        }
+    }
+
+    // collection made on submission is followed by a new request
+    if ((pSdioHost->hybridPolling != 0U) && (pSdioHost->hybridPollBusy == 0U)) {
+        SDIOHost_HybridPollOnIdle(pSdioHost);
+    }
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+static void SDIOHost_InterruptAcknowledge(CSDD_SDIO_Slot* pSlot, uint32_t Status)
+{
+    uint32_t regStatus = Status;
+    uint32_t intToClear;
+
+    // slot stays masked until the bottom half runs, so the top half never
+    // preempts it on this slot; errors and card interrupt which are not
+    // acknowledged here stay latched for the error recovery
+    pSlot->IsrSignalEnable = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS14);
+    CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS14, 0U);
+    pSlot->IsrMasked = 1U;
+
+    /* The CC and TC are to be used only when CQ is disabled or halted */
+    if ((pSlot->CQEnabled != 0U) && (pSlot->CQHalted == 0U)) {
+        regStatus &= ~(SRS12_COMMAND_COMPLETE | SRS12_TRANSFER_COMPLETE);
+    }
+    intToClear = regStatus & (SRS12_NORMAL_STAUS_MASK & ~SRS12_CMD_QUEUING_INT);
+    if (intToClear != 0U) {
+        CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS12, intToClear);
+    }
+
+    if ((regStatus & SRS12_CMD_QUEUING_INT) != 0U) {
+        uint32_t cqStatus = CPS_REG_READ(&pSlot->RegOffset->CQRS.CQRS04);
+        CPS_REG_WRITE(&pSlot->RegOffset->CQRS.CQRS04, cqStatus);
+        pSlot->IsrCqrs04 |= cqStatus;
+    }
+
+    pSlot->IsrSrs12 |= regStatus;
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+void SDIOHost_InterruptTopHalf(CSDD_SDIO_Host *pSdioHost, uint8_t *Handled)
+{
+    uint8_t i;
+
+    *Handled = 0;
+
+#if SDIO_CFG_HOST_VER >= 4
+    SDIOHost_InterruptHandlerAxiError(pSdioHost);
+#endif
+
+    for (i = 0; i < pSdioHost->NumberOfSlots; i++) {
+        CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[i];
+        uint32_t IntSignal = 1;
+
+        if ((pSdioHost->intEn != 0U) && (i < SDIO_SLOT_COUNT)) {
+            IntSignal = (CPS_REG_READ(&pSdioHost->RegOffset->CRS.CRS63) >> i) & 1U;
+        }
 
+        if ((IntSignal != 0U) && (pSlot->IsrMasked == 0U)) {
             uint32_t regStatus = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS12);
-            while (regStatus != 0U) {
-                uint32_t intToClear;
+            if (regStatus != 0U) {
                 *Handled = 1;
-                /* The CC and TC are to be used only when CQ is disabled or halted */
-                if ((pSlot->CQEnabled != 0U) && (pSlot->CQHalted == 0U)) {
-                    regStatus &= ~(SRS12_COMMAND_COMPLETE | SRS12_TRANSFER_COMPLETE);
-                }
-                intToClear =  regStatus
-                             & (SRS12_NORMAL_STAUS_MASK & ~SRS12_CMD_QUEUING_INT);
-                // clear occurred normal status interrupts apart from CQ interrupt
-                if (intToClear != 0U) {
-                    CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS12, intToClear);
-                }
-                SDIOHost_CheckInterrupt(pSlot, regStatus);
-
-                regStatus = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS12);
+                SDIOHost_InterruptAcknowledge(pSlot, regStatus);
             }
         }
     }
 }
 //-----------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+void SDIOHost_InterruptBottomHalf(CSDD_SDIO_Host *pSdioHost)
+{
+    uint8_t i;
+    uint8_t handled = 0;
+
+    for (i = 0; i < pSdioHost->NumberOfSlots; i++) {
+        CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[i];
+
+        if (pSlot->IsrMasked != 0U) {
+            SDIOHost_SlotInterruptHandler(pSlot, &handled);
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+
 //-----------------------------------------------------------------------------
 static uint8_t SDIOHost_MmcBootStatus(const CSDD_SDIO_Slot* pSlot)
 {
@@ -1555,14 +1761,28 @@ uint8_t SDIOHost_SlotInitialize(CSDD_SDIO_Slot* pSlot, CSDD_SDIO_Host* pSdioHost
 
     const uint32_t SRS14 = 0U;
 
+    // capabilities do not change, hot paths use the copies
+    pSlot->CapabilitiesSrs16 = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS16);
+    pSlot->CapabilitiesSrs17 = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS17);
+    pSlot->DmaSelect = SRS10_DMA_SELECT_UNKNOWN;
+
     pSlot->UhsiSelected = 0;
     pSlot->CardInserted = 0;
     pSlot->NeedAttach = 0;
+    pSlot->NonBlockIssue = 0;
+    pSlot->IsrSrs12 = 0;
+    pSlot->IsrCqrs04 = 0;
+    pSlot->IsrMasked = 0;
     pSlot->pSdioHost = pSdioHost;
     pSlot->RetuningEnabled = 0;
     pSlot->RetuningRequest = 0;
+    pSlot->RetuningTimer = 0;
     pSlot->DataCount = 0;
+    pSlot->MmcRca = 0x1000;
     pSlot->DmaMode = (uint8_t)CSDD_AUTO_MODE;
+    DMA_ResetModeTable(pSlot);
+    pSlot->DmaCalActive = 0;
+    pSlot->SdmaBoundary = 0;
     pSlot->pDevice = &pSlot->Devices[0];
     pSlot->SlotSettings.DMA64_En = 0;
     pSlot->SlotSettings.HostVer4_En = 0;
@@ -1576,12 +1796,16 @@ uint8_t SDIOHost_SlotInitialize(CSDD_SDIO_Slot* pSlot, CSDD_SDIO_Host* pSdioHost
         DataSet(&pSlot->Devices, 0,
                 (uint32_t)sizeof(pSlot->Devices[0]) * CSDD_MAX_DEV_PER_SLOT);
         pSlot->pCurrentRequest = NULL;
+        pSlot->pRequestQueueHead = NULL;
+        pSlot->pRequestQueueTail = NULL;
+        pSlot->pPreparedRequest = NULL;
+        pSlot->DescRing = 0U;
         pSlot->DMABufferBoundary = (uint32_t)SRS1_DMA_BUFF_SIZE_512KB;
         pSlot->AbortRequest = 0;
         pSlot->ProgClockMode = 0;
         uint32_t reg = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS15);
         if (pSdioHost->dma64BitEn) {
-            uint32_t cap = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS16);
+            uint32_t cap = pSlot->CapabilitiesSrs16;
             uint32_t A64VS = SRS16_64BIT_SUPPORT_V4;
             if(pSdioHost->hostCtrlVer < 6U){
                 A64VS = SRS16_64BIT_SUPPORT;
@@ -1600,8 +1824,10 @@ uint8_t SDIOHost_SlotInitialize(CSDD_SDIO_Slot* pSlot, CSDD_SDIO_Host* pSdioHost
         if(pSdioHost->hostCtrlVer >= SDIO_HOST_VER_WTH_CCP) {
             pSlot->SlotSettings.HostVer4_En = 1;
             reg |= SRS15_HOST_4_ENABLE;
+            // 26-bit descriptor length, set once instead of on each ADMA2 transfer
+            reg |= SRS15_ADMA2LM_MASK;
         }
-        CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS15, reg);
+        SDIOHost_WriteHostCtrl2(pSlot, reg);
         CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS13, SRS13);
         CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS14, SRS14);
 
@@ -1644,10 +1870,10 @@ static uint8_t SDIOHost_HostInitSlots(CSDD_SDIO_Host* pSdioHost)
     } else {
 
         for (i = 0; i < (MAX_SUPPORTED_DEVICE_COUNT + 1U); i++) {
-            SuppDevListArray[i].Item = NULL;
-            SuppDevListArray[i].Next = NULL;
+            pSdioHost->SuppDevList[i].Item = NULL;
+            pSdioHost->SuppDevList[i].Next = NULL;
         }
-        SuppDevList->Item = (CSDD_DeviceInfo*)(uint32_t)0xFFFFFFFFUL;
+        pSdioHost->SuppDevList[0].Item = (CSDD_DeviceInfo*)(uint32_t)0xFFFFFFFFUL;
 
         for (i = 0; i < pSdioHost->NumberOfSlots; i++) {
             status = SDIOHost_SlotInitialize(&pSdioHost->Slots[i], pSdioHost);
@@ -1677,6 +1903,13 @@ uint8_t SDIOHost_HostInitialize(CSDD_SDIO_Host* pSdioHost)
     vDbgMsg(DBG_GEN_MSG, DBG_FYI, "%s", "Start host initializing... \n");
     pSdioHost->HostBusMode = (uint8_t)CSDD_BUS_MODE_SD;
 
+    pSdioHost->hybridPolling = 0;
+    pSdioHost->hybridPollBusy = 0;
+    pSdioHost->hybridPollThreshold = 0;
+    pSdioHost->hybridWindowCount = 0;
+    pSdioHost->hybridWindowStartNs = 0;
+    DataSet(&pSdioHost->hybridPollStats, 0, sizeof(pSdioHost->hybridPollStats));
+
     tmp = CPS_REG_READ(&pSdioHost->RegOffset->CRS.CRS63);
     pSdioHost->SpecVersNumb = (uint8_t)CRS63_GET_SPEC_VERSION(tmp);
     vDbgMsg(DBG_GEN_MSG, DBG_FYI, "Specification Version Number %d \n",
@@ -2087,7 +2320,7 @@ uint8_t SDIOHost_GetBaseClk(CSDD_SDIO_Slot* pSlot, uint32_t *frequencyKHz)
     uint32_t temp;
 
     //read base clock frequency for SD clock in kilo herz
-    temp = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS16);
+    temp = pSlot->CapabilitiesSrs16;
     *frequencyKHz = SRS16_GET_BASE_CLK_FREQ_MHZ(temp) * 1000U;
 
     if (*frequencyKHz == 0U) {
@@ -2115,7 +2348,7 @@ static void CalclProgrammableClockMode(CSDD_SDIO_Slot* pSlot, uint32_t Frequency
                                        uint32_t* pSrs11Reg, uint32_t* pSetFreqKhz)
 {
     uint32_t i;
-    uint32_t Temp2 = 0, M = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS17);
+    uint32_t Temp2 = 0, M = pSlot->CapabilitiesSrs17;
     M = SRS17_GET_CLOCK_MULTIPLIER(M);
     for (i = 1; i < 1024U; i++) {
         if (((BaseCLKkHz * M) / i) <= FrequencyKHz) {
@@ -2265,7 +2498,7 @@ uint8_t SDIOHost_SetPower(CSDD_SDIO_Slot* pSlot, uint32_t Voltage)
         //clear current voltage settings
         Temp &= ~SRS10_BUS_VOLTAGE_MASK;
 
-        SRS16 = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS16);
+        SRS16 = pSlot->CapabilitiesSrs16;
 
         // if Voltage == 0
         // disable bus power
@@ -2586,7 +2819,7 @@ static uint8_t SDIOHOST_MatchVoltage(CSDD_SDIO_Slot* pSlot, uint32_t OCR,
     } else {
 
         /// host voltage capabilities
-        uint32_t HostCapabilities = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS16);
+        uint32_t HostCapabilities = pSlot->CapabilitiesSrs16;
 
         bool voltage33vSupported = ((HostCapabilities & SRS16_VOLTAGE_3_3V_SUPPORT) != 0U);
         bool voltage30vSupported = ((HostCapabilities & SRS16_VOLTAGE_3_0V_SUPPORT) != 0U);
@@ -3069,6 +3302,7 @@ static uint8_t SDIOHost_LookingForDriver(CSDD_SDIO_Slot* pSlot)
     uint8_t status;
     CSDD_SDIO_Device* pDevice = pSlot->pDevice;
     CSDD_DeviceInfo *DevInfo = NULL;
+    const LIST_NODE* SuppDevList = pSlot->pSdioHost->SuppDevList;
 
     if (SuppDevList->Next == NULL) {
         status = SDIO_ERR_DRIVER_NOT_IMPLEMENTED;
@@ -3213,7 +3447,7 @@ static void TransferDataBuffer(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest)
     if (pRequest == NULL) {
         vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "Error! pRequest is null\n");
     } else if ((pRequest->dataRemaining & 3U) != 0U) {
-        pRequest->status = SDIO_ERR_INVALID_PARAMETER;
+        SDIOHost_CompleteRequest(pRequest, SDIO_ERR_INVALID_PARAMETER);
     } else {
 
         if (pRequest->pCmd->requestFlags.dataTransferDirection == CSDD_TRANSFER_READ) {
@@ -3829,7 +4063,7 @@ static uint8_t SDIOHost_InterruptCommandComplete(CSDD_SDIO_Slot* pSlot, CSDD_Req
     if (LocalStatus != SDIO_ERR_NO_ERROR) {
         (void)ResetLines(pSlot, 1, 1);
         vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Response error - %d\n", LocalStatus);
-        pCurrentRequest->status = LocalStatus;
+        SDIOHost_CompleteRequest(pCurrentRequest, LocalStatus);
         returnStatus = 1U;
     } else {
         // if request doesn't need to transfer data
@@ -3842,14 +4076,14 @@ static uint8_t SDIOHost_InterruptCommandComplete(CSDD_SDIO_Slot* pSlot, CSDD_Req
             if (((uint32_t)(pCurrentRequest->busyCheckFlags)
                  & (SRS12_COMMAND_COMPLETE | SRS12_TRANSFER_COMPLETE)) ==
                 (SRS12_COMMAND_COMPLETE | SRS12_TRANSFER_COMPLETE)) {
-                pCurrentRequest->status = SDIO_ERR_NO_ERROR;
                 pSlot->pCurrentRequest = NULL;
+                SDIOHost_CompleteRequest(pCurrentRequest, SDIO_ERR_NO_ERROR);
                 returnStatus = 1U;
             }
         }
         else {
-            pCurrentRequest->status = SDIO_ERR_NO_ERROR;
             pSlot->pCurrentRequest = NULL;
+            SDIOHost_CompleteRequest(pCurrentRequest, SDIO_ERR_NO_ERROR);
             returnStatus = 1;
         }
     }
@@ -3868,8 +4102,8 @@ static uint8_t SDIOHost_InterruptBufferReadReady(CSDD_SDIO_Slot* pSlot, CSDD_Req
     // in cmd19 command - (tuning command)
     // we wait only for buffer read ready interrupt
     if (pCurrentRequest->pCmd->command == SDIO_CMD19) {
-        pCurrentRequest->status = SDIO_ERR_NO_ERROR;
         pSlot->pCurrentRequest = NULL;
+        SDIOHost_CompleteRequest(pCurrentRequest, SDIO_ERR_NO_ERROR);
         status = 1U;
     }
     else if ((pSlot->pCurrentRequest == NULL) || (pCurrentRequest->pBufferPos == NULL)) {
@@ -3877,8 +4111,8 @@ static uint8_t SDIOHost_InterruptBufferReadReady(CSDD_SDIO_Slot* pSlot, CSDD_Req
         status = 1U;
     } else if ((pCurrentRequest->pCmd->requestFlags.isInfinite != 0U)
                && (pCurrentRequest->dataRemaining == 0U)) {
-        pCurrentRequest->status = SDIO_ERR_NO_ERROR;
         pSlot->pCurrentRequest = NULL;
+        SDIOHost_CompleteRequest(pCurrentRequest, SDIO_ERR_NO_ERROR);
         status = 1U;
     } else {
 
@@ -3904,8 +4138,8 @@ static uint8_t SDIOHost_InterruptBufferWriteReady(CSDD_SDIO_Slot* pSlot, CSDD_Re
         status = 1U;
     } else if ((pCurrentRequest->pCmd->requestFlags.isInfinite != 0U)
                && (pCurrentRequest->dataRemaining == 0U)) {
-        pCurrentRequest->status = SDIO_ERR_NO_ERROR;
         pSlot->pCurrentRequest = NULL;
+        SDIOHost_CompleteRequest(pCurrentRequest, SDIO_ERR_NO_ERROR);
         status = 1U;
     } else {
 
@@ -3946,13 +4180,13 @@ static uint8_t SDIOHost_InterruptTransferComplete(CSDD_SDIO_Slot* pSlot, CSDD_Re
              & (SRS12_COMMAND_COMPLETE | SRS12_TRANSFER_COMPLETE)) ==
             (SRS12_COMMAND_COMPLETE | SRS12_TRANSFER_COMPLETE)) {
 
-            if(pSlot->pCurrentRequest->commandCategory != CSDD_CMD_CAT_NORMAL) {
-                if(pSlot->pCurrentRequest->subCommandRequest->status == SDIO_STATUS_PENDING) {
-                   pSlot->pCurrentRequest->subCommandRequest->status = SDIO_ERR_NO_ERROR;
+            pSlot->pCurrentRequest = NULL;
+            if(pCurrentRequest->commandCategory != CSDD_CMD_CAT_NORMAL) {
+                if(pCurrentRequest->subCommandRequest->status == SDIO_STATUS_PENDING) {
+                   SDIOHost_CompleteRequest(pCurrentRequest->subCommandRequest, SDIO_ERR_NO_ERROR);
                 }
             }
-            pCurrentRequest->status = SDIO_ERR_NO_ERROR;
-            pSlot->pCurrentRequest = NULL;
+            SDIOHost_CompleteRequest(pCurrentRequest, SDIO_ERR_NO_ERROR);
         }
     } while (0);
 
@@ -4061,22 +4295,22 @@ static bool SDIOHost_CheckInterruptError(CSDD_SDIO_Slot* pSlot, uint32_t status,
             if(pCurrentRequest->commandCategory != CSDD_CMD_CAT_NORMAL) {
                 if(pSlot->subCommandStatus != 0U) {
                     vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "error is due to subcommand!\n");
-                    pCurrentRequest->subCommandRequest->status = ret;
+                    SDIOHost_CompleteRequest(pCurrentRequest->subCommandRequest, ret);
                     if(pCurrentRequest->status == SDIO_STATUS_PENDING) {
-                        pCurrentRequest->status =  SDIO_ERR_GENERAL;
+                        SDIOHost_CompleteRequest(pCurrentRequest, SDIO_ERR_GENERAL);
                     }
                     interruptProcessed = true;
 
                 } else {
                     vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "error is due to main command!\n");
-                    pCurrentRequest->status = ret;
+                    SDIOHost_CompleteRequest(pCurrentRequest, ret);
                     if(pCurrentRequest->subCommandRequest->status == SDIO_STATUS_PENDING) {
-                        pCurrentRequest->subCommandRequest->status = SDIO_ERR_NO_ERROR;
+                        SDIOHost_CompleteRequest(pCurrentRequest->subCommandRequest, SDIO_ERR_NO_ERROR);
                     }
                     interruptProcessed = true;
                 }
             } else {
-                pCurrentRequest->status = ret;
+                SDIOHost_CompleteRequest(pCurrentRequest, ret);
                 interruptProcessed = true;
             }
         }
@@ -4107,7 +4341,7 @@ static bool SDIOHost_CheckInterruptErrorOnRecovery(CSDD_SDIO_Slot* pSlot, uint32
             (void)DMA_HandleInterrupt(pSlot, pCurrentRequest, status);
 #endif
             DumpRequest(pCurrentRequest, 1);
-            pCurrentRequest->status = SDIOHost_CheckErrorOnRecovery(pSlot);
+            SDIOHost_CompleteRequest(pCurrentRequest, SDIOHost_CheckErrorOnRecovery(pSlot));
 
             interruptProcessed = true;
         }
@@ -4204,6 +4438,12 @@ void SDIOHost_CheckInterrupt(CSDD_SDIO_Slot* pSlot, uint32_t status)
                 if (!interruptProcessed) {
                     SDIOHost_CheckInterruptNonError(pSlot, status, pCurrentRequest);
                 }
+
+                // chain next queued request as soon as the slot is released
+                if ((status & (SRS12_COMMAND_COMPLETE | SRS12_TRANSFER_COMPLETE
+                               | SRS12_ERROR_INTERRUPT)) != 0U) {
+                    SDIOHost_IssueQueuedRequests(pSlot);
+                }
             }
         }
     }
@@ -4238,6 +4478,90 @@ static void SDIOHost_CheckInterruptOnRecovery(CSDD_SDIO_Slot* pSlot, uint32_t st
 }
 //-----------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+static void SDIOHost_RequestQueueAppend(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest)
+{
+    vDbgMsg(DBG_GEN_MSG, DBG_HIVERB, "%s", "Slot is busy, request is queued\n");
+
+    pRequest->status = SDIO_STATUS_PENDING;
+    pRequest->pNextRequest = NULL;
+    if (pSlot->pRequestQueueTail == NULL) {
+        pSlot->pRequestQueueHead = pRequest;
+    } else {
+        pSlot->pRequestQueueTail->pNextRequest = pRequest;
+    }
+    pSlot->pRequestQueueTail = pRequest;
+
+    if (pSlot->pRequestQueueHead == pRequest) {
+        // request is issued next, DMA is prepared while the slot is busy
+        DMA_PrepareNext(pSlot, pRequest);
+    }
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+static void SDIOHost_RequestQueuePushFront(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest)
+{
+    pRequest->pNextRequest = pSlot->pRequestQueueHead;
+    pSlot->pRequestQueueHead = pRequest;
+    if (pSlot->pRequestQueueTail == NULL) {
+        pSlot->pRequestQueueTail = pRequest;
+    }
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+static CSDD_Request* SDIOHost_RequestQueuePop(CSDD_SDIO_Slot* pSlot)
+{
+    CSDD_Request* pRequest = pSlot->pRequestQueueHead;
+
+    if (pRequest != NULL) {
+        pSlot->pRequestQueueHead = pRequest->pNextRequest;
+        if (pSlot->pRequestQueueHead == NULL) {
+            pSlot->pRequestQueueTail = NULL;
+        }
+        pRequest->pNextRequest = NULL;
+    }
+
+    return (pRequest);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+static bool SDIOHost_RequestQueueRemove(CSDD_SDIO_Slot* pSlot, const CSDD_Request* pRequest)
+{
+    CSDD_Request* pPrev = NULL;
+    CSDD_Request* pIter = pSlot->pRequestQueueHead;
+
+    while ((pIter != NULL) && (pIter != pRequest)) {
+        pPrev = pIter;
+        pIter = pIter->pNextRequest;
+    }
+
+    if (pIter != NULL) {
+        if (pPrev == NULL) {
+            pSlot->pRequestQueueHead = pIter->pNextRequest;
+        } else {
+            pPrev->pNextRequest = pIter->pNextRequest;
+        }
+        if (pSlot->pRequestQueueTail == pIter) {
+            pSlot->pRequestQueueTail = pPrev;
+        }
+        pIter->pNextRequest = NULL;
+    }
+
+    return (pIter != NULL);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+static bool SDIOHost_IsSlotBusy(const CSDD_SDIO_Slot* pSlot)
+{
+    return ((pSlot->pCurrentRequest != NULL)
+            && (pSlot->pCurrentRequest->status == SDIO_STATUS_PENDING));
+}
+//-----------------------------------------------------------------------------
+
 //-----------------------------------------------------------------------------
 static uint8_t SDIOHost_ExecCardCommand_Precond(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest)
 {
@@ -4272,11 +4596,20 @@ static uint8_t SDIOHost_ExecCardCommand_Precond(CSDD_SDIO_Slot* pSlot, CSDD_Requ
         }
 #endif
         if (pRequest->pCmd->requestFlags.commandType != CSDD_CMD_TYPE_ABORT) {
-            if (pSlot->pCurrentRequest != NULL) {
+            if (pSlot->pRequestQueueHead != NULL) {
+                // keep submission order, request is issued after the queued ones
+                SDIOHost_RequestQueueAppend(pSlot, pRequest);
+                doContinue = 0U;
+            } else if (pSlot->pCurrentRequest != NULL) {
                 /* In ADMA3 sub commands can be send only when ADMA3 engine stopped*/
                 if((pSlot->pCurrentRequest->status == SDIO_STATUS_PENDING) && ((pSlot->dmaModeSelected == CSDD_ADMA3_MODE) || (subCommandflag == 0))) {
-                    DumpRequest(pRequest, 1);
-                    pRequest->status = SDIO_ERR_SLOT_IS_BUSY;
+                    if (pSlot->NonBlockIssue != 0U) {
+                        // request is chained from completion interrupt
+                        SDIOHost_RequestQueueAppend(pSlot, pRequest);
+                    } else {
+                        DumpRequest(pRequest, 1);
+                        SDIOHost_RejectRequest(pRequest, SDIO_ERR_SLOT_IS_BUSY);
+                    }
                     doContinue = 0U;
                 } else {
                     // Reset to default mode
@@ -4312,14 +4645,13 @@ static bool SDIOHost_ExecCardCommand_ProcessRequestDataPresentMultiBlock(CSDD_SD
         if (pRequest->pCmd->requestFlags.autoCMD23Enable != 0U) {
             if ((TransmissionMode == (uint8_t)CSDD_SDMA_MODE)
                 || (pSlot->pDevice->CMD23Supported == 0U)) {
-                pRequest->status = SDIO_ERR_AUTO_CMD23_NOT_POSSIBLE;
                 DumpRequest(pRequest, 1);
                 pSlot->pCurrentRequest = NULL;
+                SDIOHost_CompleteRequest(pRequest, SDIO_ERR_AUTO_CMD23_NOT_POSSIBLE);
                 doContinue = false;;
             } else {
                 command_information |= (uint32_t)SRS3_AUTOCMD23_ENABLE;
-                uint32_t reg = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS15);
-                if((reg & SRS15_CMD23_ENABLE)!= 0U) {    // for version > 4.10, Auto CMD Auto Select used
+                if((pSlot->HostCtrl2 & SRS15_CMD23_ENABLE)!= 0U) {    // for version > 4.10, Auto CMD Auto Select used
                     command_information |= (uint32_t)SRS3_AUTO_CMD_AUTO_SELECT_ENABLE;
                 }
                 // block count form auto CMD23 command
@@ -4341,8 +4673,7 @@ static void SDIOHost_ExecCardCommand_Set_Block_Count(CSDD_SDIO_Slot* pSlot,CSDD_
 {
     uint32_t tmp;
     uint32_t block_count = pRequest->pCmd->blockCount;
-    uint32_t reg = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS15);
-    tmp = CPS_FLD_READ(SD4HC__SRS__SRS15,HV4E, reg);
+    tmp = CPS_FLD_READ(SD4HC__SRS__SRS15,HV4E, pSlot->HostCtrl2);
     if( (tmp == 1U) && (pSlot->pSdioHost->hostCtrlVer >= 6U)){
         CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS00,
                                 block_count);
@@ -4359,10 +4690,20 @@ static bool SDIOHost_ExecCardCommand_ProcessRequestDataPresent(CSDD_SDIO_Slot* p
 {
     uint32_t command_information = 0U;
     bool doContinue = true;
+    DMA_BounceAcquire(pSlot, pRequest);
     pRequest->pBufferPos = pRequest->pCmd->pDataBuffer;
     pRequest->dataRemaining = (uint32_t)pRequest->pCmd->blockCount * pRequest->pCmd->blockLen;
     uint8_t TransmissionMode = DMA_SpecifyTransmissionMode(pSlot, pRequest);
 
+    if ((pRequest->pCmd->subBuffersCount != 0U) && (TransmissionMode == (uint8_t)CSDD_NONEDMA_MODE)) {
+        // sub buffers cannot be transferred through the data port
+        DumpRequest(pRequest, 1);
+        pSlot->pCurrentRequest = NULL;
+        SDIOHost_CompleteRequest(pRequest, SDIO_ERR_INVALID_PARAMETER);
+        doContinue = false;
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", SDIO_ERR_INVALID_PARAMETER);
+    }
+
 #if SDIO_ADMA3_SUPPORTED || SDIO_ADMA2_SUPPORTED || SDIO_ADMA1_SUPPORTED || SDIO_SDMA_SUPPORTED
     if (TransmissionMode == (uint8_t)CSDD_ADMA3_MODE) {
         // hardware will check
@@ -4372,9 +4713,9 @@ static bool SDIOHost_ExecCardCommand_ProcessRequestDataPresent(CSDD_SDIO_Slot* p
     if (TransmissionMode != (uint8_t)CSDD_NONEDMA_MODE) {
         uint8_t status = DMA_PrepareTransfer(pSlot, pRequest);
         if (status != SDIO_ERR_NO_ERROR) {
-            pRequest->status = status;
             DumpRequest(pRequest, 1);
             pSlot->pCurrentRequest = NULL;
+            SDIOHost_CompleteRequest(pRequest, status);
             doContinue = false;
             vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", status);
         } else {
@@ -4461,18 +4802,39 @@ uint32_t SDIOHost_ExecCardCommand_ProcessRequestCheckRespType(CSDD_ResponseType
 }
 //-----------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+static bool SDIOHost_IsDatLineCheckNeeded(const CSDD_Request* pRequest, uint8_t BusyCheck)
+{
+    return (( pRequest->pCmd->requestFlags.dataTransferDirection != 0U)
+            || ((BusyCheck != 0U) && (pRequest->pCmd->command != SDIO_CMD12)
+                && (pRequest->pCmd->command != SDIO_CMD52)));
+}
+//-----------------------------------------------------------------------------
+
 //-----------------------------------------------------------------------------
 static bool SDIOHost_IsDatLineBusy(CSDD_SDIO_Slot* pSlot, const CSDD_Request* pRequest, uint8_t BusyCheck)
 {
-    return ((( pRequest->pCmd->requestFlags.dataTransferDirection != 0U)
-             || ((BusyCheck != 0U) && (pRequest->pCmd->command != SDIO_CMD12)
-                 && (pRequest->pCmd->command != SDIO_CMD52))) // check if data line is not busy
+    return (SDIOHost_IsDatLineCheckNeeded(pRequest, BusyCheck) // check if data line is not busy
             && (WaitForValue(&pSlot->RegOffset->SRS.SRS09,
                              SRS9_CMD_INHIBIT_CMD | SRS9_CMD_INHIBIT_DAT,
                              0, COMMANDS_TIMEOUT) != 0U));
 }
 //-----------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+// single read of inhibit bits, used in non-blocking issue mode instead of WaitForValue
+static bool SDIOHost_IsLineInhibited(CSDD_SDIO_Slot* pSlot, const CSDD_Request* pRequest, uint8_t BusyCheck)
+{
+    uint32_t mask = SRS9_CMD_INHIBIT_CMD;
+
+    if (SDIOHost_IsDatLineCheckNeeded(pRequest, BusyCheck)) {
+        mask |= SRS9_CMD_INHIBIT_DAT;
+    }
+
+    return ((CPS_REG_READ(&pSlot->RegOffset->SRS.SRS09) & mask) != 0U);
+}
+//-----------------------------------------------------------------------------
+
 //-----------------------------------------------------------------------------
 static void SDIOHost_ExecCardCommand_Set_Command_Flag(CSDD_SDIO_Slot* pSlot, uint32_t* commandInformation, CSDD_Request* pRequest,CSDD_Request* currentMainRequest)
 {
@@ -4512,19 +4874,25 @@ static void SDIOHost_ExecCardCommand_ProcessRequest(CSDD_SDIO_Slot* pSlot, CSDD_
 
     uint32_t command_information = SDIOHost_ExecCardCommand_ProcessRequestCheckRespType(pRequest->pCmd->requestFlags.responseType, &BusyCheck);
 
+    if ((pSlot->NonBlockIssue != 0U) && SDIOHost_IsLineInhibited(pSlot, pRequest, BusyCheck)) {
+        // line is still busy, request will be issued from completion interrupt
+        vDbgMsg(DBG_GEN_MSG, DBG_HIVERB, "%s", "Line is busy, request is queued\n");
+        pSlot->pCurrentRequest = currentMainRequest;
+        SDIOHost_RequestQueuePushFront(pSlot, pRequest);
+    }
     // check if command line is not busy
-    if (WaitForValue(&pSlot->RegOffset->SRS.SRS09, SRS9_CMD_INHIBIT_CMD, 0,
+    else if (WaitForValue(&pSlot->RegOffset->SRS.SRS09, SRS9_CMD_INHIBIT_CMD, 0,
                      COMMANDS_TIMEOUT) != 0U) {
-        pRequest->status = SDIO_ERR_CMD_LINE_BUSY;
         vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "Command line is busy can't execute command\n");
         DumpRequest(pRequest, 1);
         pSlot->pCurrentRequest = NULL;
+        SDIOHost_CompleteRequest(pRequest, SDIO_ERR_CMD_LINE_BUSY);
     } else if (SDIOHost_IsDatLineBusy(pSlot, pRequest, BusyCheck)) {
 
-        pRequest->status = SDIO_ERR_DAT_LINE_BUSY;
         vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "DAT line is busy can't execute command\n");
         DumpRequest(pRequest, 1);
         pSlot->pCurrentRequest = NULL;
+        SDIOHost_CompleteRequest(pRequest, SDIO_ERR_DAT_LINE_BUSY);
     } else {
 
         // clear all status interrupts except:
@@ -4571,6 +4939,44 @@ static void SDIOHost_ExecCardCommand_ProcessRequest(CSDD_SDIO_Slot* pSlot, CSDD_
 
 //-----------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+// Issue queued requests one by one until one of them occupies the slot.
+// Called from completion interrupt, so registers of the next request
+// (SRS00-SRS02, DMA address) are programmed right after the previous
+// request is finished. Re-tuning is checked only on direct submission.
+// DMA descriptors and cache maintenance of the queue head are done
+// by DMA_PrepareNext before.
+static void SDIOHost_IssueQueuedRequests(CSDD_SDIO_Slot* pSlot)
+{
+    CSDD_Request* pRequest = NULL;
+
+    if (!SDIOHost_IsSlotBusy(pSlot)) {
+        pRequest = SDIOHost_RequestQueuePop(pSlot);
+    }
+
+    while (pRequest != NULL) {
+        pRequest->busyCheckFlags = 0;
+        // accesses of the transfers ahead of it in the queue are not counted
+        SDIOHost_RegAccessCountStart(pRequest);
+        SDIOHost_ExecCardCommand_ProcessRequest(pSlot, pRequest);
+
+        if ((pSlot->pRequestQueueHead == pRequest) || SDIOHost_IsSlotBusy(pSlot)) {
+            // line is still inhibited or request is executing
+            pRequest = NULL;
+        } else {
+            // request failed before it was issued, take the next one
+            pRequest = SDIOHost_RequestQueuePop(pSlot);
+        }
+    }
+
+    // DMA of the next queued request is prepared while this one is on the bus,
+    // so only registers are written when it is issued
+    if ((pSlot->pRequestQueueHead != NULL) && SDIOHost_IsSlotBusy(pSlot)) {
+        DMA_PrepareNext(pSlot, pSlot->pRequestQueueHead);
+    }
+}
+//-----------------------------------------------------------------------------
+
 //-----------------------------------------------------------------------------
 static void SDIOHost_ExecCardCommand_Impl(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest)
 {
@@ -4608,9 +5014,13 @@ static uint8_t SDIOHost_ExecCardCommandPreconds(CSDD_SDIO_Slot* pSlot, CSDD_Requ
 {
     uint8_t doContinue = 1U;
 
+    // owner of rejected request is notified too
+    pRequest->pSdioHost = pSlot->pSdioHost;
+    pRequest->slotIndex = pSlot->SlotNr;
+
     if ((pSlot->CQEnabled != 0U) && (pSlot->CQHalted == 0U)) {
         vDbgMsg(DBG_GEN_MSG, DBG_FYI, "%s", "This function is not supported if command queuing is enabled\n");
-        pRequest->status = SDIO_ERR_UNSUPORRTED_OPERATION;
+        SDIOHost_RejectRequest(pRequest, SDIO_ERR_UNSUPORRTED_OPERATION);
         doContinue = 0U;
     } else if ((pRequest->pCmd->requestFlags.isInfinite != 0U)
                && (pRequest->infiniteStatus == SDIOHOST_REQUEST_ISTATUS_NEXT)) {
@@ -4627,8 +5037,6 @@ static uint8_t SDIOHost_ExecCardCommandPreconds(CSDD_SDIO_Slot* pSlot, CSDD_Requ
         TransferDataBuffer(pSlot, pRequest);
         doContinue = 0U;
     } else {
-        pRequest->pSdioHost = pSlot->pSdioHost;
-        pRequest->slotIndex = pSlot->SlotNr;
         pRequest->busyCheckFlags = 0;
     }
 
@@ -4639,13 +5047,24 @@ static uint8_t SDIOHost_ExecCardCommandPreconds(CSDD_SDIO_Slot* pSlot, CSDD_Requ
 //-----------------------------------------------------------------------------
 void SDIOHost_ExecCardCommand(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest)
 {
-    uint8_t doContinue = SDIOHost_ExecCardCommandPreconds(pSlot, pRequest);
+    uint8_t doContinue;
+    uint64_t CalStartNs = 0U;
+
+    SDIOHost_HybridPollOnSubmit(pSlot->pSdioHost);
+    // completions collected above are measured by the interrupt handler
+    if (pSlot->DmaCalActive != 0U) {
+        CalStartNs = CPS_GetTimeNs();
+    }
+    SDIOHost_RequestSubmitted(pRequest);
+
+    doContinue = SDIOHost_ExecCardCommandPreconds(pSlot, pRequest);
 
     if (doContinue != 0U) {
         if (pSlot->InterfaceType == (uint8_t)CSDD_INTERFACE_TYPE_SD) {
             if (pRequest->pCmd->requestFlags.appCmd != 0U) {
-                    pRequest->status = SDIOHost_ExecCMD55Command(pSlot);
-                    if (pRequest->status != SDIO_ERR_NO_ERROR) {
+                    const uint8_t status = SDIOHost_ExecCMD55Command(pSlot);
+                    if (status != SDIO_ERR_NO_ERROR) {
+                            SDIOHost_RejectRequest(pRequest, status);
                             doContinue = 0U;
                     }
             }
@@ -4655,6 +5074,10 @@ void SDIOHost_ExecCardCommand(CSDD_SDIO_Slot* pSlot, CSDD_Request* pRequest)
         }
 
     }
+
+    if (pSlot->DmaCalActive != 0U) {
+        pSlot->DmaCalCpuNs += CPS_GetTimeNs() - CalStartNs;
+    }
 }
 //-----------------------------------------------------------------------------
 
@@ -4663,16 +5086,20 @@ static uint8_t SDIOHost_ExecCardCmdFiniteNonAppPreconds(const CSDD_SDIO_Slot* pS
 {
     uint8_t doContinue = 1U;
 
+    SDIOHost_RequestSubmitted(pRequest);
+    // owner of rejected request is notified too
+    pRequest->pSdioHost = pSlot->pSdioHost;
+    pRequest->slotIndex = pSlot->SlotNr;
+
     if ((pRequest->pCmd->requestFlags.appCmd != 0U) || (pRequest->pCmd->requestFlags.isInfinite != 0U)) {
         vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "This function works only with finite not app CMD\n");
+        SDIOHost_RejectRequest(pRequest, SDIO_ERR_INVALID_PARAMETER);
         doContinue = 0U;
     } else if ((pSlot->CQEnabled != 0U) && (pSlot->CQHalted == 0U)) {
         vDbgMsg(DBG_GEN_MSG, DBG_FYI, "%s", "This function is not supported if command queuing is enabled\n");
-        pRequest->status = SDIO_ERR_UNSUPORRTED_OPERATION;
+        SDIOHost_RejectRequest(pRequest, SDIO_ERR_UNSUPORRTED_OPERATION);
         doContinue = 0U;
     } else {
-        pRequest->pSdioHost = pSlot->pSdioHost;
-        pRequest->slotIndex = pSlot->SlotNr;
         pRequest->busyCheckFlags = 0;
     }
 
@@ -5157,7 +5584,12 @@ uint8_t SDIOHost_DeviceDetach(CSDD_SDIO_Slot* pSlot)
     } else {
 
         if (pSlot->pCurrentRequest != NULL) {
-            pSlot->pCurrentRequest->status = SDIO_STATUS_ABORTED;
+            SDIOHost_CompleteRequest(pSlot->pCurrentRequest, SDIO_STATUS_ABORTED);
+        }
+        CSDD_Request* pQueued = SDIOHost_RequestQueuePop(pSlot);
+        while (pQueued != NULL) {
+            SDIOHost_CompleteRequest(pQueued, SDIO_STATUS_ABORTED);
+            pQueued = SDIOHost_RequestQueuePop(pSlot);
         }
 
         // reset CMD line and DAT lines
@@ -5167,6 +5599,8 @@ uint8_t SDIOHost_DeviceDetach(CSDD_SDIO_Slot* pSlot)
 
         pSlot->CardInserted = 0;
         pSlot->NeedAttach = 0;
+        // calibration was made for the removed card
+        DMA_ResetModeTable(pSlot);
 
         if ((pSlot->pDevice != NULL) && (pSlot->pDevice->pCardDeinitialize != NULL)) {
             uint8_t status = pSlot->pDevice->pCardDeinitialize(pSlot->pSdioHost, pSlot->SlotNr);
@@ -5192,9 +5626,9 @@ static uint8_t SDIOHost_SetDmaMode(CSDD_SDIO_Slot* pSlot, uint8_t mode)
 {
     uint8_t status = SDIO_ERR_NO_ERROR;
     uint32_t SRS17 = 0;
-    uint32_t SRS16 = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS16);
+    uint32_t SRS16 = pSlot->CapabilitiesSrs16;
     if(pSlot->pSdioHost->hostCtrlVer >= 6) {
-        SRS17 = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS17);
+        SRS17 = pSlot->CapabilitiesSrs17;
     }
 
     switch(mode) {
@@ -5347,6 +5781,129 @@ static uint8_t SDIOHost_ConfigureSetDatTimeout(CSDD_SDIO_Slot* pSlot,
 }
 //-----------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+static uint8_t SDIOHost_ConfigureSetNonBlockIssue(CSDD_SDIO_Slot* pSlot,
+                                                  void *Data,  uint8_t dataSize)
+{
+    uint8_t status = SDIO_ERR_NO_ERROR;
+
+    if (dataSize == sizeof(uint8_t)) {
+        uint8_t* Data8 = Data;
+
+        vDbgMsg(DBG_GEN_MSG, DBG_FYI,
+                    "Cmd = CSDD_CONFIG_SET_NONBLOCK_ISSUE, Enable = %d\n",
+                    *Data8);
+        if ((*Data8 == 0U) && (pSlot->pRequestQueueHead != NULL)) {
+            // blocking mode has no one to issue the queued requests
+            vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "Requests are waiting for issue\n");
+            status = SDIO_ERR_SLOT_IS_BUSY;
+        } else {
+            pSlot->NonBlockIssue = (*Data8 != 0U) ? 1U : 0U;
+        }
+    }
+    else {
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT,
+                     "SizeOfData should be %d but is %d\n",
+                     sizeof(uint8_t), dataSize);
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", SDIO_ERR_INVALID_PARAMETER);
+        status = SDIO_ERR_INVALID_PARAMETER;
+    }
+
+    return (status);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+static uint8_t SDIOHost_ConfigureSetHybridPoll(CSDD_SDIO_Slot* pSlot,
+                                               void *Data,  uint8_t dataSize)
+{
+    uint8_t status = SDIO_ERR_NO_ERROR;
+    CSDD_SDIO_Host* pSdioHost = pSlot->pSdioHost;
+
+    if (dataSize == sizeof(uint32_t)) {
+        uint32_t* Data32 = Data;
+
+        vDbgMsg(DBG_GEN_MSG, DBG_FYI,
+                    "Cmd = CSDD_CONFIG_SET_HYBRID_POLL, Threshold = %ld\n",
+                    *Data32);
+        pSdioHost->hybridPollThreshold = *Data32;
+        pSdioHost->hybridWindowCount = 0;
+        pSdioHost->hybridWindowStartNs = CPS_GetTimeNs();
+        if ((*Data32 == 0U) && (pSdioHost->hybridPolling != 0U)) {
+            SDIOHost_HybridPollSetPhase(pSdioHost, 0);
+        }
+    }
+    else {
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT,
+                     "SizeOfData should be %d but is %d\n",
+                     sizeof(uint32_t), dataSize);
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", SDIO_ERR_INVALID_PARAMETER);
+        status = SDIO_ERR_INVALID_PARAMETER;
+    }
+
+    return (status);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+static uint8_t SDIOHost_ConfigureSetSdmaBoundary(CSDD_SDIO_Slot* pSlot,
+                                                 const void *Data,  uint8_t dataSize)
+{
+    uint8_t status = SDIO_ERR_NO_ERROR;
+
+    if (dataSize == sizeof(uint32_t)) {
+        const uint32_t Boundary = *(const uint32_t*)Data;
+
+        vDbgMsg(DBG_GEN_MSG, DBG_FYI,
+                    "Cmd = CSDD_CONFIG_SET_SDMA_BOUNDARY, Boundary = %ld\n",
+                    Boundary);
+        if ((Boundary != 0U)
+            && ((Boundary < SRS1_DMA_BUFF_MIN_BYTES) || (Boundary > SRS1_DMA_BUFF_MAX_BYTES)
+                || ((Boundary & (Boundary - 1U)) != 0U))) {
+            vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", SDIO_ERR_INVALID_PARAMETER);
+            status = SDIO_ERR_INVALID_PARAMETER;
+        } else {
+            pSlot->SdmaBoundary = Boundary;
+        }
+    }
+    else {
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT,
+                     "SizeOfData should be %d but is %d\n",
+                     sizeof(uint32_t), dataSize);
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", SDIO_ERR_INVALID_PARAMETER);
+        status = SDIO_ERR_INVALID_PARAMETER;
+    }
+
+    return (status);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+static uint8_t SDIOHost_ConfigureSetCqComplRing(CSDD_SDIO_Slot* pSlot,
+                                                const void *Data,  uint8_t dataSize)
+{
+    uint8_t status;
+
+    if (dataSize == sizeof(uint8_t)) {
+        const uint8_t Enable = *(const uint8_t*)Data;
+
+        vDbgMsg(DBG_GEN_MSG, DBG_FYI,
+                    "Cmd = CSDD_CONFIG_SET_CQ_COMPLETION_RING, Enable = %d\n",
+                    Enable);
+        status = SDIOHost_CQ_SetCompletionRing(pSlot, Enable);
+    }
+    else {
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT,
+                     "SizeOfData should be %d but is %d\n",
+                     sizeof(uint8_t), dataSize);
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", SDIO_ERR_INVALID_PARAMETER);
+        status = SDIO_ERR_INVALID_PARAMETER;
+    }
+
+    return (status);
+}
+//-----------------------------------------------------------------------------
+
 //-----------------------------------------------------------------------------
 uint8_t SDIOHost_Configure(CSDD_SDIO_Slot* pSlot, CSDD_ConfigCmd Cmd,
                            void *Data, const uint8_t *SizeOfData)
@@ -5384,6 +5941,23 @@ uint8_t SDIOHost_Configure(CSDD_SDIO_Slot* pSlot, CSDD_ConfigCmd Cmd,
                         "Cmd = SDIOHOST_SET_DMA_MODE\n");
             status = SDIOHost_SetDmaMode(pSlot, *(uint8_t *)Data);
             break;
+        case CSDD_CONFIG_SET_NONBLOCK_ISSUE:
+            status = SDIOHost_ConfigureSetNonBlockIssue(pSlot, Data, dataSize);
+            break;
+        case CSDD_CONFIG_SET_HYBRID_POLL:
+            status = SDIOHost_ConfigureSetHybridPoll(pSlot, Data, dataSize);
+            break;
+        case CSDD_CONFIG_FLUSH_ADDR_CACHE:
+            vDbgMsg(DBG_GEN_MSG, DBG_FYI, "%s",
+                        "Cmd = CSDD_CONFIG_FLUSH_ADDR_CACHE\n");
+            DMA_FlushAddrCache(pSlot->pSdioHost);
+            break;
+        case CSDD_CONFIG_SET_SDMA_BOUNDARY:
+            status = SDIOHost_ConfigureSetSdmaBoundary(pSlot, Data, dataSize);
+            break;
+        case CSDD_CONFIG_SET_CQ_COMPLETION_RING:
+            status = SDIOHost_ConfigureSetCqComplRing(pSlot, Data, dataSize);
+            break;
         default:
             vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Cmd %d is not recognized\n", Cmd);
             vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", SDIO_ERR_INVALID_PARAMETER);
@@ -5428,7 +6002,7 @@ static uint8_t SDIOHost_ProcessAbort(CSDD_SDIO_Slot* pSlot)
     uint8_t status = ResetLines(pSlot, 1, 1);
     if (status != SDIO_ERR_NO_ERROR) {
         if (pAbortingRequest != NULL) {
-            pAbortingRequest->status = SDIO_ERR_ABORT_ERROR;
+            SDIOHost_CompleteRequest(pAbortingRequest, SDIO_ERR_ABORT_ERROR);
         }
 
         vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "Abort Error\n");
@@ -5445,7 +6019,7 @@ static uint8_t SDIOHost_ProcessAbort(CSDD_SDIO_Slot* pSlot)
             SDIOHost_ProcessAbortErrorRecovery(pSlot);
 
             if (pAbortingRequest != NULL) {
-                pAbortingRequest->status = SDIO_ERR_ABORT_ERROR;
+                SDIOHost_CompleteRequest(pAbortingRequest, SDIO_ERR_ABORT_ERROR);
             }
             status = SDIO_ERR_ABORT_ERROR;
         } else {
@@ -5454,14 +6028,14 @@ static uint8_t SDIOHost_ProcessAbort(CSDD_SDIO_Slot* pSlot)
             status = ResetLines(pSlot, 1, 1);
             if (status != SDIO_ERR_NO_ERROR) {
                 if (pAbortingRequest != NULL) {
-                    pAbortingRequest->status = SDIO_ERR_ABORT_ERROR;
+                    SDIOHost_CompleteRequest(pAbortingRequest, SDIO_ERR_ABORT_ERROR);
                 }
                 status = SDIO_ERR_ABORT_ERROR;
             } else {
 
                 // set status of aborting request to SDIO_STATUS_ABORTED
                 if (pAbortingRequest != NULL) {
-                    pAbortingRequest->status = SDIO_STATUS_ABORTED;
+                    SDIOHost_CompleteRequest(pAbortingRequest, SDIO_STATUS_ABORTED);
                 }
             }
         }
@@ -6006,7 +6580,7 @@ uint8_t SDIOHost_Tuning(CSDD_SDIO_Slot* pSlot)
         }
         break;
     case (uint8_t)CSDD_ACCESS_MODE_SDR50:
-        tmp = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS17);
+        tmp = pSlot->CapabilitiesSrs17;
         if ((tmp & SRS17_USE_TUNING_SDR50) != 0U) {
             pSlot->RetuningEnabled = 1;
             status = ExecuteTuning(pSlot, 1, NULL);
@@ -6035,7 +6609,7 @@ void SDIOHost_PresetValueSwitch(CSDD_SDIO_Slot* pSlot, bool Enable)
         tmp &= ~SRS15_PRESET_VALUE_ENABLE;
     }
 
-    CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS15, tmp);
+    SDIOHost_WriteHostCtrl2(pSlot, tmp);
 }
 //-----------------------------------------------------------------------------
 
@@ -6047,7 +6621,7 @@ uint8_t SDIOHost_ClockGeneratorSelect(CSDD_SDIO_Slot* pSlot, uint8_t ProgClkMode
 
     if (ProgClkMode != pSlot->ProgClockMode) {
         if (ProgClkMode != 0U) {
-            tmp = CPS_REG_READ(&pSlot->RegOffset->SRS.SRS17);
+            tmp = pSlot->CapabilitiesSrs17;
             // if Clock Multiplier is 0 that means Programmable Clock Mode
             // is not supported
             if (SRS17_GET_CLOCK_MULTIPLIER(tmp) == 0U) {
@@ -6096,7 +6670,7 @@ uint8_t SDIOHost_ConfigureDrvStrength(CSDD_SDIO_Slot* pSlot,
             break;
         }
 
-        CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS15, SRS15);
+        SDIOHost_WriteHostCtrl2(pSlot, SRS15);
 
         status = SDIO_ERR_NO_ERROR;
     }
@@ -6105,6 +6679,18 @@ uint8_t SDIOHost_ConfigureDrvStrength(CSDD_SDIO_Slot* pSlot,
 }
 //-----------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+static void SDIOHost_WriteSignalEnable(CSDD_SDIO_Slot* pSlot, uint32_t SignalEnable)
+{
+    if (pSlot->IsrMasked != 0U) {
+        // slot is masked by the top half, settings apply when it is unmasked
+        pSlot->IsrSignalEnable = SignalEnable;
+    } else {
+        CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS14, SignalEnable);
+    }
+}
+//-----------------------------------------------------------------------------
+
 //-----------------------------------------------------------------------------
 uint8_t SDIOHost_InterruptConfig(CSDD_SDIO_Slot* pSlot, uint8_t enable)
 {
@@ -6138,7 +6724,7 @@ uint8_t SDIOHost_InterruptConfig(CSDD_SDIO_Slot* pSlot, uint8_t enable)
                             | SRS14_CMD_QUEUING_SIG_EN);
     }
 
-    CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS14, SRS14);
+    SDIOHost_WriteSignalEnable(pSlot, SRS14);
 
     (void)SDIOHost_CQ_InterruptConfig(pSlot, enable);
 
@@ -6146,10 +6732,128 @@ uint8_t SDIOHost_InterruptConfig(CSDD_SDIO_Slot* pSlot, uint8_t enable)
 }
 //-----------------------------------------------------------------------------
 
+//-----------------------------------------------------------------------------
+void SDIOHost_HybridPollSetPhase(CSDD_SDIO_Host* pSdioHost, uint8_t polling)
+{
+    uint8_t i;
+
+    if (polling != 0U) {
+        vDbgMsg(DBG_GEN_MSG, DBG_HIVERB, "%s", "Hybrid mode: polling completions\n");
+        pSdioHost->intEn = 0;
+        for (i = 0; i < pSdioHost->NumberOfSlots; i++) {
+            // card detection is never polled, keep its interrupts. DMA
+            // interrupt refills ADMA2 descriptor ring which has to be done
+            // before DMA reaches the not valid page, it is not left to polling
+            SDIOHost_WriteSignalEnable(&pSdioHost->Slots[i],
+                                       (uint32_t)(SRS14_CARD_REMOVAL_SIG_EN
+                                                  | SRS14_DMA_INTERRUPT_SIG_EN
+#   if ENABLE_CARD_INTERRUPT
+                                                  | SRS14_CARD_INTERRUPT_SIG_EN
+#   endif
+                                                  | SRS14_CARD_INERTION_SIG_EN));
+        }
+        pSdioHost->hybridPolling = 1;
+        pSdioHost->hybridPollStats.pollingPhases++;
+    } else {
+        vDbgMsg(DBG_GEN_MSG, DBG_HIVERB, "%s", "Hybrid mode: interrupt completions\n");
+        // status bits latched while polling raise the interrupt at once
+        for (i = 0; i < pSdioHost->NumberOfSlots; i++) {
+            (void)SDIOHost_InterruptConfig(&pSdioHost->Slots[i], 1);
+        }
+        pSdioHost->hybridPolling = 0;
+        pSdioHost->hybridPollStats.interruptPhases++;
+    }
+    pSdioHost->hybridPollStats.polling = (polling != 0U);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+static bool SDIOHost_IsCQEnabled(const CSDD_SDIO_Host* pSdioHost)
+{
+    bool result = false;
+    uint8_t i;
+
+    for (i = 0; i < pSdioHost->NumberOfSlots; i++) {
+        if (pSdioHost->Slots[i].CQEnabled != 0U) {
+            result = true;
+        }
+    }
+
+    return (result);
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+static void SDIOHost_HybridPollOnSubmit(CSDD_SDIO_Host* pSdioHost)
+{
+    uint64_t NowNs, ElapsedNs;
+    uint8_t handled;
+
+    if (pSdioHost->hybridPollThreshold != 0U) {
+        NowNs = CPS_GetTimeNs();
+        ElapsedNs = NowNs - pSdioHost->hybridWindowStartNs;
+
+        if (ElapsedNs >= SDIO_CFG_HYBRID_POLL_WINDOW_NS) {
+            // request rate over the elapsed time (it includes idle time
+            // before this request) dropped below the threshold, so
+            // completions are reported by interrupts again
+            if ((pSdioHost->hybridPolling != 0U)
+                && (((uint64_t)pSdioHost->hybridWindowCount * SDIO_CFG_HYBRID_POLL_WINDOW_NS)
+                    < ((uint64_t)pSdioHost->hybridPollThreshold * ElapsedNs))) {
+                SDIOHost_HybridPollSetPhase(pSdioHost, 0);
+            }
+            pSdioHost->hybridWindowStartNs = NowNs;
+            pSdioHost->hybridWindowCount = 0;
+        }
+        pSdioHost->hybridWindowCount++;
+
+        if ((pSdioHost->hybridPolling == 0U) && (pSdioHost->intEn != 0U)
+            && (pSdioHost->hybridWindowCount >= pSdioHost->hybridPollThreshold)
+            && !SDIOHost_IsCQEnabled(pSdioHost)) {
+            SDIOHost_HybridPollSetPhase(pSdioHost, 1);
+        }
+
+        // collect completions of earlier requests, unless this submission
+        // comes from a completion callback of such collection
+        if ((pSdioHost->hybridPolling != 0U) && (pSdioHost->hybridPollBusy == 0U)) {
+            pSdioHost->hybridPollBusy = 1;
+            SDIOHost_InterruptHandler(pSdioHost, &handled);
+            pSdioHost->hybridPollBusy = 0;
+        }
+    }
+}
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Nobody polls a host with no request in progress, so when the last one
+// finished its completion is reported by interrupts again. The next request
+// submitted while the rate stays above the threshold masks them again.
+static void SDIOHost_HybridPollOnIdle(CSDD_SDIO_Host* pSdioHost)
+{
+    bool idle = true;
+    uint8_t i;
+
+    for (i = 0; i < pSdioHost->NumberOfSlots; i++) {
+        const CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[i];
+
+        if (SDIOHost_IsSlotBusy(pSlot) || (pSlot->pRequestQueueHead != NULL)) {
+            idle = false;
+        }
+    }
+
+    if (idle) {
+        SDIOHost_HybridPollSetPhase(pSdioHost, 0);
+    }
+}
+//-----------------------------------------------------------------------------
+
 //-----------------------------------------------------------------------------
 void SDIOHost_CheckBusy(CSDD_SDIO_Host* pSdioHost, CSDD_Request* pRequest)
 {
-    uint32_t TimeNs = COMMANDS_TIMEOUT * 1000 + 100;
+    SDIO_PollTimer Timer;
+    CSDD_SDIO_Slot* pSlot = &pSdioHost->Slots[pRequest->slotIndex];
+
+    PollTimerStart(&Timer, REQUEST_TIMEOUT);
 
     while(pRequest->status == SDIO_STATUS_PENDING) {
         /*if interrupts are disabled then we need to call
@@ -6159,27 +6863,52 @@ void SDIOHost_CheckBusy(CSDD_SDIO_Host* pSdioHost, CSDD_Request* pRequest)
             SDIOHost_InterruptHandler(pSdioHost, &handled);
         }
 
-        if (TimeNs < 100) {
+        /* queued requests with nothing in progress will not be issued
+         * by the completion interrupt */
+        if ((pSlot->pRequestQueueHead != NULL) && !SDIOHost_IsSlotBusy(pSlot)) {
+            SDIOHost_IssueQueuedRequests(pSlot);
+        }
+
+        // ADMA2 ring pages have to be refilled before DMA reaches
+        // the not valid one, refill must not wait for a backed off check
+        if (DMA_RingRefillPending(pSlot)) {
+            PollTimerNoBackoff(&Timer);
+        }
+
+        if (pRequest->status != SDIO_STATUS_PENDING) {
+            // request finished during this pass
+        } else if (PollTimerWait(&Timer) != SDIO_ERR_NO_ERROR) {
             vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "Driver timeout error!\n");
-            if (pRequest->pCmd->requestFlags.commandType != CSDD_CMD_TYPE_ABORT) {
-                (void)SDIOHost_Abort(&pSdioHost->Slots[pRequest->slotIndex], 0);
+            if (SDIOHost_RequestQueueRemove(pSlot, pRequest)) {
+                // request was never issued, there is nothing to abort
+            } else if (pRequest->pCmd->requestFlags.commandType != CSDD_CMD_TYPE_ABORT) {
+                (void)SDIOHost_Abort(pSlot, 0);
+            } else {
+                // All 'if ... else if' constructs shall be terminated with an 'else' statement
+                // (MISRA2012-RULE-15_7-3)
             }
-            pRequest->status = SDIO_ERR_TIMEOUT;
+            SDIOHost_CompleteRequest(pRequest, SDIO_ERR_TIMEOUT);
+        } else {
+            // All 'if ... else if' constructs shall be terminated with an 'else' statement
+            // (MISRA2012-RULE-15_7-3)
         }
-        CPS_DelayNs(100U);
-        TimeNs -= 100;
     }
+    // statuses set by polling paths do not go through SDIOHost_CompleteRequest
+    SDIOHost_RequestFinished(pRequest, pRequest->status);
 }
 //-----------------------------------------------------------------------------
 
 //-----------------------------------------------------------------------------
 static void SDIOHost_CheckBusyAbort(CSDD_SDIO_Host* pSdioHost, CSDD_Request* pRequest)
 {
-    uint32_t TimeNs = COMMANDS_TIMEOUT * 1000 + 100;
+    SDIO_PollTimer Timer;
 
     if (pRequest->pCmd->requestFlags.commandType != CSDD_CMD_TYPE_ABORT) {
         vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "should be used only with ABORT command!\n");
     }
+
+    PollTimerStart(&Timer, REQUEST_TIMEOUT);
+
     while(pRequest->status == SDIO_STATUS_PENDING) {
         /*if interrupts are disabled then we need to call
          *  interrupt handler manually - polling mode*/
@@ -6188,13 +6917,18 @@ static void SDIOHost_CheckBusyAbort(CSDD_SDIO_Host* pSdioHost, CSDD_Request* pRe
             SDIOHost_InterruptHandler(pSdioHost, &handled);
         }
         // check if given Time is not exceeded
-        if (TimeNs < 100) {
+        if (pRequest->status != SDIO_STATUS_PENDING) {
+            // request finished during this pass
+        } else if (PollTimerWait(&Timer) != SDIO_ERR_NO_ERROR) {
             vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "%s", "Driver timeout error!\n");
-            pRequest->status = SDIO_ERR_TIMEOUT;
+            SDIOHost_CompleteRequest(pRequest, SDIO_ERR_TIMEOUT);
+        } else {
+            // All 'if ... else if' constructs shall be terminated with an 'else' statement
+            // (MISRA2012-RULE-15_7-3)
         }
-        CPS_DelayNs(100U);
-        TimeNs -= 100;
     }
+    // statuses set by polling paths do not go through SDIOHost_CompleteRequest
+    SDIOHost_RequestFinished(pRequest, pRequest->status);
 }
 //-----------------------------------------------------------------------------
 
@@ -6214,7 +6948,7 @@ static uint8_t SDIOHost_EnableCMD23Ifsupported(CSDD_SDIO_Slot* pSlot)
     if((pSlot->pSdioHost->hostCtrlVer >= SDIO_HOST_VER_WTH_CCP) && (pSlot->pDevice->CMD23Supported != 0U)){
         tmp |= SRS15_CMD23_ENABLE;
     }
-    CPS_REG_WRITE(&pSlot->RegOffset->SRS.SRS15, tmp);
+    SDIOHost_WriteHostCtrl2(pSlot, tmp);
 
     return status;
 }
@@ -125,6 +125,12 @@ static inline uint32_t CRS63_GET_VENDOR_VERSION(const uint32_t val)
 #define SRS1_DMA_BUFF_SIZE_512KB    0x00007000UL
 /// DMA buffer size mask
 #define SRS1_DMA_BUFF_SIZE_MASK     SD4HC__SRS__SRS01__SDMABB_MASK
+/// DMA buffer size shift
+#define SRS1_DMA_BUFF_SIZE_SHIFT    12U
+/// smallest DMA buffer size in bytes
+#define SRS1_DMA_BUFF_MIN_BYTES     (4U * 1024U)
+/// biggest DMA buffer size in bytes
+#define SRS1_DMA_BUFF_MAX_BYTES     (512U * 1024U)
 /// Transfer block size mask
 #define SRS1_BLOCK_SIZE             SD4HC__SRS__SRS01__TBS_MASK
 //@}
@@ -287,6 +293,8 @@ static inline uint32_t CRS63_GET_VENDOR_VERSION(const uint32_t val)
 #define SRS10_DMA_SELECT_ADMA2              ((uint32_t)(0x2UL << 3))
 /// DMA mode selection mask
 #define SRS10_DMA_SELECT_MASK               ((uint32_t)(0x3UL << 3))
+/// DMA select field value is not known, it never matches a written one
+#define SRS10_DMA_SELECT_UNKNOWN            ((uint32_t)0xFFFFFFFFUL)
 /// High speed enable.
 #define SRS10_HIGH_SPEED_ENABLE             SD4HC__SRS__SRS10__HSE_MASK
 /// Set 4 bit data transfer width
@@ -582,6 +590,8 @@ static inline uint32_t CRS63_GET_VENDOR_VERSION(const uint32_t val)
 #define SRS15_CMD23_ENABLE				0x08000000U
 // ADMA2LM - ADMA2 Length Mode
 #define SRS15_ADMA2LM_MASK				0x04000000U
+/// Host Control 2 part of the register
+#define SRS15_HOST_CTRL2_MASK           ((uint32_t)0xFFFF0000UL)
 /// Sampling Clock Select
 #define SRS15_SAMPLING_CLOCK_SELECT     SD4HC__SRS__SRS15__SCS_MASK
 /// Execute Tuning
@@ -877,7 +887,7 @@ inline static uint32_t CQRS01_GET_ITCFMUL(const uint32_t rv)
 /// Get Internal Timer Clock Frequency Value
 inline static uint32_t CQRS01_GET_ITCFVAL(const uint32_t rv)
 {
-    return  (rv & 0x3FU);
+    return ((rv & SD4HC__CQRS__CQRS01__ITCFVAL_MASK) >> SD4HC__CQRS__CQRS01__ITCFVAL_SHIFT);
 }
 //@}
 //-----------------------------------------------------------------------------
@@ -1214,11 +1224,6 @@ inline static bool IS_CARD_WRITE_PROTECT(const CSDD_SDIO_Slot* pSlot) {
     return ((CPS_REG_READ(&pSlot->RegOffset->SRS.SRS09) & SRS9_WP_SWITCH_LEVEL) != 0U);
 #endif
 
-/// List of supported SDIO devices.
-/// If once create a driver for a SDIO device then should add this device
-/// to the list. First element is a head and it's item is always NULL
-extern LIST_NODE *SuppDevList;
-
 /*****************************************************************************/
 /*!
  * @fn          void SDIOHost_ExecCardCommand( CSDD_SDIO_Slot* pSlot,
@@ -1334,6 +1339,29 @@ uint8_t SDIOHost_Configure( CSDD_SDIO_Slot* pSlot, CSDD_ConfigCmd Cmd,
 /*****************************************************************************/
 void SDIOHost_InterruptHandler( CSDD_SDIO_Host *pSdioHost, uint8_t *Handled);
 
+/*****************************************************************************/
+/*!
+ * @fn      void SDIOHost_InterruptTopHalf( CSDD_SDIO_Host *pSdioHost,
+ *                                          uint8_t *Handled )
+ * @param   pSdioHost SDIO Host object
+ * @param   Handled flag informs if interrupt ocurred and
+ *              SDIOHost_InterruptBottomHalf has to be called
+ * @brief   Acknowledges normal and CQ status of signalling slots, saves it
+ *              in the slot object and masks the slot interrupt signals
+ */
+/*****************************************************************************/
+void SDIOHost_InterruptTopHalf( CSDD_SDIO_Host *pSdioHost, uint8_t *Handled);
+
+/*****************************************************************************/
+/*!
+ * @fn      void SDIOHost_InterruptBottomHalf( CSDD_SDIO_Host *pSdioHost )
+ * @param   pSdioHost SDIO Host object
+ * @brief   Handles status saved by SDIOHost_InterruptTopHalf together with
+ *              latched errors and unmasks the slot interrupt signals
+ */
+/*****************************************************************************/
+void SDIOHost_InterruptBottomHalf( CSDD_SDIO_Host *pSdioHost);
+
 /*****************************************************************************/
 /*!
  * @fn      uint8_t SDIOHost_ConfigureHighSpeed( CSDD_SDIO_Slot* pSlot,
@@ -1602,6 +1630,19 @@ uint8_t ResetHost(CSDD_SDIO_Host* pSdioHost);
 
 uint8_t SDIOHost_InterruptConfig(CSDD_SDIO_Slot* pSlot, uint8_t enable);
 
+/*****************************************************************************/
+/*!
+ * @fn      void SDIOHost_HybridPollSetPhase(CSDD_SDIO_Host* pSdioHost, uint8_t polling)
+ * @brief   Function switches hybrid interrupt/polling mode between phases.
+ *              In polling phase all interrupt signals apart from card
+ *              detection are masked and intEn is cleared, so waiting
+ *              functions call the interrupt handler themselves.
+ * @param   pSdioHost host on which operation shall be executed
+ * @param   polling 1 - poll completions, 0 - use interrupts
+ */
+/*****************************************************************************/
+void SDIOHost_HybridPollSetPhase(CSDD_SDIO_Host* pSdioHost, uint8_t polling);
+
 uint8_t ResetLines(CSDD_SDIO_Slot* pSlot, uint8_t cmd, uint8_t dat);
 
 uint8_t CheckResponseError(const uint32_t *Response, uint8_t ResponseType,
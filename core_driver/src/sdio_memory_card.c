@@ -52,42 +52,48 @@
 static uint8_t MemoryCard_Initialize(CSDD_SDIO_Host* pD, uint8_t slotIndex);
 static uint8_t MemoryCard_Deinitialize(CSDD_SDIO_Host* pD, uint8_t slotIndex);
 
-struct MemCards_s {
-    CSDD_MEMORY_CARD_INFO Card;
-    uint8_t Used;
-};
-
-static struct MemCards_s MemCards[CSDD_MAX_DEV_PER_SLOT * SDIO_SLOT_COUNT];
-
-static CSDD_MEMORY_CARD_INFO *GetUnusedCard(void)
+static CSDD_Request *GetUnusedRequest(CSDD_SDIO_Slot* pSlot, CSDD_RequestCompleteCallback Callback)
 {
-    CSDD_MEMORY_CARD_INFO* result = NULL;
+    CSDD_Request* result = NULL;
 
     uint32_t i;
-    for(i = 0; i < SDIO_SLOT_COUNT; i++) {
-        if (MemCards[i].Used == 0U) {
-            MemCards[i].Used = 1U;
-            result = &MemCards[i].Card;
+    for(i = 0; i < SDIO_CFG_MEM_REQUESTS_PER_SLOT; i++) {
+        if (pSlot->MemRequests[i].Used == 0U) {
+            pSlot->MemRequests[i].Used = 1U;
+            pSlot->MemRequests[i].Callback = Callback;
+            result = &pSlot->MemRequests[i].Request;
             break;
         }
     }
     return (result);
 }
 
-static void FreeCard(const CSDD_MEMORY_CARD_INFO *pCard)
+static void FreeRequest(CSDD_SDIO_Slot* pSlot, const CSDD_Request *pRequest)
 {
     uint32_t i;
-    for(i = 0; i < SDIO_SLOT_COUNT; i++) {
-        if (&MemCards[i].Card == pCard) {
-            MemCards[i].Used = 0U;
+    for(i = 0; i < SDIO_CFG_MEM_REQUESTS_PER_SLOT; i++) {
+        if (&pSlot->MemRequests[i].Request == pRequest) {
+            pSlot->MemRequests[i].Used = 0U;
         }
     }
 }
 
-static CSDD_Request gRequest;
+// Completion of pool request with user callback.
+// Request goes back to the pool when the user callback returns.
+static void RequestComplete(CSDD_Request* pRequest, void* UserContext)
+{
+    CSDD_SDIO_Slot* pSlot = &pRequest->pSdioHost->Slots[pRequest->slotIndex];
+    uint32_t i;
+    for(i = 0; i < SDIO_CFG_MEM_REQUESTS_PER_SLOT; i++) {
+        if (&pSlot->MemRequests[i].Request == pRequest) {
+            pSlot->MemRequests[i].Callback(pRequest, UserContext);
+            pSlot->MemRequests[i].Used = 0U;
+        }
+    }
+}
 
 //------------------------------------------------------------------------------------------
-void MemoryCard_LoadDriver(void)
+void MemoryCard_LoadDriver(CSDD_SDIO_Host* pSdioHost)
 {
     static CSDD_DeviceInfo SD_Card = {
         .manufacturerCode = 0,
@@ -107,14 +113,16 @@ void MemoryCard_LoadDriver(void)
         .pCardDeinitialize = MemoryCard_Deinitialize,
     };
 
-    uint32_t i;
+    uint32_t i, j;
     for(i = 0; i < SDIO_SLOT_COUNT; i++) {
-        MemCards[i].Used = 0;
+        for(j = 0; j < SDIO_CFG_MEM_REQUESTS_PER_SLOT; j++) {
+            pSdioHost->Slots[i].MemRequests[j].Used = 0;
+        }
     }
 
     // add supported by driver devices to list
-    (void)SDIOHost_AddItem( SuppDevList, &SD_Card );
-    (void)SDIOHost_AddItem( SuppDevList, &MMC_Card );
+    (void)SDIOHost_AddItem( pSdioHost->SuppDevList, &SD_Card );
+    (void)SDIOHost_AddItem( pSdioHost->SuppDevList, &MMC_Card );
 }
 //------------------------------------------------------------------------------------------
 
@@ -309,20 +317,15 @@ static uint8_t MemoryCard_Initialize(CSDD_SDIO_Host* pD, uint8_t slotIndex)
             Status = SDIO_ERR_DEV_NULL_POINTER;
         } else {
 
-            pCard = GetUnusedCard();
-            if ( pCard == NULL ) {
-                Status = SDIO_ERR_MEM_ALLOC;
-            } else {
-
-                pDevice->CardDriverData = pCard;
+            pCard = &pDevice->MemoryCardInfo;
+            pDevice->CardDriverData = pCard;
 
-                Status = MemoryCard_GetCSD (pDevice);
-                if (Status != SDIO_ERR_NO_ERROR) {
-                    vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", Status);
-                } else {
+            Status = MemoryCard_GetCSD (pDevice);
+            if (Status != SDIO_ERR_NO_ERROR) {
+                vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", Status);
+            } else {
 
-                    Status = MemoryCard_ProcessInitialize(pDevice, pCard);
-                }
+                Status = MemoryCard_ProcessInitialize(pDevice, pCard);
             }
         }
     }
@@ -348,7 +351,7 @@ static uint8_t MemoryCard_Deinitialize(CSDD_SDIO_Host* pD, uint8_t slotIndex)
             status = SDIO_ERR_DEV_NULL_POINTER;
         } else {
 
-            FreeCard(pDevice->CardDriverData);
+            pDevice->CardDriverData = NULL;
 
             status = SDIO_ERR_NO_ERROR;
         }
@@ -549,9 +552,14 @@ uint8_t MemoryCard_PartialDataTransfer(CSDD_SDIO_Device* pDevice, uint32_t Addre
 //------------------------------------------------------------------------------------------
 uint8_t MemoryCard_FinishXferNonBlock(CSDD_Request* pRequest)
 {
+    uint8_t Status;
+
     SDIOHost_CheckBusy(pRequest->pSdioHost, pRequest);
 
-    return (pRequest->status);
+    Status = pRequest->status;
+    FreeRequest(&pRequest->pSdioHost->Slots[pRequest->slotIndex], pRequest);
+
+    return (Status);
 }
 //------------------------------------------------------------------------------------------
 
@@ -574,7 +582,10 @@ static uint8_t MemoryCard_DataXferNonBlockCheckPrecond(const CSDD_SDIO_Device* p
     } else if ((BufferSize % 512U) != 0U) {
         vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", SDIO_ERR_INVALID_PARAMETER);
         status = SDIO_ERR_INVALID_PARAMETER;
-    } else if ((!USE_AUTO_CMD) && (pDevice->pSlot->InterfaceType == (uint8_t)CSDD_INTERFACE_TYPE_SD)) {
+    } else if ((!USE_AUTO_CMD) && (BufferSize > 512U)
+               && (pDevice->pSlot->InterfaceType == (uint8_t)CSDD_INTERFACE_TYPE_SD)) {
+        // multiple block transfer is ended by auto CMD12 or auto CMD23,
+        // single block transfer does not need them
         status = SDIO_ERR_CANT_EXECUTE;
     } else if (IsWriteToWriteProtectedSd(pDevice, TransferDirection)) {
         status = SDIO_ERR_CARD_WRITE_PROTECTED;
@@ -623,7 +634,8 @@ static uint8_t MemoryCard_SetBlockLengthTo512(CSDD_SDIO_Device* pDevice, const C
 //------------------------------------------------------------------------------------------
 static uint8_t MemoryCard_ProcessDataTransferNonBlock(CSDD_SDIO_Device* pDevice, uint32_t Address,
                                                       void* Buffer, uint32_t BufferSize, CSDD_TransferDirection TransferDirection,
-                                                      const CSDD_MEMORY_CARD_INFO* pCard, void **Request)
+                                                      const CSDD_MEMORY_CARD_INFO* pCard, CSDD_RequestCompleteCallback Callback,
+                                                      void *UserContext, CSDD_Request* pRequest)
 {
     uint8_t Status = SDIO_ERR_NO_ERROR;
     uint8_t TransMode;
@@ -656,10 +668,10 @@ static uint8_t MemoryCard_ProcessDataTransferNonBlock(CSDD_SDIO_Device* pDevice,
             if (pDevice->CMD23Supported != 0U) {
                 // block count and block length are necessary to
                 // specify data transmission mode type
-                gRequest.pCmd->blockCount = BlockCount;
-                gRequest.pCmd->blockLen = BlockLen;
-                gRequest.pCmd->requestFlags.isInfinite = 0;
-                TransMode = DMA_SpecifyTransmissionMode(pDevice->pSlot, &gRequest);
+                pRequest->pCmd->blockCount = BlockCount;
+                pRequest->pCmd->blockLen = BlockLen;
+                pRequest->pCmd->requestFlags.isInfinite = 0;
+                TransMode = DMA_SpecifyTransmissionMode(pDevice->pSlot, pRequest);
                 if ((TransMode != (uint8_t)CSDD_SDMA_MODE) /*&& USE_AUTO_CMD*/) {
                     // if card supports CMD23, and auto command should be used and
                     // transmission mode is not SDMA then use auto CMD23
@@ -678,13 +690,14 @@ static uint8_t MemoryCard_ProcessDataTransferNonBlock(CSDD_SDIO_Device* pDevice,
         if (Status != SDIO_ERR_NO_ERROR) {
             vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", Status);
         } else {
-            *Request = &gRequest;
-            SDIO_REQ_INIT_CMD_WITH_DATA(&gRequest, &((SD_CsddRequesParams){.cmd = Command, .arg = argument,
+            SDIO_REQ_INIT_CMD_WITH_DATA(pRequest, &((SD_CsddRequesParams){.cmd = Command, .arg = argument,
                                                                            .cmdType = CSDD_CMD_TYPE_NORMAL, .respType = CSDD_RESPONSE_R1, .hwRespCheck = 0}),
                                         &((SD_CsddRequesParamsExt){.buf = Buffer, .blkCount = BlockCount, .blkLen = BlockLen,
                                                                    .auto12 = autoCMD12Enable, .auto23 = autoCMD23Enable, .dir = TransferDirection}));
+            pRequest->completeCallback = (Callback != NULL) ? RequestComplete : NULL;
+            pRequest->userContext = UserContext;
             // start data transfer
-            SDIOHost_ExecCardCommand( pDevice->pSlot, &gRequest );
+            SDIOHost_ExecCardCommand( pDevice->pSlot, pRequest );
 
         }
     }
@@ -696,9 +709,10 @@ static uint8_t MemoryCard_ProcessDataTransferNonBlock(CSDD_SDIO_Device* pDevice,
 //------------------------------------------------------------------------------------------
 uint8_t MemoryCard_DataXferNonBlock(CSDD_SDIO_Device* pDevice, uint32_t Address,
                                         void* Buffer, uint32_t BufferSize, CSDD_TransferDirection TransferDirection,
-                                        void **Request)
+                                        CSDD_RequestCompleteCallback Callback, void *UserContext, void **Request)
 {
     CSDD_MEMORY_CARD_INFO* pCard;
+    CSDD_Request* pRequest;
     bool isTransferNeeded;
     uint8_t Status;
 
@@ -713,9 +727,27 @@ uint8_t MemoryCard_DataXferNonBlock(CSDD_SDIO_Device* pDevice, uint32_t Address,
 
         if (Status == SDIO_ERR_NO_ERROR) {
 
-            Status = MemoryCard_ProcessDataTransferNonBlock(pDevice, Address,
-                                                            Buffer, BufferSize, TransferDirection,
-                                                            pCard, Request);
+            pRequest = GetUnusedRequest(pDevice->pSlot, Callback);
+
+            if (pRequest == NULL) {
+                vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", SDIO_ERR_MEM_ALLOC);
+                Status = SDIO_ERR_MEM_ALLOC;
+            } else {
+                Status = MemoryCard_ProcessDataTransferNonBlock(pDevice, Address,
+                                                                Buffer, BufferSize, TransferDirection,
+                                                                pCard, Callback, UserContext, pRequest);
+                if (Status != SDIO_ERR_NO_ERROR) {
+                    FreeRequest(pDevice->pSlot, pRequest);
+                } else if ((Callback == NULL) && (pRequest->status != SDIO_STATUS_PENDING)
+                           && (pRequest->status != SDIO_ERR_NO_ERROR)) {
+                    // rejected or failed already, there is nothing to finish.
+                    // Request with callback goes back to the pool in RequestComplete
+                    Status = pRequest->status;
+                    FreeRequest(pDevice->pSlot, pRequest);
+                } else {
+                    *Request = pRequest;
+                }
+            }
         }
     }
 
@@ -732,7 +764,21 @@ uint8_t MemoryCard_DataXfer(CSDD_SDIO_Device* pDevice, uint32_t Address,
 //------------------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------------------
-static uint8_t MemoryCard_DataXfer2CheckPrecond(const CSDD_SDIO_Device* pDevice,
+static bool MemoryCard_SubBuffersSizeMatch(const CSDD_SubBuffer* pSubBuffers, uint32_t SubBufferCount, uint32_t BufferSize)
+{
+    uint64_t size = 0U;
+    uint32_t i;
+
+    for (i = 0; i < SubBufferCount; i++) {
+        size += pSubBuffers[i].size;
+    }
+
+    return ((SubBufferCount == 0U) || (size == BufferSize));
+}
+//------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------
+static uint8_t MemoryCard_DataXfer2CheckPrecond(const CSDD_SDIO_Device* pDevice, const void* Buffer,
                                                     uint32_t BufferSize, CSDD_TransferDirection TransferDirection,
                                                     uint32_t SubBufferCount, bool* transferNeeded)
 {
@@ -742,6 +788,9 @@ static uint8_t MemoryCard_DataXfer2CheckPrecond(const CSDD_SDIO_Device* pDevice,
     if ((BufferSize % 512U) != 0U) {
         vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", SDIO_ERR_INVALID_PARAMETER);
         status = SDIO_ERR_INVALID_PARAMETER;
+    } else if (!MemoryCard_SubBuffersSizeMatch(Buffer, SubBufferCount, BufferSize)) {
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", SDIO_ERR_INVALID_PARAMETER);
+        status = SDIO_ERR_INVALID_PARAMETER;
     } else if ( pDevice == NULL ) {
         status = SDIO_ERR_DEV_NULL_POINTER;
     } else if ((BufferSize == 0U) && (SubBufferCount == 0U)) {
@@ -850,6 +899,7 @@ static uint8_t MemoryCard_ProcessDataTransfer2( CSDD_SDIO_Device* pDevice, uint3
             // specify data transmission mode type
             Request.pCmd->blockCount = BlockCount;
             Request.pCmd->blockLen = BlockLen;
+            Request.pCmd->subBuffersCount = SubBufferCount;
             Request.pCmd->requestFlags.isInfinite = 0;
             TransMode = DMA_SpecifyTransmissionMode(pDevice->pSlot, &Request);
             if ((TransMode != (uint8_t)CSDD_SDMA_MODE) && USE_AUTO_CMD) {
@@ -878,7 +928,7 @@ static uint8_t MemoryCard_ProcessDataTransfer2( CSDD_SDIO_Device* pDevice, uint3
                                                                                         .cmdType = CSDD_CMD_TYPE_NORMAL, .respType = CSDD_RESPONSE_R1, .hwRespCheck = 1}),
                                                                 &((SD_CsddRequesParamsExt){.buf = Buffer, .blkCount = BlockCount, .blkLen = BlockLen,
                                                                                            .auto12 = autoCMD12Enable, .auto23 = autoCMD23Enable, .dir = TransferDirection,
-                                                                                           .subBuffersCount = (uint8_t)SubBufferCount}));
+                                                                                           .subBuffersCount = SubBufferCount}));
 
     }
 
@@ -897,7 +947,7 @@ uint8_t MemoryCard_DataXfer2( CSDD_SDIO_Device* pDevice, uint32_t Address,
     uint8_t Status;
     bool isTransferNeeded;
 
-    Status = MemoryCard_DataXfer2CheckPrecond(pDevice,
+    Status = MemoryCard_DataXfer2CheckPrecond(pDevice, Buffer,
                                                   BufferSize, TransferDirection,
                                                   SubBufferCount, &isTransferNeeded);
 
@@ -919,6 +969,228 @@ uint8_t MemoryCard_DataXfer2( CSDD_SDIO_Device* pDevice, uint32_t Address,
 }
 //------------------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------------------
+static uint8_t MemoryCard_BatchXferCheckPrecond(const CSDD_SDIO_Device* pDevice, const CSDD_MemBatchEntry* pEntries,
+                                                uint32_t EntryCount)
+{
+    uint8_t status;
+    uint32_t i;
+
+    if (pDevice == NULL) {
+        status = SDIO_ERR_DEV_NULL_POINTER;
+    } else if ((pDevice->pSlot == NULL) || (pDevice->CardDriverData == NULL)) {
+        status = SDIO_ERR_INVALID_PARAMETER;
+    } else {
+        status = SDIO_ERR_NO_ERROR;
+    }
+
+    for (i = 0; (i < EntryCount) && (status == SDIO_ERR_NO_ERROR); i++) {
+        if ((pEntries[i].buffer == NULL) || (pEntries[i].size == 0U) || ((pEntries[i].size % 512U) != 0U)) {
+            vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", SDIO_ERR_INVALID_PARAMETER);
+            status = SDIO_ERR_INVALID_PARAMETER;
+        } else if ((pEntries[i].direction != CSDD_TRANSFER_READ) && (pEntries[i].direction != CSDD_TRANSFER_WRITE)) {
+            status = SDIO_ERR_INVALID_PARAMETER;
+        } else if (!DMA_BufferAligned(pDevice->pSlot, pEntries[i].buffer)) {
+            // ADMA3 chain has no bounce buffer, each entry is transferred in place
+            vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", SDIO_ERR_INVALID_PARAMETER);
+            status = SDIO_ERR_INVALID_PARAMETER;
+        } else if (IsWriteToWriteProtectedSd(pDevice, pEntries[i].direction)) {
+            status = SDIO_ERR_CARD_WRITE_PROTECTED;
+        } else {
+            // All 'if ... else if' constructs shall be terminated with an 'else' statement
+            // (MISRA2012-RULE-15_7-3)
+        }
+    }
+
+    return (status);
+}
+//------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------
+/// Executes up to CSDD_MAX_NUMBER_COMMAND entries as one ADMA3 request
+static uint8_t MemoryCard_ProcessBatchChain(CSDD_SDIO_Device* pDevice, const CSDD_MemBatchEntry* pEntries,
+                                            uint8_t EntryCount, const CSDD_MEMORY_CARD_INFO* pCard)
+{
+    CSDD_Request Request = {0};
+    uint8_t Status = SDIO_ERR_NO_ERROR;
+    uint32_t BlockCount, argument;
+    uint16_t BlockLen;
+    uint8_t i;
+
+    for (i = 0; i < EntryCount; i++) {
+        MemoryCard_ProcessDataTransfer2CalcArgAndBlockLen(pDevice, pEntries[i].address, pCard, &argument, &BlockLen);
+        BlockCount = ((pEntries[i].size - 1U) / pCard->BlockSize) + 1U;
+
+        SDIO_REQ_INIT_CMD_DATA_ADMA3(&Request.pCmd[i],
+                                     &((SD_CsddRequesParams){.cmd = MemoryCard_DataXferCalcCommand(BlockCount, pEntries[i].direction),
+                                                             .arg = argument, .cmdType = CSDD_CMD_TYPE_NORMAL,
+                                                             .respType = CSDD_RESPONSE_R1, .hwRespCheck = 1}),
+                                     &((SD_CsddRequesParamsADMA3Ext){.buf = pEntries[i].buffer, .blkCount = BlockCount,
+                                                                     .blkLen = BlockLen, .dir = pEntries[i].direction,
+                                                                     .subBuffersCount = 0}));
+    }
+    SDIO_REQ_INIT_CMD_DATA_MULTI(&Request, EntryCount);
+
+    if (DMA_SpecifyTransmissionMode(pDevice->pSlot, &Request) != (uint8_t)CSDD_ADMA3_MODE) {
+        // commands can be chained only by ADMA3 descriptors
+        Status = SDIO_ERR_UNSUPORRTED_OPERATION;
+    } else {
+        // one interrupt when the last command of the chain is finished
+        SDIOHost_ExecCardCommand( pDevice->pSlot, &Request );
+        SDIOHost_CheckBusy(Request.pSdioHost, &Request);
+        Status = Request.status;
+    }
+
+    if (Status != SDIO_ERR_NO_ERROR) {
+        vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", Status);
+    }
+
+    return (Status);
+}
+//------------------------------------------------------------------------------------------
+
+// Addresses are in block (512 Byte) units
+//------------------------------------------------------------------------------------------
+uint8_t MemoryCard_BatchXfer( CSDD_SDIO_Device* pDevice, const CSDD_MemBatchEntry* pEntries,
+                              uint32_t EntryCount )
+{
+    CSDD_MEMORY_CARD_INFO* pCard;
+    uint8_t Status;
+    uint32_t Done = 0U;
+    uint32_t Count;
+
+    Status = MemoryCard_BatchXferCheckPrecond(pDevice, pEntries, EntryCount);
+
+    if ((Status == SDIO_ERR_NO_ERROR) && (EntryCount != 0U)) {
+
+        pCard = pDevice->CardDriverData;
+
+        Status = MemoryCard_SetBlockLengthTo512(pDevice, pCard);
+
+        if (Status == SDIO_ERR_NO_ERROR) {
+            (void)SDIOHost_SelectCard( pDevice->pSlot, pDevice->RCA );
+        }
+
+        while ((Status == SDIO_ERR_NO_ERROR) && (Done < EntryCount)) {
+            Count = EntryCount - Done;
+            if (Count > CSDD_MAX_NUMBER_COMMAND) {
+                Count = CSDD_MAX_NUMBER_COMMAND;
+            }
+            Status = MemoryCard_ProcessBatchChain(pDevice, &pEntries[Done], (uint8_t)Count, pCard);
+            Done += Count;
+        }
+    }
+
+    return (Status);
+}
+//------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------
+/// Measures average timing of reads of Size bytes in the DMA mode set in the slot,
+/// the first transfer is not measured
+static uint8_t MemoryCard_CalibrateMode(CSDD_SDIO_Device* pDevice, uint32_t Address, void* Buffer,
+                                        uint32_t Size, CSDD_DmaCalTiming* pTiming)
+{
+    CSDD_SDIO_Slot* pSlot = pDevice->pSlot;
+    uint8_t Status = SDIO_ERR_NO_ERROR;
+    uint64_t WallNs = 0U;
+    uint64_t CpuNs = 0U;
+    uint64_t StartNs, StartCpuNs;
+    uint32_t i;
+
+    for (i = 0; (i <= SDIO_CFG_DMA_CAL_REPEATS) && (Status == SDIO_ERR_NO_ERROR); i++) {
+        StartNs = CPS_GetTimeNs();
+        StartCpuNs = pSlot->DmaCalCpuNs;
+        Status = MemoryCard_DataXfer2(pDevice, Address, Buffer, Size, CSDD_TRANSFER_READ, 0);
+        if (i != 0U) {
+            WallNs += CPS_GetTimeNs() - StartNs;
+            CpuNs += pSlot->DmaCalCpuNs - StartCpuNs;
+        }
+    }
+
+    if (Status == SDIO_ERR_NO_ERROR) {
+        pTiming->wallNs = WallNs / SDIO_CFG_DMA_CAL_REPEATS;
+        pTiming->cpuNs = CpuNs / SDIO_CFG_DMA_CAL_REPEATS;
+    }
+
+    return (Status);
+}
+//------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------
+static uint8_t MemoryCard_CalibrateClass(CSDD_SDIO_Device* pDevice, uint32_t Address, void* Buffer,
+                                         uint8_t Class, CSDD_DmaCalibration* pResult)
+{
+    // ADMA1 is not measured, auto DMA mode may use it only for 4 KB
+    // aligned buffers and blocks and the selection is by size only
+    static const uint8_t Modes[] = {
+        (uint8_t)CSDD_NONEDMA_MODE, (uint8_t)CSDD_SDMA_MODE,
+        (uint8_t)CSDD_ADMA2_MODE, (uint8_t)CSDD_ADMA3_MODE
+    };
+    CSDD_SDIO_Slot* pSlot = pDevice->pSlot;
+    CSDD_DmaCalTiming* pTiming;
+    uint8_t Status = SDIO_ERR_NO_ERROR;
+    uint32_t i;
+
+    for (i = 0; (i < (sizeof(Modes) / sizeof(Modes[0]))) && (Status == SDIO_ERR_NO_ERROR); i++) {
+        if (DMA_ModeSupported(pSlot, Modes[i])) {
+            if (Modes[i] == (uint8_t)CSDD_NONEDMA_MODE) {
+                pTiming = &pResult->pio[Class];
+            } else {
+                pTiming = &pResult->dma[Class][Modes[i]];
+            }
+            pSlot->DmaMode = Modes[i];
+            Status = MemoryCard_CalibrateMode(pDevice, Address, Buffer, pResult->size[Class], pTiming);
+        }
+    }
+
+    return (Status);
+}
+//------------------------------------------------------------------------------------------
+
+// Address is in block (512 Byte) units
+//------------------------------------------------------------------------------------------
+uint8_t MemoryCard_CalibrateDmaMode(CSDD_SDIO_Device* pDevice, uint32_t Address, void* Buffer,
+                                    uint32_t BufferSize, CSDD_DmaCalibration* pResult)
+{
+    CSDD_SDIO_Slot* pSlot;
+    uint8_t Status = SDIO_ERR_NO_ERROR;
+    uint8_t SavedMode;
+    uint32_t Size = 512U;
+    uint8_t Class;
+
+    if (pDevice == NULL) {
+        Status = SDIO_ERR_DEV_NULL_POINTER;
+    } else if ((pDevice->pSlot == NULL) || (pDevice->CardDriverData == NULL) || (BufferSize < 512U)) {
+        Status = SDIO_ERR_INVALID_PARAMETER;
+    } else {
+        pSlot = pDevice->pSlot;
+        SavedMode = pSlot->DmaMode;
+
+        DataSet(pResult, 0, sizeof(*pResult));
+        DMA_ResetModeTable(pSlot);
+        pSlot->DmaCalActive = 1U;
+
+        for (Class = 0; (Class < SDIO_CFG_DMA_CAL_CLASSES) && (Size <= BufferSize) && (Status == SDIO_ERR_NO_ERROR); Class++) {
+            pResult->size[Class] = Size;
+            Status = MemoryCard_CalibrateClass(pDevice, Address, Buffer, Class, pResult);
+            Size <<= 2;
+        }
+
+        pSlot->DmaCalActive = 0U;
+        pSlot->DmaMode = SavedMode;
+
+        if (Status == SDIO_ERR_NO_ERROR) {
+            DMA_ApplyCalibration(pSlot, pResult);
+        } else {
+            vDbgMsg(DBG_GEN_MSG, DBG_CRIT, "Error %d\n", Status);
+        }
+    }
+
+    return (Status);
+}
+//------------------------------------------------------------------------------------------
+
 // Address is in block (512 Byte) units
 //------------------------------------------------------------------------------------------
 uint8_t MemoryCard_InfXferStart(CSDD_SDIO_Device* pDevice, uint32_t Address, void* Buffer,
@@ -966,17 +1238,17 @@ uint8_t MemoryCard_InfXferStart(CSDD_SDIO_Device* pDevice, uint32_t Address, voi
             // multiple block transfer
             Command = (TransferDirection == CSDD_TRANSFER_WRITE) ? SDIO_CMD25 : SDIO_CMD18;
 
-            SDIO_REQ_INIT_CMD_DATA_INF_S(&gRequest, &((SD_CsddRequesParams){.cmd = Command, .arg = argument,
+            SDIO_REQ_INIT_CMD_DATA_INF_S(&pCard->InfRequest, &((SD_CsddRequesParams){.cmd = Command, .arg = argument,
                                                                             .cmdType = CSDD_CMD_TYPE_NORMAL, .respType = CSDD_RESPONSE_R1, .hwRespCheck = 0}),
                                               &((SD_CsddRequesParamsExt){.buf = Buffer, .blkCount = BlockCount, .blkLen = BlockLen,
                                                                          .dir = TransferDirection}));
 
             // start data transfer
-            SDIOHost_ExecCardCommand(pDevice->pSlot, &gRequest);
+            SDIOHost_ExecCardCommand(pDevice->pSlot, &pCard->InfRequest);
 
-            SDIOHost_CheckBusy(gRequest.pSdioHost, &gRequest);
+            SDIOHost_CheckBusy(pCard->InfRequest.pSdioHost, &pCard->InfRequest);
 
-            status = gRequest.status;
+            status = pCard->InfRequest.status;
         }
     }
 
@@ -1018,14 +1290,14 @@ uint8_t MemoryCard_InfXferContinue(CSDD_SDIO_Device* pDevice,
 
         BlockCount = ((BufferSize - 1U) / pCard->BlockSize) + 1U;
 
-        SDIO_REQ_INIT_CMD_DATA_INF_N(&gRequest, Buffer, BlockCount,
+        SDIO_REQ_INIT_CMD_DATA_INF_N(&pCard->InfRequest, Buffer, BlockCount,
                                     BlockLen, TransferDirection);
 
         // start data transfer
-        SDIOHost_ExecCardCommand( pDevice->pSlot, &gRequest );
-        SDIOHost_CheckBusy(gRequest.pSdioHost, &gRequest);
+        SDIOHost_ExecCardCommand( pDevice->pSlot, &pCard->InfRequest );
+        SDIOHost_CheckBusy(pCard->InfRequest.pSdioHost, &pCard->InfRequest);
 
-        status = gRequest.status;
+        status = pCard->InfRequest.status;
     }
 
     return (status);
@@ -1156,8 +1428,7 @@ uint8_t MemoryCard_DataErase(CSDD_SDIO_Device* pDevice, uint32_t StartBlockAddre
 static uint8_t MemoryCard_ConfigureExecCmd(CSDD_SDIO_Device* pDevice, CSDD_MmcConfigCmd Cmd,
                                            const uint8_t* Data, uint8_t SizeOfData, CSDD_MEMORY_CARD_INFO* pCard)
 {
-    static uint8_t cfgBuffer[512];
-
+    uint8_t* cfgBuffer = pDevice->pSlot->LockCmdBuffer;
     uint8_t status;
     CSDD_Request Request = {0};
     uint32_t i;
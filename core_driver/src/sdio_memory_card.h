@@ -41,42 +41,14 @@
 #include "sdio_types.h"
 #include "csdd_if.h"
 
-struct MEMORY_CARD_INFO_s {
-    /// Block size
-    uint16_t BlockSize;
-    /// Card command classes
-    uint16_t commandClasses;
-    /// Device size
-    uint32_t DeviceSizeMB;
-    /// Defines whether partial block sizes can be used in block read commands.
-    uint8_t PartialReadAllowed;
-    /// Defines whether partial block sizes can be used in block write commands.
-    uint8_t PartialWriteAllowed;
-    /// Defines if the data block to be written by one command can be
-    /// spread over more than one physical block of the memory device.
-    uint8_t WriteBlkMisalign;
-    /// Defines if the data block to be read by one command can be
-    /// spread over more than one physical block of the memory device.
-    uint8_t ReadBlkMisalign;
-    /// The size of an erasable sector.
-    /// The content of this register is a 7-bit binary coded value, defining the
-    /// number of write blocks (see WRITE_BL_LEN
-    uint16_t SectorSize;
-    /// The EraseBlkEn defines the granularity of the unit size of the data to be erased.
-    uint8_t EraseBlkEn;
-    /// The maximum read data block length.
-    uint8_t ReadBlLen;
-    /// The maximum write data block length.
-    uint8_t WriteBlLen;
-};
-
 /***************************************************************/
 /*!
- * @fn       void MemoryCard_LoadDriver(void)
+ * @fn       void MemoryCard_LoadDriver(CSDD_SDIO_Host* pSdioHost)
  * @brief   Function loads memory card driver to host drivers list
+ * @param   pSdioHost host to which list the driver is added
  */
 /***************************************************************/
-void MemoryCard_LoadDriver(void);
+void MemoryCard_LoadDriver(CSDD_SDIO_Host* pSdioHost);
 
 /***************************************************************/
 /*!
@@ -127,7 +99,7 @@ uint8_t MemoryCard_DataXfer( CSDD_SDIO_Device*           pDevice,
  *              to find something out
  * @param   SubBufferCount if parameter is bigger than 0
  *		the Buffer parameter is treated as array of CSDD_SubBuffer
- *		pointers.
+ *		with DMA addresses, their sizes must add up to BufferSize.
  * @return  Function returns 0 if everything is ok
  *              otherwise returns error number
  */
@@ -139,6 +111,55 @@ uint8_t MemoryCard_DataXfer2( CSDD_SDIO_Device*           pDevice,
                                   CSDD_TransferDirection TransferDirection,
                                   uint32_t               SubBufferCount );
 
+/***************************************************************/
+/*!
+ * @fn      uint8_t MemoryCard_BatchXfer( CSDD_SDIO_Device* pDevice,
+ *                                        const CSDD_MemBatchEntry* pEntries,
+ *                                        uint32_t EntryCount )
+ * @brief   Function executes independent block transfers as commands
+ *              of one ADMA3 integrated descriptor chain, up to
+ *              CSDD_MAX_NUMBER_COMMAND commands per chain.
+ *              Controller interrupts once per chain.
+ * @param   pDevice Device card to which data shall be send
+ * @param   pEntries array of transfers, addresses are in 512 bytes blocks
+ * @param   EntryCount number of transfers
+ * @return  Function returns 0 if everything is ok
+ *              otherwise returns error number.
+ *              SDIO_ERR_UNSUPORRTED_OPERATION is returned if
+ *              ADMA3 cannot be used
+ */
+/***************************************************************/
+uint8_t MemoryCard_BatchXfer( CSDD_SDIO_Device*         pDevice,
+                              const CSDD_MemBatchEntry* pEntries,
+                              uint32_t                  EntryCount );
+
+/***************************************************************/
+/*!
+ * @fn      uint8_t MemoryCard_CalibrateDmaMode( CSDD_SDIO_Device* pDevice,
+ *                                               uint32_t Address,
+ *                                               void* Buffer,
+ *                                               uint32_t BufferSize,
+ *                                               CSDD_DmaCalibration* pResult )
+ * @brief   Function measures reads of each transfer size class
+ *              in all DMA modes supported by the slot and without DMA,
+ *              and stores DMA mode selection table used by auto mode.
+ *              Classes bigger than the buffer are not measured.
+ * @param   pDevice Device card which is read
+ * @param   Address Addres in 512 bytes blocks on memory card where data
+ *              is read from.
+ * @param   Buffer Buffer aligned for DMA to read data to
+ * @param   BufferSize Size of Buffer in bytes
+ * @param   pResult measured timings and selected modes
+ * @return  Function returns 0 if everything is ok
+ *              otherwise returns error number
+ */
+/***************************************************************/
+uint8_t MemoryCard_CalibrateDmaMode( CSDD_SDIO_Device*    pDevice,
+                                     uint32_t             Address,
+                                     void*                Buffer,
+                                     uint32_t             BufferSize,
+                                     CSDD_DmaCalibration* pResult );
+
 /***************************************************************/
 /*!
  * @fn      uint8_t MemoryCard_Configure ( CSDD_SDIO_Device* pDevice, CSDD_MmcConfigCmd Cmd,
@@ -283,7 +304,8 @@ uint8_t MemoryCard_InfDataXferFinish(CSDD_SDIO_Device*           pDevice,
  *                                              uint32_t Address, void* Buffer,
  *                                              uint32_t BufferSize,
  *                                              CSDD_TransferDirection TransferDirection,
- *                                              void **Request)
+ *                                              CSDD_RequestCompleteCallback Callback,
+ *                                              void *UserContext, void **Request)
  * @brief   Function transfers data to/from memory card.
  *              Function operates on 512 data blocks. Function don't wait on
  *              operation finish. Therefore it returns pointer to current request
@@ -291,6 +313,11 @@ uint8_t MemoryCard_InfDataXferFinish(CSDD_SDIO_Device*           pDevice,
  *              request pointer can wait until operation finish
  *              and  get the status of operation. Function needs
  *              AUTO_CMD option enabled.
+ *              Request is taken from the memory card request pool, so
+ *              several transfers can be in flight on different slots.
+ *              Request goes back to the pool in MemoryCard_FinishXferNonBlock
+ *              or, if Callback is not NULL, after Callback returns.
+ *              In the latter case request must not be used after Callback.
  * @param   pDevice Device card to which data shall be send
  * @param   Address Addres in 512 bytes blocks on memory card where data
  *              shall be transfer to/from.
@@ -300,21 +327,27 @@ uint8_t MemoryCard_InfDataXferFinish(CSDD_SDIO_Device*           pDevice,
  * @param   TransferDirection This parameter defines transfer direction
  *              please see the @ref TransferDirections definitions
  *              to find something out
+ * @param   Callback function called when the request finishes, may be NULL
+ * @param   UserContext pointer passed to Callback
  * @param   Request defining transfer operation
- * @return  Function returns 0 if everything is ok
+ * @return  Function returns 0 if everything is ok,
+ *              SDIO_ERR_MEM_ALLOC if all requests from the pool are in use
  *              otherwise returns error number
  */
 /*****************************************************************************/
 uint8_t MemoryCard_DataXferNonBlock(CSDD_SDIO_Device* pDevice, uint32_t Address,
                                         void* Buffer, uint32_t BufferSize,
                                         CSDD_TransferDirection TransferDirection,
-                                        void **Request);
+                                        CSDD_RequestCompleteCallback Callback,
+                                        void *UserContext, void **Request);
 
 /*****************************************************************************/
 /*!
  * @fn      uint8_t MemoryCard_FinishXferNonBlock(CSDD_Request* pRequest)
  * @brief   Function waits until request finish
- *          and returns status of request execution
+ *          and returns status of request execution.
+ *          Request taken from the memory card request pool is released,
+ *          it must not be used after this call
  * @param   pRequest request to wait on
  * @return  Function returns 0 if everything is OK
  *              otherwise returns error number
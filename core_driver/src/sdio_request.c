@@ -58,6 +58,8 @@ void SDIO_REQ_INIT_CMD(CSDD_Request* req, const SD_CsddRequesParams* params)
     req->pCmd->blockLen = 0;
     req->status = 1;
     req->commandCategory = CSDD_CMD_CAT_NORMAL;
+    req->completeCallback = NULL;
+    req->userContext = NULL;
     req->cmdCount = 1;
 }
 
@@ -77,6 +79,8 @@ void SDIO_REQ_INIT_ACMD(CSDD_Request* req, const SD_CsddRequesParams* params)
     req->pCmd->blockCount = 0;
     req->pCmd->blockLen = 0;
     req->commandCategory = CSDD_CMD_CAT_NORMAL;
+    req->completeCallback = NULL;
+    req->userContext = NULL;
     req->cmdCount = 1;
 }
 
@@ -101,6 +105,8 @@ void SDIO_REQ_INIT_CMD_WITH_DATA(CSDD_Request* req, const SD_CsddRequesParams* p
     req->pCmd->subBuffersCount = paramsExt->subBuffersCount;
     req->pCmd->requestFlags.isInfinite = 0;
     req->commandCategory = CSDD_CMD_CAT_NORMAL;
+    req->completeCallback = NULL;
+    req->userContext = NULL;
     req->cmdCount = 1;
 }
 
@@ -126,6 +132,8 @@ void SDIO_REQ_INIT_CMD_DATA_INF_S(CSDD_Request* req, const SD_CsddRequesParams*
     req->pCmd->requestFlags.isInfinite = 1;
     req->infiniteStatus = SDIOHOST_REQUEST_ISTATUS_FIRST;
     req->commandCategory = CSDD_CMD_CAT_NORMAL;
+    req->completeCallback = NULL;
+    req->userContext = NULL;
     req->cmdCount = 1;
 }
 
@@ -153,3 +161,23 @@ void SDIO_REQ_INIT_CMD_DATA_MULTI(CSDD_Request* req, uint8_t cmdCount)
     req->requestType = (uint8_t)CSDD_REQUEST_TYPE_SD;
 }
 
+void SDIO_REQ_INIT_CMD_DATA_ADMA3(CSDD_CommandField* pCmd, const SD_CsddRequesParams* params,
+                                  const SD_CsddRequesParamsADMA3Ext* paramsExt)
+{
+    pCmd->command = params->cmd;
+    pCmd->argument = params->arg;
+    pCmd->requestFlags.commandType = params->cmdType;
+    pCmd->requestFlags.responseType = params->respType;
+    pCmd->requestFlags.hwResponseCheck = params->hwRespCheck;
+    pCmd->blockCount = paramsExt->blkCount;
+    pCmd->blockLen = paramsExt->blkLen;
+    pCmd->pDataBuffer = paramsExt->buf;
+    pCmd->requestFlags.dataPresent = 1;
+    pCmd->requestFlags.dataTransferDirection = paramsExt->dir;
+    // auto CMD auto select is used by ADMA3 command descriptors
+    pCmd->requestFlags.autoCMD12Enable = 0;
+    pCmd->requestFlags.autoCMD23Enable = 0;
+    pCmd->requestFlags.appCmd = 0;
+    pCmd->subBuffersCount = paramsExt->subBuffersCount;
+    pCmd->requestFlags.isInfinite = 0;
+}
@@ -62,7 +62,7 @@ typedef struct {
     uint8_t auto23;
     CSDD_TransferDirection dir;
     uint8_t appCmd;
-    uint8_t subBuffersCount;
+    uint32_t subBuffersCount;
 } SD_CsddRequesParamsExt;
 
 typedef struct {
@@ -70,7 +70,7 @@ typedef struct {
     uint32_t blkCount;
     uint16_t blkLen;
     CSDD_TransferDirection dir;
-    uint8_t subBuffersCount;
+    uint32_t subBuffersCount;
 } SD_CsddRequesParamsADMA3Ext;
 
 void SDIO_REQ_INIT_CMD(CSDD_Request* req, const SD_CsddRequesParams* params);
@@ -88,4 +88,7 @@ void SDIO_REQ_INIT_CMD_DATA_INF_N(CSDD_Request* req, void* buf,
                                        CSDD_TransferDirection dir);
 void SDIO_REQ_INIT_CMD_DATA_MULTI(CSDD_Request* req, uint8_t cmdCount);
 
+void SDIO_REQ_INIT_CMD_DATA_ADMA3(CSDD_CommandField* pCmd, const SD_CsddRequesParams* params,
+                                  const SD_CsddRequesParamsADMA3Ext* paramsExt);
+
 #endif
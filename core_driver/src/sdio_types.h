@@ -57,12 +57,9 @@
 
 /**
  * @struct LIST_NODE
- * @brief Structure defines a list node
+ * @brief Structure defines a list node, nodes are kept in CSDD_SDIO_Host
  */
-typedef struct LIST_NODE_S {
-    CSDD_DeviceInfo* Item;
-    struct LIST_NODE_S *Next;
-} LIST_NODE;
+typedef CSDD_DeviceListNode LIST_NODE;
 
 
 #endif // SDIO_TYPES_H
@@ -75,50 +75,93 @@ uint8_t WaitForValue(volatile uint32_t* Address, uint32_t Mask, uint8_t IsSet,
                      uint32_t TimeUs)
 {
     uint8_t status = SDIO_ERR_NO_ERROR;
-    uint32_t TimeNs = TimeUs * 1000 + 100;
+    SDIO_PollTimer Timer;
+
+    PollTimerStart(&Timer, TimeUs);
 
     if (IsSet == 0U) {
         // wait until bit/bits will clear
         while (((CPS_REG_READ(Address) & Mask) != 0U)) {
-            CPS_DelayNs(100);
-            if (TimeNs < 100) {
-                status = SDIO_ERR_TIMEOUT;
+            status = PollTimerWait(&Timer);
+            if (status != SDIO_ERR_NO_ERROR) {
                 break;
             }
-            TimeNs -= 100;
-
         }
     } else {
         // wait until a bit/bits will set
         while (((CPS_REG_READ(Address) & Mask) == 0U)) {
-            CPS_DelayNs(100);
-            if (TimeNs < 100) {
-                status = SDIO_ERR_TIMEOUT;
+            status = PollTimerWait(&Timer);
+            if (status != SDIO_ERR_NO_ERROR) {
                 break;
             }
-            TimeNs -= 100;
         }
     }
     return (status);
 }
 /******************************************************************************/
 
+/******************************************************************************/
+void PollTimerStart(SDIO_PollTimer* pTimer, uint32_t TimeUs)
+{
+    pTimer->StartNs = CPS_GetTimeNs();
+    pTimer->DeadlineNs = pTimer->StartNs + ((uint64_t)TimeUs * 1000U);
+    pTimer->DelayNs = SDIO_CFG_POLL_MIN_DELAY_NS;
+}
+/******************************************************************************/
+
+/******************************************************************************/
+uint8_t PollTimerWait(SDIO_PollTimer* pTimer)
+{
+    uint8_t status = SDIO_ERR_NO_ERROR;
+    uint64_t NowNs = CPS_GetTimeNs();
+    uint64_t DelayNs = pTimer->DelayNs;
+
+    if (NowNs >= pTimer->DeadlineNs) {
+        status = SDIO_ERR_TIMEOUT;
+    } else {
+        // don't sleep past the deadline, last check is made just after it
+        if (DelayNs > (pTimer->DeadlineNs - NowNs)) {
+            DelayNs = pTimer->DeadlineNs - NowNs;
+        }
+        CPS_DelayNs((uint32_t)DelayNs);
+
+        // back off when the hardware stays busy longer than the spin time
+        if (((NowNs - pTimer->StartNs) >= SDIO_CFG_POLL_SPIN_NS)
+            && (pTimer->DelayNs < SDIO_CFG_POLL_MAX_DELAY_NS)) {
+            pTimer->DelayNs = GetMin(pTimer->DelayNs * 2U, SDIO_CFG_POLL_MAX_DELAY_NS);
+            // keep the delay small compared to the time already spent,
+            // this bounds how late the end of the wait is noticed
+            pTimer->DelayNs = (uint32_t)GetMin((uint64_t)pTimer->DelayNs,
+                                               GetMax((NowNs - pTimer->StartNs) / 8U, (uint64_t)SDIO_CFG_POLL_MIN_DELAY_NS));
+        }
+    }
+
+    return (status);
+}
+/******************************************************************************/
+
+/******************************************************************************/
+void PollTimerNoBackoff(SDIO_PollTimer* pTimer)
+{
+    pTimer->DelayNs = SDIO_CFG_POLL_MIN_DELAY_NS;
+}
+/******************************************************************************/
+
 
-static uint32_t Timer[SDIO_SLOT_COUNT];
 /******************************************************************************/
-void RetuningSetTimer(uint32_t Seconds, uint8_t TimerNumber)
+void RetuningSetTimer(uint32_t *Timer, uint32_t Seconds)
 {
-    Timer[TimerNumber] = Seconds;
+    *Timer = Seconds;
 }
 /******************************************************************************/
 
 /******************************************************************************/
-void RetuningGetTimer(uint32_t *Seconds, uint8_t TimerNumber)
+void RetuningGetTimer(uint32_t *Timer, uint32_t *Seconds)
 {
-    if (Timer[TimerNumber] > 0U) {
-        Timer[TimerNumber]--;
+    if (*Timer > 0U) {
+        (*Timer)--;
     }
-    *Seconds = Timer[TimerNumber];
+    *Seconds = *Timer;
 }
 /******************************************************************************/
 
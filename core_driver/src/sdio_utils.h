@@ -47,6 +47,16 @@
 /// macro gets one byte from dword
 #define GetByte(dword, byte_nr)     (((dword) >> ((byte_nr) * 8U)) & 0xFFU)
 
+/// State of a polling loop with timeout, see PollTimerStart
+typedef struct {
+    /// time when polling started
+    uint64_t StartNs;
+    /// time when polling times out
+    uint64_t DeadlineNs;
+    /// delay before the next check
+    uint32_t DelayNs;
+} SDIO_PollTimer;
+
 /*****************************************************************************/
 /*!
  * @fn          void DataSet(void *Destination, uint8_t Value, uint32_t Size)
@@ -79,34 +89,70 @@ void DataSet(void *Destination, uint8_t Value, size_t SizeArg);
 /*****************************************************************************/
 uint8_t WaitForValue(volatile uint32_t* Address, uint32_t Mask, uint8_t IsSet, uint32_t Time);
 
+/*****************************************************************************/
+/*!
+ * @fn          void PollTimerStart(SDIO_PollTimer* pTimer, uint32_t TimeUs)
+ * @brief       Function starts timeout measurement of a polling loop.
+ *                  Time is taken from CPS_GetTimeNs
+ * @param       pTimer polling loop state
+ * @param       TimeUs timeout in microseconds
+ */
+/*****************************************************************************/
+void PollTimerStart(SDIO_PollTimer* pTimer, uint32_t TimeUs);
 
 /*****************************************************************************/
 /*!
- * @fn          void RetuningSetTimer(uint32_t Seconds, uint8_t TimerNumber)
+ * @fn          uint8_t PollTimerWait(SDIO_PollTimer* pTimer)
+ * @brief       Function waits before the next check of a polling loop.
+ *                  Checks are frequent for SDIO_CFG_POLL_SPIN_NS,
+ *                  later the delay doubles on every call up to
+ *                  SDIO_CFG_POLL_MAX_DELAY_NS. Delay never goes past
+ *                  the deadline, so the caller always makes one more
+ *                  check after the timeout has elapsed
+ * @param       pTimer polling loop state
+ * @return      Function returns SDIO_ERR_TIMEOUT if the deadline was
+ *                  already reached when the function was called,
+ *                  otherwise returns 0
+ */
+/*****************************************************************************/
+uint8_t PollTimerWait(SDIO_PollTimer* pTimer);
+
+/*****************************************************************************/
+/*!
+ * @fn          void PollTimerNoBackoff(SDIO_PollTimer* pTimer)
+ * @brief       Function drops the back off of a polling loop, the next
+ *                  check is made after SDIO_CFG_POLL_MIN_DELAY_NS.
+ *                  It is called on every pass while the hardware needs
+ *                  prompt service. Timeout is not changed
+ * @param       pTimer polling loop state
+ */
+/*****************************************************************************/
+void PollTimerNoBackoff(SDIO_PollTimer* pTimer);
+
+
+/*****************************************************************************/
+/*!
+ * @fn          void RetuningSetTimer(uint32_t *Timer, uint32_t Seconds)
  * @brief       Function sets Timer with Seconds parameter value.
  *                  Timer is used to specify when re-tuning procedure
  *                  have to be executed
+ * @param       Timer re-tuning timer of the slot
  * @param       Seconds number of seconds to set
- * @param       TimerNumber timer number to set
- * @return      Function returns 0 if everything is ok
- *                  otherwise returns error number
  */
 /*****************************************************************************/
-void RetuningSetTimer(uint32_t Seconds, uint8_t TimerNumber);
+void RetuningSetTimer(uint32_t *Timer, uint32_t Seconds);
 
 /*****************************************************************************/
 /*!
- * @fn          void RetuningGetTimer(uint32_t *Seconds, uint8_t TimerNumber)
- * @brief       Function gets Timer value.
+ * @fn          void RetuningGetTimer(uint32_t *Timer, uint32_t *Seconds)
+ * @brief       Function decrements Timer and gets its value.
  *                  Timer is used to specify when re-tuning procedure
  *                  have to be executed
- * @param       Seconds number of seconds to set
- * @param       TimerNumber timer number to set
- * @return      Function returns 0 if everything is ok
- *                  otherwise returns error number
+ * @param       Timer re-tuning timer of the slot
+ * @param       Seconds number of seconds left
  */
 /*****************************************************************************/
-void RetuningGetTimer(uint32_t *Seconds, uint8_t TimerNumber);
+void RetuningGetTimer(uint32_t *Timer, uint32_t *Seconds);
 
 uint32_t GetTimeUs(void);
 uint8_t IsTimeAfter(uint32_t startTime, uint32_t requestedTime);
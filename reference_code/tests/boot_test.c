@@ -274,6 +274,8 @@ int CSSD_RunFunctionalTests(void)
     config.descPhyAddress = config.descLogAddress;
     config.idDescLogAddress = (uint32_t*)malloc(sysReq.idDescSize);
     config.idDescPhyAddress = config.idDescLogAddress;
+    config.bounceLogAddress = malloc(sysReq.bounceSize);
+    config.bouncePhyAddress = config.bounceLogAddress;
     config.regBase = SDHC0_REGS_APB_BASE;
 
     if (sizeof(void*) > 4) {
@@ -40,19 +40,27 @@
  */
 #ifdef __BARE_METAL__
 
+#define _POSIX_C_SOURCE 199309L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <time.h>
 #include "cps.h"
 
+static uint64_t regReads = 0;
+static uint64_t regWrites = 0;
+
 /* see cps.h */
 uint32_t CPS_ReadReg32(volatile uint32_t* address) {
+    regReads++;
     return *address;
 }
 
 /* see cps.h */
 void CPS_WriteReg32(volatile uint32_t* address, uint32_t value) {
+    regWrites++;
     *address = value;
 }
 
@@ -78,6 +86,7 @@ uint64_t CPS_UncachedRead64(volatile uint64_t* address) {
 
 /* see cps.h */
 extern uint64_t CPS_ReadReg64(volatile uint64_t* address) {
+    regReads++;
     return *address;
 }
 
@@ -103,6 +112,7 @@ void CPS_UncachedWrite64(volatile uint64_t* address, uint64_t value) {
 
 /* see cps.h */
 extern void CPS_WriteReg64(volatile uint64_t* address, uint64_t value) {
+    regWrites++;
     *address = value;
 }
 
@@ -132,10 +142,32 @@ void CPS_CacheFlush(void* address, size_t size, uintptr_t devInfo) {
     return;
 }
 
+/* see cps.h
+ * Time is read from a free-running monotonic counter, a platform without
+ * clock_gettime reads its architecture timer here instead */
+uint64_t CPS_GetTimeNs(void)
+{
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000U) + (uint64_t)now.tv_nsec;
+}
+
 /* see cps.h */
 void CPS_DelayNs(uint32_t ns)
 {
-    return;
+    const uint64_t end = CPS_GetTimeNs() + ns;
+
+    while (CPS_GetTimeNs() < end) {
+        /* busy wait, there is no scheduler to yield to */
+    }
+}
+
+/* see cps.h */
+void CPS_GetRegAccessCount(uint64_t* reads, uint64_t* writes)
+{
+    *reads = regReads;
+    *writes = regWrites;
 }
 
 /* see cps.h */
@@ -153,4 +185,20 @@ void CPS_MemoryBarrierRead(void) {
 
 }
 
+/* Compare and swap must be atomic also against interrupt handlers,
+ * compiler builtins are used, a platform without them shall disable
+ * interrupts around the compare and write instead */
+
+/* see cps.h */
+bool CPS_AtomicCompareSwap32(volatile uint32_t* address, uint32_t expected, uint32_t value) {
+    return __atomic_compare_exchange_n(address, &expected, value, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+/* see cps.h */
+bool CPS_AtomicCompareSwapPtr(void* volatile* address, void* expected, void* value) {
+    return __atomic_compare_exchange_n(address, &expected, value, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
 #endif /* __BARE_METAL__ */
@@ -43,6 +43,7 @@
 #include <csp.h>
 #include <csdd_obj_if.h>
 #include <csdd_structs_if.h>
+#include <sdio_errors.h>
 #include <sdio_dfi.h>
 #include <irq.h>
 #include <common.h>
@@ -396,60 +397,1259 @@ uint8_t ADMA3Test(uint8_t slotIndex, uint32_t sectorNumber)
     return status;
 }
 
+#define BATCH_ENTRIES 12
+
+uint8_t BatchXferTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    /* more entries than one ADMA3 chain takes, blocks are not adjacent */
+    CSDD_MemBatchEntry entries[BATCH_ENTRIES];
+    const uint32_t EntrySize = 1024;
+    uint8_t status;
+    int i;
+
+    if (sdHost->hostCtrlVer < 6) {
+        printf("ADMA3 is not supported for host %d\n", sdHost->hostCtrlVer);
+        return CDN_ENOTSUP;
+    }
+
+    for (i = 0; i < BATCH_ENTRIES; i++) {
+        entries[i].address = sectorNumber + ((i * 5) % BATCH_ENTRIES) * 3;
+        entries[i].buffer = writeBuffer + i * EntrySize;
+        entries[i].size = EntrySize;
+        entries[i].direction = CSDD_TRANSFER_WRITE;
+    }
+    status = sdHostDriver->memCardBatchXfer(sdHost, slotIndex, entries, BATCH_ENTRIES);
+    CHECK_STATUS(status);
+
+    Clearbuf(readBuffer, BATCH_ENTRIES * EntrySize, 0xDEADBEEF);
+    for (i = 0; i < BATCH_ENTRIES; i++) {
+        entries[i].buffer = readBuffer + i * EntrySize;
+        entries[i].direction = CSDD_TRANSFER_READ;
+    }
+    status = sdHostDriver->memCardBatchXfer(sdHost, slotIndex, entries, BATCH_ENTRIES);
+    CHECK_STATUS(status);
+
+    status = Comparebuf(writeBuffer, readBuffer, BATCH_ENTRIES * EntrySize);
+    if (status) {
+        SubPrint("\tError written data and read data are different\n\n");
+        return status;
+    }
+
+    /* there is no bounce buffer for batch entries */
+    entries[1].buffer = readBuffer + 2;
+    if (sdHostDriver->memCardBatchXfer(sdHost, slotIndex, entries, 2) != EINVAL) {
+        SubPrint("\tBatch with not aligned buffer accepted\n\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+#define SG_SEGMENTS 8
+
+uint8_t SgTransferTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    /* segments of different sizes, taken from the buffers out of order */
+    static const uint32_t Sizes[SG_SEGMENTS] = { 512, 1536, 64, 448, 1024, 8, 496, 8 };
+    static const uint32_t Order[SG_SEGMENTS] = { 5, 2, 7, 0, 3, 6, 1, 4 };
+    CSDD_SubBuffer segments[SG_SEGMENTS];
+    uint32_t offsets[SG_SEGMENTS];
+    uint32_t offset = 0, pos = 0, total = 0;
+    uint8_t *rbuf = readBuffer + 8192;
+    uint8_t status;
+    int i;
+
+    /* segments are placed in the buffers with gaps between them */
+    for (i = 0; i < SG_SEGMENTS; i++) {
+        offsets[Order[i]] = offset;
+        offset += Sizes[Order[i]] + 64;
+    }
+    for (i = 0; i < SG_SEGMENTS; i++) {
+        segments[i].address = (uintptr_t)(writeBuffer + offsets[i]);
+        segments[i].size = Sizes[i];
+        total += Sizes[i];
+    }
+
+    status = sdHostDriver->memoryCardSgTransfer(sdHost, slotIndex, sectorNumber, segments,
+                                                SG_SEGMENTS, CSDD_TRANSFER_WRITE);
+    CHECK_STATUS(status);
+
+    /* card holds the segments one after another */
+    Clearbuf(readBuffer, total, 0xDEADBEEF);
+    status = sdHostDriver->memoryCardDataTransfer(sdHost, slotIndex, sectorNumber,
+                                                  readBuffer, total, CSDD_TRANSFER_READ);
+    CHECK_STATUS(status);
+    for (i = 0; i < SG_SEGMENTS; i++) {
+        status = Comparebuf(writeBuffer + offsets[i], readBuffer + pos, Sizes[i]);
+        if (status) {
+            SubPrint("\tError written segment %d is different\n\n", i);
+            return status;
+        }
+        pos += Sizes[i];
+    }
+
+    /* scattered read puts each segment back at its place */
+    Clearbuf(rbuf, offset, 0xDEADBEEF);
+    for (i = 0; i < SG_SEGMENTS; i++) {
+        segments[i].address = (uintptr_t)(rbuf + offsets[i]);
+    }
+    status = sdHostDriver->memoryCardSgTransfer(sdHost, slotIndex, sectorNumber, segments,
+                                                SG_SEGMENTS, CSDD_TRANSFER_READ);
+    CHECK_STATUS(status);
+    for (i = 0; i < SG_SEGMENTS; i++) {
+        status = Comparebuf(writeBuffer + offsets[i], rbuf + offsets[i], Sizes[i]);
+        if (status) {
+            SubPrint("\tError read segment %d is different\n\n", i);
+            return status;
+        }
+    }
+
+    /* segments are not staged, one which DMA can not address is rejected */
+    segments[3].address += 2;
+    if (sdHostDriver->memoryCardSgTransfer(sdHost, slotIndex, sectorNumber, segments,
+                                           SG_SEGMENTS, CSDD_TRANSFER_READ) != EINVAL) {
+        SubPrint("\tNot aligned segment accepted\n\n");
+        return 1;
+    }
+    segments[3].address -= 2;
+    segments[5].size = 16;
+    if (sdHostDriver->memoryCardSgTransfer(sdHost, slotIndex, sectorNumber, segments,
+                                           SG_SEGMENTS, CSDD_TRANSFER_READ) != EINVAL) {
+        SubPrint("\tSegments which are not whole blocks accepted\n\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+#define RING_SEGMENTS 512
+
+static uint8_t AdmaRingWriteReadCompare(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    /* small segments take many more descriptors than the ring pages hold,
+     * so DMA runs through the ring several times */
+    static CSDD_SubBuffer segments[RING_SEGMENTS];
+    const uint32_t SegmentSize = 32;
+    uint8_t status;
+    int i;
+
+    for (i = 0; i < RING_SEGMENTS; i++) {
+        segments[i].address = (uintptr_t)(writeBuffer + i * SegmentSize);
+        segments[i].size = SegmentSize;
+    }
+    status = sdHostDriver->memoryCardSgTransfer(sdHost, slotIndex, sectorNumber, segments,
+                                                RING_SEGMENTS, CSDD_TRANSFER_WRITE);
+    CHECK_STATUS(status);
+
+    Clearbuf(readBuffer, RING_SEGMENTS * SegmentSize, 0xDEADBEEF);
+    for (i = 0; i < RING_SEGMENTS; i++) {
+        segments[i].address = (uintptr_t)(readBuffer + i * SegmentSize);
+    }
+    status = sdHostDriver->memoryCardSgTransfer(sdHost, slotIndex, sectorNumber, segments,
+                                                RING_SEGMENTS, CSDD_TRANSFER_READ);
+    CHECK_STATUS(status);
+
+    status = Comparebuf(writeBuffer, readBuffer, RING_SEGMENTS * SegmentSize);
+    if (status) {
+        SubPrint("\tError written data and read data are different\n\n");
+    }
+    return status;
+}
+
+static uint8_t AdmaRingModesTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    uint32_t threshold;
+    uint8_t status, size;
+
+    SubPrint("\tInterrupt mode\n");
+    status = AdmaRingWriteReadCompare(slotIndex, sectorNumber);
+    CHECK_STATUS(status);
+
+    /* ring pages are refilled by the polling loop */
+    SubPrint("\tPolling mode\n");
+    sdHostDriver->stop(sdHost);
+    status = AdmaRingWriteReadCompare(slotIndex, sectorNumber);
+    sdHostDriver->start(sdHost);
+    CHECK_STATUS(status);
+
+    /* every request switches hybrid mode to polling */
+    SubPrint("\tHybrid polling mode\n");
+    threshold = 1;
+    size = sizeof(threshold);
+    status = sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_HYBRID_POLL,
+                                     &threshold, &size);
+    CHECK_STATUS(status);
+    status = AdmaRingWriteReadCompare(slotIndex, sectorNumber);
+    threshold = 0;
+    (void)sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_HYBRID_POLL,
+                                  &threshold, &size);
+
+    return status;
+}
+
+uint8_t AdmaRingTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    uint8_t status, size;
+    uint8_t DmaMode = CSDD_ADMA2_MODE;
+
+    size = sizeof(DmaMode);
+    status = sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_DMA_MODE,
+                                     &DmaMode, &size);
+    CHECK_STATUS(status);
+
+    status = AdmaRingModesTest(slotIndex, sectorNumber);
+
+    DmaMode = CSDD_AUTO_MODE;
+    size = sizeof(DmaMode);
+    (void)sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_DMA_MODE,
+                                  &DmaMode, &size);
+
+    return status;
+}
+
+uint8_t HybridPollTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    CSDD_HybridPollStats before, after;
+    uint32_t threshold = 2;
+    uint8_t status, size = sizeof(threshold);
+    int i;
+
+    status = sdHostDriver->getHybridPollStats(sdHost, &before);
+    CHECK_STATUS(status);
+    status = sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_HYBRID_POLL,
+                                     &threshold, &size);
+    CHECK_STATUS(status);
+
+    /* requests above the threshold are polled, interrupts come back
+     * when the last one finished */
+    for (i = 0; (i < 4) && (status == 0); i++) {
+        status = WriteReadCompare(slotIndex, sectorNumber, 1024);
+    }
+    if (status == 0) {
+        status = sdHostDriver->getHybridPollStats(sdHost, &after);
+    }
+    threshold = 0;
+    (void)sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_HYBRID_POLL,
+                                  &threshold, &size);
+    CHECK_STATUS(status);
+
+    if (after.polling) {
+        SubPrint("\tInterrupts are masked with no request in progress\n\n");
+        return 1;
+    }
+    if ((after.pollingPhases == before.pollingPhases)
+        || ((after.pollingPhases - before.pollingPhases)
+            != (after.interruptPhases - before.interruptPhases))
+        || (after.polledEvents == before.polledEvents)) {
+        SubPrint("\tPolling phases: %u, interrupt phases: %u, polled events: %u\n\n",
+                 (unsigned)(after.pollingPhases - before.pollingPhases),
+                 (unsigned)(after.interruptPhases - before.interruptPhases),
+                 (unsigned)(after.polledEvents - before.polledEvents));
+        return 1;
+    }
+
+    /* mode is disabled, nothing is polled */
+    status = WriteReadCompare(slotIndex, sectorNumber, 1024);
+    CHECK_STATUS(status);
+    status = sdHostDriver->getHybridPollStats(sdHost, &before);
+    CHECK_STATUS(status);
+    if ((before.pollingPhases != after.pollingPhases)
+        || (before.polledEvents != after.polledEvents)) {
+        SubPrint("\tCompletions polled with hybrid mode disabled\n\n");
+        return 1;
+    }
+
+    return 0;
+}
+
 uint8_t SingleSectorTest(uint8_t slotIndex, uint32_t sectorNumber)
 {
-    uint8_t status, i;
+    uint8_t status, i;
+
+    for (i = 0; i < 4; i++) {
+        status = WriteReadCompare(slotIndex, sectorNumber, 512);
+        CHECK_STATUS(status);
+    }
+
+    return 0;
+}
+
+uint8_t NonBlockingTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    uint8_t status;
+    void *pReq;
+    uint32_t DataSize = 8192;
+
+    SubPrint("\tWrite data to memory sector number:%d, data size:%d\n",
+             sectorNumber, DataSize);
+
+    status = sdHostDriver->memCardDataXferNonBlock(sdHost, slotIndex,
+                                                    sectorNumber,
+                                                    writeBuffer, DataSize,
+                                                    CSDD_TRANSFER_WRITE, &pReq);
+    CHECK_STATUS(status);
+
+    status = sdHostDriver->memCardFinishXferNonBlock(sdHost, pReq);
+    CHECK_STATUS(status);
+
+    SubPrint("\tData write operation succeed\n");
+
+    Clearbuf(readBuffer, DataSize, 0xDEADBEEF);
+
+    SubPrint("\tRead data from memory sector number:%d, data size:%d\n",
+             sectorNumber, DataSize);
+
+    status = sdHostDriver->memCardDataXferNonBlock(sdHost, slotIndex,
+                                                    sectorNumber,
+                                                    readBuffer, DataSize,
+                                                    CSDD_TRANSFER_READ, &pReq);
+    CHECK_STATUS(status);
+
+    status = sdHostDriver->memCardFinishXferNonBlock(sdHost, pReq);
+    CHECK_STATUS(status);
+    SubPrint("\tData read operation succeed\n");
+
+    status = Comparebuf(writeBuffer, readBuffer, DataSize);
+    if (status) {
+        SubPrint("\tError written data and read data are different\n\n");
+    }
+    else{
+        SubPrint("\tWritten data and read data are identically\n\n");
+    }
+    return status;
+}
+
+/* read or write of blockCount blocks, multi-block transfers are stopped by auto CMD12 */
+static void DataRequestInit(CSDD_Request *request, uint32_t sectorNumber,
+                            uint8_t *buffer, uint32_t blockCount,
+                            CSDD_TransferDirection direction)
+{
+    memset(request, 0, sizeof(*request));
+    if (direction == CSDD_TRANSFER_WRITE) {
+        request->pCmd[0].command = (blockCount > 1) ? 25 : 24;
+    } else {
+        request->pCmd[0].command = (blockCount > 1) ? 18 : 17;
+    }
+    request->pCmd[0].argument = sectorNumber;
+    request->pCmd[0].requestFlags.dataPresent = 1;
+    request->pCmd[0].requestFlags.dataTransferDirection = direction;
+    request->pCmd[0].requestFlags.autoCMD12Enable = (blockCount > 1);
+    request->pCmd[0].requestFlags.hwResponseCheck = 1;
+    request->pCmd[0].requestFlags.responseType = CSDD_RESPONSE_R1;
+    request->pCmd[0].requestFlags.commandType = CSDD_CMD_TYPE_NORMAL;
+    request->pCmd[0].blockCount = blockCount;
+    request->pCmd[0].blockLen = 512;
+    request->pCmd[0].pDataBuffer = buffer;
+    request->cmdCount = 1;
+    request->commandCategory = CSDD_CMD_CAT_NORMAL;
+    request->requestType = (uint8_t)CSDD_REQUEST_TYPE_SD;
+}
+
+static volatile uint32_t rejectCallbacks;
+static volatile uint8_t rejectStatus;
+
+static void RejectedRequestComplete(CSDD_Request* request, void* userContext)
+{
+    rejectCallbacks++;
+    rejectStatus = request->status;
+}
+
+uint8_t BusySlotRejectTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    uint8_t status = 0;
+    CSDD_Request busyRequest, Request;
+
+    /* keep the slot busy with a long transfer */
+    DataRequestInit(&busyRequest, sectorNumber, writeBuffer, 128, CSDD_TRANSFER_WRITE);
+    DataRequestInit(&Request, sectorNumber, readBuffer, 1, CSDD_TRANSFER_READ);
+    Request.completeCallback = RejectedRequestComplete;
+
+    rejectCallbacks = 0;
+    rejectStatus = 0;
+    sdHostDriver->execCardCommand(sdHost, slotIndex, &busyRequest);
+    if (busyRequest.status != SDIO_STATUS_PENDING) {
+        SubPrint("\tTransfer finished before the slot was checked\n\n");
+        status = 1;
+    } else {
+        /* slot is busy and non-blocking issue is off, request is rejected */
+        sdHostDriver->execCardCommand(sdHost, slotIndex, &Request);
+        if ((rejectCallbacks != 1) || (rejectStatus != SDIO_ERR_SLOT_IS_BUSY)
+            || (Request.status != SDIO_ERR_SLOT_IS_BUSY)) {
+            SubPrint("\tRejected request: %u callbacks, status %u\n\n",
+                     (unsigned)rejectCallbacks, (unsigned)Request.status);
+            status = 1;
+        }
+    }
+
+    sdHostDriver->waitForRequest(busyRequest.pSdioHost, &busyRequest);
+    if (busyRequest.status != CDN_EOK) {
+        SubPrint("\tData write operation failed\n\n");
+        status = 1;
+    }
+
+    /* callback must not be called again when the slot gets idle */
+    if ((status == 0) && (rejectCallbacks != 1)) {
+        SubPrint("\tRejected request callback called %u times\n\n",
+                 (unsigned)rejectCallbacks);
+        status = 1;
+    }
+
+    return status;
+}
+
+static uint8_t SetNonBlockIssue(uint8_t slotIndex, uint8_t enable)
+{
+    uint8_t size = sizeof(enable);
+
+    return sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_NONBLOCK_ISSUE,
+                                   &enable, &size);
+}
+
+/* second request is queued while the first one is on the bus,
+ * its DMA is prepared before it is issued */
+static uint8_t PreparedXfer(uint8_t slotIndex, CSDD_Request *busyRequest, CSDD_Request *request)
+{
+    uint8_t status = 0;
+
+    sdHostDriver->execCardCommand(sdHost, slotIndex, busyRequest);
+    sdHostDriver->execCardCommand(sdHost, slotIndex, request);
+    if ((busyRequest->status != SDIO_STATUS_PENDING) || (request->status != SDIO_STATUS_PENDING)) {
+        SubPrint("\tRequests finished before they were checked\n\n");
+        status = 1;
+    } else if (request->dmaPrepared == 0) {
+        SubPrint("\tDMA of queued request was not prepared\n\n");
+        status = 1;
+    }
+
+    sdHostDriver->waitForRequest(busyRequest->pSdioHost, busyRequest);
+    sdHostDriver->waitForRequest(request->pSdioHost, request);
+    if ((busyRequest->status != CDN_EOK) || (request->status != CDN_EOK)) {
+        SubPrint("\tTransfer failed: %u, %u\n\n", busyRequest->status, request->status);
+        status = 1;
+    }
+
+    return status;
+}
+
+/* bounce buffer pool configured at CSDD_Init */
+#define BOUNCE_POOL_BUFFERS 2U
+#define BOUNCE_POOL_BUFFER_SIZE (128U * 1024U)
+/* blocks transferred through the pool, more than the default bounce buffer holds */
+#define BOUNCE_POOL_XFER_BLOCKS 200U
+
+uint8_t BounceBufferTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    uint8_t status;
+    uint32_t DataSize = 4096;
+    /* buffers which are not aligned for DMA are copied through the bounce buffer */
+    uint8_t *wbuf = writeBuffer + DataSize + 1;
+    uint8_t *rbuf = readBuffer + 1;
+    CSDD_BounceStats before, after;
+
+    memcpy(wbuf, writeBuffer, DataSize);
+    Clearbuf(readBuffer, DataSize + 4, 0xDEADBEEF);
+
+    status = sdHostDriver->getBounceStats(sdHost, &before);
+    CHECK_STATUS(status);
+
+    status = sdHostDriver->memoryCardDataTransfer(sdHost, slotIndex, sectorNumber,
+                                                  wbuf, DataSize, CSDD_TRANSFER_WRITE);
+    CHECK_STATUS(status);
+    status = sdHostDriver->memoryCardDataTransfer(sdHost, slotIndex, sectorNumber,
+                                                  rbuf, DataSize, CSDD_TRANSFER_READ);
+    CHECK_STATUS(status);
+
+    status = sdHostDriver->getBounceStats(sdHost, &after);
+    CHECK_STATUS(status);
+    if ((after.bouncedRequests - before.bouncedRequests) != 2) {
+        SubPrint("\t%u of 2 transfers were bounced\n\n",
+                 (unsigned)(after.bouncedRequests - before.bouncedRequests));
+        return 1;
+    }
+
+    status = Comparebuf(writeBuffer, rbuf, DataSize);
+    if (status) {
+        SubPrint("\tError written data and read data are different\n\n");
+        return status;
+    }
+
+    /* queued request takes the second buffer of the pool when its DMA
+     * is prepared, single blocks are prepared for SDMA */
+    uint8_t *src = writeBuffer + BOUNCE_POOL_XFER_BLOCKS * 512 + 1;
+    uint8_t *dst = writeBuffer + (2 * BOUNCE_POOL_XFER_BLOCKS + 1) * 512 + 1;
+    CSDD_Request busyRequest, Request;
+
+    memcpy(src, writeBuffer, BOUNCE_POOL_XFER_BLOCKS * 512);
+    Clearbuf(dst - 1, BOUNCE_POOL_XFER_BLOCKS * 512 + 4, 0xDEADBEEF);
+    status = SetNonBlockIssue(slotIndex, 1);
+    CHECK_STATUS(status);
+
+    DataRequestInit(&busyRequest, sectorNumber, src, 1, CSDD_TRANSFER_WRITE);
+    DataRequestInit(&Request, sectorNumber + 1, src + 512, 1, CSDD_TRANSFER_WRITE);
+    status = PreparedXfer(slotIndex, &busyRequest, &Request);
+    if (status == 0) {
+        DataRequestInit(&busyRequest, sectorNumber, dst, 1, CSDD_TRANSFER_READ);
+        DataRequestInit(&Request, sectorNumber + 1, dst + 512, 1, CSDD_TRANSFER_READ);
+        status = PreparedXfer(slotIndex, &busyRequest, &Request);
+    }
+    (void)SetNonBlockIssue(slotIndex, 0);
+    CHECK_STATUS(status);
+
+    /* transfers bigger than the default bounce buffer fit in the pool */
+    status = sdHostDriver->memoryCardDataTransfer(sdHost, slotIndex, sectorNumber + 2,
+                                                  src + 2 * 512, (BOUNCE_POOL_XFER_BLOCKS - 2) * 512,
+                                                  CSDD_TRANSFER_WRITE);
+    CHECK_STATUS(status);
+    status = sdHostDriver->memoryCardDataTransfer(sdHost, slotIndex, sectorNumber + 2,
+                                                  dst + 2 * 512, (BOUNCE_POOL_XFER_BLOCKS - 2) * 512,
+                                                  CSDD_TRANSFER_READ);
+    CHECK_STATUS(status);
+
+    before = after;
+    status = sdHostDriver->getBounceStats(sdHost, &after);
+    CHECK_STATUS(status);
+    if (((after.bouncedRequests - before.bouncedRequests) != 6)
+        || (after.pioFallbacks != before.pioFallbacks)) {
+        SubPrint("\t%u of 6 transfers were bounced, %u PIO fallbacks\n\n",
+                 (unsigned)(after.bouncedRequests - before.bouncedRequests),
+                 (unsigned)(after.pioFallbacks - before.pioFallbacks));
+        return 1;
+    }
+    status = Comparebuf(writeBuffer, dst, BOUNCE_POOL_XFER_BLOCKS * 512);
+    if (status) {
+        SubPrint("\tError written data and read data are different\n\n");
+        return status;
+    }
+
+    /* data bigger than buffers of the pool is transferred without DMA */
+    status = sdHostDriver->memoryCardDataTransfer(sdHost, slotIndex, sectorNumber, src,
+                                                  BOUNCE_POOL_BUFFER_SIZE + 512,
+                                                  CSDD_TRANSFER_WRITE);
+    CHECK_STATUS(status);
+    before = after;
+    status = sdHostDriver->getBounceStats(sdHost, &after);
+    CHECK_STATUS(status);
+    if ((after.bouncedRequests != before.bouncedRequests)
+        || ((after.pioFallbacks - before.pioFallbacks) != 1)) {
+        SubPrint("\tTransfer bigger than bounce buffers: %u bounced, %u PIO fallbacks\n\n",
+                 (unsigned)(after.bouncedRequests - before.bouncedRequests),
+                 (unsigned)(after.pioFallbacks - before.pioFallbacks));
+        return 1;
+    }
+
+    return 0;
+}
+
+uint8_t PrepareNextTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    uint8_t DmaModeArray[] = { CSDD_SDMA_MODE, CSDD_ADMA2_MODE };
+    CSDD_Request busyRequest, Request;
+    uint8_t status, DmaMode, size;
+    int i;
+
+    status = SetNonBlockIssue(slotIndex, 1);
+    CHECK_STATUS(status);
+
+    for (i = 0; (i < sizeof(DmaModeArray)) && (status == 0); i++) {
+        DmaMode = DmaModeArray[i];
+        size = sizeof(DmaMode);
+        status = sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_DMA_MODE,
+                                         &DmaMode, &size);
+        if (status) {
+            break;
+        }
+        SubPrint("\tDMA mode %d\n", DmaMode);
+
+        /* prepared write */
+        DataRequestInit(&busyRequest, sectorNumber, writeBuffer, 16, CSDD_TRANSFER_WRITE);
+        DataRequestInit(&Request, sectorNumber + 16, writeBuffer + 16 * 512, 8,
+                        CSDD_TRANSFER_WRITE);
+        status = PreparedXfer(slotIndex, &busyRequest, &Request);
+        if (status) {
+            break;
+        }
+
+        /* prepared read, written data stays the same */
+        Clearbuf(readBuffer, 24 * 512, 0xDEADBEEF);
+        DataRequestInit(&Request, sectorNumber, readBuffer, 24, CSDD_TRANSFER_READ);
+        status = PreparedXfer(slotIndex, &busyRequest, &Request);
+        if (status) {
+            break;
+        }
+        status = Comparebuf(writeBuffer, readBuffer, 24 * 512);
+        if (status) {
+            SubPrint("\tError written data and read data are different\n\n");
+        }
+    }
+
+    (void)SetNonBlockIssue(slotIndex, 0);
+    DmaMode = CSDD_AUTO_MODE;
+    size = sizeof(DmaMode);
+    (void)sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_DMA_MODE,
+                                  &DmaMode, &size);
+
+    return status;
+}
+
+/* longest time in which a request submitted to busy slot has to be queued */
+#define NONBLOCK_ISSUE_MAX_NS 20000U
+
+uint8_t NonBlockIssueTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    const uint32_t BusyBlocks = 128, ReadBlocks = 8;
+    CSDD_Request busyRequest, Request;
+    uint64_t submitNs;
+    uint8_t status;
+
+    status = SetNonBlockIssue(slotIndex, 1);
+    CHECK_STATUS(status);
+
+    /* read of the last written blocks is queued behind the write */
+    DataRequestInit(&busyRequest, sectorNumber, writeBuffer, BusyBlocks, CSDD_TRANSFER_WRITE);
+    DataRequestInit(&Request, sectorNumber + BusyBlocks - ReadBlocks, readBuffer, ReadBlocks,
+                    CSDD_TRANSFER_READ);
+    Clearbuf(readBuffer, ReadBlocks * 512, 0xDEADBEEF);
+
+    sdHostDriver->execCardCommand(sdHost, slotIndex, &busyRequest);
+    submitNs = CPS_GetTimeNs();
+    sdHostDriver->execCardCommand(sdHost, slotIndex, &Request);
+    submitNs = CPS_GetTimeNs() - submitNs;
+    if ((busyRequest.status != SDIO_STATUS_PENDING) || (Request.status != SDIO_STATUS_PENDING)) {
+        SubPrint("\tRequests not pending after submission: %u, %u\n\n",
+                 busyRequest.status, Request.status);
+        status = 1;
+    } else if (submitNs > NONBLOCK_ISSUE_MAX_NS) {
+        SubPrint("\tSubmission to busy slot took %u ns\n\n", (unsigned)submitNs);
+        status = 1;
+    }
+
+    sdHostDriver->waitForRequest(busyRequest.pSdioHost, &busyRequest);
+    sdHostDriver->waitForRequest(Request.pSdioHost, &Request);
+    if ((busyRequest.status != CDN_EOK) || (Request.status != CDN_EOK)) {
+        SubPrint("\tTransfer failed: %u, %u\n\n", busyRequest.status, Request.status);
+        status = 1;
+    }
+    if (status == 0) {
+        status = Comparebuf(writeBuffer + (BusyBlocks - ReadBlocks) * 512, readBuffer,
+                            ReadBlocks * 512);
+        if (status) {
+            SubPrint("\tError written data and read data are different\n\n");
+        }
+    }
+
+    (void)SetNonBlockIssue(slotIndex, 0);
+
+    return status;
+}
+
+#define QUEUE_CHAIN_WRITES 4
+#define QUEUE_CHAIN_BLOCKS 8
+
+static volatile uint32_t queueChainDone;
+static uint32_t queueChainOrder[2 * QUEUE_CHAIN_WRITES];
+
+static void QueueChainComplete(CSDD_Request* request, void* userContext)
+{
+    if (queueChainDone < 2 * QUEUE_CHAIN_WRITES) {
+        queueChainOrder[queueChainDone] = (uint32_t)(uintptr_t)userContext;
+    }
+    queueChainDone++;
+}
+
+uint8_t QueueChainTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    static CSDD_Request Request[2 * QUEUE_CHAIN_WRITES];
+    const uint32_t Count = 2 * QUEUE_CHAIN_WRITES;
+    const uint32_t DataSize = QUEUE_CHAIN_WRITES * QUEUE_CHAIN_BLOCKS * 512;
+    uint8_t status;
+    uint32_t i;
+
+    status = SetNonBlockIssue(slotIndex, 1);
+    CHECK_STATUS(status);
+
+    /* writes are followed by reads of the same sectors, all submitted at once */
+    Clearbuf(readBuffer, DataSize, 0xDEADBEEF);
+    for (i = 0; i < Count; i++) {
+        uint32_t offset = (i % QUEUE_CHAIN_WRITES) * QUEUE_CHAIN_BLOCKS;
+
+        if (i < QUEUE_CHAIN_WRITES) {
+            DataRequestInit(&Request[i], sectorNumber + offset, writeBuffer + offset * 512,
+                            QUEUE_CHAIN_BLOCKS, CSDD_TRANSFER_WRITE);
+        } else {
+            DataRequestInit(&Request[i], sectorNumber + offset, readBuffer + offset * 512,
+                            QUEUE_CHAIN_BLOCKS, CSDD_TRANSFER_READ);
+        }
+        Request[i].completeCallback = QueueChainComplete;
+        Request[i].userContext = (void*)(uintptr_t)i;
+    }
+    queueChainDone = 0;
+    for (i = 0; i < Count; i++) {
+        sdHostDriver->execCardCommand(sdHost, slotIndex, &Request[i]);
+    }
+
+    /* requests are chained by the driver, only the last one is waited for */
+    sdHostDriver->waitForRequest(Request[Count - 1].pSdioHost, &Request[Count - 1]);
+    if (queueChainDone != Count) {
+        SubPrint("\t%u of %u requests finished\n\n", (unsigned)queueChainDone,
+                 (unsigned)Count);
+        status = 1;
+    }
+    for (i = 0; (i < Count) && (status == 0); i++) {
+        if ((Request[i].status != CDN_EOK) || (queueChainOrder[i] != i)) {
+            SubPrint("\tRequest %u finished as %u with status %u\n\n", (unsigned)i,
+                     (unsigned)queueChainOrder[i], Request[i].status);
+            status = 1;
+        }
+    }
+    if (status == 0) {
+        status = Comparebuf(writeBuffer, readBuffer, DataSize);
+        if (status) {
+            SubPrint("\tError written data and read data are different\n\n");
+        }
+    }
+
+    /* after a failure above requests can be still queued */
+    for (i = 0; i < Count; i++) {
+        sdHostDriver->waitForRequest(Request[i].pSdioHost, &Request[i]);
+    }
+    (void)SetNonBlockIssue(slotIndex, 0);
+
+    return status;
+}
+
+/* queued read may wait for the line longer than the single one */
+#define REG_COUNT_QUEUE_SLACK 2U
+
+/* queued request counts register accesses from its issue, without
+ * the accesses of the long transfer ahead of it. Data is transferred
+ * without DMA, each word of it is a register access */
+uint8_t RegCountQueueTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    CSDD_Request busyRequest, Request;
+    uint32_t soloReads, soloWrites;
+    uint8_t status, DmaMode, size;
+
+    DmaMode = CSDD_NONEDMA_MODE;
+    size = sizeof(DmaMode);
+    status = sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_DMA_MODE,
+                                     &DmaMode, &size);
+    CHECK_STATUS(status);
+    status = SetNonBlockIssue(slotIndex, 1);
+
+    if (status == 0) {
+        DataRequestInit(&Request, sectorNumber, readBuffer, 1, CSDD_TRANSFER_READ);
+        sdHostDriver->execCardCommand(sdHost, slotIndex, &Request);
+        sdHostDriver->waitForRequest(Request.pSdioHost, &Request);
+        soloReads = Request.regReads;
+        soloWrites = Request.regWrites;
+        status = Request.status;
+    }
+    if (status == 0) {
+        DataRequestInit(&busyRequest, sectorNumber, writeBuffer, 128, CSDD_TRANSFER_WRITE);
+        DataRequestInit(&Request, sectorNumber, readBuffer, 1, CSDD_TRANSFER_READ);
+        sdHostDriver->execCardCommand(sdHost, slotIndex, &busyRequest);
+        sdHostDriver->execCardCommand(sdHost, slotIndex, &Request);
+        sdHostDriver->waitForRequest(busyRequest.pSdioHost, &busyRequest);
+        sdHostDriver->waitForRequest(Request.pSdioHost, &Request);
+        status = (busyRequest.status != 0) ? busyRequest.status : Request.status;
+    }
+    (void)SetNonBlockIssue(slotIndex, 0);
+    DmaMode = CSDD_AUTO_MODE;
+    size = sizeof(DmaMode);
+    (void)sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_DMA_MODE,
+                                  &DmaMode, &size);
+    CHECK_STATUS(status);
+
+    SubPrint("\tsingle read: %u reads, %u writes; queued: %u reads, %u writes\n",
+             (unsigned)soloReads, (unsigned)soloWrites,
+             (unsigned)Request.regReads, (unsigned)Request.regWrites);
+    if ((Request.regReads > REG_COUNT_QUEUE_SLACK * soloReads)
+        || (Request.regWrites > REG_COUNT_QUEUE_SLACK * soloWrites)) {
+        SubPrint("\tQueued request counted accesses of the busy one\n\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+/* data buffer seen by the driver at xlateVirt is made of 4 KB pages
+ * of xlatePhys in reverse order, so DMA has to split it at each page */
+#define XLATE_PAGE 4096U
+#define XLATE_PAGES 16U
+/* bytes of round trip transfers, they start in the middle of a page */
+#define XLATE_XFER (6U * XLATE_PAGE)
+#define XLATE_XFER_OFFSET 512U
+
+static uint8_t *xlateVirt;
+static uint8_t *xlatePhys;
+static volatile uint32_t xlateCalls;
+
+static uint8_t *XlatePage(uint32_t page)
+{
+    return xlatePhys + (XLATE_PAGES - 1U - page) * XLATE_PAGE;
+}
+
+static uintptr_t XlateVirtToPhys(CSDD_SDIO_Host* pd, void* address, uint32_t size,
+                                 uint32_t* contiguousSize)
+{
+    const uintptr_t offset = (uintptr_t)address - (uintptr_t)xlateVirt;
+    uint32_t left;
+
+    if (((uintptr_t)address < (uintptr_t)xlateVirt) || (offset >= XLATE_PAGES * XLATE_PAGE)) {
+        /* other buffers are identity mapped */
+        *contiguousSize = size;
+        return (uintptr_t)address;
+    }
+
+    xlateCalls++;
+    left = XLATE_PAGE - (uint32_t)(offset % XLATE_PAGE);
+    *contiguousSize = (size < left) ? size : left;
+    return (uintptr_t)(XlatePage((uint32_t)(offset / XLATE_PAGE)) + offset % XLATE_PAGE);
+}
+
+/* copies data between buf and the pages mapped at xlateVirt + offset */
+static void XlateCopy(uint32_t offset, uint8_t *buf, uint32_t size, int toVirt)
+{
+    uint32_t len;
+
+    while (size > 0U) {
+        uint8_t *phys = XlatePage(offset / XLATE_PAGE) + offset % XLATE_PAGE;
+
+        len = XLATE_PAGE - offset % XLATE_PAGE;
+        if (len > size) {
+            len = size;
+        }
+        if (toVirt) {
+            memcpy(phys, buf, len);
+        } else {
+            memcpy(buf, phys, len);
+        }
+        offset += len;
+        buf += len;
+        size -= len;
+    }
+}
+
+static uint8_t XlateSetDmaMode(uint8_t slotIndex, uint8_t DmaMode)
+{
+    uint8_t size = sizeof(DmaMode);
 
-    for (i = 0; i < 4; i++) {
-        status = WriteReadCompare(slotIndex, sectorNumber, 512);
-        CHECK_STATUS(status);
+    return sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_DMA_MODE,
+                                   &DmaMode, &size);
+}
+
+static uint8_t XlateFlushCache(uint8_t slotIndex)
+{
+    uint8_t unused = 0;
+    uint8_t size = sizeof(unused);
+
+    return sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_FLUSH_ADDR_CACHE, &unused, &size);
+}
+
+/* writes size bytes from xlateVirt + wOffset and reads them back to
+ * xlateVirt + rOffset, data on the card is checked without translation */
+static uint8_t XlateRoundTrip(uint8_t slotIndex, uint32_t sectorNumber, uint32_t wOffset,
+                              uint32_t rOffset, uint32_t size)
+{
+    uint8_t *check = writeBuffer + 512 * 1024;
+    uint8_t status;
+
+    XlateCopy(wOffset, writeBuffer, size, 1);
+    Clearbuf(check, size, 0xDEADBEEF);
+    XlateCopy(rOffset, check, size, 1);
+
+    status = sdHostDriver->memoryCardDataTransfer(sdHost, slotIndex, sectorNumber,
+                                                  xlateVirt + wOffset, size, CSDD_TRANSFER_WRITE);
+    CHECK_STATUS(status);
+    status = sdHostDriver->memoryCardDataTransfer(sdHost, slotIndex, sectorNumber,
+                                                  xlateVirt + rOffset, size, CSDD_TRANSFER_READ);
+    CHECK_STATUS(status);
+
+    XlateCopy(rOffset, check, size, 0);
+    status = Comparebuf(writeBuffer, check, size);
+    if (status) {
+        SubPrint("\tError written data and read data are different\n\n");
+        return status;
     }
 
+    Clearbuf(readBuffer, 0x4000, 0xDEADBEEF);
+    status = sdHostDriver->memoryCardDataTransfer(sdHost, slotIndex, sectorNumber, readBuffer,
+                                                  (size < 0x4000) ? size : 0x4000, CSDD_TRANSFER_READ);
+    CHECK_STATUS(status);
+    status = Comparebuf(writeBuffer, readBuffer, (size < 0x4000) ? size : 0x4000);
+    if (status) {
+        SubPrint("\tError card data is different from translated buffer\n\n");
+    }
+    return status;
+}
+
+/* writes pages of the translated buffer, checks how many of them were
+ * translated by the callback and not found in the host cache */
+static uint8_t XlateCacheXfer(uint8_t slotIndex, uint32_t sectorNumber, uint32_t page,
+                              uint32_t pages, CSDD_TransferDirection dir, uint32_t misses)
+{
+    uint8_t status;
+    uint32_t calls = xlateCalls;
+
+    status = sdHostDriver->memoryCardDataTransfer(sdHost, slotIndex, sectorNumber,
+                                                  xlateVirt + page * XLATE_PAGE,
+                                                  pages * XLATE_PAGE, dir);
+    CHECK_STATUS(status);
+    if ((xlateCalls - calls) != misses) {
+        SubPrint("\tPages %u-%u: %u translations, expected %u\n\n", (unsigned)page,
+                 (unsigned)(page + pages - 1U), (unsigned)(xlateCalls - calls), (unsigned)misses);
+        return 1;
+    }
     return 0;
 }
 
-uint8_t NonBlockingTest(uint8_t slotIndex, uint32_t sectorNumber)
+static uint8_t XlateCacheTest(uint8_t slotIndex, uint32_t sectorNumber)
 {
     uint8_t status;
-    void *pReq;
-    uint32_t DataSize = 8192;
 
-    SubPrint("\tWrite data to memory sector number:%d, data size:%d\n",
-             sectorNumber, DataSize);
+    status = XlateSetDmaMode(slotIndex, CSDD_ADMA2_MODE);
+    CHECK_STATUS(status);
+    status = XlateFlushCache(slotIndex);
+    CHECK_STATUS(status);
 
-    status = sdHostDriver->memCardDataXferNonBlock(sdHost, slotIndex,
-                                                    sectorNumber,
-                                                    writeBuffer, DataSize,
-                                                    CSDD_TRANSFER_WRITE, &pReq);
+    /* each page is translated once, then it is found in the cache */
+    status = XlateCacheXfer(slotIndex, sectorNumber, 0, 6, CSDD_TRANSFER_WRITE, 6);
+    CHECK_STATUS(status);
+    status = XlateCacheXfer(slotIndex, sectorNumber, 0, 6, CSDD_TRANSFER_WRITE, 0);
+    CHECK_STATUS(status);
+    /* 8 entries are replaced round robin, pages 10 and 11 replace pages 0 and 1 */
+    status = XlateCacheXfer(slotIndex, sectorNumber, 8, 4, CSDD_TRANSFER_READ, 4);
+    CHECK_STATUS(status);
+    status = XlateCacheXfer(slotIndex, sectorNumber, 4, 2, CSDD_TRANSFER_WRITE, 0);
+    CHECK_STATUS(status);
+    status = XlateCacheXfer(slotIndex, sectorNumber, 0, 2, CSDD_TRANSFER_WRITE, 2);
+    CHECK_STATUS(status);
+    /* pages 0 and 1 replaced pages 2 and 3 */
+    status = XlateCacheXfer(slotIndex, sectorNumber, 2, 2, CSDD_TRANSFER_WRITE, 2);
     CHECK_STATUS(status);
 
-    status = sdHostDriver->memCardFinishXferNonBlock(sdHost, pReq);
+    /* flushed ranges are translated again */
+    status = XlateCacheXfer(slotIndex, sectorNumber, 0, 2, CSDD_TRANSFER_WRITE, 0);
+    CHECK_STATUS(status);
+    status = XlateFlushCache(slotIndex);
     CHECK_STATUS(status);
+    return XlateCacheXfer(slotIndex, sectorNumber, 0, 2, CSDD_TRANSFER_WRITE, 2);
+}
 
-    SubPrint("\tData write operation succeed\n");
+uint8_t VirtToPhysTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    uint8_t DmaModeArray[] = { CSDD_SDMA_MODE, CSDD_ADMA2_MODE, CSDD_ADMA3_MODE };
+    uint8_t *virtAlloc = malloc((XLATE_PAGES + 1U) * XLATE_PAGE);
+    uint8_t *physAlloc = malloc((XLATE_PAGES + 1U) * XLATE_PAGE);
+    uint8_t status = 0;
+    int i;
+
+    if ((virtAlloc == NULL) || (physAlloc == NULL)) {
+        free(virtAlloc);
+        free(physAlloc);
+        return 1;
+    }
+    xlateVirt = (uint8_t*)(((uintptr_t)virtAlloc + XLATE_PAGE - 1U) & ~(uintptr_t)(XLATE_PAGE - 1U));
+    xlatePhys = (uint8_t*)(((uintptr_t)physAlloc + XLATE_PAGE - 1U) & ~(uintptr_t)(XLATE_PAGE - 1U));
+
+    /* virtToPhysCallback is taken by CSDD_Init, it is installed only for
+     * this test so that the other tests use identity mapped buffers */
+    sdHost->virtToPhys = XlateVirtToPhys;
+    status = XlateFlushCache(slotIndex);
+
+    for (i = 0; (i < sizeof(DmaModeArray)) && (status == 0); i++) {
+        if ((DmaModeArray[i] == CSDD_ADMA3_MODE) && (sdHost->hostCtrlVer < 6)) {
+            break;
+        }
+        status = XlateSetDmaMode(slotIndex, DmaModeArray[i]);
+        if (status == 0) {
+            SubPrint("\tDMA mode %d\n", DmaModeArray[i]);
+            status = XlateRoundTrip(slotIndex, sectorNumber, XLATE_XFER_OFFSET,
+                                    8U * XLATE_PAGE + 2U * XLATE_XFER_OFFSET, XLATE_XFER);
+        }
+    }
+
+    if (status == 0) {
+        status = XlateCacheTest(slotIndex, sectorNumber);
+    }
+
+    if (status == 0) {
+        /* single block is transferred by SDMA in auto mode, but the buffer
+         * may be not physically contiguous, so ADMA2 is used */
+        status = XlateSetDmaMode(slotIndex, CSDD_AUTO_MODE);
+        if (status == 0) {
+            status = XlateRoundTrip(slotIndex, sectorNumber, XLATE_PAGE - 256U,
+                                    9U * XLATE_PAGE - 256U, 512);
+        }
+        if ((status == 0) && (sdHost->Slots[slotIndex].dmaModeSelected != CSDD_ADMA2_MODE)) {
+            SubPrint("\tSingle block used DMA mode %d\n\n", sdHost->Slots[slotIndex].dmaModeSelected);
+            status = 1;
+        }
+    }
+
+    (void)XlateSetDmaMode(slotIndex, CSDD_AUTO_MODE);
+    sdHost->virtToPhys = NULL;
+    (void)XlateFlushCache(slotIndex);
+    free(virtAlloc);
+    free(physAlloc);
+
+    return status;
+}
+
+uint8_t CalibrationTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    const uint32_t DataSize = 0x4000;
+    CSDD_DmaCalibration result;
+    uint64_t bestWallNs, maxWallNs;
+    const CSDD_DmaCalTiming *selected;
+    uint8_t status;
+    uint32_t size = 512;
+    int i, mode;
+
+    status = sdHostDriver->memoryCardDataTransfer(sdHost, slotIndex, sectorNumber,
+                                                  writeBuffer, DataSize, CSDD_TRANSFER_WRITE);
+    CHECK_STATUS(status);
 
     Clearbuf(readBuffer, DataSize, 0xDEADBEEF);
+    status = sdHostDriver->memCardCalibrateDmaMode(sdHost, slotIndex, sectorNumber,
+                                                   readBuffer, DataSize, &result);
+    CHECK_STATUS(status);
 
-    SubPrint("\tRead data from memory sector number:%d, data size:%d\n",
-             sectorNumber, DataSize);
+    /* card data is only read, the biggest measured class fills half of the buffer */
+    status = Comparebuf(writeBuffer, readBuffer, DataSize / 2);
+    if (status) {
+        SubPrint("\tError data read by calibration is different\n\n");
+        return status;
+    }
 
-    status = sdHostDriver->memCardDataXferNonBlock(sdHost, slotIndex,
-                                                    sectorNumber,
-                                                    readBuffer, DataSize,
-                                                    CSDD_TRANSFER_READ, &pReq);
+    for (i = 0; i < SDIO_CFG_DMA_CAL_CLASSES; i++, size *= 4) {
+        if (size > DataSize) {
+            /* class bigger than the buffer keeps fixed rules */
+            if ((result.size[i] != 0) || (result.selected[i] != CSDD_AUTO_MODE)) {
+                SubPrint("\tClass %d of %u bytes was measured\n\n", i, (unsigned)size);
+                return 1;
+            }
+        } else if ((result.size[i] != size) || (result.pio[i].wallNs == 0)) {
+            SubPrint("\tClass %d of %u bytes was not measured\n\n", i, (unsigned)size);
+            return 1;
+        } else if ((result.dma[i][CSDD_ADMA1_MODE].wallNs != 0)
+                   || (result.selected[i] == CSDD_ADMA1_MODE)) {
+            /* ADMA1 depends on buffer alignment, it cannot be selected by size */
+            SubPrint("\tClass %d: ADMA1 was measured\n\n", i);
+            return 1;
+        } else {
+            /* selected mode is not much slower than the fastest one */
+            bestWallNs = result.pio[i].wallNs;
+            for (mode = 0; mode < 4; mode++) {
+                if ((result.dma[i][mode].wallNs != 0) && (result.dma[i][mode].wallNs < bestWallNs)) {
+                    bestWallNs = result.dma[i][mode].wallNs;
+                }
+            }
+            maxWallNs = bestWallNs + bestWallNs / SDIO_CFG_DMA_CAL_WALL_SLACK;
+            selected = (result.selected[i] == CSDD_NONEDMA_MODE) ? &result.pio[i]
+                       : &result.dma[i][result.selected[i]];
+            SubPrint("\t%6u bytes: mode %d, wall %llu ns, cpu %llu ns\n", (unsigned)size,
+                     result.selected[i], (unsigned long long)selected->wallNs,
+                     (unsigned long long)selected->cpuNs);
+            if ((selected->wallNs == 0) || (selected->wallNs > maxWallNs)) {
+                SubPrint("\tClass %d: selected mode is too slow\n\n", i);
+                return 1;
+            }
+        }
+        /* auto DMA mode uses the selection */
+        if (sdHost->Slots[slotIndex].DmaModeTable[i] != result.selected[i]) {
+            SubPrint("\tClass %d: selection is not used by auto DMA mode\n\n", i);
+            return 1;
+        }
+    }
+
+    return WriteReadCompare(slotIndex, sectorNumber, 8192);
+}
+
+static uint8_t SetSdmaBoundary(uint8_t slotIndex, uint32_t boundary)
+{
+    uint8_t size = sizeof(boundary);
+
+    return sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_SDMA_BOUNDARY,
+                                   &boundary, &size);
+}
+
+/* transfers blocks in SDMA mode and checks SDMA stopped at each
+ * boundary crossed by the buffer */
+static uint8_t SdmaBoundaryXfer(uint8_t slotIndex, uint32_t sectorNumber, uint8_t *buffer,
+                                uint32_t blockCount, CSDD_TransferDirection direction,
+                                uint32_t boundary)
+{
+    const uintptr_t first = (uintptr_t)buffer;
+    const uintptr_t last = first + blockCount * 512 - 1;
+    const uint32_t expected = (uint32_t)((last / boundary) - (first / boundary));
+    CSDD_Request request;
+
+    DataRequestInit(&request, sectorNumber, buffer, blockCount, direction);
+    sdHostDriver->execCardCommand(sdHost, slotIndex, &request);
+    sdHostDriver->waitForRequest(request.pSdioHost, &request);
+    if (request.status != CDN_EOK) {
+        SubPrint("\tTransfer failed: %u\n\n", request.status);
+        return 1;
+    }
+    if (request.sdmaBoundaryInts != expected) {
+        SubPrint("\tBoundary %u: %u boundary interrupts, %u boundaries crossed\n\n",
+                 (unsigned)boundary, (unsigned)request.sdmaBoundaryInts, (unsigned)expected);
+        return 1;
+    }
+
+    return 0;
+}
+
+uint8_t SdmaBoundaryTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    const uint32_t blockCount = 32;
+    uint8_t DmaMode = CSDD_SDMA_MODE, size = sizeof(DmaMode);
+    uint8_t status;
+
+    status = sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_DMA_MODE,
+                                     &DmaMode, &size);
     CHECK_STATUS(status);
 
-    status = sdHostDriver->memCardFinishXferNonBlock(sdHost, pReq);
+    /* boundary is a power of 2 from 4 KB to 512 KB */
+    if ((SetSdmaBoundary(slotIndex, 3000) == 0) || (SetSdmaBoundary(slotIndex, 2048) == 0)
+        || (SetSdmaBoundary(slotIndex, 1024 * 1024) == 0)) {
+        SubPrint("\tNot valid SDMA boundary accepted\n\n");
+        status = 1;
+    }
+
+    /* small boundary stops the transfer every 4 KB */
+    if (status == 0) {
+        status = SetSdmaBoundary(slotIndex, 4096);
+    }
+    if (status == 0) {
+        status = SdmaBoundaryXfer(slotIndex, sectorNumber, writeBuffer, blockCount,
+                                  CSDD_TRANSFER_WRITE, 4096);
+    }
+    if (status == 0) {
+        Clearbuf(readBuffer, blockCount * 512, 0xDEADBEEF);
+        status = SdmaBoundaryXfer(slotIndex, sectorNumber, readBuffer, blockCount,
+                                  CSDD_TRANSFER_READ, 4096);
+    }
+
+    /* contiguous buffer gets the biggest boundary */
+    if (status == 0) {
+        status = SetSdmaBoundary(slotIndex, 0);
+    }
+    if (status == 0) {
+        status = SdmaBoundaryXfer(slotIndex, sectorNumber + blockCount, writeBuffer, blockCount,
+                                  CSDD_TRANSFER_WRITE, 512 * 1024);
+    }
+    if (status == 0) {
+        status = Comparebuf(writeBuffer, readBuffer, blockCount * 512);
+        if (status) {
+            SubPrint("\tError written data and read data are different\n\n");
+        }
+    }
+
+    (void)SetSdmaBoundary(slotIndex, 0);
+    DmaMode = CSDD_AUTO_MODE;
+    (void)sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_DMA_MODE,
+                                  &DmaMode, &size);
+
+    return status;
+}
+
+static volatile uint32_t poolCallbacks;
+
+static void PoolRequestComplete(CSDD_Request* request, void* userContext)
+{
+    poolCallbacks++;
+}
+
+uint8_t RequestPoolTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    uint8_t status = 0;
+    CSDD_Request busyRequest;
+    void *pReq;
+    uint32_t DataSize = 8192;
+    uint32_t i;
+
+    DataRequestInit(&busyRequest, sectorNumber, writeBuffer, DataSize / 512, CSDD_TRANSFER_WRITE);
+    sdHostDriver->execCardCommand(sdHost, slotIndex, &busyRequest);
+
+    /* every rejected transfer must give its request back to the pool */
+    poolCallbacks = 0;
+    for (i = 0; i < 2 * SDIO_CFG_MEM_REQUESTS_PER_SLOT; i++) {
+        if (busyRequest.status != SDIO_STATUS_PENDING) {
+            break;
+        }
+        if (sdHostDriver->memCardDataXferNonBlock(sdHost, slotIndex, sectorNumber,
+                                                  readBuffer, 512, CSDD_TRANSFER_READ,
+                                                  &pReq) == CDN_EOK) {
+            SubPrint("\tTransfer to busy slot was not rejected\n\n");
+            (void)sdHostDriver->memCardFinishXferNonBlock(sdHost, pReq);
+            status = 1;
+        }
+        (void)sdHostDriver->memCardDataXferNonBlockCb(sdHost, slotIndex, sectorNumber,
+                                                      readBuffer, 512, CSDD_TRANSFER_READ,
+                                                      PoolRequestComplete, NULL, &pReq);
+    }
+    if (poolCallbacks != i) {
+        SubPrint("\t%u of %u rejected transfers called back\n\n",
+                 (unsigned)poolCallbacks, (unsigned)i);
+        status = 1;
+    }
+
+    sdHostDriver->waitForRequest(busyRequest.pSdioHost, &busyRequest);
+    CHECK_STATUS(busyRequest.status);
     CHECK_STATUS(status);
-    SubPrint("\tData read operation succeed\n");
+
+    /* queued transfers hold their requests until they complete, the pool
+     * is exhausted when all of them are queued */
+    status = SetNonBlockIssue(slotIndex, 1);
+    CHECK_STATUS(status);
+    sdHostDriver->execCardCommand(sdHost, slotIndex, &busyRequest);
+    poolCallbacks = 0;
+    for (i = 0; i < SDIO_CFG_MEM_REQUESTS_PER_SLOT; i++) {
+        if (sdHostDriver->memCardDataXferNonBlockCb(sdHost, slotIndex, sectorNumber + i,
+                                                    readBuffer + i * 512, 512, CSDD_TRANSFER_READ,
+                                                    PoolRequestComplete, NULL, &pReq) != CDN_EOK) {
+            SubPrint("\tTransfer %u was not queued\n\n", (unsigned)i);
+            status = 1;
+        }
+    }
+    if (sdHostDriver->memCardDataXferNonBlockCb(sdHost, slotIndex, sectorNumber,
+                                                readBuffer, 512, CSDD_TRANSFER_READ,
+                                                PoolRequestComplete, NULL, &pReq) != CDN_ENOMEM) {
+        SubPrint("\tTransfer was accepted with exhausted pool\n\n");
+        status = 1;
+    }
+    sdHostDriver->waitForRequest(busyRequest.pSdioHost, &busyRequest);
+    for (i = 0; (poolCallbacks < SDIO_CFG_MEM_REQUESTS_PER_SLOT) && (i < 100000U); i++) {
+        IDLE();
+    }
+    (void)SetNonBlockIssue(slotIndex, 0);
+    if (poolCallbacks != SDIO_CFG_MEM_REQUESTS_PER_SLOT) {
+        SubPrint("\t%u of %u queued transfers called back\n\n",
+                 (unsigned)poolCallbacks, (unsigned)SDIO_CFG_MEM_REQUESTS_PER_SLOT);
+        status = 1;
+    }
+    CHECK_STATUS(busyRequest.status);
+    CHECK_STATUS(status);
+
+    /* pool is not exhausted, data written by the busy request reads back.
+     * Without auto CMD only single block transfers are non-blocking */
+    Clearbuf(readBuffer, DataSize, 0xDEADBEEF);
+    for (i = 0; i < DataSize / 512; i++) {
+        status = sdHostDriver->memCardDataXferNonBlock(sdHost, slotIndex, sectorNumber + i,
+                                                        readBuffer + i * 512, 512,
+                                                        CSDD_TRANSFER_READ, &pReq);
+        CHECK_STATUS(status);
+
+        status = sdHostDriver->memCardFinishXferNonBlock(sdHost, pReq);
+        CHECK_STATUS(status);
+    }
 
     status = Comparebuf(writeBuffer, readBuffer, DataSize);
     if (status) {
         SubPrint("\tError written data and read data are different\n\n");
     }
-    else{
-        SubPrint("\tWritten data and read data are identically\n\n");
-    }
     return status;
 }
 
@@ -845,45 +2045,191 @@ uint8_t SimpleTest(uint8_t slotIndex, uint32_t sectorNumber)
                                                    readBuffer, 512,
                                                    CSDD_TRANSFER_READ);
 
-    status = WriteReadCompare(slotIndex, sectorNumber, 2048);
-    CHECK_STATUS(status);
+    status = WriteReadCompare(slotIndex, sectorNumber, 2048);
+    CHECK_STATUS(status);
+
+    return status;
+}
+
+uint8_t HSTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    uint8_t status;
+    uint32_t freq = 50000;
+    unsigned char size;
+
+    SubPrint("\tSwitch to high speed mode\n");
+    status = sdHostDriver->configureHighSpeed(sdHost, slotIndex, 1);
+    CHECK_STATUS(status);
+
+    size = sizeof(freq);
+
+    /* set new clock frequency */
+    status = sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_CLK,
+                                     &freq, &size);
+    CHECK_STATUS(status);
+    SubPrint("\tChange clock frequency to %dKHz \n", freq);
+
+    status = WriteReadCompare(slotIndex, sectorNumber, 2048);
+    CHECK_STATUS(status);
+
+    return status;
+}
+
+volatile int isrCounter = 0;
+void Isr(void* pD)
+{
+    CSDD_OBJ *sdHostDriver;
+    bool handled;
+
+    isrCounter++;
+    sdHostDriver = CSDD_GetInstance();
+    sdHostDriver->isr(pD, &handled);
+}
+
+static volatile uint32_t topHalfIrqs;
+static volatile uint8_t topHalfPending;
+
+/* interrupt handler which defers the handling to the bottom half */
+static void TopHalfIsr(void* pD)
+{
+    CSDD_OBJ *sdHostDriver;
+    bool handled;
+
+    isrCounter++;
+    sdHostDriver = CSDD_GetInstance();
+    sdHostDriver->isrTopHalf(pD, &handled);
+    if (handled) {
+        topHalfIrqs++;
+        topHalfPending = 1;
+    }
+}
+
+/* runs the bottom half delayNs after each top half until the request
+ * finishes, the request must not finish and the slot must stay masked
+ * in between */
+static uint8_t BottomHalfXfer(uint8_t slotIndex, CSDD_Request *request, uint32_t delayNs)
+{
+    uint32_t timeout = 10000000;
+    uint8_t status = 0;
+
+    topHalfIrqs = 0;
+    sdHostDriver->execCardCommand(sdHost, slotIndex, request);
+    while ((request->status == SDIO_STATUS_PENDING) && (timeout > 0) && (status == 0)) {
+        IDLE();
+        timeout--;
+        if (topHalfPending == 0) {
+            continue;
+        }
+        if (delayNs != 0) {
+            CPS_DelayNs(delayNs);
+        }
+        if ((request->status != SDIO_STATUS_PENDING)
+            || (sdHost->Slots[slotIndex].IsrMasked == 0)) {
+            SubPrint("\tAfter top half: request status %u, slot masked %u\n\n",
+                     request->status, sdHost->Slots[slotIndex].IsrMasked);
+            status = 1;
+        }
+        topHalfPending = 0;
+        if (sdHostDriver->isrBottomHalf(sdHost) != 0) {
+            SubPrint("\tBottom half failed\n\n");
+            status = 1;
+        }
+        if (sdHost->Slots[slotIndex].IsrMasked != 0) {
+            SubPrint("\tSlot still masked after bottom half\n\n");
+            status = 1;
+        }
+    }
+    if ((status == 0) && ((request->status != CDN_EOK) || (topHalfIrqs == 0))) {
+        SubPrint("\tTransfer status %u after %u interrupts\n\n", request->status,
+                 (unsigned)topHalfIrqs);
+        status = 1;
+    }
+
+    return status;
+}
+
+uint8_t IsrBottomHalfTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    const uint32_t BlockCount = 16;
+    CSDD_Request request;
+    uint8_t status;
+
+    CsddInterruptInit(sdHost, &TopHalfIsr);
+    topHalfPending = 0;
+
+    DataRequestInit(&request, sectorNumber, writeBuffer, BlockCount, CSDD_TRANSFER_WRITE);
+    status = BottomHalfXfer(slotIndex, &request, 0);
+    if (status == 0) {
+        Clearbuf(readBuffer, BlockCount * 512, 0xDEADBEEF);
+        DataRequestInit(&request, sectorNumber, readBuffer, BlockCount, CSDD_TRANSFER_READ);
+        status = BottomHalfXfer(slotIndex, &request, 0);
+    }
+    if (status == 0) {
+        status = Comparebuf(writeBuffer, readBuffer, BlockCount * 512);
+        if (status) {
+            SubPrint("\tError written data and read data are different\n\n");
+        }
+    }
+
+    CsddInterruptInit(sdHost, &Isr);
 
     return status;
 }
 
-uint8_t HSTest(uint8_t slotIndex, uint32_t sectorNumber)
+/* bottom half runs when DMA is about half way through the second ring
+ * page after the one which raised the interrupt, so ends of two pages
+ * are handled by one bottom half */
+#define RING_BOTTOM_HALF_DELAY_NS 60000U
+
+static uint8_t AdmaRingDeferredXfer(uint8_t slotIndex, uint32_t sectorNumber, uint8_t *buffer,
+                                    CSDD_TransferDirection direction)
 {
-    uint8_t status;
-    uint32_t freq = 50000;
-    unsigned char size;
+    static CSDD_SubBuffer segments[RING_SEGMENTS];
+    const uint32_t SegmentSize = 32;
+    CSDD_Request request;
+    int i;
 
-    SubPrint("\tSwitch to high speed mode\n");
-    status = sdHostDriver->configureHighSpeed(sdHost, slotIndex, 1);
-    CHECK_STATUS(status);
+    for (i = 0; i < RING_SEGMENTS; i++) {
+        segments[i].address = (uintptr_t)(buffer + i * SegmentSize);
+        segments[i].size = SegmentSize;
+    }
+    DataRequestInit(&request, sectorNumber, (uint8_t*)segments,
+                    RING_SEGMENTS * SegmentSize / 512, direction);
+    request.pCmd[0].subBuffersCount = RING_SEGMENTS;
 
-    size = sizeof(freq);
+    return BottomHalfXfer(slotIndex, &request, RING_BOTTOM_HALF_DELAY_NS);
+}
 
-    /* set new clock frequency */
-    status = sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_CLK,
-                                     &freq, &size);
-    CHECK_STATUS(status);
-    SubPrint("\tChange clock frequency to %dKHz \n", freq);
+uint8_t AdmaRingDeferredTest(uint8_t slotIndex, uint32_t sectorNumber)
+{
+    const uint32_t DataSize = RING_SEGMENTS * 32;
+    uint8_t DmaMode = CSDD_ADMA2_MODE, size = sizeof(DmaMode);
+    uint8_t status;
 
-    status = WriteReadCompare(slotIndex, sectorNumber, 2048);
+    status = sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_DMA_MODE,
+                                     &DmaMode, &size);
     CHECK_STATUS(status);
+    CsddInterruptInit(sdHost, &TopHalfIsr);
+    topHalfPending = 0;
 
-    return status;
-}
+    status = AdmaRingDeferredXfer(slotIndex, sectorNumber, writeBuffer, CSDD_TRANSFER_WRITE);
+    if (status == 0) {
+        Clearbuf(readBuffer, DataSize, 0xDEADBEEF);
+        status = AdmaRingDeferredXfer(slotIndex, sectorNumber, readBuffer, CSDD_TRANSFER_READ);
+    }
+    if (status == 0) {
+        status = Comparebuf(writeBuffer, readBuffer, DataSize);
+        if (status) {
+            SubPrint("\tError written data and read data are different\n\n");
+        }
+    }
 
-volatile int isrCounter = 0;
-void Isr(void* pD)
-{
-    CSDD_OBJ *sdHostDriver;
-    bool handled;
+    CsddInterruptInit(sdHost, &Isr);
+    DmaMode = CSDD_AUTO_MODE;
+    (void)sdHostDriver->configure(sdHost, slotIndex, CSDD_CONFIG_SET_DMA_MODE,
+                                  &DmaMode, &size);
 
-    isrCounter++;
-    sdHostDriver = CSDD_GetInstance();
-    sdHostDriver->isr(pD, &handled);
+    return status;
 }
 
 uint8_t MmcSwitchMode(uint8_t slotIndex, CSDD_SpeedMode cardMode,
@@ -1279,9 +2625,18 @@ uint8_t CQInterruptCoalescingTest(bool withInt)
     status = sdHostDriver->cQSetIntCoalescingConfig(sdHost, &intCoalCfg);
     CHECK_STATUS(status);
 
-    sdHostDriver->cQGetIntCoalescingTimeoutBase(sdHost, &clockFreqKHz);
-    SubPrint("Configure interrupt coalescing timeout to %lu KHz\n",
-             (unsigned long)clockFreqKHz * intCoalCfg.timeout);
+    status = sdHostDriver->cQGetIntCoalescingTimeoutBase(sdHost, &clockFreqKHz);
+    CHECK_STATUS(status);
+    SubPrint("Interrupt coalescing timeout base clock is %lu KHz\n",
+             (unsigned long)clockFreqKHz);
+#ifdef __SD4HC_MODEL__
+    /* the model reports 200 MHz, all 10 bits of the frequency value are used */
+    if (clockFreqKHz != 200000) {
+        SubPrint("Timeout base clock %lu KHz is different than suspected 200000 KHz\n\n",
+                 (unsigned long)clockFreqKHz);
+        return 1;
+    }
+#endif
 
     isrCounter = 0;
     status = CQWriteReadCompareSplit2(withInt, 1);
@@ -1316,6 +2671,523 @@ uint8_t CQInterruptCoalescingTest(bool withInt)
     return status;
 }
 
+#ifdef __SD4HC_MODEL__
+#include <pthread.h>
+
+/* producers submit more requests than CQ tasks, so the backlog is used too */
+#define CQ_STRESS_THREADS   4
+#define CQ_STRESS_REQUESTS  24
+#define CQ_STRESS_BATCH     4
+#define CQ_STRESS_FIRST_BLK 0x2000U
+#define CQ_STRESS_BLK_SIZE  512U
+
+typedef struct {
+    CSDD_CQRequest request[CQ_STRESS_REQUESTS];
+    CSDD_CQRequestData buffers[CQ_STRESS_REQUESTS];
+    uint8_t *data;
+    uint32_t firstBlock;
+    CSDD_TransferDirection direction;
+    uint32_t submitErrors;
+} CQStressProducer;
+
+static volatile uint32_t cqStressDone;
+
+/* called by the interrupt handler, concurrently with producers */
+static void CQStressComplete(CSDD_CQRequest* request, void* userContext)
+{
+    __atomic_fetch_add(&cqStressDone, 1U, __ATOMIC_SEQ_CST);
+}
+
+static void* CQStressProducerThread(void* arg)
+{
+    CQStressProducer *producer = arg;
+    int i;
+
+    for (i = 0; i < CQ_STRESS_REQUESTS; i++) {
+        CSDD_CQRequest *request = &producer->request[i];
+        /* doorbell is rung after each batch, other producers' tasks may start with it */
+        uint8_t ring = (((i + 1) % CQ_STRESS_BATCH) == 0) || (i == (CQ_STRESS_REQUESTS - 1));
+
+        memset(request, 0, sizeof(*request));
+        producer->buffers[i].buffPhyAddr = (uintptr_t)(producer->data + i * CQ_STRESS_BLK_SIZE);
+        producer->buffers[i].bufferSize = CQ_STRESS_BLK_SIZE;
+
+        request->blockAddress = producer->firstBlock + i;
+        request->blockCount = 1;
+        request->buffers = &producer->buffers[i];
+        request->numberOfBuffers = 1;
+        request->transferDirection = producer->direction;
+        request->completeCallback = CQStressComplete;
+        request->userContext = producer;
+
+        if (sdHostDriver->cQSubmit(sdHost, request, ring) != 0) {
+            producer->submitErrors++;
+        }
+    }
+
+    return NULL;
+}
+
+static uint8_t CQStressRun(CQStressProducer *producers, CSDD_TransferDirection direction,
+                           uint8_t *data)
+{
+    pthread_t threads[CQ_STRESS_THREADS];
+    const uint32_t total = CQ_STRESS_THREADS * CQ_STRESS_REQUESTS;
+    uint32_t timeout = 10000000;
+    int i, j;
+
+    cqStressDone = 0;
+    for (i = 0; i < CQ_STRESS_THREADS; i++) {
+        producers[i].data = data + i * CQ_STRESS_REQUESTS * CQ_STRESS_BLK_SIZE;
+        producers[i].firstBlock = CQ_STRESS_FIRST_BLK + i * CQ_STRESS_REQUESTS;
+        producers[i].direction = direction;
+        producers[i].submitErrors = 0;
+        if (pthread_create(&threads[i], NULL, CQStressProducerThread, &producers[i]) != 0) {
+            SubPrint("Cannot create producer thread %d\n", i);
+            return 1;
+        }
+    }
+
+    /* model delivers interrupts while this thread waits, so completions
+     * and backlog refills run concurrently with the producers */
+    while ((__atomic_load_n(&cqStressDone, __ATOMIC_SEQ_CST) < total) && (timeout > 0)) {
+        IDLE();
+        timeout--;
+    }
+
+    for (i = 0; i < CQ_STRESS_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    if (cqStressDone != total) {
+        SubPrint("Only %u of %u requests finished\n", (unsigned)cqStressDone, (unsigned)total);
+        return 1;
+    }
+
+    for (i = 0; i < CQ_STRESS_THREADS; i++) {
+        if (producers[i].submitErrors != 0) {
+            SubPrint("Producer %d: %u requests not submitted\n", i,
+                     (unsigned)producers[i].submitErrors);
+            return 1;
+        }
+        for (j = 0; j < CQ_STRESS_REQUESTS; j++) {
+            if (producers[i].request[j].cQReqStat != CSDD_CQ_REQ_STAT_FINISHED) {
+                SubPrint("Producer %d: request %d failed\n", i, j);
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+uint8_t CQMultiProducerStressTest(void)
+{
+    static CQStressProducer producers[CQ_STRESS_THREADS];
+    const uint32_t DataSize = CQ_STRESS_THREADS * CQ_STRESS_REQUESTS * CQ_STRESS_BLK_SIZE;
+    uint8_t *rbuf;
+    uint8_t status;
+    uint8_t taskId;
+
+    rbuf = malloc(DataSize);
+    if (!rbuf) {
+        SubPrint("Read buffer allocation failed\r\n");
+        return 1;
+    }
+    Clearbuf(rbuf, DataSize, 0xDEADBEEF);
+
+    status = CQStressRun(producers, CSDD_TRANSFER_WRITE, writeBuffer);
+    if (status == 0) {
+        status = CQStressRun(producers, CSDD_TRANSFER_READ, rbuf);
+    }
+
+    if (status == 0) {
+        status = Comparebuf(writeBuffer, rbuf, DataSize);
+        if (status) {
+            SubPrint("\tError written data and read data are different\n\n");
+        }
+    }
+
+    /* every task must be free again after all producers finished */
+    if ((status == 0) && ((sdHostDriver->cQGetUnusedTaskId(sdHost, &taskId) != 0) || (taskId != 0))) {
+        SubPrint("\tTasks are left busy after the test\n\n");
+        status = 1;
+    }
+
+    free(rbuf);
+
+    return status;
+}
+
+#define CQ_SCHED_MERGED     4
+#define CQ_SCHED_FIRST_BLK  0x3000U
+#define CQ_SCHED_REQ_BLOCKS 2U
+
+static volatile uint32_t cqSchedDone;
+static uint32_t cqSchedOrder[CQ_SCHED_MERGED];
+
+static void CQSchedComplete(CSDD_CQRequest* request, void* userContext)
+{
+    cqSchedOrder[cqSchedDone % CQ_SCHED_MERGED] = (uint32_t)(uintptr_t)userContext;
+    cqSchedDone++;
+}
+
+static uint8_t CQSchedWait(CSDD_CQRequest *request, uint32_t count)
+{
+    uint32_t timeout = 1000000;
+    uint32_t i;
+
+    while ((cqSchedDone < count) && (timeout > 0)) {
+        IDLE();
+        timeout--;
+    }
+    for (i = 0; i < count; i++) {
+        if (request[i].cQReqStat != CSDD_CQ_REQ_STAT_FINISHED) {
+            SubPrint("\tRequest %u failed\n", (unsigned)i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* requests of adjacent blocks go to one task, the last one rings the doorbell */
+static uint8_t CQSchedMergedXfer(CSDD_CQRequest *request, CSDD_CQRequestData *buffers,
+                                 uint8_t *data, uint32_t stride,
+                                 CSDD_TransferDirection direction)
+{
+    uint8_t status;
+    int i;
+
+    memset(request, 0, CQ_SCHED_MERGED * sizeof(*request));
+    cqSchedDone = 0;
+    for (i = 0; i < CQ_SCHED_MERGED; i++) {
+        buffers[i].buffPhyAddr = (uintptr_t)(data + i * stride);
+        buffers[i].bufferSize = CQ_SCHED_REQ_BLOCKS * 512U;
+        request[i].blockAddress = CQ_SCHED_FIRST_BLK + i * CQ_SCHED_REQ_BLOCKS;
+        request[i].blockCount = CQ_SCHED_REQ_BLOCKS;
+        request[i].buffers = &buffers[i];
+        request[i].numberOfBuffers = 1;
+        request[i].transferDirection = direction;
+        request[i].completeCallback = CQSchedComplete;
+        status = sdHostDriver->cQSubmit(sdHost, &request[i], i == (CQ_SCHED_MERGED - 1));
+        CHECK_STATUS(status);
+    }
+
+    status = CQSchedWait(request, CQ_SCHED_MERGED);
+    CHECK_STATUS(status);
+    for (i = 1; i < CQ_SCHED_MERGED; i++) {
+        if (request[i].taskId != request[0].taskId) {
+            SubPrint("\tRequest %d was not merged\n", i);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* bulk request which waited longer than its deadline is started before
+ * a latency request submitted later, without the wait latency goes first */
+static uint8_t CQSchedDeadlineOrder(uint8_t *data, bool expired, uint32_t *first)
+{
+    static const CSDD_CQIoClass ioClass[2] = { CSDD_CQ_IO_CLASS_BULK, CSDD_CQ_IO_CLASS_LATENCY };
+    CSDD_CQRequest request[2];
+    CSDD_CQRequestData buffers[2];
+    uint8_t status;
+    int i;
+
+    memset(request, 0, sizeof(request));
+    cqSchedDone = 0;
+    for (i = 0; i < 2; i++) {
+        buffers[i].buffPhyAddr = (uintptr_t)(data + i * 4096U);
+        buffers[i].bufferSize = 512U;
+        /* blocks are not adjacent, requests are never merged */
+        request[i].blockAddress = CQ_SCHED_FIRST_BLK + i * 64U;
+        request[i].blockCount = 1;
+        request[i].buffers = &buffers[i];
+        request[i].numberOfBuffers = 1;
+        request[i].transferDirection = CSDD_TRANSFER_READ;
+        request[i].ioClass = ioClass[i];
+        request[i].completeCallback = CQSchedComplete;
+        request[i].userContext = (void*)(uintptr_t)ioClass[i];
+        status = sdHostDriver->cQSubmit(sdHost, &request[i], i == 1);
+        CHECK_STATUS(status);
+        if ((i == 0) && expired) {
+            CPS_DelayNs(20000U);
+        }
+    }
+
+    status = CQSchedWait(request, 2);
+    *first = cqSchedOrder[0];
+    return status;
+}
+
+uint8_t CQSchedulerTest(void)
+{
+    static CSDD_CQRequest request[CQ_SCHED_MERGED];
+    static CSDD_CQRequestData buffers[CQ_SCHED_MERGED];
+    const uint32_t reqSize = CQ_SCHED_REQ_BLOCKS * 512U;
+    /* read buffers are apart, so merged task has one descriptor per request */
+    const uint32_t stride = 2 * reqSize;
+    CSDD_CQSchedConfig config = { 0 };
+    uint32_t first;
+    uint8_t status;
+    uint8_t *rbuf;
+    int i;
+
+    config.enable = 1;
+    config.maxMergeBlocks = 0xFFFF;
+    config.deadlineUs[CSDD_CQ_IO_CLASS_DEFAULT] = 1000;
+    config.deadlineUs[CSDD_CQ_IO_CLASS_BULK] = 10;
+    if (sdHostDriver->cQSetSchedConfig(sdHost, &config) != EINVAL) {
+        SubPrint("\tToo big merge limit accepted\n");
+        return 1;
+    }
+    config.maxMergeBlocks = 64;
+    config.deadlineUs[CSDD_CQ_IO_CLASS_BULK] = 0;
+    if (sdHostDriver->cQSetSchedConfig(sdHost, &config) != EINVAL) {
+        SubPrint("\tBulk class without deadline accepted\n");
+        return 1;
+    }
+    config.deadlineUs[CSDD_CQ_IO_CLASS_BULK] = 10;
+    status = sdHostDriver->cQSetSchedConfig(sdHost, &config);
+    CHECK_STATUS(status);
+
+    rbuf = malloc(CQ_SCHED_MERGED * stride);
+    if (!rbuf) {
+        SubPrint("Read buffer allocation failed\r\n");
+        return 1;
+    }
+    Clearbuf(rbuf, CQ_SCHED_MERGED * stride, 0xDEADBEEF);
+
+    status = CQSchedMergedXfer(request, buffers, writeBuffer, reqSize, CSDD_TRANSFER_WRITE);
+    if (status == 0) {
+        status = CQSchedMergedXfer(request, buffers, rbuf, stride, CSDD_TRANSFER_READ);
+    }
+    for (i = 0; (status == 0) && (i < CQ_SCHED_MERGED); i++) {
+        status = Comparebuf(writeBuffer + i * reqSize, rbuf + i * stride, reqSize);
+        if (status) {
+            SubPrint("\tError data of merged request %d is different\n\n", i);
+        }
+    }
+
+    if (status == 0) {
+        status = CQSchedDeadlineOrder(rbuf, false, &first);
+        if ((status == 0) && (first != CSDD_CQ_IO_CLASS_LATENCY)) {
+            SubPrint("\tLatency request was not started first\n");
+            status = 1;
+        }
+    }
+    if (status == 0) {
+        status = CQSchedDeadlineOrder(rbuf, true, &first);
+        if ((status == 0) && (first != CSDD_CQ_IO_CLASS_BULK)) {
+            SubPrint("\tRequest which missed its deadline was not started first\n");
+            status = 1;
+        }
+    }
+
+    memset(&config, 0, sizeof(config));
+    (void)sdHostDriver->cQSetSchedConfig(sdHost, &config);
+    free(rbuf);
+
+    return status;
+}
+
+#define CQ_COAL_REQUESTS  64
+#define CQ_COAL_FIRST_BLK 0x4000U
+
+static volatile uint32_t cqCoalDone;
+
+static void CQCoalComplete(CSDD_CQRequest* request, void* userContext)
+{
+    cqCoalDone++;
+}
+
+/* submits requests from first to last, at most depth of them in flight,
+ * and waits until waitFor of all requests finished */
+static uint8_t CQCoalSubmit(CSDD_CQRequest *request, CSDD_CQRequestData *buffers,
+                            int first, int last, uint32_t depth, uint32_t waitFor)
+{
+    uint32_t timeout = 10000000;
+    int i;
+
+    for (i = first; i < last; i++) {
+        while (((uint32_t)i - cqCoalDone >= depth) && (timeout > 0)) {
+            IDLE();
+            timeout--;
+        }
+        memset(&request[i], 0, sizeof(request[i]));
+        buffers[i].buffPhyAddr = (uintptr_t)(writeBuffer + i * 512);
+        buffers[i].bufferSize = 512;
+        request[i].blockAddress = CQ_COAL_FIRST_BLK + i;
+        request[i].blockCount = 1;
+        request[i].buffers = &buffers[i];
+        request[i].numberOfBuffers = 1;
+        request[i].transferDirection = CSDD_TRANSFER_WRITE;
+        request[i].intCoalEn = 1;
+        request[i].completeCallback = CQCoalComplete;
+        request[i].userContext = (void*)(uintptr_t)i;
+        if (sdHostDriver->cQSubmit(sdHost, &request[i], 1) != 0) {
+            SubPrint("\tRequest %d not submitted\n", i);
+            return 1;
+        }
+    }
+    while ((cqCoalDone < waitFor) && (timeout > 0)) {
+        IDLE();
+        timeout--;
+    }
+    if (cqCoalDone < waitFor) {
+        SubPrint("\tOnly %u of %u requests finished\n", (unsigned)cqCoalDone, (unsigned)waitFor);
+        return 1;
+    }
+
+    return 0;
+}
+
+uint8_t CQCoalAutoTest(void)
+{
+    static CSDD_CQRequest request[CQ_COAL_REQUESTS];
+    static CSDD_CQRequestData buffers[CQ_COAL_REQUESTS];
+    const int Serial = CQ_COAL_REQUESTS / 2;
+    CSDD_CQIntCoalescingAuto config = { 0 };
+    CSDD_CQIntCoalescingStats stats;
+    uint8_t status;
+
+    config.enable = 1;
+    config.latencyTargetUs = 1000;
+    if (sdHostDriver->cQSetIntCoalescingAuto(sdHost, &config) != EINVAL) {
+        SubPrint("\tAdaptive mode without interrupt rate cap accepted\n");
+        return 1;
+    }
+    config.maxIntRate = 100000;
+    status = sdHostDriver->cQSetIntCoalescingAuto(sdHost, &config);
+    CHECK_STATUS(status);
+
+    /* each request waits for the previous one, coalescing would only delay it */
+    cqCoalDone = 0;
+    status = CQCoalSubmit(request, buffers, 0, Serial, 1, Serial);
+    if (status == 0) {
+        status = sdHostDriver->cQGetIntCoalescingStats(sdHost, &stats);
+    }
+    if ((status == 0) && ((stats.enable != 0) || (stats.threshold != 0)
+                          || (stats.interrupts != stats.completions))) {
+        SubPrint("\tQueue depth 1: coalescing %u, threshold %u, %u interrupts of %u tasks\n",
+                 stats.enable, stats.threshold, (unsigned)stats.interrupts,
+                 (unsigned)stats.completions);
+        status = 1;
+    }
+
+    /* all requests are queued at once, several completions share an interrupt */
+    if (status == 0) {
+        status = CQCoalSubmit(request, buffers, Serial, CQ_COAL_REQUESTS, CQ_COAL_REQUESTS,
+                              CQ_COAL_REQUESTS - 8);
+    }
+    if (status == 0) {
+        status = sdHostDriver->cQGetIntCoalescingStats(sdHost, &stats);
+    }
+    if ((status == 0) && ((stats.enable == 0) || (stats.threshold < 2)
+                          || (stats.interrupts >= stats.completions))) {
+        SubPrint("\tLoaded queue: coalescing %u, threshold %u, %u interrupts of %u tasks\n",
+                 stats.enable, stats.threshold, (unsigned)stats.interrupts,
+                 (unsigned)stats.completions);
+        status = 1;
+    }
+    if (status == 0) {
+        status = CQCoalSubmit(request, buffers, 0, 0, 1, CQ_COAL_REQUESTS);
+    }
+
+    config.enable = 0;
+    (void)sdHostDriver->cQSetIntCoalescingAuto(sdHost, &config);
+
+    return status;
+}
+
+static uint8_t SetCQComplRing(uint8_t enable)
+{
+    uint8_t size = sizeof(enable);
+
+    return sdHostDriver->configure(sdHost, 0, CSDD_CONFIG_SET_CQ_COMPLETION_RING,
+                                   &enable, &size);
+}
+
+/* reads all completions from the ring and checks each of count requests
+ * finished exactly once */
+static uint8_t CQComplRingDrain(uint32_t count, uint32_t expOverflows)
+{
+    static CSDD_CQCompletion entries[SDIO_CFG_CQ_COMPL_RING_SIZE];
+    uint8_t seen[CQ_COAL_REQUESTS] = { 0 };
+    uint32_t total = 0, overflows = 0, i;
+    uint8_t n;
+
+    do {
+        if (sdHostDriver->cQGetCompletions(sdHost, entries, 16, &n, &overflows) != 0) {
+            SubPrint("\tCompletions not read\n");
+            return 1;
+        }
+        for (i = 0; i < n; i++) {
+            uint32_t context = (uint32_t)(uintptr_t)entries[i].userContext;
+
+            if ((context >= CQ_COAL_REQUESTS) || (seen[context] != 0)
+                || (entries[i].status != CSDD_CQ_REQ_STAT_FINISHED)
+                || (entries[i].taskId >= 31)) {
+                SubPrint("\tNot valid completion: task %u, status %u, context %u\n",
+                         entries[i].taskId, entries[i].status, (unsigned)context);
+                return 1;
+            }
+            seen[context] = 1;
+        }
+        total += n;
+    } while (n != 0);
+
+    if ((total != count) || (overflows != expOverflows)) {
+        SubPrint("\t%u completions, %u dropped, expected %u and %u\n",
+                 (unsigned)total, (unsigned)overflows, (unsigned)count,
+                 (unsigned)expOverflows);
+        return 1;
+    }
+
+    return 0;
+}
+
+uint8_t CQComplRingTest(void)
+{
+    static CSDD_CQRequest request[CQ_COAL_REQUESTS];
+    static CSDD_CQRequestData buffers[CQ_COAL_REQUESTS];
+    CSDD_CQCompletion entry;
+    const uint32_t Dropped = 8;
+    uint8_t status, n;
+
+    if (sdHostDriver->cQGetCompletions(sdHost, &entry, 1, &n, NULL) != EIO) {
+        SubPrint("\tCompletions read with ring disabled\n");
+        return 1;
+    }
+    status = SetCQComplRing(1);
+    CHECK_STATUS(status);
+
+    cqCoalDone = 0;
+    status = CQCoalSubmit(request, buffers, 0, 24, 8, 24);
+    if (status == 0) {
+        status = CQComplRingDrain(24, 0);
+    }
+
+    /* ring is filled up without reading it, next completions are dropped */
+    if (status == 0) {
+        cqCoalDone = 0;
+        status = CQCoalSubmit(request, buffers, 0, SDIO_CFG_CQ_COMPL_RING_SIZE, 16,
+                              SDIO_CFG_CQ_COMPL_RING_SIZE);
+    }
+    if (status == 0) {
+        cqCoalDone = 0;
+        status = CQCoalSubmit(request, buffers, 0, Dropped, 8, Dropped);
+    }
+    if (status == 0) {
+        status = CQComplRingDrain(SDIO_CFG_CQ_COMPL_RING_SIZE, Dropped);
+    }
+
+    (void)SetCQComplRing(0);
+
+    return status;
+}
+#endif
+
 static uint32_t readPhyReg(uint32_t address)
 {
     uint32_t value = 0;
@@ -1570,6 +3442,10 @@ int CSSD_RunFunctionalTests(void)
     config.descPhyAddress = config.descLogAddress;
     config.idDescLogAddress = (uint32_t*)malloc(sysReq.idDescSize);
     config.idDescPhyAddress = config.idDescLogAddress;
+    config.bounceCount = BOUNCE_POOL_BUFFERS;
+    config.bounceBufferSize = BOUNCE_POOL_BUFFER_SIZE;
+    config.bounceLogAddress = malloc(BOUNCE_POOL_BUFFERS * BOUNCE_POOL_BUFFER_SIZE);
+    config.bouncePhyAddress = config.bounceLogAddress;
     config.regBase = SD_REG_BASE;
 
     if (sizeof(void*) > 4) {
@@ -1660,11 +3536,41 @@ int CSSD_RunFunctionalTests(void)
     testResult("SingleSectorTest", SingleSectorTest(slotIndex, sectorNumber));
     testResult("DMATest", DMATest(slotIndex, sectorNumber));
     sectorNumber += 16;
+    testResult("BounceBufferTest", BounceBufferTest(slotIndex, sectorNumber));
+    sectorNumber += BOUNCE_POOL_BUFFER_SIZE / 512 + 1;
     testResult("ADMA3Test", ADMA3Test(slotIndex, sectorNumber));
     sectorNumber += 16;
+    testResult("BatchXferTest", BatchXferTest(slotIndex, sectorNumber));
+    sectorNumber += 3 * BATCH_ENTRIES;
+    testResult("SgTransferTest", SgTransferTest(slotIndex, sectorNumber));
+    sectorNumber += 8;
+    testResult("AdmaRingTest", AdmaRingTest(slotIndex, sectorNumber));
+    sectorNumber += 32;
+    testResult("HybridPollTest", HybridPollTest(slotIndex, sectorNumber));
+    sectorNumber += 4;
     if (USE_AUTO_CMD) {
         testResult("NonBlockingTest", NonBlockingTest(slotIndex, sectorNumber));
     }
+    testResult("BusySlotRejectTest", BusySlotRejectTest(slotIndex, sectorNumber));
+    testResult("PrepareNextTest", PrepareNextTest(slotIndex, sectorNumber));
+    sectorNumber += 24;
+    testResult("NonBlockIssueTest", NonBlockIssueTest(slotIndex, sectorNumber));
+    sectorNumber += 128;
+    testResult("QueueChainTest", QueueChainTest(slotIndex, sectorNumber));
+    sectorNumber += QUEUE_CHAIN_WRITES * QUEUE_CHAIN_BLOCKS;
+    testResult("RegCountQueueTest", RegCountQueueTest(slotIndex, sectorNumber));
+    sectorNumber += 128;
+    testResult("IsrBottomHalfTest", IsrBottomHalfTest(slotIndex, sectorNumber));
+    sectorNumber += 16;
+    testResult("AdmaRingDeferredTest", AdmaRingDeferredTest(slotIndex, sectorNumber));
+    sectorNumber += RING_SEGMENTS * 32 / 512;
+    testResult("VirtToPhysTest", VirtToPhysTest(slotIndex, sectorNumber));
+    sectorNumber += XLATE_XFER / 512;
+    testResult("CalibrationTest", CalibrationTest(slotIndex, sectorNumber));
+    sectorNumber += 32;
+    testResult("SdmaBoundaryTest", SdmaBoundaryTest(slotIndex, sectorNumber));
+    sectorNumber += 64;
+    testResult("RequestPoolTest", RequestPoolTest(slotIndex, sectorNumber));
 
     if (intType == CSDD_INTERFACE_TYPE_SD) {
         testResult("LowClockFreqTest", LowClockFreqTest(slotIndex,
@@ -1722,6 +3628,13 @@ int CSSD_RunFunctionalTests(void)
                   CQWriteReadCompareSplit2(withInt, 0));
                   testResult("CQ Split data across descriptors test",
                   CQWriteReadCompareSplited(withInt, descPtr, 2048));
+#ifdef __SD4HC_MODEL__
+                testResult("CQ Multi-producer submit stress test",
+                           CQMultiProducerStressTest());
+                testResult("CQ I/O scheduler test", CQSchedulerTest());
+                testResult("CQ adaptive interrupt coalescing test", CQCoalAutoTest());
+                testResult("CQ completion ring test", CQComplRingTest());
+#endif
 
                 /* Reset card to set slower transfer mode.
                  * To make sure that we do not miss an interrupt.*/
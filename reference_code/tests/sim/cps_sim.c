@@ -0,0 +1,230 @@
+/******************************************************************************
+*
+* (C) 2023 Cadence Design Systems, Inc. 
+*
+******************************************************************************
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+******************************************************************************
+*
+ ******************************************************************************
+ * cps_sim.c
+ *
+ * Implementation of Cadence Platform Services for running the driver on a
+ * build host against the SD4HC software model. Accesses to the controller
+ * register file are routed to the model, everything else is plain memory.
+ ******************************************************************************
+ */
+#ifdef __SD4HC_MODEL__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "cps.h"
+#include "map_system_memory.h"
+#include "sd4hc_model.h"
+
+static void ModelAttach(void)
+{
+    static int attached = 0;
+
+    if (attached == 0) {
+        if (SD4HC_ModelInit(SDHC0_REGS_APB_BASE, NULL) != 0) {
+            fprintf(stderr, "SD4HC model initialization failed\n");
+            exit(EXIT_FAILURE);
+        }
+        attached = 1;
+    }
+}
+
+/* only accesses which reach the model are counted, atomically
+ * because producer threads of the CQ stress test access registers too */
+static uint64_t regReads = 0;
+static uint64_t regWrites = 0;
+
+static int IsModelRegister(volatile const void* address)
+{
+    ModelAttach();
+    return SD4HC_ModelIsRegister((uintptr_t)address) ? 1 : 0;
+}
+
+/* see cps.h */
+uint32_t CPS_ReadReg32(volatile uint32_t* address) {
+    uint32_t value;
+    if (IsModelRegister(address) != 0) {
+        __atomic_fetch_add(&regReads, 1U, __ATOMIC_RELAXED);
+        value = SD4HC_ModelReadReg((uintptr_t)address);
+    } else {
+        value = *address;
+    }
+    return value;
+}
+
+/* see cps.h */
+void CPS_WriteReg32(volatile uint32_t* address, uint32_t value) {
+    if (IsModelRegister(address) != 0) {
+        __atomic_fetch_add(&regWrites, 1U, __ATOMIC_RELAXED);
+        SD4HC_ModelWriteReg((uintptr_t)address, value);
+    } else {
+        *address = value;
+    }
+}
+
+/* see cps.h */
+uint8_t CPS_UncachedRead8(volatile uint8_t* address) {
+    return *address;
+}
+
+/* see cps.h */
+uint16_t CPS_UncachedRead16(volatile uint16_t* address) {
+    return *address;
+}
+
+/* see cps.h */
+uint32_t CPS_UncachedRead32(volatile uint32_t* address) {
+    return CPS_ReadReg32(address);
+}
+
+/* see cps.h */
+uint64_t CPS_UncachedRead64(volatile uint64_t* address) {
+    return CPS_ReadReg64(address);
+}
+
+/* see cps.h */
+extern uint64_t CPS_ReadReg64(volatile uint64_t* address) {
+    uint64_t value;
+    if (IsModelRegister(address) != 0) {
+        __atomic_fetch_add(&regReads, 1U, __ATOMIC_RELAXED);
+        value = SD4HC_ModelReadReg((uintptr_t)address);
+        value |= (uint64_t)SD4HC_ModelReadReg((uintptr_t)address + 4U) << 32;
+    } else {
+        value = *address;
+    }
+    return value;
+}
+
+/* see cps.h */
+void CPS_UncachedWrite8(volatile uint8_t* address, uint8_t value) {
+    *address = value;
+}
+
+/* see cps.h */
+void CPS_UncachedWrite16(volatile uint16_t* address, uint16_t value) {
+    *address = value;
+}
+
+/* see cps.h */
+void CPS_UncachedWrite32(volatile uint32_t* address, uint32_t value) {
+    CPS_WriteReg32(address, value);
+}
+
+/* see cps.h */
+void CPS_UncachedWrite64(volatile uint64_t* address, uint64_t value) {
+    CPS_WriteReg64(address, value);
+}
+
+/* see cps.h */
+extern void CPS_WriteReg64(volatile uint64_t* address, uint64_t value) {
+    if (IsModelRegister(address) != 0) {
+        __atomic_fetch_add(&regWrites, 1U, __ATOMIC_RELAXED);
+        SD4HC_ModelWriteReg((uintptr_t)address, (uint32_t)value);
+        SD4HC_ModelWriteReg((uintptr_t)address + 4U, (uint32_t)(value >> 32));
+    } else {
+        *address = value;
+    }
+}
+
+/* see cps.h */
+void CPS_WritePhysAddress32(volatile uint32_t* location, uint32_t addrValue) {
+    *location = addrValue;
+}
+
+/* see cps.h */
+void CPS_BufferCopy(volatile uint8_t *dst, volatile const uint8_t *src, uint32_t size) {
+    memcpy((void*)dst, (void*)src, size);
+}
+
+/* The model accesses host memory directly, so there is no cache to maintain */
+
+void CPS_CacheInvalidate(void* address, size_t size, uintptr_t devInfo) {
+    return;
+}
+
+void CPS_CacheFlush(void* address, size_t size, uintptr_t devInfo) {
+    return;
+}
+
+/* see cps.h */
+void CPS_DelayNs(uint32_t ns)
+{
+    ModelAttach();
+    SD4HC_ModelDelay(ns);
+}
+
+/* see cps.h */
+uint64_t CPS_GetTimeNs(void)
+{
+    ModelAttach();
+    return SD4HC_ModelGetTimeNs();
+}
+
+/* see cps.h */
+void CPS_GetRegAccessCount(uint64_t* reads, uint64_t* writes)
+{
+    *reads = regReads;
+    *writes = regWrites;
+}
+
+/* see cps.h */
+void CPS_MemoryBarrier(void) {
+    __sync_synchronize();
+}
+
+/* see cps.h */
+void CPS_MemoryBarrierWrite(void) {
+    __sync_synchronize();
+}
+
+/* see cps.h */
+void CPS_MemoryBarrierRead(void) {
+    __sync_synchronize();
+}
+
+/* see cps.h */
+bool CPS_AtomicCompareSwap32(volatile uint32_t* address, uint32_t expected, uint32_t value) {
+    return __atomic_compare_exchange_n(address, &expected, value, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+/* see cps.h */
+bool CPS_AtomicCompareSwapPtr(void* volatile* address, void* expected, void* value) {
+    return __atomic_compare_exchange_n(address, &expected, value, false,
+                                       __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+#endif /* __SD4HC_MODEL__ */
@@ -0,0 +1,2349 @@
+/******************************************************************************
+*
+* (C) 2023 Cadence Design Systems, Inc.
+*
+******************************************************************************
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+******************************************************************************
+*
+ ******************************************************************************
+ * sd4hc_model.c
+ *
+ * Software model of the SD4HC host controller and an attached memory card.
+ *
+ * The controller part keeps the SRS/HRS/CQRS register file, runs the command
+ * and data engines (PIO, SDMA, ADMA2, ADMA3 and the command queue) and
+ * computes the interrupt status. The card part answers the SD and eMMC
+ * commands used by the core driver and stores data in RAM or in an image
+ * file. All activity is scheduled on a virtual time line; see sd4hc_model.h.
+ ******************************************************************************
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "sd4hc_regs.h"
+#include "ccp_full_regs.h"
+#include "sd4hc_model.h"
+
+/* register indexes inside the modelled register file */
+#define REG_IDX(reg) ((uint32_t)(offsetof(SD4HC_Regs, reg) / 4U))
+#define REG_COUNT    ((uint32_t)(sizeof(SD4HC_Regs) / 4U))
+
+/* register fields used by the model */
+#define SRS01_TBS          SD4HC__SRS__SRS01__TBS_MASK
+#define SRS01_SDMABB       SD4HC__SRS__SRS01__SDMABB_MASK
+#define SRS03_DMAE         SD4HC__SRS__SRS03__DMAE_MASK
+#define SRS03_BCE          SD4HC__SRS__SRS03__BCE_MASK
+#define SRS03_ACE          SD4HC__SRS__SRS03__ACE_MASK
+#define SRS03_DTDS         SD4HC__SRS__SRS03__DTDS_MASK
+#define SRS03_MSBS         SD4HC__SRS__SRS03__MSBS_MASK
+#define SRS03_RID          SD4HC__SRS__SRS03__RID_MASK
+#define SRS03_RTS          SD4HC__SRS__SRS03__RTS_MASK
+#define SRS03_SCF          SD4HC__SRS__SRS03__SCF_MASK
+#define SRS03_DPS          SD4HC__SRS__SRS03__DPS_MASK
+#define SRS03_CT           SD4HC__SRS__SRS03__CT_MASK
+#define SRS03_CIDX         SD4HC__SRS__SRS03__CIDX_MASK
+#define SRS09_CICMD        SD4HC__SRS__SRS09__CICMD_MASK
+#define SRS09_CIDAT        SD4HC__SRS__SRS09__CIDAT_MASK
+#define SRS09_DLA          SD4HC__SRS__SRS09__DLA_MASK
+#define SRS09_WTA          SD4HC__SRS__SRS09__WTA_MASK
+#define SRS09_RTA          SD4HC__SRS__SRS09__RTA_MASK
+#define SRS09_BWE          SD4HC__SRS__SRS09__BWE_MASK
+#define SRS09_BRE          SD4HC__SRS__SRS09__BRE_MASK
+#define SRS09_CI           SD4HC__SRS__SRS09__CI_MASK
+#define SRS09_CSS          SD4HC__SRS__SRS09__CSS_MASK
+#define SRS09_CDSL         SD4HC__SRS__SRS09__CDSL_MASK
+#define SRS09_WPSL         SD4HC__SRS__SRS09__WPSL_MASK
+#define SRS09_DATSL1       SD4HC__SRS__SRS09__DATSL1_MASK
+#define SRS09_CMDSL        SD4HC__SRS__SRS09__CMDSL_MASK
+#define SRS09_SCMDS        SD4HC__SRS__SRS09__SCMDS_MASK
+#define SRS10_DTW          SD4HC__SRS__SRS10__DTW_MASK
+#define SRS10_DMASEL       SD4HC__SRS__SRS10__DMASEL_MASK
+#define SRS10_EDTW         SD4HC__SRS__SRS10__EDTW_MASK
+#define SRS10_BP           SD4HC__SRS__SRS10__BP_MASK
+#define SRS11_ICE          SD4HC__SRS__SRS11__ICE_MASK
+#define SRS11_ICS          SD4HC__SRS__SRS11__ICS_MASK
+#define SRS11_SDCE         SD4HC__SRS__SRS11__SDCE_MASK
+#define SRS11_SDCFSH       SD4HC__SRS__SRS11__SDCFSH_MASK
+#define SRS11_SDCFSL       SD4HC__SRS__SRS11__SDCFSL_MASK
+#define SRS11_SRFA         SD4HC__SRS__SRS11__SRFA_MASK
+#define SRS11_SRCMD        SD4HC__SRS__SRS11__SRCMD_MASK
+#define SRS11_SRDAT        SD4HC__SRS__SRS11__SRDAT_MASK
+#define SRS12_CC           SD4HC__SRS__SRS12__CC_MASK
+#define SRS12_TC           SD4HC__SRS__SRS12__TC_MASK
+#define SRS12_DMAINT       SD4HC__SRS__SRS12__DMAINT_MASK
+#define SRS12_BWR          SD4HC__SRS__SRS12__BWR_MASK
+#define SRS12_BRR          SD4HC__SRS__SRS12__BRR_MASK
+#define SRS12_CQINT        SD4HC__SRS__SRS12__CQINT_MASK
+#define SRS12_EINT         SD4HC__SRS__SRS12__EINT_MASK
+#define SRS12_ECT          SD4HC__SRS__SRS12__ECT_MASK
+#define SRS12_EADMA        SD4HC__SRS__SRS12__EADMA_MASK
+#define SRS12_ERR_MASK     0xFFFF0000U
+#define SRS15_EXTNG        SD4HC__SRS__SRS15__EXTNG_MASK
+#define SRS15_SCS          SD4HC__SRS__SRS15__SCS_MASK
+#define SRS15_ADMA2LM      SD4HC__SRS__SRS15__ADMA2LM_MASK
+#define SRS15_CMD23E       SD4HC__SRS__SRS15__CMD23E_MASK
+#define SRS15_HV4E         SD4HC__SRS__SRS15__HV4E_MASK
+#define SRS15_A64B         SD4HC__SRS__SRS15__A64B_MASK
+#define SRS16_BCSDCLK      SD4HC__SRS__SRS16__BCSDCLK_MASK
+#define SRS21_EADMAS       SD4HC__SRS__SRS21__EADMAS_MASK
+#define CQRS02_CQE         SD4HC__CQRS__CQRS02__CQE_MASK
+#define CQRS02_CQTDS       SD4HC__CQRS__CQRS02__CQTDS_MASK
+#define CQRS03_CQHLT       SD4HC__CQRS__CQRS03__CQHLT_MASK
+#define CQRS03_CQCAT       SD4HC__CQRS__CQRS03__CQCAT_MASK
+#define CQRS04_CQHAC       SD4HC__CQRS__CQRS04__CQHAC_MASK
+#define CQRS04_CQTCC       SD4HC__CQRS__CQRS04__CQTCC_MASK
+#define CQRS04_WOCLR       SD4HC__CQRS__CQRS04_WOCLR_MASK
+#define CQRS07_CQICTOVAL   SD4HC__CQRS__CQRS07__CQICTOVAL_MASK
+#define CQRS07_CQICTOVALEN SD4HC__CQRS__CQRS07__CQICTOVALEN_MASK
+#define CQRS07_CQICCTH     SD4HC__CQRS__CQRS07__CQICCTH_MASK
+#define CQRS07_CQICCTHWEN  SD4HC__CQRS__CQRS07__CQICCTHWEN_MASK
+#define CQRS07_CQICCTR     SD4HC__CQRS__CQRS07__CQICCTR_MASK
+#define CQRS07_CQICSB      SD4HC__CQRS__CQRS07__CQICSB_MASK
+#define CQRS07_CQICED      SD4HC__CQRS__CQRS07__CQICED_MASK
+
+/* reset values of the read only identification registers */
+#define MODEL_HRS00_RESET  0x00010000U  /* one slot available */
+#define MODEL_HRS30_VALUE  0x00000003U  /* CQ and HS400ES supported */
+#define MODEL_HRS31_VALUE  0x06000000U  /* host controller version 6 */
+#define MODEL_SRS16_VALUE  (32U | SD4HC__SRS__SRS16__TCU_MASK \
+                            | (200U << 8) | (2U << 16) \
+                            | SD4HC__SRS__SRS16__EDS8_MASK \
+                            | SD4HC__SRS__SRS16__ADMA2S_MASK \
+                            | SD4HC__SRS__SRS16__HSS_MASK \
+                            | SD4HC__SRS__SRS16__DMAS_MASK \
+                            | SD4HC__SRS__SRS16__VS33_MASK \
+                            | SD4HC__SRS__SRS16__A64SV4_MASK \
+                            | SD4HC__SRS__SRS16__A64SV3_MASK)
+#define MODEL_SRS17_VALUE  SD4HC__SRS__SRS17__ADMA3SUP_MASK
+#define MODEL_CRS63_VALUE  (4U << 16)    /* SD host specification 4.10 */
+#define MODEL_CQRS00_VALUE 0x00000510U  /* CQ version 5.10 */
+#define MODEL_CQRS01_VALUE ((3U << 12) | 200U) /* internal timer clock 200 MHz */
+
+/* PHY registers with a non-zero reset value */
+#define MODEL_PHY_VERSION_REG 0x2070U
+#define MODEL_PHY_VERSION     (0x6182U << 16)
+#define MODEL_PHY_MAX_REGS    64U
+
+/* ADMA2 and ADMA3 descriptor attributes */
+#define ADMA_ATTR_VALID     0x01U
+#define ADMA_ATTR_END       0x02U
+#define ADMA_ATTR_INT       0x04U
+#define ADMA_ATTR_ACT_MASK  0x38U
+#define ADMA_ATTR_ACT_TRAN  0x20U
+#define ADMA_ATTR_ACT_LINK  0x30U
+#define ADMA3_CMD_DESC_SIZE 8U
+#define ADMA3_CMD_DESC_NUM  4U
+
+/* command queue descriptor fields */
+#define CQ_ATTR_VALID       0x0001U
+#define CQ_ATTR_END         0x0002U
+#define CQ_ATTR_INT         0x0004U
+#define CQ_ATTR_ACT_MASK    0x0038U
+#define CQ_ATTR_ACT_TRAN    (4U << 3)
+#define CQ_ATTR_ACT_LINK    (6U << 3)
+#define CQ_ATTR_DIR_READ    0x1000U
+#define CQ_DCMD_TASK        31U
+#define CQ_DCMD_RESP_R1B    3U
+#define CQ_MAX_DESCRIPTORS  256U
+
+/* eMMC EXT_CSD bytes */
+#define EXT_CSD_CMDQ_MODE_EN 15U
+#define EXT_CSD_BUS_WIDTH    183U
+#define EXT_CSD_HS_TIMING    185U
+#define EXT_CSD_SEC_CNT      212U
+
+#define MODEL_BLOCK_SIZE    512U
+#define MODEL_FIFO_SIZE     4096U
+#define MODEL_NEVER         UINT64_MAX
+
+/* card states as reported in the R1 status */
+typedef enum {
+    CARD_IDLE = 0,
+    CARD_READY = 1,
+    CARD_IDENT = 2,
+    CARD_STBY = 3,
+    CARD_TRAN = 4,
+    CARD_DATA = 5,
+    CARD_RCV = 6,
+    CARD_PRG = 7
+} CardState;
+
+/* where the data phase of the last command goes to or comes from */
+typedef enum {
+    DATA_SRC_NONE = 0,
+    DATA_SRC_STORAGE,
+    DATA_SRC_BUFFER
+} DataSource;
+
+typedef enum {
+    RESP_NONE = 0,
+    RESP_48,
+    RESP_136
+} RespKind;
+
+typedef enum {
+    XFER_PIO = 0,
+    XFER_SDMA,
+    XFER_ADMA2
+} XferMode;
+
+typedef struct {
+    CardState state;
+    bool appCmd;
+    uint16_t rca;
+    uint32_t blockLen;
+    uint32_t eraseStart;
+    uint32_t eraseEnd;
+    uint8_t cid[16];
+    uint8_t csd[16];
+    uint8_t extCsd[512];
+    uint8_t sdFunc[6];
+    /* data phase of the last command */
+    DataSource src;
+    uint64_t offset;
+    uint8_t buf[512];
+    uint32_t bufLen;
+    /* storage */
+    uint64_t capacity;
+    int fd;
+    uint8_t *ram;
+} ModelCard;
+
+typedef struct {
+    bool active;
+    bool adma3;
+    uint32_t srs03;
+    uint32_t arg;
+    uint64_t at;
+} ModelCmd;
+
+typedef struct {
+    bool active;
+    bool read;
+    bool infinite;
+    bool adma3;
+    bool finishing;
+    bool paused;
+    bool pauseNext;
+    bool errorNext;
+    bool intNext;
+    XferMode mode;
+    uint8_t autoCmd;
+    uint32_t blockLen;
+    uint64_t blocksLeft;
+    uint64_t bytesLeft;
+    /* PIO buffer */
+    uint8_t fifo[MODEL_FIFO_SIZE];
+    uint32_t fifoPos;
+    bool bufReady;
+    /* SDMA */
+    uint64_t sysAddr;
+    uint32_t boundary;
+    /* ADMA2 */
+    uint64_t descAddr;
+    uint64_t segAddr;
+    uint32_t segLeft;
+    bool segInt;
+    bool segEnd;
+    uint64_t at;
+} ModelData;
+
+typedef struct {
+    bool active;
+    bool last;
+    uint64_t idAddr;
+    uint64_t dataDescAddr;
+    uint64_t at;
+} ModelAdma3;
+
+typedef struct {
+    uint32_t status;      /* CQRS04 */
+    uint32_t doorbell;    /* CQRS10 */
+    uint32_t completion;  /* CQRS11 */
+    uint32_t pending;     /* CQRS13 */
+    uint32_t clear;       /* CQRS14 */
+    uint32_t coalCtrl;    /* CQRS07 without the counter state */
+    uint32_t coalCount;
+    uint64_t coalAt;
+    int32_t current;
+    uint64_t at;
+} ModelCq;
+
+typedef struct {
+    uint32_t address;
+    uint32_t value;
+} ModelPhyReg;
+
+typedef struct {
+    pthread_mutex_t lock;
+    bool initialized;
+    uintptr_t base;
+    SD4HC_ModelConfig cfg;
+    uint64_t now;
+    uint32_t regs[REG_COUNT];
+    uint32_t intStatus;
+    ModelPhyReg phy[MODEL_PHY_MAX_REGS];
+    uint32_t phyCount;
+    void (*isr)(void *arg);
+    void *isrArg;
+    bool inIsr;
+    ModelCard card;
+    ModelCmd cmd;
+    ModelCmd sub;
+    uint64_t busyAt;
+    bool busyAdma3;
+    ModelData data;
+    ModelAdma3 adma3;
+    ModelCq cq;
+    SD4HC_ModelStats stats;
+} SD4HC_Model;
+
+static SD4HC_Model model = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+#define REG(reg) (model.regs[REG_IDX(reg)])
+
+static void CardCommand(uint32_t idx, uint32_t arg, RespKind *kind, uint32_t *r1, uint8_t *r2);
+static void DataStart(const ModelCmd *cmd);
+static void Adma3Next(void);
+
+/******************************************************************************
+ * Helpers
+ *****************************************************************************/
+
+static uint32_t EnvU32(const char *name, uint32_t def)
+{
+    const char *val = getenv(name);
+    uint32_t ret = def;
+
+    if ((val != NULL) && (*val != '\0')) {
+        ret = (uint32_t)strtoul(val, NULL, 0);
+    }
+    return ret;
+}
+
+static uint32_t MemRead32(uint64_t address)
+{
+    uint32_t value;
+    memcpy(&value, (const void*)(uintptr_t)address, sizeof(value));
+    return value;
+}
+
+static uint64_t Min64(uint64_t a, uint64_t b)
+{
+    return (a < b) ? a : b;
+}
+
+/* bus time in ns needed to move size bytes over the data lines */
+static uint64_t BusNs(uint64_t size)
+{
+    uint64_t kbps = model.cfg.busKBps;
+    uint64_t ns;
+
+    if (kbps == 0U) {
+        /* derive bandwidth from SD clock frequency and bus width */
+        const uint32_t srs10 = REG(SRS.SRS10);
+        const uint32_t srs11 = REG(SRS.SRS11);
+        const uint64_t baseKHz = (uint64_t)((MODEL_SRS16_VALUE & SRS16_BCSDCLK) >> 8) * 1000U;
+        const uint32_t div = ((srs11 & SRS11_SDCFSL) >> 8) | ((srs11 & SRS11_SDCFSH) << 2);
+        const uint64_t clkKHz = (div == 0U) ? baseKHz : (baseKHz / (2U * div));
+        const uint64_t width = ((srs10 & SRS10_EDTW) != 0U) ? 8U :
+                               (((srs10 & SRS10_DTW) != 0U) ? 4U : 1U);
+        kbps = (clkKHz * 1000U * width) / (8U * 1024U);
+        if (kbps == 0U) {
+            kbps = 1U;
+        }
+    }
+    ns = (size * 1000000000ULL) / (kbps * 1024U);
+    if (ns == 0U) {
+        ns = 1U;
+    }
+    model.stats.dataBusyNs += ns;
+    return ns;
+}
+
+/******************************************************************************
+ * Card storage
+ *****************************************************************************/
+
+static int StorageOpen(void)
+{
+    ModelCard *card = &model.card;
+    int ret = 0;
+
+    card->fd = -1;
+    card->ram = NULL;
+    card->capacity = (uint64_t)model.cfg.capacityMB << 20;
+
+    if (model.cfg.imagePath != NULL) {
+        struct stat st;
+        card->fd = open(model.cfg.imagePath, O_RDWR | O_CREAT, 0644);
+        if ((card->fd < 0) || (fstat(card->fd, &st) != 0)) {
+            perror(model.cfg.imagePath);
+            ret = -1;
+        } else {
+            if (card->capacity == 0U) {
+                card->capacity = (uint64_t)st.st_size;
+            } else if ((uint64_t)st.st_size < card->capacity) {
+                if (ftruncate(card->fd, (off_t)card->capacity) != 0) {
+                    perror(model.cfg.imagePath);
+                    ret = -1;
+                }
+            } else {
+                /* keep image size */
+            }
+        }
+    } else {
+        if (card->capacity == 0U) {
+            card->capacity = 128ULL << 20;
+        }
+        card->ram = calloc(1, card->capacity);
+        if (card->ram == NULL) {
+            ret = -1;
+        }
+    }
+    card->capacity &= ~(uint64_t)(MODEL_BLOCK_SIZE - 1U);
+    if ((ret == 0) && (card->capacity == 0U)) {
+        fprintf(stderr, "sd4hc model: card image is empty\n");
+        ret = -1;
+    }
+    return ret;
+}
+
+static void StorageClose(void)
+{
+    if (model.card.fd >= 0) {
+        (void)close(model.card.fd);
+        model.card.fd = -1;
+    }
+    free(model.card.ram);
+    model.card.ram = NULL;
+}
+
+static void StorageRead(uint64_t offset, uint8_t *dst, uint32_t size)
+{
+    ModelCard *card = &model.card;
+    uint32_t valid = 0;
+
+    if (offset < card->capacity) {
+        valid = (uint32_t)Min64(size, card->capacity - offset);
+    }
+    if (valid > 0U) {
+        if (card->ram != NULL) {
+            memcpy(dst, &card->ram[offset], valid);
+        } else if (pread(card->fd, dst, valid, (off_t)offset) != (ssize_t)valid) {
+            memset(dst, 0, valid);
+        } else {
+            /* data read from image */
+        }
+    }
+    memset(&dst[valid], 0, size - valid);
+    model.stats.bytesRead += size;
+}
+
+static void StorageWrite(uint64_t offset, const uint8_t *src, uint32_t size)
+{
+    ModelCard *card = &model.card;
+    uint32_t valid = 0;
+
+    if (offset < card->capacity) {
+        valid = (uint32_t)Min64(size, card->capacity - offset);
+    }
+    if (valid > 0U) {
+        if (card->ram != NULL) {
+            memcpy(&card->ram[offset], src, valid);
+        } else if (pwrite(card->fd, src, valid, (off_t)offset) != (ssize_t)valid) {
+            perror("sd4hc model: image write");
+        } else {
+            /* data written to image */
+        }
+    }
+    model.stats.bytesWritten += size;
+}
+
+static void StorageErase(uint64_t first, uint64_t last)
+{
+    static const uint8_t zero[MODEL_BLOCK_SIZE];
+    uint64_t block;
+
+    for (block = first; block <= last; block++) {
+        const uint64_t offset = block * MODEL_BLOCK_SIZE;
+        if (offset >= model.card.capacity) {
+            break;
+        }
+        if (model.card.ram != NULL) {
+            memset(&model.card.ram[offset], 0, MODEL_BLOCK_SIZE);
+        } else {
+            (void)pwrite(model.card.fd, zero, MODEL_BLOCK_SIZE, (off_t)offset);
+        }
+    }
+}
+
+/* move data of the current card transfer into dst */
+static void CardReadData(uint8_t *dst, uint32_t size)
+{
+    ModelCard *card = &model.card;
+
+    if (card->src == DATA_SRC_STORAGE) {
+        StorageRead(card->offset, dst, size);
+        model.stats.blocksRead += size / MODEL_BLOCK_SIZE;
+    } else if (card->src == DATA_SRC_BUFFER) {
+        uint32_t i;
+        for (i = 0; i < size; i++) {
+            const uint64_t pos = card->offset + i;
+            dst[i] = (pos < card->bufLen) ? card->buf[pos] : 0U;
+        }
+    } else {
+        memset(dst, 0, size);
+    }
+    card->offset += size;
+}
+
+/* move data of the current card transfer from src */
+static void CardWriteData(const uint8_t *src, uint32_t size)
+{
+    ModelCard *card = &model.card;
+
+    if (card->src == DATA_SRC_STORAGE) {
+        StorageWrite(card->offset, src, size);
+        model.stats.blocksWritten += size / MODEL_BLOCK_SIZE;
+    }
+    card->offset += size;
+}
+
+/******************************************************************************
+ * Card registers
+ *****************************************************************************/
+
+/* set a bit field in a big-endian 128-bit register, start is the LSB position */
+static void SetBits128(uint8_t *reg, uint32_t start, uint32_t width, uint32_t value)
+{
+    uint32_t i;
+
+    for (i = 0; i < width; i++) {
+        const uint32_t bit = start + i;
+        const uint32_t byte = 15U - (bit / 8U);
+        const uint8_t mask = (uint8_t)(1U << (bit % 8U));
+        if (((value >> i) & 1U) != 0U) {
+            reg[byte] |= mask;
+        } else {
+            reg[byte] &= (uint8_t)~mask;
+        }
+    }
+}
+
+static void CardInitRegisters(void)
+{
+    ModelCard *card = &model.card;
+    const uint64_t sectors = card->capacity / MODEL_BLOCK_SIZE;
+
+    memset(card->cid, 0, sizeof(card->cid));
+    memset(card->csd, 0, sizeof(card->csd));
+    memset(card->extCsd, 0, sizeof(card->extCsd));
+
+    /* CID: manufacturer, OEM, product name "SIMCD", serial number */
+    card->cid[0] = 0x03U;
+    memcpy(&card->cid[1], "CDSIMCD", 7);
+    card->cid[8] = 0x10U;
+    card->cid[9] = 0x12U;
+    card->cid[10] = 0x34U;
+    card->cid[11] = 0x56U;
+    card->cid[12] = 0x78U;
+    card->cid[13] = 0x01U;
+    card->cid[14] = 0x7AU;
+
+    if (model.cfg.cardType == SD4HC_MODEL_CARD_SD) {
+        /* CSD version 2.0 */
+        const uint32_t cSize = (uint32_t)(card->capacity / (512U * 1024U)) - 1U;
+        SetBits128(card->csd, 126, 2, 1);
+        SetBits128(card->csd, 112, 8, 0x0E);      /* TAAC */
+        SetBits128(card->csd, 96, 8, 0x32);       /* TRAN_SPEED */
+        SetBits128(card->csd, 84, 12, 0x5B5);     /* CCC */
+        SetBits128(card->csd, 80, 4, 9);          /* READ_BL_LEN */
+        SetBits128(card->csd, 48, 22, cSize);
+        SetBits128(card->csd, 46, 1, 1);          /* ERASE_BLK_EN */
+        SetBits128(card->csd, 39, 7, 0x7F);       /* SECTOR_SIZE */
+        SetBits128(card->csd, 22, 4, 9);          /* WRITE_BL_LEN */
+    } else {
+        SetBits128(card->csd, 126, 2, 3);         /* CSD_STRUCTURE: in EXT_CSD */
+        SetBits128(card->csd, 122, 4, 4);         /* SPEC_VERS */
+        SetBits128(card->csd, 112, 8, 0x0E);
+        SetBits128(card->csd, 96, 8, 0x32);
+        SetBits128(card->csd, 84, 12, 0x8F5);
+        SetBits128(card->csd, 80, 4, 9);
+        SetBits128(card->csd, 62, 12, 0xFFF);     /* C_SIZE: size in EXT_CSD */
+        SetBits128(card->csd, 47, 3, 7);          /* C_SIZE_MULT */
+        SetBits128(card->csd, 22, 4, 9);
+
+        card->extCsd[504] = 0x01U;                /* S_CMD_SET */
+        card->extCsd[308] = 0x01U;                /* CMDQ_SUPPORT */
+        card->extCsd[307] = 31U;                  /* CMDQ_DEPTH - 1 */
+        card->extCsd[EXT_CSD_SEC_CNT] = (uint8_t)sectors;
+        card->extCsd[EXT_CSD_SEC_CNT + 1U] = (uint8_t)(sectors >> 8);
+        card->extCsd[EXT_CSD_SEC_CNT + 2U] = (uint8_t)(sectors >> 16);
+        card->extCsd[EXT_CSD_SEC_CNT + 3U] = (uint8_t)(sectors >> 24);
+        card->extCsd[196] = 0x03U;                /* DEVICE_TYPE: HS26 and HS52 */
+        card->extCsd[194] = 0x02U;                /* CSD_STRUCTURE */
+        card->extCsd[192] = 0x08U;                /* EXT_CSD_REV */
+    }
+}
+
+/* card goes to idle state, on CMD0 and on power up */
+static void CardReset(void)
+{
+    ModelCard *card = &model.card;
+
+    card->state = CARD_IDLE;
+    card->appCmd = false;
+    card->rca = 0;
+    card->blockLen = MODEL_BLOCK_SIZE;
+    card->src = DATA_SRC_NONE;
+    memset(card->sdFunc, 0, sizeof(card->sdFunc));
+    card->extCsd[EXT_CSD_BUS_WIDTH] = 0;
+    card->extCsd[EXT_CSD_HS_TIMING] = 0;
+    card->extCsd[EXT_CSD_CMDQ_MODE_EN] = 0;
+}
+
+static uint32_t CardStatus(CardState state)
+{
+    uint32_t status = ((uint32_t)state << 9) | 0x100U;   /* READY_FOR_DATA */
+
+    if (model.card.appCmd) {
+        status |= 0x20U;                                 /* APP_CMD */
+    }
+    return status;
+}
+
+static void CardSetBuffer(const uint8_t *data, uint32_t size)
+{
+    ModelCard *card = &model.card;
+
+    memset(card->buf, 0, sizeof(card->buf));
+    if (data != NULL) {
+        memcpy(card->buf, data, size);
+    }
+    card->bufLen = size;
+    card->offset = 0;
+    card->src = DATA_SRC_BUFFER;
+}
+
+/* SD CMD6 switch function status */
+static void CardSdSwitch(uint32_t arg)
+{
+    ModelCard *card = &model.card;
+    uint8_t status[64] = { 0 };
+    uint8_t result[6];
+    bool valid = true;
+    uint32_t group;
+
+    status[0] = 0x00U;
+    status[1] = 0x64U;                       /* 100 mA */
+    for (group = 0; group < 5U; group++) {
+        status[2U + (2U * group)] = 0x80U;
+        status[3U + (2U * group)] = 0x01U;   /* function 0 only */
+    }
+    status[12] = 0x80U;
+    status[13] = 0x03U;                      /* default and high speed */
+
+    for (group = 0; group < 6U; group++) {
+        const uint8_t func = (uint8_t)((arg >> (group * 4U)) & 0xFU);
+        const uint8_t maxFunc = (group == 0U) ? 1U : 0U;
+        if (func == 0xFU) {
+            result[group] = card->sdFunc[group];
+        } else if (func <= maxFunc) {
+            result[group] = func;
+        } else {
+            result[group] = 0xFU;
+            valid = false;
+        }
+    }
+    status[14] = (uint8_t)((result[5] << 4) | result[4]);
+    status[15] = (uint8_t)((result[3] << 4) | result[2]);
+    status[16] = (uint8_t)((result[1] << 4) | result[0]);
+    status[17] = 0x01U;
+
+    if (valid && ((arg & 0x80000000U) != 0U)) {
+        memcpy(card->sdFunc, result, sizeof(card->sdFunc));
+    }
+    CardSetBuffer(status, sizeof(status));
+}
+
+/* eMMC CMD6 EXT_CSD access */
+static void CardMmcSwitch(uint32_t arg)
+{
+    ModelCard *card = &model.card;
+    const uint32_t access = (arg >> 24) & 3U;
+    const uint32_t index = (arg >> 16) & 0xFFU;
+    const uint8_t value = (uint8_t)(arg >> 8);
+
+    if (access == 1U) {
+        card->extCsd[index] |= value;
+    } else if (access == 2U) {
+        card->extCsd[index] &= (uint8_t)~value;
+    } else if (access == 3U) {
+        card->extCsd[index] = value;
+    } else {
+        /* command set change is ignored */
+    }
+}
+
+static void CardTuningBlock(void)
+{
+    static const uint8_t pattern[64] = {
+        0xFF, 0x0F, 0xFF, 0x00, 0xFF, 0xCC, 0xC3, 0xCC,
+        0xC3, 0x3C, 0xCC, 0xFF, 0xFE, 0xFF, 0xFE, 0xEF,
+        0xFF, 0xDF, 0xFF, 0xDD, 0xFF, 0xFB, 0xFF, 0xFB,
+        0xBF, 0xFF, 0x7F, 0xFF, 0x77, 0xF7, 0xBD, 0xEF,
+        0xFF, 0xF0, 0xFF, 0xF0, 0x0F, 0xFC, 0xCC, 0x3C,
+        0xCC, 0x33, 0xCC, 0xCF, 0xFF, 0xEF, 0xFF, 0xEE,
+        0xFF, 0xFD, 0xFF, 0xFD, 0xDF, 0xFF, 0xBF, 0xFF,
+        0xBB, 0xFF, 0xF7, 0xFF, 0xF7, 0x7F, 0x7B, 0xDE
+    };
+    uint8_t block[128];
+
+    memcpy(block, pattern, sizeof(pattern));
+    memcpy(&block[64], pattern, sizeof(pattern));
+    CardSetBuffer(block, sizeof(block));
+}
+
+static bool CardAppCommand(uint32_t idx, uint32_t arg, RespKind *kind, uint32_t *r1)
+{
+    ModelCard *card = &model.card;
+    static const uint8_t scr[8] = { 0x02, 0x35, 0x80, 0x03, 0x00, 0x00, 0x00, 0x00 };
+    const uint32_t status = CardStatus(card->state);
+    bool handled = true;
+
+    switch (idx) {
+    case 6U:
+    case 23U:
+    case 42U:
+        *kind = RESP_48;
+        *r1 = status;
+        break;
+    case 13U:
+        CardSetBuffer(NULL, 64U);
+        *kind = RESP_48;
+        *r1 = status;
+        break;
+    case 22U:
+        CardSetBuffer(NULL, 4U);
+        *kind = RESP_48;
+        *r1 = status;
+        break;
+    case 41U:
+        if ((card->state == CARD_IDLE) || (card->state == CARD_READY)) {
+            uint32_t ocr = 0x00FF8000U;
+            if ((arg & 0x00FF8000U) != 0U) {
+                ocr |= 0x80000000U | (arg & 0x40000000U);
+                card->state = CARD_READY;
+            }
+            *kind = RESP_48;
+            *r1 = ocr;
+        }
+        break;
+    case 51U:
+        CardSetBuffer(scr, sizeof(scr));
+        *kind = RESP_48;
+        *r1 = status;
+        break;
+    default:
+        handled = false;
+        break;
+    }
+    return handled;
+}
+
+/* execute a command on the card and produce its response */
+static void CardCommand(uint32_t idx, uint32_t arg, RespKind *kind, uint32_t *r1, uint8_t *r2)
+{
+    ModelCard *card = &model.card;
+    const bool isSd = (model.cfg.cardType == SD4HC_MODEL_CARD_SD);
+    const bool appCmd = card->appCmd;
+    const bool addressed = ((arg >> 16) == card->rca) && (card->rca != 0U);
+    const uint32_t status = CardStatus(card->state);
+
+    *kind = RESP_NONE;
+    *r1 = 0;
+    model.stats.commands++;
+
+    if (isSd && appCmd && CardAppCommand(idx, arg, kind, r1)) {
+        card->appCmd = false;
+        return;
+    }
+    card->appCmd = false;
+
+    switch (idx) {
+    case 0U:
+        CardReset();
+        break;
+    case 1U:
+        if (!isSd && ((card->state == CARD_IDLE) || (card->state == CARD_READY))) {
+            *r1 = 0x40FF8080U;
+            if (arg != 0U) {
+                *r1 |= 0x80000000U;
+                card->state = CARD_READY;
+            }
+            *kind = RESP_48;
+        }
+        break;
+    case 2U:
+        if (card->state == CARD_READY) {
+            memcpy(r2, card->cid, 16);
+            card->state = CARD_IDENT;
+            *kind = RESP_136;
+        }
+        break;
+    case 3U:
+        if ((card->state == CARD_IDENT) || (card->state == CARD_STBY)) {
+            if (isSd) {
+                card->rca = 0x1234U;
+                *r1 = ((uint32_t)card->rca << 16) | (status & 0x1FFFU);
+            } else {
+                card->rca = (uint16_t)(arg >> 16);
+                *r1 = status;
+            }
+            card->state = CARD_STBY;
+            *kind = RESP_48;
+        }
+        break;
+    case 6U:
+        if (card->state == CARD_TRAN) {
+            if (isSd) {
+                CardSdSwitch(arg);
+            } else {
+                CardMmcSwitch(arg);
+            }
+            *r1 = status;
+            *kind = RESP_48;
+        }
+        break;
+    case 7U:
+        if (addressed) {
+            if (card->state == CARD_STBY) {
+                card->state = CARD_TRAN;
+            }
+            *r1 = status;
+            *kind = RESP_48;
+        } else if (card->state >= CARD_TRAN) {
+            card->state = CARD_STBY;
+        } else {
+            /* deselect of a card which is not selected */
+        }
+        break;
+    case 8U:
+        if (isSd && (card->state == CARD_IDLE)) {
+            *r1 = arg & 0xFFFU;
+            *kind = RESP_48;
+        } else if (!isSd && (card->state == CARD_TRAN)) {
+            CardSetBuffer(card->extCsd, sizeof(card->extCsd));
+            *r1 = status;
+            *kind = RESP_48;
+        } else {
+            /* no response */
+        }
+        break;
+    case 9U:
+    case 10U:
+        if (addressed) {
+            memcpy(r2, (idx == 9U) ? card->csd : card->cid, 16);
+            *kind = RESP_136;
+        }
+        break;
+    case 12U:
+        if ((card->state == CARD_DATA) || (card->state == CARD_RCV)) {
+            card->state = CARD_TRAN;
+        }
+        card->src = DATA_SRC_NONE;
+        *r1 = status;
+        *kind = RESP_48;
+        break;
+    case 13U:
+        if (addressed || (card->state >= CARD_TRAN)) {
+            *r1 = status;
+            *kind = RESP_48;
+        }
+        break;
+    case 16U:
+        card->blockLen = arg;
+        *r1 = status;
+        *kind = RESP_48;
+        break;
+    case 17U:
+    case 18U:
+    case 24U:
+    case 25U:
+        if (card->state == CARD_TRAN) {
+            card->src = DATA_SRC_STORAGE;
+            card->offset = (uint64_t)arg * MODEL_BLOCK_SIZE;
+            card->state = ((idx == 17U) || (idx == 18U)) ? CARD_DATA : CARD_RCV;
+            *r1 = status;
+            *kind = RESP_48;
+        }
+        break;
+    case 19U:
+    case 21U:
+        if (card->state == CARD_TRAN) {
+            CardTuningBlock();
+            *r1 = status;
+            *kind = RESP_48;
+        }
+        break;
+    case 23U:
+        *r1 = status;
+        *kind = RESP_48;
+        break;
+    case 32U:
+    case 35U:
+        card->eraseStart = arg;
+        *r1 = status;
+        *kind = RESP_48;
+        break;
+    case 33U:
+    case 36U:
+        card->eraseEnd = arg;
+        *r1 = status;
+        *kind = RESP_48;
+        break;
+    case 38U:
+        if (card->eraseEnd >= card->eraseStart) {
+            StorageErase(card->eraseStart, card->eraseEnd);
+        }
+        *r1 = status;
+        *kind = RESP_48;
+        break;
+    case 55U:
+        if (isSd) {
+            card->appCmd = true;
+            *r1 = CardStatus(card->state);
+            *kind = RESP_48;
+        }
+        break;
+    default:
+        /* unsupported command, no response */
+        break;
+    }
+}
+
+/******************************************************************************
+ * Interrupts
+ *****************************************************************************/
+
+static uint32_t CqIntStatus(void)
+{
+    return model.cq.status & model.regs[REG_IDX(CQRS.CQRS05)];
+}
+
+static uint32_t IntStatus(void)
+{
+    uint32_t status = model.intStatus;
+
+    if ((status & SRS12_ERR_MASK) != 0U) {
+        status |= SRS12_EINT;
+    }
+    if (CqIntStatus() != 0U) {
+        status |= SRS12_CQINT & REG(SRS.SRS13);
+    }
+    return status;
+}
+
+static bool IrqLine(void)
+{
+    const uint32_t status = IntStatus();
+    bool line = ((status & REG(SRS.SRS14) & ~SRS12_EINT) != 0U);
+
+    if (((REG(SRS.SRS14) & SRS12_CQINT) != 0U)
+        && ((CqIntStatus() & REG(CQRS.CQRS06)) != 0U)) {
+        line = true;
+    }
+    return line;
+}
+
+static void RaiseInt(uint32_t bits)
+{
+    model.intStatus |= bits & REG(SRS.SRS13);
+}
+
+static void CqRaise(uint32_t bits)
+{
+    model.cq.status |= bits;
+}
+
+/******************************************************************************
+ * Data engine
+ *****************************************************************************/
+
+static void DataStop(void)
+{
+    model.data.active = false;
+    model.data.at = MODEL_NEVER;
+    model.data.bufReady = false;
+}
+
+static void AdmaError(void)
+{
+    DataStop();
+    model.adma3.active = false;
+    model.adma3.at = MODEL_NEVER;
+    REG(SRS.SRS21) = (REG(SRS.SRS21) & ~SRS21_EADMAS) | 1U;
+    RaiseInt(SRS12_EADMA);
+}
+
+static void DataFinish(void)
+{
+    ModelData *d = &model.data;
+    RespKind kind;
+    uint32_t r1;
+    uint8_t r2[16];
+
+    DataStop();
+    if (d->autoCmd == 12U) {
+        CardCommand(12U, 0U, &kind, &r1, r2);
+        REG(SRS.SRS07) = r1;
+    }
+    if ((model.card.state == CARD_DATA) || (model.card.state == CARD_RCV)) {
+        model.card.state = CARD_TRAN;
+    }
+    if (d->adma3) {
+        Adma3Next();
+    } else {
+        RaiseInt(SRS12_TC);
+    }
+}
+
+/* copy size bytes between system memory and the card */
+static void DmaMove(uint64_t address, uint32_t size)
+{
+    if (model.data.read) {
+        CardReadData((uint8_t*)(uintptr_t)address, size);
+    } else {
+        CardWriteData((const uint8_t*)(uintptr_t)address, size);
+    }
+}
+
+/* schedule the next data step after size bytes went over the bus */
+static void DataScheduleAfter(uint64_t size)
+{
+    ModelData *d = &model.data;
+
+    d->at = model.now + BusNs(size);
+    if (d->bytesLeft == 0U) {
+        d->finishing = true;
+        if (!d->read) {
+            d->at += model.cfg.writeLatencyNs;
+        }
+    }
+}
+
+static void SdmaStep(void)
+{
+    ModelData *d = &model.data;
+    uint32_t size;
+
+    if (d->pauseNext) {
+        /* stop at the buffer boundary until the host updates the address */
+        d->pauseNext = false;
+        d->paused = true;
+        d->at = MODEL_NEVER;
+        if ((REG(SRS.SRS15) & SRS15_HV4E) != 0U) {
+            REG(SRS.SRS22) = (uint32_t)d->sysAddr;
+            REG(SRS.SRS23) = (uint32_t)(d->sysAddr >> 32);
+        } else {
+            REG(SRS.SRS00) = (uint32_t)d->sysAddr;
+        }
+        RaiseInt(SRS12_DMAINT);
+        return;
+    }
+    if (d->sysAddr == 0U) {
+        AdmaError();
+        return;
+    }
+    size = (uint32_t)Min64(d->bytesLeft, d->boundary - (d->sysAddr % d->boundary));
+    DmaMove(d->sysAddr, size);
+    d->sysAddr += size;
+    d->bytesLeft -= size;
+    if ((d->bytesLeft != 0U) && ((d->sysAddr % d->boundary) == 0U)) {
+        d->pauseNext = true;
+    }
+    DataScheduleAfter(size);
+}
+
+static void SdmaResume(uint64_t address)
+{
+    ModelData *d = &model.data;
+
+    if (d->active && d->paused) {
+        d->paused = false;
+        d->sysAddr = address;
+        d->at = model.now;
+    }
+}
+
+/* ADMA system address shows the next descriptor to fetch */
+static void Adma2PublishAddr(void)
+{
+    const ModelData *d = &model.data;
+
+    if (!d->adma3) {
+        REG(SRS.SRS22) = (uint32_t)d->descAddr;
+        REG(SRS.SRS23) = (uint32_t)(d->descAddr >> 32);
+    }
+}
+
+/* fetch ADMA2 descriptors until a transfer descriptor is found */
+static bool Adma2Fetch(void)
+{
+    ModelData *d = &model.data;
+    const uint32_t srs15 = REG(SRS.SRS15);
+    const bool dma64 = ((srs15 & SRS15_A64B) != 0U);
+    const uint32_t descSize = dma64 ? (((srs15 & SRS15_HV4E) != 0U) ? 16U : 12U) : 8U;
+    uint32_t count;
+
+    for (count = 0; count < CQ_MAX_DESCRIPTORS; count++) {
+        uint32_t attr, act;
+        uint64_t address;
+
+        if ((d->descAddr == 0U) || d->segEnd) {
+            break;
+        }
+        attr = MemRead32(d->descAddr);
+        address = MemRead32(d->descAddr + 4U);
+        if (dma64) {
+            address |= (uint64_t)MemRead32(d->descAddr + 8U) << 32;
+        }
+        if ((attr & ADMA_ATTR_VALID) == 0U) {
+            break;
+        }
+        act = attr & ADMA_ATTR_ACT_MASK;
+        if (act == ADMA_ATTR_ACT_LINK) {
+            d->descAddr = address;
+            continue;
+        }
+        d->descAddr += descSize;
+        d->segEnd = ((attr & ADMA_ATTR_END) != 0U);
+        if (act == ADMA_ATTR_ACT_TRAN) {
+            uint32_t len = attr >> 16;
+            if ((srs15 & SRS15_ADMA2LM) != 0U) {
+                len |= ((attr >> 6) & 0x3FFU) << 16;
+            }
+            d->segAddr = address;
+            d->segLeft = (len == 0U) ? 65536U : len;
+            d->segInt = ((attr & ADMA_ATTR_INT) != 0U);
+            Adma2PublishAddr();
+            return (address != 0U);
+        }
+    }
+    Adma2PublishAddr();
+    return false;
+}
+
+static void Adma2Step(void)
+{
+    ModelData *d = &model.data;
+    uint32_t size;
+
+    if (d->intNext) {
+        d->intNext = false;
+        RaiseInt(SRS12_DMAINT);
+    }
+    if ((d->segLeft == 0U) && !Adma2Fetch()) {
+        AdmaError();
+        return;
+    }
+    size = (uint32_t)Min64(d->segLeft, d->bytesLeft);
+    DmaMove(d->segAddr, size);
+    d->segAddr += size;
+    d->segLeft -= size;
+    d->bytesLeft -= size;
+    if ((d->segLeft == 0U) && d->segInt) {
+        d->intNext = true;
+    }
+    DataScheduleAfter(size);
+}
+
+/* PIO: next block is available in the buffer (read) or may be written */
+static void PioBufferReady(void)
+{
+    ModelData *d = &model.data;
+
+    d->fifoPos = 0;
+    d->bufReady = true;
+    d->at = MODEL_NEVER;
+    if (d->read) {
+        CardReadData(d->fifo, d->blockLen);
+        RaiseInt(SRS12_BRR);
+    } else {
+        RaiseInt(SRS12_BWR);
+    }
+}
+
+/* PIO: host has read or written the whole block */
+static void PioBlockDone(void)
+{
+    ModelData *d = &model.data;
+
+    d->bufReady = false;
+    if (!d->read) {
+        CardWriteData(d->fifo, d->blockLen);
+    }
+    if (!d->infinite) {
+        d->blocksLeft--;
+    }
+    if (d->blocksLeft == 0U) {
+        d->finishing = true;
+        d->at = model.now + BusNs(d->blockLen);
+        if (!d->read) {
+            d->at += model.cfg.writeLatencyNs;
+        }
+    } else {
+        d->at = model.now + BusNs(d->blockLen);
+    }
+}
+
+static void DataStep(void)
+{
+    ModelData *d = &model.data;
+
+    if (d->finishing) {
+        DataFinish();
+    } else if (d->mode == XFER_PIO) {
+        PioBufferReady();
+    } else if (d->mode == XFER_SDMA) {
+        SdmaStep();
+    } else {
+        Adma2Step();
+    }
+}
+
+static uint64_t DataLatency(bool read)
+{
+    uint64_t latency = 0;
+
+    if (read) {
+        latency = (model.card.src == DATA_SRC_STORAGE) ? model.cfg.readLatencyNs
+                                                       : model.cfg.cmdLatencyNs;
+    }
+    return latency;
+}
+
+static void DataStart(const ModelCmd *cmd)
+{
+    ModelData *d = &model.data;
+    const uint32_t srs03 = cmd->srs03;
+    const uint32_t srs01 = REG(SRS.SRS01);
+    const uint32_t srs15 = REG(SRS.SRS15);
+    const uint32_t ace = (srs03 & SRS03_ACE) >> 2;
+    uint32_t count;
+
+    d->active = true;
+    d->read = ((srs03 & SRS03_DTDS) != 0U);
+    d->adma3 = cmd->adma3;
+    d->finishing = false;
+    d->paused = false;
+    d->pauseNext = false;
+    d->intNext = false;
+    d->bufReady = false;
+    d->fifoPos = 0;
+    d->blockLen = srs01 & SRS01_TBS;
+    if (d->blockLen == 0U) {
+        d->blockLen = MODEL_BLOCK_SIZE;
+    }
+    if (d->blockLen > MODEL_FIFO_SIZE) {
+        d->blockLen = MODEL_FIFO_SIZE;
+    }
+
+    count = srs01 >> 16;
+    if (((srs15 & SRS15_HV4E) != 0U) && (count == 0U)) {
+        count = REG(SRS.SRS00);
+    }
+    d->infinite = false;
+    if ((srs03 & SRS03_MSBS) == 0U) {
+        count = 1U;
+    } else if ((srs03 & SRS03_BCE) == 0U) {
+        d->infinite = true;
+    } else {
+        /* block count from the registers */
+    }
+    d->blocksLeft = d->infinite ? 1U : count;
+    d->bytesLeft = d->infinite ? UINT64_MAX : ((uint64_t)count * d->blockLen);
+
+    d->autoCmd = 0;
+    if (((srs03 & SRS03_MSBS) != 0U) && !d->infinite) {
+        if ((ace == 1U) || ((ace == 3U) && ((srs15 & SRS15_CMD23E) == 0U))) {
+            d->autoCmd = 12U;
+        }
+    }
+
+    if (d->adma3) {
+        d->mode = XFER_ADMA2;
+    } else if ((srs03 & SRS03_DMAE) == 0U) {
+        d->mode = XFER_PIO;
+    } else if (((REG(SRS.SRS10) & SRS10_DMASEL) >> 3) == 0U) {
+        d->mode = XFER_SDMA;
+    } else {
+        d->mode = XFER_ADMA2;
+    }
+
+    if (d->mode == XFER_SDMA) {
+        if ((srs15 & SRS15_HV4E) != 0U) {
+            d->sysAddr = REG(SRS.SRS22);
+            if ((srs15 & SRS15_A64B) != 0U) {
+                d->sysAddr |= (uint64_t)REG(SRS.SRS23) << 32;
+            }
+        } else {
+            d->sysAddr = REG(SRS.SRS00);
+        }
+        d->boundary = 4096U << ((srs01 & SRS01_SDMABB) >> 12);
+    } else if (d->mode == XFER_ADMA2) {
+        if (d->adma3) {
+            d->descAddr = model.adma3.dataDescAddr;
+        } else {
+            d->descAddr = REG(SRS.SRS22);
+            if ((srs15 & SRS15_A64B) != 0U) {
+                d->descAddr |= (uint64_t)REG(SRS.SRS23) << 32;
+            }
+        }
+        d->segLeft = 0;
+        d->segEnd = false;
+    } else {
+        /* PIO */
+    }
+
+    if ((d->mode == XFER_PIO) && !d->read) {
+        PioBufferReady();
+    } else if (d->mode == XFER_PIO) {
+        d->at = model.now + DataLatency(true) + BusNs(d->blockLen);
+    } else {
+        d->at = model.now + DataLatency(d->read);
+    }
+}
+
+/******************************************************************************
+ * Command engine
+ *****************************************************************************/
+
+static void SetLongResponse(const uint8_t *b, bool toSrs04Only)
+{
+    REG(SRS.SRS04) = ((uint32_t)b[11] << 24) | ((uint32_t)b[12] << 16)
+                     | ((uint32_t)b[13] << 8) | b[14];
+    if (!toSrs04Only) {
+        REG(SRS.SRS05) = ((uint32_t)b[7] << 24) | ((uint32_t)b[8] << 16)
+                         | ((uint32_t)b[9] << 8) | b[10];
+        REG(SRS.SRS06) = ((uint32_t)b[3] << 24) | ((uint32_t)b[4] << 16)
+                         | ((uint32_t)b[5] << 8) | b[6];
+        REG(SRS.SRS07) = ((uint32_t)b[0] << 16) | ((uint32_t)b[1] << 8) | b[2];
+    }
+}
+
+static uint64_t BusyTime(uint32_t idx)
+{
+    return (idx == 38U) ? model.cfg.writeLatencyNs : model.cfg.cmdLatencyNs;
+}
+
+static void CmdIssue(ModelCmd *cmd, uint32_t srs03, bool adma3)
+{
+    cmd->active = true;
+    cmd->adma3 = adma3;
+    cmd->srs03 = srs03;
+    cmd->arg = REG(SRS.SRS02);
+    cmd->at = model.now + model.cfg.cmdLatencyNs;
+
+    if ((srs03 & SRS03_CT) == SRS03_CT) {
+        /* abort command stops the data transfer in progress */
+        DataStop();
+    }
+}
+
+static void CmdComplete(ModelCmd *cmd, bool subCommand)
+{
+    const uint32_t srs03 = cmd->srs03;
+    const uint32_t idx = (srs03 & SRS03_CIDX) >> 24;
+    const uint32_t rts = (srs03 & SRS03_RTS) >> 16;
+    RespKind kind;
+    uint32_t r1;
+    uint8_t r2[16];
+
+    cmd->active = false;
+    cmd->at = MODEL_NEVER;
+
+    CardCommand(idx, cmd->arg, &kind, &r1, r2);
+    if ((rts != 0U) && (kind == RESP_NONE)) {
+        RaiseInt(SRS12_ECT);
+        if (cmd->adma3) {
+            model.adma3.active = false;
+        }
+        return;
+    }
+    if (rts == 1U) {
+        SetLongResponse(r2, subCommand);
+    } else if (rts != 0U) {
+        REG(SRS.SRS04) = r1;
+    } else {
+        /* no response expected */
+    }
+    if (((srs03 & SRS03_RID) == 0U) && !cmd->adma3) {
+        RaiseInt(SRS12_CC);
+    }
+
+    if (subCommand) {
+        return;
+    }
+    if (((idx == 19U) || (idx == 21U)) && ((REG(SRS.SRS15) & SRS15_EXTNG) != 0U)) {
+        /* tuning block is checked by the controller itself */
+        REG(SRS.SRS15) = (REG(SRS.SRS15) & ~SRS15_EXTNG) | SRS15_SCS;
+        model.card.src = DATA_SRC_NONE;
+        RaiseInt(SRS12_BRR);
+    } else if ((srs03 & SRS03_DPS) != 0U) {
+        DataStart(cmd);
+    } else if (rts == 3U) {
+        model.busyAt = model.now + BusyTime(idx);
+        model.busyAdma3 = cmd->adma3;
+    } else if (cmd->adma3) {
+        Adma3Next();
+    } else {
+        /* command done */
+    }
+}
+
+static void BusyComplete(void)
+{
+    model.busyAt = MODEL_NEVER;
+    if (model.busyAdma3) {
+        Adma3Next();
+    } else {
+        RaiseInt(SRS12_TC);
+    }
+}
+
+/******************************************************************************
+ * ADMA3
+ *****************************************************************************/
+
+static void Adma3Start(void)
+{
+    model.adma3.idAddr = REG(SRS.SRS30);
+    if ((REG(SRS.SRS15) & SRS15_A64B) != 0U) {
+        model.adma3.idAddr |= (uint64_t)REG(SRS.SRS31) << 32;
+    }
+    model.adma3.active = true;
+    model.adma3.last = false;
+    model.adma3.at = model.now;
+}
+
+/* fetch the next integrated descriptor and issue its command */
+static void Adma3Step(void)
+{
+    ModelAdma3 *a = &model.adma3;
+    const bool dma64 = ((REG(SRS.SRS15) & SRS15_A64B) != 0U);
+    uint32_t attr;
+    uint64_t cmdDesc;
+    uint32_t values[ADMA3_CMD_DESC_NUM];
+    uint32_t i;
+
+    a->at = MODEL_NEVER;
+    attr = MemRead32(a->idAddr);
+    cmdDesc = MemRead32(a->idAddr + 4U);
+    if (dma64) {
+        cmdDesc |= (uint64_t)MemRead32(a->idAddr + 8U) << 32;
+    }
+    if (((attr & ADMA_ATTR_VALID) == 0U) || (cmdDesc == 0U)) {
+        AdmaError();
+        return;
+    }
+    a->last = ((attr & ADMA_ATTR_END) != 0U);
+    a->idAddr += dma64 ? 16U : 8U;
+
+    for (i = 0; i < ADMA3_CMD_DESC_NUM; i++) {
+        const uint64_t desc = cmdDesc + ((uint64_t)i * ADMA3_CMD_DESC_SIZE);
+        if ((MemRead32(desc) & ADMA_ATTR_VALID) == 0U) {
+            AdmaError();
+            return;
+        }
+        values[i] = MemRead32(desc + 4U);
+    }
+    a->dataDescAddr = cmdDesc + (ADMA3_CMD_DESC_NUM * ADMA3_CMD_DESC_SIZE);
+    REG(SRS.SRS00) = values[0];
+    REG(SRS.SRS01) = values[1];
+    REG(SRS.SRS02) = values[2];
+    CmdIssue(&model.cmd, values[3], true);
+}
+
+static void Adma3Next(void)
+{
+    if (model.adma3.last || !model.adma3.active) {
+        model.adma3.active = false;
+        RaiseInt(SRS12_TC);
+    } else {
+        model.adma3.at = model.now;
+    }
+}
+
+/******************************************************************************
+ * Command queue
+ *****************************************************************************/
+
+static void CqReset(void)
+{
+    ModelCq *cq = &model.cq;
+
+    cq->status = 0;
+    cq->doorbell = 0;
+    cq->completion = 0;
+    cq->pending = 0;
+    cq->clear = 0;
+    cq->coalCtrl = 0;
+    cq->coalCount = 0;
+    cq->coalAt = MODEL_NEVER;
+    cq->current = -1;
+    cq->at = MODEL_NEVER;
+}
+
+static uint64_t CqSlotAddress(uint32_t task)
+{
+    const uint64_t base = ((uint64_t)REG(CQRS.CQRS09) << 32) | REG(CQRS.CQRS08);
+    const uint32_t slotSize = ((REG(CQRS.CQRS02) & CQRS02_CQTDS) != 0U) ? 32U : 16U;
+
+    return base + ((uint64_t)task * slotSize);
+}
+
+static bool CqIsDcmd(uint32_t task)
+{
+    return (task == CQ_DCMD_TASK) && ((REG(CQRS.CQRS02) & SD4HC__CQRS__CQRS02__CQDCE_MASK) != 0U);
+}
+
+/*
+ * Walk transfer descriptors of a task. Returns number of bytes described, or
+ * 0 if the list is malformed. Data is moved only when move is set.
+ */
+static uint64_t CqTransfer(uint32_t task, bool move)
+{
+    const bool desc128 = ((REG(CQRS.CQRS02) & CQRS02_CQTDS) != 0U);
+    const uint32_t descSize = desc128 ? 16U : 8U;
+    const uint64_t slot = CqSlotAddress(task);
+    const uint32_t taskAttr = MemRead32(slot);
+    const bool read = ((taskAttr & CQ_ATTR_DIR_READ) != 0U);
+    uint64_t offset = (uint64_t)MemRead32(slot + 4U) * MODEL_BLOCK_SIZE;
+    uint64_t desc = slot + descSize;
+    uint64_t total = 0;
+    uint32_t count;
+
+    for (count = 0; count < CQ_MAX_DESCRIPTORS; count++) {
+        const uint32_t attr = MemRead32(desc);
+        const uint32_t act = attr & CQ_ATTR_ACT_MASK;
+        uint64_t address = MemRead32(desc + 4U);
+        uint32_t len = attr >> 16;
+
+        if (desc128) {
+            address |= (uint64_t)MemRead32(desc + 8U) << 32;
+        }
+        if ((attr & CQ_ATTR_VALID) == 0U) {
+            return 0;
+        }
+        if (act == CQ_ATTR_ACT_LINK) {
+            desc = address;
+            continue;
+        }
+        if (act == CQ_ATTR_ACT_TRAN) {
+            if (len == 0U) {
+                len = 65536U;
+            }
+            if (move) {
+                if (read) {
+                    StorageRead(offset, (uint8_t*)(uintptr_t)address, len);
+                    model.stats.blocksRead += len / MODEL_BLOCK_SIZE;
+                } else {
+                    StorageWrite(offset, (const uint8_t*)(uintptr_t)address, len);
+                    model.stats.blocksWritten += len / MODEL_BLOCK_SIZE;
+                }
+            }
+            offset += len;
+            total += len;
+        }
+        if ((attr & CQ_ATTR_END) != 0U) {
+            break;
+        }
+        desc += descSize;
+    }
+    return total;
+}
+
+static void CqSchedule(void)
+{
+    ModelCq *cq = &model.cq;
+    uint32_t ready;
+    uint32_t task;
+    uint64_t duration;
+
+    if ((cq->current >= 0) || ((REG(CQRS.CQRS02) & CQRS02_CQE) == 0U)
+        || ((REG(CQRS.CQRS03) & CQRS03_CQHLT) != 0U)) {
+        return;
+    }
+    ready = cq->doorbell;
+    if (ready == 0U) {
+        return;
+    }
+    task = (uint32_t)__builtin_ctz(ready);
+    cq->current = (int32_t)task;
+
+    if (CqIsDcmd(task)) {
+        duration = model.cfg.cmdLatencyNs;
+    } else {
+        const uint32_t attr = MemRead32(CqSlotAddress(task));
+        const uint64_t size = CqTransfer(task, false);
+        /* CMD44, CMD45, CMD46/CMD47 and the data phase */
+        duration = 3U * (uint64_t)model.cfg.cmdLatencyNs;
+        if (size != 0U) {
+            duration += BusNs(size);
+        }
+        duration += ((attr & CQ_ATTR_DIR_READ) != 0U) ? model.cfg.readLatencyNs
+                                                      : model.cfg.writeLatencyNs;
+        cq->pending |= 1UL << task;
+    }
+    cq->at = model.now + duration;
+}
+
+static void CqCoalescingTimerStart(void)
+{
+    ModelCq *cq = &model.cq;
+    const uint32_t toval = cq->coalCtrl & CQRS07_CQICTOVAL;
+    const uint32_t cqrs01 = MODEL_CQRS01_VALUE;
+    const uint64_t clkKHz = (uint64_t)(cqrs01 & 0x3FFU) * 1000U;
+
+    if ((toval != 0U) && (cq->coalAt == MODEL_NEVER)) {
+        /* timeout is counted in units of 1024 internal timer clocks */
+        cq->coalAt = model.now + (((uint64_t)toval * 1024U * 1000000U) / clkKHz);
+    }
+}
+
+static void CqTaskComplete(void)
+{
+    ModelCq *cq = &model.cq;
+    const uint32_t task = (uint32_t)cq->current;
+    const uint32_t mask = 1UL << task;
+    const uint64_t slot = CqSlotAddress(task);
+    const uint32_t attr = MemRead32(slot);
+    bool error = false;
+
+    cq->current = -1;
+    cq->at = MODEL_NEVER;
+    if ((cq->doorbell & mask) == 0U) {
+        /* task cleared while running */
+        CqSchedule();
+        return;
+    }
+
+    if (CqIsDcmd(task)) {
+        const uint32_t idx = (attr >> 16) & 0x3FU;
+        const uint32_t respType = (attr >> 23) & 3U;
+        RespKind kind;
+        uint32_t r1;
+        uint8_t r2[16];
+        CardCommand(idx, MemRead32(slot + 4U), &kind, &r1, r2);
+        if ((respType != 0U) && (kind == RESP_NONE)) {
+            error = true;
+        }
+        REG(CQRS.CQRS18) = r1;
+    } else if (CqTransfer(task, true) == 0U) {
+        error = true;
+    } else {
+        model.stats.commands += 3U;
+    }
+    model.stats.cqTasks++;
+
+    cq->doorbell &= ~mask;
+    cq->pending &= ~mask;
+    cq->completion |= mask;
+    if (error) {
+        CqRaise(SD4HC__CQRS__CQRS04__CQREDI_MASK);
+    }
+
+    if (((attr & CQ_ATTR_INT) != 0U) || ((cq->coalCtrl & CQRS07_CQICED) == 0U)) {
+        CqRaise(CQRS04_CQTCC);
+    } else {
+        const uint32_t threshold = (cq->coalCtrl & CQRS07_CQICCTH) >> 8;
+        cq->coalCount++;
+        if ((threshold != 0U) && (cq->coalCount >= threshold)) {
+            CqRaise(CQRS04_CQTCC);
+            cq->coalAt = MODEL_NEVER;
+        } else {
+            CqCoalescingTimerStart();
+        }
+    }
+    CqSchedule();
+}
+
+static void CqCoalescingTimeout(void)
+{
+    model.cq.coalAt = MODEL_NEVER;
+    if (model.cq.coalCount != 0U) {
+        CqRaise(CQRS04_CQTCC);
+    }
+}
+
+static void CqWriteCoalescing(uint32_t value)
+{
+    ModelCq *cq = &model.cq;
+    uint32_t ctrl = cq->coalCtrl;
+
+    if ((value & CQRS07_CQICTOVALEN) != 0U) {
+        ctrl = (ctrl & ~CQRS07_CQICTOVAL) | (value & CQRS07_CQICTOVAL);
+    }
+    if ((value & CQRS07_CQICCTHWEN) != 0U) {
+        ctrl = (ctrl & ~CQRS07_CQICCTH) | (value & CQRS07_CQICCTH);
+    }
+    ctrl = (ctrl & ~CQRS07_CQICED) | (value & CQRS07_CQICED);
+    if ((value & CQRS07_CQICCTR) != 0U) {
+        cq->coalCount = 0;
+        cq->coalAt = MODEL_NEVER;
+    }
+    cq->coalCtrl = ctrl;
+}
+
+static uint32_t CqReadCoalescing(void)
+{
+    uint32_t value = model.cq.coalCtrl;
+
+    if (model.cq.coalCount != 0U) {
+        value |= CQRS07_CQICSB;
+    }
+    return value;
+}
+
+static void CqClearTasks(uint32_t mask)
+{
+    ModelCq *cq = &model.cq;
+
+    cq->doorbell &= ~mask;
+    cq->pending &= ~mask;
+}
+
+/******************************************************************************
+ * Reset handling
+ *****************************************************************************/
+
+static void EnginesReset(bool cmdLine, bool datLine)
+{
+    if (cmdLine) {
+        model.cmd.active = false;
+        model.cmd.at = MODEL_NEVER;
+        model.sub.active = false;
+        model.sub.at = MODEL_NEVER;
+    }
+    if (datLine) {
+        DataStop();
+        model.busyAt = MODEL_NEVER;
+        model.adma3.active = false;
+        model.adma3.at = MODEL_NEVER;
+        model.intStatus &= ~(SRS12_BRR | SRS12_BWR);
+    }
+}
+
+static void SlotReset(void)
+{
+    uint32_t i;
+
+    for (i = REG_IDX(SRS.SRS00); i <= REG_IDX(SRS.SRS31); i++) {
+        model.regs[i] = 0;
+    }
+    for (i = REG_IDX(CQRS.CQRS00); i < REG_COUNT; i++) {
+        model.regs[i] = 0;
+    }
+    model.intStatus = 0;
+    EnginesReset(true, true);
+    CqReset();
+}
+
+static const ModelPhyReg phyResetValues[] = {
+    { MODEL_PHY_VERSION_REG, MODEL_PHY_VERSION },
+    { (uint32_t)offsetof(CCP_Regs, phy_dll_obs_reg_0), CCP__PHY_DLL_OBS_REG_0__DLL_LOCK_MASK },
+    { (uint32_t)offsetof(CCP_Regs, phy_features_reg),
+      CCP__PHY_FEATURES_REG__DFI_CLOCK_RATIO_MASK | CCP__PHY_FEATURES_REG__PER_BIT_DESKEW_MASK }
+};
+
+static void ControllerReset(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < REG_IDX(SRS.SRS00); i++) {
+        model.regs[i] = 0;
+    }
+    SlotReset();
+    model.regs[REG_IDX(HRS.HRS00)] = MODEL_HRS00_RESET;
+    model.phyCount = sizeof(phyResetValues) / sizeof(phyResetValues[0]);
+    memcpy(model.phy, phyResetValues, sizeof(phyResetValues));
+    CardReset();
+}
+
+static ModelPhyReg *PhyLookup(uint32_t address, bool create)
+{
+    ModelPhyReg *reg = NULL;
+    uint32_t i;
+
+    for (i = 0; i < model.phyCount; i++) {
+        if (model.phy[i].address == address) {
+            reg = &model.phy[i];
+            break;
+        }
+    }
+    if ((reg == NULL) && create && (model.phyCount < MODEL_PHY_MAX_REGS)) {
+        reg = &model.phy[model.phyCount];
+        reg->address = address;
+        reg->value = 0;
+        model.phyCount++;
+    }
+    return reg;
+}
+
+/******************************************************************************
+ * Event loop
+ *****************************************************************************/
+
+static uint64_t NextEvent(void)
+{
+    uint64_t next = model.cmd.at;
+
+    next = Min64(next, model.sub.at);
+    next = Min64(next, model.busyAt);
+    next = Min64(next, model.data.at);
+    next = Min64(next, model.adma3.at);
+    next = Min64(next, model.cq.at);
+    next = Min64(next, model.cq.coalAt);
+    return next;
+}
+
+static void RunUntil(uint64_t target)
+{
+    for (;;) {
+        const uint64_t next = NextEvent();
+        if (next > target) {
+            break;
+        }
+        if (next > model.now) {
+            model.now = next;
+        }
+        if (model.cmd.at <= model.now) {
+            CmdComplete(&model.cmd, false);
+        } else if (model.sub.at <= model.now) {
+            CmdComplete(&model.sub, true);
+        } else if (model.busyAt <= model.now) {
+            BusyComplete();
+        } else if (model.data.at <= model.now) {
+            DataStep();
+        } else if (model.adma3.at <= model.now) {
+            Adma3Step();
+        } else if (model.cq.at <= model.now) {
+            CqTaskComplete();
+        } else {
+            CqCoalescingTimeout();
+        }
+    }
+    if (target > model.now) {
+        model.now = target;
+    }
+}
+
+/******************************************************************************
+ * Register access
+ *****************************************************************************/
+
+static uint32_t PresentState(void)
+{
+    const ModelData *d = &model.data;
+    uint32_t state = SRS09_CI | SRS09_CSS | SRS09_CDSL | SRS09_WPSL | SRS09_CMDSL;
+    const bool dataBusy = d->active || (model.busyAt != MODEL_NEVER) || model.adma3.active;
+
+    if (model.cmd.active) {
+        state |= SRS09_CICMD;
+    }
+    if (model.sub.active) {
+        state |= SRS09_SCMDS;
+    }
+    if (dataBusy) {
+        state |= SRS09_CIDAT | SRS09_DLA;
+        if (d->active) {
+            state |= d->read ? SRS09_RTA : SRS09_WTA;
+        }
+    }
+    if (d->active && d->bufReady) {
+        state |= d->read ? SRS09_BRE : SRS09_BWE;
+    }
+    if (model.busyAt == MODEL_NEVER) {
+        state |= SRS09_DATSL1;
+    }
+    return state;
+}
+
+static uint32_t ReadFifo(void)
+{
+    ModelData *d = &model.data;
+    uint32_t value = 0;
+
+    if (!d->active || !d->read || d->finishing) {
+        return 0;
+    }
+    if (!d->bufReady) {
+        /* host reads ahead of the buffer ready status */
+        PioBufferReady();
+    }
+    memcpy(&value, &d->fifo[d->fifoPos], sizeof(value));
+    d->fifoPos += 4U;
+    if (d->fifoPos >= d->blockLen) {
+        PioBlockDone();
+    }
+    return value;
+}
+
+static void WriteFifo(uint32_t value)
+{
+    ModelData *d = &model.data;
+
+    if (!d->active || d->read || d->finishing) {
+        return;
+    }
+    if (!d->bufReady) {
+        d->fifoPos = 0;
+        d->bufReady = true;
+        d->at = MODEL_NEVER;
+    }
+    memcpy(&d->fifo[d->fifoPos], &value, sizeof(value));
+    d->fifoPos += 4U;
+    if (d->fifoPos >= d->blockLen) {
+        PioBlockDone();
+    }
+}
+
+static uint32_t ReadRegister(uint32_t idx)
+{
+    uint32_t value = model.regs[idx];
+
+    switch (idx) {
+    case REG_IDX(HRS.HRS05):
+    {
+        const ModelPhyReg *reg = PhyLookup(REG(HRS.HRS04), false);
+        value = (reg != NULL) ? reg->value : 0U;
+        break;
+    }
+    case REG_IDX(HRS.HRS09):
+        value &= ~SD4HC__HRS__HRS09__PHY_INIT_COMPLETE_MASK;
+        if ((value & SD4HC__HRS__HRS09__PHY_SW_RESET_MASK) != 0U) {
+            value |= SD4HC__HRS__HRS09__PHY_INIT_COMPLETE_MASK;
+        }
+        break;
+    case REG_IDX(HRS.HRS30):
+        value = MODEL_HRS30_VALUE;
+        break;
+    case REG_IDX(HRS.HRS31):
+        value = MODEL_HRS31_VALUE;
+        break;
+    case REG_IDX(SRS.SRS08):
+        value = ReadFifo();
+        break;
+    case REG_IDX(SRS.SRS09):
+        value = PresentState();
+        break;
+    case REG_IDX(SRS.SRS12):
+        value = IntStatus();
+        break;
+    case REG_IDX(SRS.SRS16):
+        value = MODEL_SRS16_VALUE;
+        break;
+    case REG_IDX(SRS.SRS17):
+        value = MODEL_SRS17_VALUE;
+        break;
+    case REG_IDX(CRS.CRS63):
+        value = MODEL_CRS63_VALUE | (IrqLine() ? 1U : 0U);
+        break;
+    case REG_IDX(CQRS.CQRS00):
+        value = MODEL_CQRS00_VALUE;
+        break;
+    case REG_IDX(CQRS.CQRS01):
+        value = MODEL_CQRS01_VALUE;
+        break;
+    case REG_IDX(CQRS.CQRS04):
+        value = CqIntStatus();
+        break;
+    case REG_IDX(CQRS.CQRS07):
+        value = CqReadCoalescing();
+        break;
+    case REG_IDX(CQRS.CQRS10):
+        value = model.cq.doorbell;
+        break;
+    case REG_IDX(CQRS.CQRS11):
+        value = model.cq.completion;
+        break;
+    case REG_IDX(CQRS.CQRS13):
+        value = model.cq.pending;
+        break;
+    case REG_IDX(CQRS.CQRS14):
+        value = model.cq.clear;
+        break;
+    default:
+        break;
+    }
+    return value;
+}
+
+static void WriteSrs03(uint32_t value)
+{
+    const bool subCommand = ((value & SRS03_SCF) != 0U)
+                            && (model.data.active || (model.busyAt != MODEL_NEVER));
+
+    model.regs[REG_IDX(SRS.SRS03)] = value;
+    if (subCommand) {
+        CmdIssue(&model.sub, value, false);
+    } else {
+        CmdIssue(&model.cmd, value, false);
+    }
+}
+
+static void WriteSrs10(uint32_t value)
+{
+    const uint32_t old = REG(SRS.SRS10);
+
+    REG(SRS.SRS10) = value;
+    if (((old & SRS10_BP) == 0U) && ((value & SRS10_BP) != 0U)) {
+        /* card power up */
+        CardReset();
+    }
+}
+
+static void WriteSrs11(uint32_t value)
+{
+    uint32_t reg = value & ~(SRS11_SRFA | SRS11_SRCMD | SRS11_SRDAT);
+
+    if ((value & SRS11_SRFA) != 0U) {
+        SlotReset();
+        reg = 0;
+    } else {
+        EnginesReset((value & SRS11_SRCMD) != 0U, (value & SRS11_SRDAT) != 0U);
+    }
+    if ((reg & SRS11_ICE) != 0U) {
+        reg |= SRS11_ICS;
+    } else {
+        reg &= ~SRS11_ICS;
+    }
+    REG(SRS.SRS11) = reg;
+}
+
+static void WriteCqrs02(uint32_t value)
+{
+    const uint32_t old = REG(CQRS.CQRS02);
+
+    REG(CQRS.CQRS02) = value;
+    if (((old & CQRS02_CQE) == 0U) && ((value & CQRS02_CQE) != 0U)) {
+        const uint32_t coal = model.cq.coalCtrl;
+        CqReset();
+        model.cq.coalCtrl = coal;
+    }
+}
+
+static void WriteCqrs03(uint32_t value)
+{
+    const uint32_t old = REG(CQRS.CQRS03);
+    uint32_t reg = (old & CQRS03_CQCAT) | (value & (CQRS03_CQHLT | CQRS03_CQCAT));
+
+    if ((value & CQRS03_CQCAT) != 0U) {
+        /* clear all tasks */
+        CqClearTasks(0xFFFFFFFFU);
+    }
+    REG(CQRS.CQRS03) = reg;
+    if (((old & CQRS03_CQHLT) == 0U) && ((value & CQRS03_CQHLT) != 0U)) {
+        CqRaise(CQRS04_CQHAC);
+    } else if ((value & CQRS03_CQHLT) == 0U) {
+        CqSchedule();
+    } else {
+        /* still halted */
+    }
+}
+
+static void WriteRegister(uint32_t idx, uint32_t value)
+{
+    switch (idx) {
+    case REG_IDX(HRS.HRS00):
+        if ((value & SD4HC__HRS__HRS00__SWR_MASK) != 0U) {
+            ControllerReset();
+        } else {
+            model.regs[idx] = value;
+        }
+        break;
+    case REG_IDX(HRS.HRS05):
+    {
+        ModelPhyReg *reg = PhyLookup(REG(HRS.HRS04), true);
+        if (reg != NULL) {
+            reg->value = value;
+        }
+        break;
+    }
+    case REG_IDX(HRS.HRS06):
+        model.regs[idx] = value & ~0x8000U;   /* tuning request completes at once */
+        break;
+    case REG_IDX(HRS.HRS30):
+    case REG_IDX(HRS.HRS31):
+    case REG_IDX(SRS.SRS09):
+    case REG_IDX(SRS.SRS16):
+    case REG_IDX(SRS.SRS17):
+    case REG_IDX(CRS.CRS63):
+    case REG_IDX(CQRS.CQRS00):
+    case REG_IDX(CQRS.CQRS01):
+    case REG_IDX(CQRS.CQRS13):
+        /* read only */
+        break;
+    case REG_IDX(SRS.SRS00):
+        model.regs[idx] = value;
+        if ((REG(SRS.SRS15) & SRS15_HV4E) == 0U) {
+            SdmaResume(value);
+        }
+        break;
+    case REG_IDX(SRS.SRS03):
+        WriteSrs03(value);
+        break;
+    case REG_IDX(SRS.SRS08):
+        WriteFifo(value);
+        break;
+    case REG_IDX(SRS.SRS10):
+        WriteSrs10(value);
+        break;
+    case REG_IDX(SRS.SRS11):
+        WriteSrs11(value);
+        break;
+    case REG_IDX(SRS.SRS12):
+        model.intStatus &= ~value;
+        break;
+    case REG_IDX(SRS.SRS22):
+        model.regs[idx] = value;
+        if ((REG(SRS.SRS15) & (SRS15_HV4E | SRS15_A64B)) == SRS15_HV4E) {
+            SdmaResume(value);
+        }
+        break;
+    case REG_IDX(SRS.SRS23):
+        model.regs[idx] = value;
+        if ((REG(SRS.SRS15) & (SRS15_HV4E | SRS15_A64B)) == (SRS15_HV4E | SRS15_A64B)) {
+            SdmaResume(((uint64_t)value << 32) | REG(SRS.SRS22));
+        }
+        break;
+    case REG_IDX(SRS.SRS30):
+        model.regs[idx] = value;
+        if ((REG(SRS.SRS15) & SRS15_A64B) == 0U) {
+            Adma3Start();
+        }
+        break;
+    case REG_IDX(SRS.SRS31):
+        model.regs[idx] = value;
+        if ((REG(SRS.SRS15) & SRS15_A64B) != 0U) {
+            Adma3Start();
+        }
+        break;
+    case REG_IDX(CQRS.CQRS02):
+        WriteCqrs02(value);
+        break;
+    case REG_IDX(CQRS.CQRS03):
+        WriteCqrs03(value);
+        break;
+    case REG_IDX(CQRS.CQRS04):
+        model.cq.status &= ~(value & CQRS04_WOCLR);
+        break;
+    case REG_IDX(CQRS.CQRS07):
+        CqWriteCoalescing(value);
+        break;
+    case REG_IDX(CQRS.CQRS10):
+        if ((REG(CQRS.CQRS02) & CQRS02_CQE) != 0U) {
+            model.cq.doorbell |= value;
+            CqSchedule();
+        }
+        break;
+    case REG_IDX(CQRS.CQRS11):
+        model.cq.completion &= ~value;
+        break;
+    case REG_IDX(CQRS.CQRS14):
+        /* tasks are dropped at once, the clear bits stay set until CQ is re-enabled */
+        model.cq.clear |= value;
+        CqClearTasks(value);
+        break;
+    default:
+        model.regs[idx] = value;
+        break;
+    }
+}
+
+/******************************************************************************
+ * Public interface
+ *****************************************************************************/
+
+/* see sd4hc_model.h */
+void SD4HC_ModelGetDefaultConfig(SD4HC_ModelConfig *cfg)
+{
+    const char *card = getenv("SD4HC_MODEL_CARD");
+    const char *image = getenv("SD4HC_MODEL_IMAGE");
+
+    cfg->cardType = SD4HC_MODEL_CARD_SD;
+    if ((card != NULL) && (strcasecmp(card, "emmc") == 0)) {
+        cfg->cardType = SD4HC_MODEL_CARD_EMMC;
+    }
+    cfg->imagePath = ((image != NULL) && (*image != '\0')) ? image : NULL;
+    cfg->capacityMB = EnvU32("SD4HC_MODEL_CAPACITY_MB", 128U);
+    cfg->cmdLatencyNs = EnvU32("SD4HC_MODEL_CMD_LATENCY_NS", 2000U);
+    cfg->readLatencyNs = EnvU32("SD4HC_MODEL_READ_LATENCY_NS", 50000U);
+    cfg->writeLatencyNs = EnvU32("SD4HC_MODEL_WRITE_LATENCY_NS", 100000U);
+    cfg->busKBps = EnvU32("SD4HC_MODEL_BUS_KBPS", 25000U);
+    cfg->mmioLatencyNs = EnvU32("SD4HC_MODEL_MMIO_NS", 30U);
+}
+
+/* see sd4hc_model.h */
+int SD4HC_ModelInit(uintptr_t regBase, const SD4HC_ModelConfig *cfg)
+{
+    int ret = 0;
+
+    pthread_mutex_lock(&model.lock);
+    if (!model.initialized) {
+        if (cfg != NULL) {
+            model.cfg = *cfg;
+        } else {
+            SD4HC_ModelGetDefaultConfig(&model.cfg);
+        }
+        model.base = regBase;
+        model.now = 0;
+        memset(&model.stats, 0, sizeof(model.stats));
+        ret = StorageOpen();
+        if (ret == 0) {
+            CardInitRegisters();
+            ControllerReset();
+            model.initialized = true;
+        } else {
+            StorageClose();
+        }
+    }
+    pthread_mutex_unlock(&model.lock);
+    return ret;
+}
+
+/* see sd4hc_model.h */
+void SD4HC_ModelShutdown(void)
+{
+    pthread_mutex_lock(&model.lock);
+    if (model.initialized) {
+        StorageClose();
+        model.initialized = false;
+        model.isr = NULL;
+    }
+    pthread_mutex_unlock(&model.lock);
+}
+
+/* see sd4hc_model.h */
+bool SD4HC_ModelIsRegister(uintptr_t address)
+{
+    return (address >= model.base) && (address < (model.base + sizeof(SD4HC_Regs)));
+}
+
+/* see sd4hc_model.h */
+uint32_t SD4HC_ModelReadReg(uintptr_t address)
+{
+    uint32_t value;
+
+    pthread_mutex_lock(&model.lock);
+    RunUntil(model.now + model.cfg.mmioLatencyNs);
+    value = ReadRegister((uint32_t)((address - model.base) / 4U));
+    model.stats.regReads++;
+    pthread_mutex_unlock(&model.lock);
+    return value;
+}
+
+/* see sd4hc_model.h */
+void SD4HC_ModelWriteReg(uintptr_t address, uint32_t value)
+{
+    pthread_mutex_lock(&model.lock);
+    RunUntil(model.now + model.cfg.mmioLatencyNs);
+    WriteRegister((uint32_t)((address - model.base) / 4U), value);
+    model.stats.regWrites++;
+    pthread_mutex_unlock(&model.lock);
+}
+
+/* see sd4hc_model.h */
+void SD4HC_ModelDelay(uint64_t ns)
+{
+    void (*isr)(void *arg) = NULL;
+    void *arg = NULL;
+
+    pthread_mutex_lock(&model.lock);
+    RunUntil(model.now + ns);
+    if ((model.isr != NULL) && !model.inIsr && IrqLine()) {
+        isr = model.isr;
+        arg = model.isrArg;
+        model.inIsr = true;
+        model.stats.interrupts++;
+    }
+    pthread_mutex_unlock(&model.lock);
+
+    if (isr != NULL) {
+        isr(arg);
+        pthread_mutex_lock(&model.lock);
+        model.inIsr = false;
+        pthread_mutex_unlock(&model.lock);
+    }
+}
+
+/* see sd4hc_model.h */
+uint64_t SD4HC_ModelGetTimeNs(void)
+{
+    uint64_t now;
+
+    pthread_mutex_lock(&model.lock);
+    now = model.now;
+    pthread_mutex_unlock(&model.lock);
+    return now;
+}
+
+/* see sd4hc_model.h */
+void SD4HC_ModelSetIsr(void (*isr)(void *arg), void *arg)
+{
+    pthread_mutex_lock(&model.lock);
+    model.isr = isr;
+    model.isrArg = arg;
+    pthread_mutex_unlock(&model.lock);
+}
+
+/* see sd4hc_model.h */
+void SD4HC_ModelGetStats(SD4HC_ModelStats *stats)
+{
+    pthread_mutex_lock(&model.lock);
+    *stats = model.stats;
+    pthread_mutex_unlock(&model.lock);
+}
+
+/* see sd4hc_model.h */
+void SD4HC_ModelResetStats(void)
+{
+    pthread_mutex_lock(&model.lock);
+    memset(&model.stats, 0, sizeof(model.stats));
+    pthread_mutex_unlock(&model.lock);
+}
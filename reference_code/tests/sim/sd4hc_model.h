@@ -0,0 +1,168 @@
+/******************************************************************************
+*
+* (C) 2023 Cadence Design Systems, Inc.
+*
+******************************************************************************
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in the
+*    documentation and/or other materials provided with the distribution.
+* 3. Neither the name of the copyright holder nor the names of its
+*    contributors may be used to endorse or promote products derived from
+*    this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+* ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+* LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+* CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+* SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+* INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+* CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+* ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+******************************************************************************
+*
+ ******************************************************************************
+ * sd4hc_model.h
+ *
+ * Software model of the SD4HC host controller and an attached SD or eMMC
+ * memory card. The model sits behind the CPS register accessors (see
+ * cps_sim.c) so the unmodified core driver and reference tests can run on
+ * a build host without controller silicon.
+ *
+ * Time inside the model is virtual: it advances by a fixed amount on every
+ * register access and by the requested amount on every CPS_DelayNs() call,
+ * so throughput and latency figures are repeatable from run to run.
+ ******************************************************************************
+ */
+
+#ifndef SD4HC_MODEL_H
+#define SD4HC_MODEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Type of card attached to the modelled slot */
+typedef enum {
+    SD4HC_MODEL_CARD_SD = 0,
+    SD4HC_MODEL_CARD_EMMC = 1
+} SD4HC_ModelCardType;
+
+/**
+ * Model configuration. SD4HC_ModelGetDefaultConfig() fills the structure
+ * from the SD4HC_MODEL_* environment variables, falling back to the values
+ * documented for each field.
+ */
+typedef struct {
+    /** SD4HC_MODEL_CARD: "sd" (default) or "emmc" */
+    SD4HC_ModelCardType cardType;
+    /** SD4HC_MODEL_IMAGE: backing file for the card, NULL keeps data in RAM */
+    const char *imagePath;
+    /** SD4HC_MODEL_CAPACITY_MB: card capacity, 0 takes the image size (default 128) */
+    uint32_t capacityMB;
+    /** SD4HC_MODEL_CMD_LATENCY_NS: command to response time (default 2000) */
+    uint32_t cmdLatencyNs;
+    /** SD4HC_MODEL_READ_LATENCY_NS: access time before the first read block (default 50000) */
+    uint32_t readLatencyNs;
+    /** SD4HC_MODEL_WRITE_LATENCY_NS: programming time after the last written block (default 100000) */
+    uint32_t writeLatencyNs;
+    /** SD4HC_MODEL_BUS_KBPS: data bus bandwidth in KiB/s, 0 derives it from SD clock and bus width (default 25000) */
+    uint32_t busKBps;
+    /** SD4HC_MODEL_MMIO_NS: virtual time charged for every register access (default 30) */
+    uint32_t mmioLatencyNs;
+} SD4HC_ModelConfig;
+
+/** Counters collected by the model, all monotonic since the last reset */
+typedef struct {
+    uint64_t regReads;
+    uint64_t regWrites;
+    uint64_t commands;
+    uint64_t cqTasks;
+    uint64_t blocksRead;
+    uint64_t blocksWritten;
+    uint64_t bytesRead;
+    uint64_t bytesWritten;
+    uint64_t interrupts;
+    /** virtual time during which the data lines were busy */
+    uint64_t dataBusyNs;
+} SD4HC_ModelStats;
+
+/**
+ * Fill the configuration with defaults and SD4HC_MODEL_* overrides.
+ * @param[out] cfg configuration to fill
+ */
+void SD4HC_ModelGetDefaultConfig(SD4HC_ModelConfig *cfg);
+
+/**
+ * Create the model and map its register file at regBase.
+ * @param[in] regBase address the driver uses as controller base
+ * @param[in] cfg configuration, NULL takes SD4HC_ModelGetDefaultConfig()
+ * @return 0 on success, -1 if the card storage cannot be set up
+ */
+int SD4HC_ModelInit(uintptr_t regBase, const SD4HC_ModelConfig *cfg);
+
+/** Release the card storage and the model state */
+void SD4HC_ModelShutdown(void);
+
+/**
+ * Check if an address falls into the modelled register file.
+ * @param[in] address address to check
+ * @return true if accesses to the address must go through the model
+ */
+bool SD4HC_ModelIsRegister(uintptr_t address);
+
+/**
+ * Read a 32-bit controller register.
+ * @param[in] address register address inside the modelled register file
+ * @return register value
+ */
+uint32_t SD4HC_ModelReadReg(uintptr_t address);
+
+/**
+ * Write a 32-bit controller register.
+ * @param[in] address register address inside the modelled register file
+ * @param[in] value value to write
+ */
+void SD4HC_ModelWriteReg(uintptr_t address, uint32_t value);
+
+/**
+ * Advance virtual time and deliver a pending interrupt to the registered
+ * handler. The handler is never entered recursively.
+ * @param[in] ns nanoseconds to advance
+ */
+void SD4HC_ModelDelay(uint64_t ns);
+
+/**
+ * Get the current virtual time.
+ * @return nanoseconds since the model was created
+ */
+uint64_t SD4HC_ModelGetTimeNs(void);
+
+/**
+ * Register the interrupt handler called while the controller interrupt
+ * line is asserted.
+ * @param[in] isr handler, NULL disconnects the interrupt line
+ * @param[in] arg argument passed to the handler
+ */
+void SD4HC_ModelSetIsr(void (*isr)(void *arg), void *arg);
+
+/**
+ * Get a snapshot of the model counters.
+ * @param[out] stats counters
+ */
+void SD4HC_ModelGetStats(SD4HC_ModelStats *stats);
+
+/** Reset the model counters to zero */
+void SD4HC_ModelResetStats(void);
+
+#endif /* SD4HC_MODEL_H */